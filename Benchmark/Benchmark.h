@@ -0,0 +1,102 @@
+#pragma once
+
+// Additional includes
+#include "Utility.h"
+
+// STL includes
+#include <algorithm>
+
+#ifdef _MSC_VER
+	#include <intrin.h>
+#endif
+
+
+
+/**
+@brief A benchmark registered with BENCHMARK, run by the benchmark executable (see Main.cpp)
+**/
+class Benchmark
+{
+public:
+	using Function = void (*)();
+
+	///@name Construction
+						Benchmark(const char* inName, Function inFunction);	///< Register a benchmark, only used through BENCHMARK
+
+	///@name Registered benchmarks
+	static Benchmark*	sGetFirst()							{ return sFirst; }	///< First registered benchmark, in no particular order
+	Benchmark*			GetNext() const						{ return mNext; }	///< Next registered benchmark, nullptr for the last one
+
+	///@name Properties
+	const char*			GetName() const						{ return mName; }
+	void				Run() const							{ mFunction(); }
+
+private:
+	///@name Properties
+	static Benchmark*	sFirst;								///< Intrusive list of every benchmark
+	const char*			mName;
+	Function			mFunction;
+	Benchmark*			mNext;
+};
+
+
+
+/**
+@brief Define and register a benchmark, the body reports its measurements with gMeasure
+**/
+#define BENCHMARK(inName)																\
+	static void sBenchmark##inName();													\
+	static Benchmark g##inName##Benchmark(#inName, sBenchmark##inName);					\
+	static void sBenchmark##inName()
+
+
+
+/**
+@brief Make the compiler assume @a ioValue and all memory are read and written here, so a measured loop can't be
+folded away. Pass what the loop produced, e.g. the data pointer of a container it filled.
+**/
+extern const void* volatile gBenchmarkEscape;
+
+template<class T>
+inline void gDoNotOptimize(T&& ioValue)
+{
+#ifdef _MSC_VER
+	gBenchmarkEscape = &ioValue;
+	_ReadWriteBarrier();
+#else
+	asm volatile("" : : "r"(&ioValue) : "memory");
+#endif
+}
+
+
+
+/**
+@brief Print a measurement
+**/
+extern void gReport(const char* inLabel, size_t inOperations, uint64_t inBestNS, uint64_t inMedianNS);
+
+
+
+/**
+@brief Time @a inMeasure @a inRepeats times and report the best and median run
+
+@a inSetup and @a inTeardown run before and after every repeat and are not timed. @a inOperations is the amount
+of operations one call of @a inMeasure does, the report also shows the time per operation.
+**/
+template<class S, class M, class T>
+void gMeasure(const char* inLabel, size_t inOperations, int inRepeats, S&& inSetup, M&& inMeasure, T&& inTeardown)
+{
+	Array<uint64_t> times;
+	times.reserve(inRepeats);
+	for (int i = 0; i < inRepeats; ++i)
+	{
+		inSetup();
+		uint64_t start = gGetTimeNS();
+		inMeasure();
+		times.push_back(gGetTimeNS() - start);
+		inTeardown();
+	}
+
+	std::sort(times.begin(), times.end());
+	gReport(inLabel, inOperations, times.front(), times[times.size() / 2]);
+}
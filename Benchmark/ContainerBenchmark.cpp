@@ -0,0 +1,115 @@
+#include "Benchmark.h"
+
+// STL includes
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+
+
+/**
+@brief Keys that look like window pointers: 16 byte aligned and mostly sequential
+**/
+static Array<void*> sMakeKeys(size_t inCount, uintptr_t inBase)
+{
+	Array<void*> keys;
+	keys.reserve(inCount);
+	for (size_t i = 0; i < inCount; ++i)
+		keys.push_back((void*)(inBase + i * 112));
+	return keys;
+}
+
+
+
+/**
+@brief Grow and iterate arrays, build the small temporaries hit testing and painting use
+**/
+BENCHMARK(Array)
+{
+	const int cRepeats = 15;
+	const size_t cCount = 100000;
+	size_t sink = 0;
+
+	gMeasure("push_back x100000 std::vector", cCount, cRepeats, []() { },
+		[&]() { std::vector<uint32_t> values; for (size_t i = 0; i < cCount; ++i) values.push_back((uint32_t)i); gDoNotOptimize(values); }, []() { });
+	gMeasure("push_back x100000 Array", cCount, cRepeats, []() { },
+		[&]() { Array<uint32_t> values; for (size_t i = 0; i < cCount; ++i) values.push_back((uint32_t)i); gDoNotOptimize(values); }, []() { });
+
+	std::vector<uint32_t> std_values(cCount, 1);
+	Array<uint32_t> values(cCount, 1);
+	gMeasure("iterate x100000 std::vector", cCount, cRepeats, []() { },
+		[&]() { size_t sum = 0; for (uint32_t v : std_values) sum += v; gDoNotOptimize(sum); }, []() { });
+	gMeasure("iterate x100000 Array", cCount, cRepeats, []() { },
+		[&]() { size_t sum = 0; for (uint32_t v : values) sum += v; gDoNotOptimize(sum); }, []() { });
+
+	const size_t cTemporaries = 100000;
+	gMeasure("temporary of 6 std::vector", cTemporaries, cRepeats, []() { },
+		[&]() { for (size_t t = 0; t < cTemporaries; ++t) { std::vector<void*> hits; for (size_t i = 0; i < 6; ++i) hits.push_back(&sink); gDoNotOptimize(hits); } }, []() { });
+	gMeasure("temporary of 6 SmallArray<8>", cTemporaries, cRepeats, []() { },
+		[&]() { for (size_t t = 0; t < cTemporaries; ++t) { SmallArray<void*, 8> hits; for (size_t i = 0; i < 6; ++i) hits.push_back(&sink); gDoNotOptimize(hits); } }, []() { });
+}
+
+
+
+/**
+@brief Insert, look up and erase pointer keys, the way the window registry uses its map
+**/
+BENCHMARK(HashMap)
+{
+	const int cRepeats = 15;
+	const size_t cCount = 10000;
+	Array<void*> keys = sMakeKeys(cCount, 0x10000000);
+	Array<void*> missing = sMakeKeys(cCount, 0x70000000);
+	size_t sink = 0;
+
+	gMeasure("insert x10000 std::unordered_map", cCount, cRepeats, []() { },
+		[&]() { std::unordered_map<void*, uint32_t> map; for (size_t i = 0; i < cCount; ++i) map[keys[i]] = (uint32_t)i; gDoNotOptimize(map); }, []() { });
+	gMeasure("insert x10000 HashMap", cCount, cRepeats, []() { },
+		[&]() { HashMap<void*, uint32_t> map; for (size_t i = 0; i < cCount; ++i) map[keys[i]] = (uint32_t)i; gDoNotOptimize(map); }, []() { });
+
+	std::unordered_map<void*, uint32_t> std_map;
+	HashMap<void*, uint32_t> map;
+	for (size_t i = 0; i < cCount; ++i)
+	{
+		std_map[keys[i]] = (uint32_t)i;
+		map[keys[i]] = (uint32_t)i;
+	}
+
+	gMeasure("find hit x10000 std::unordered_map", cCount, cRepeats, []() { },
+		[&]() { for (void* key : keys) sink += std_map.find(key)->second; gDoNotOptimize(sink); }, []() { });
+	gMeasure("find hit x10000 HashMap", cCount, cRepeats, []() { },
+		[&]() { for (void* key : keys) sink += map.find(key)->second; gDoNotOptimize(sink); }, []() { });
+	gMeasure("find miss x10000 std::unordered_map", cCount, cRepeats, []() { },
+		[&]() { for (void* key : missing) sink += std_map.count(key); gDoNotOptimize(sink); }, []() { });
+	gMeasure("find miss x10000 HashMap", cCount, cRepeats, []() { },
+		[&]() { for (void* key : missing) sink += map.count(key); gDoNotOptimize(sink); }, []() { });
+
+	gMeasure("erase x10000 std::unordered_map", cCount, cRepeats, [&]() { for (size_t i = 0; i < cCount; ++i) std_map[keys[i]] = (uint32_t)i; },
+		[&]() { for (void* key : keys) sink += std_map.erase(key); gDoNotOptimize(std_map); }, []() { });
+	gMeasure("erase x10000 HashMap", cCount, cRepeats, [&]() { for (size_t i = 0; i < cCount; ++i) map[keys[i]] = (uint32_t)i; },
+		[&]() { for (void* key : keys) sink += map.erase(key); gDoNotOptimize(map); }, []() { });
+
+	gLog("  (%zu)\n", sink);
+}
+
+
+
+/**
+@brief Build and copy short strings (window titles) and long strings (log lines)
+**/
+BENCHMARK(String)
+{
+	const int cRepeats = 15;
+	const size_t cCount = 100000;
+	const char* short_text = "Hello, Window!";
+	const char* long_text = "A log line that is too long for any small string optimization to keep inline";
+
+	gMeasure("short construct+copy std::string", cCount, cRepeats, []() { },
+		[&]() { for (size_t i = 0; i < cCount; ++i) { std::string text(short_text); std::string copy(text); gDoNotOptimize(text); gDoNotOptimize(copy); } }, []() { });
+	gMeasure("short construct+copy String", cCount, cRepeats, []() { },
+		[&]() { for (size_t i = 0; i < cCount; ++i) { String text(short_text); String copy(text); gDoNotOptimize(text); gDoNotOptimize(copy); } }, []() { });
+	gMeasure("long construct+copy std::string", cCount, cRepeats, []() { },
+		[&]() { for (size_t i = 0; i < cCount; ++i) { std::string text(long_text); std::string copy(text); gDoNotOptimize(text); gDoNotOptimize(copy); } }, []() { });
+	gMeasure("long construct+copy String", cCount, cRepeats, []() { },
+		[&]() { for (size_t i = 0; i < cCount; ++i) { String text(long_text); String copy(text); gDoNotOptimize(text); gDoNotOptimize(copy); } }, []() { });
+}
@@ -0,0 +1,100 @@
+#include "Benchmark.h"
+
+// Additional includes
+#include "Delegate.h"
+
+// STL includes
+#include <functional>
+#include <vector>
+
+
+
+/**
+@brief Subscriber that replaces itself with a copy every time it is called
+**/
+struct SelfReplacing
+{
+	bool					operator()(int inValue) const
+	{
+		mDelegate->Unsubscribe((*mTokens)[mIndex]);
+		(*mTokens)[mIndex] = mDelegate->Subscribe(SelfReplacing(*this));
+		return false;
+	}
+
+	Delegate<bool(int)>*	mDelegate;
+	Array<DelegateToken>*	mTokens;
+	size_t					mIndex;
+};
+
+
+
+/**
+@brief Broadcast to and churn the subscribers of a delegate, the way panels attach to window events
+**/
+BENCHMARK(Delegate)
+{
+	const int cRepeats = 15;
+	const size_t cSubscribers = 16;
+	const size_t cBroadcasts = 100000;
+	size_t sink = 0;
+
+	// The captures of a typical panel listener: a pointer to its own state and some values
+	size_t counters[cSubscribers] = { };
+	std::vector<std::function<bool(int)>> std_listeners;
+	Delegate<bool(int)> delegate;
+	for (size_t i = 0; i < cSubscribers; ++i)
+	{
+		size_t* target = &counters[i];
+		size_t id = i, mask = 7, extra = i * 3;
+		std_listeners.push_back([target, id, mask, extra](int inValue) { *target += id + extra; return ((size_t)inValue & mask) == id; });
+		delegate.Subscribe([target, id, mask, extra](int inValue) { *target += id + extra; return ((size_t)inValue & mask) == id; });
+	}
+
+	gMeasure("broadcast to 16 x100000 Delegate", cBroadcasts, cRepeats, []() { },
+		[&]() { for (size_t b = 0; b < cBroadcasts; ++b) sink += delegate.Broadcast((int)b); gDoNotOptimize(sink); }, []() { });
+
+	gMeasure("broadcast to 16 x100000 std::vector<std::function>", cBroadcasts, cRepeats, []() { },
+		[&]()
+		{
+			for (size_t b = 0; b < cBroadcasts; ++b)
+			{
+				bool handled = false;
+				for (const std::function<bool(int)>& listener : std_listeners)
+					handled |= listener((int)b);
+				sink += handled;
+			}
+			gDoNotOptimize(sink);
+		}, []() { });
+
+	// The delegate escapes every iteration, otherwise its empty check is hoisted out of the loop
+	Delegate<bool(int)> empty;
+	gMeasure("broadcast to 0 x100000 Delegate", cBroadcasts, cRepeats, []() { },
+		[&]() { for (size_t b = 0; b < cBroadcasts; ++b) { gDoNotOptimize(empty); sink += empty.Broadcast((int)b); } }, []() { });
+
+	// Unsubscribing in a scattered order, every one is a token lookup and a swap with the last subscriber
+	const size_t cChurn = 1000;
+	Array<DelegateToken> tokens(cChurn);
+	Delegate<bool(int)> churn;
+	gMeasure("subscribe + unsubscribe x1000", cChurn, cRepeats, []() { },
+		[&]()
+		{
+			for (size_t i = 0; i < cChurn; ++i)
+				tokens[i] = churn.Subscribe([&sink](int inValue) { sink += inValue; return false; });
+			for (size_t i = 0; i < cChurn; ++i)
+				churn.Unsubscribe(tokens[(i * 397) % cChurn]);
+			gDoNotOptimize(churn);
+		}, []() { });
+
+	// Every subscriber unsubscribes itself and subscribes a replacement while the delegate broadcasts
+	Delegate<bool(int)> mutating;
+	Array<DelegateToken> mutating_tokens(cSubscribers);
+	for (size_t i = 0; i < cSubscribers; ++i)
+		mutating_tokens[i] = mutating.Subscribe(SelfReplacing { &mutating, &mutating_tokens, i });
+	const size_t cMutations = 10000;
+	gMeasure("broadcast to 16 replacing themselves x10000", cMutations * cSubscribers, cRepeats, []() { },
+		[&]() { for (size_t b = 0; b < cMutations; ++b) sink += mutating.Broadcast((int)b); gDoNotOptimize(sink); }, []() { });
+
+	for (size_t counter : counters)
+		sink += counter;
+	gLog("  (%zu)\n", sink);
+}
@@ -0,0 +1,63 @@
+#include "Benchmark.h"
+
+// Additional includes
+#include "Framebuffer.h"
+
+
+
+/**
+@brief Draw with the framebuffer primitives at the sizes of a tool panel and a full HD viewport
+**/
+BENCHMARK(Framebuffer)
+{
+	const int cRepeats = 15;
+	const struct { const char* mName; int mWidth, mHeight; } cSizes[] = { { "400x400", 400, 400 }, { "1920x1080", 1920, 1080 } };
+
+	for (const auto& size : cSizes)
+	{
+		Framebuffer framebuffer(size.mWidth, size.mHeight);
+		size_t pixels = (size_t)size.mWidth * size.mHeight;
+		int width = size.mWidth, height = size.mHeight;
+
+		// Whole frame fills, the operations are pixels so the results compare across sizes
+		gMeasure(gFormat("Clear %s", size.mName).c_str(), pixels, cRepeats, []() { },
+			[&]() { framebuffer.Clear(gMakeColor(37, 37, 38)); gDoNotOptimize(framebuffer); }, []() { });
+		gMeasure(gFormat("BlendRect full %s", size.mName).c_str(), pixels, cRepeats, []() { },
+			[&]() { framebuffer.BlendRect({ 0, 0, width, height }, gMakeColor(255, 255, 255, 40)); gDoNotOptimize(framebuffer); }, []() { });
+
+		// Widget sized rectangles at odd offsets, so the SIMD loops have unaligned heads and tails
+		const int cRects = 1000;
+		const int rect_w = 37, rect_h = 21;
+		gMeasure(gFormat("FillRect %dx%d x%d %s", rect_w, rect_h, cRects, size.mName).c_str(), (size_t)cRects * rect_w * rect_h, cRepeats, []() { },
+			[&]()
+			{
+				for (int i = 0; i < cRects; ++i)
+					framebuffer.FillRect({ (i * 131) % (width - rect_w), (i * 71) % (height - rect_h), rect_w, rect_h }, gMakeColor(0, 122, 204));
+				gDoNotOptimize(framebuffer);
+			}, []() { });
+		gMeasure(gFormat("BlendRect %dx%d x%d %s", rect_w, rect_h, cRects, size.mName).c_str(), (size_t)cRects * rect_w * rect_h, cRepeats, []() { },
+			[&]()
+			{
+				for (int i = 0; i < cRects; ++i)
+					framebuffer.BlendRect({ (i * 131) % (width - rect_w), (i * 71) % (height - rect_h), rect_w, rect_h }, gMakeColor(255, 255, 255, 40));
+				gDoNotOptimize(framebuffer);
+			}, []() { });
+
+		// Lines in every direction across the frame, opaque and blended, the operations are lines
+		const int cLines = 1000;
+		gMeasure(gFormat("DrawLine opaque x%d %s", cLines, size.mName).c_str(), cLines, cRepeats, []() { },
+			[&]()
+			{
+				for (int i = 0; i < cLines; ++i)
+					framebuffer.DrawLine((i * 37) % width, (i * 53) % height, (i * 91) % width, (i * 17) % height, gMakeColor(255, 200, 0));
+				gDoNotOptimize(framebuffer);
+			}, []() { });
+		gMeasure(gFormat("DrawLine blended x%d %s", cLines, size.mName).c_str(), cLines, cRepeats, []() { },
+			[&]()
+			{
+				for (int i = 0; i < cLines; ++i)
+					framebuffer.DrawLine((i * 37) % width, (i * 53) % height, (i * 91) % width, (i * 17) % height, gMakeColor(255, 200, 0, 160));
+				gDoNotOptimize(framebuffer);
+			}, []() { });
+	}
+}
@@ -0,0 +1,205 @@
+#include "Benchmark.h"
+
+// Additional includes
+#include "Input.h"
+#include "Platform.h"
+#include "PlatformHeadless.h"
+#include "Pointer.h"
+
+#ifndef WINDOW_PLATFORM_HEADLESS
+	#include <windows.h>
+#endif
+
+
+
+/**
+@brief Window that receives the benchmark messages
+**/
+class InputBenchmarkWindow : public Window { };
+
+
+
+/**
+@brief Window that wants the pointer samples, so they are batched for it
+**/
+class PointerBenchmarkWindow : public InputBenchmarkWindow
+{
+public:
+	virtual void OnPointerBatch(PointerBatch inSamples) override { mSamples += inSamples.size(); }
+
+	size_t mSamples = 0;
+};
+
+
+
+/**
+@brief Destroy the windows of a benchmark, not timed
+**/
+static void sDestroyWindows(Array<InputBenchmarkWindow*>& ioWindows)
+{
+#ifdef WINDOW_PLATFORM_HEADLESS
+	for (InputBenchmarkWindow* window : ioWindows)
+		Headless::sPostDestroy(window);
+	Headless::sPumpMessages();
+#else
+	for (InputBenchmarkWindow* window : ioWindows)
+		DestroyWindow((HWND)window->GetNativeHandle());
+#endif
+	ioWindows.clear();
+}
+
+
+
+/**
+@brief Message for @a inWindow as the platform backend would send it
+**/
+static Message sMakeMessage(const Window* inWindow, EMessage inType, KeyCode inKeyCode = 0)
+{
+	Message message;
+	message.mHandle		= inWindow->GetHandle();
+	message.mType		= inType;
+	message.mKeyCode	= inKeyCode;
+	message.mTimeNS		= gGetTimeNS();
+	return message;
+}
+
+
+
+/**
+@brief Empty the input event queue, so the timed part never measures a full queue dropping events
+**/
+static void sDrainInputEvents()
+{
+	static InputEvent events[64];
+	while (Input::sDrainEvents(events, 64) > 0) { }
+}
+
+
+
+/**
+@brief Key state queries and the key code translation a key message goes through
+**/
+BENCHMARK(Input)
+{
+	const int cRepeats = 15;
+	const size_t cCount = 1000000;
+	size_t sink = 0;
+
+	Array<InputBenchmarkWindow*> windows;
+	windows.push_back(Window::sCreate<InputBenchmarkWindow>({ 0, 0, 320, 240 }, "Benchmark"));
+
+	// Hold Ctrl and Shift, so some queries are true and some are false
+	gDispatchMessage(sMakeMessage(windows[0], EMessage::KeyDown, 0x11));
+	gDispatchMessage(sMakeMessage(windows[0], EMessage::KeyDown, 0x10));
+
+	gMeasure("sIsDown key x1000000", cCount, cRepeats, []() { },
+		[&]() { for (size_t i = 0; i < cCount; ++i) sink += Input::sIsDown((i & 1) != 0 ? KEY_CTRL : KEY_S); }, []() { });
+
+	constexpr KeyCombination cSave = KEY_CTRL | KEY_S;
+	constexpr KeyCombination cSaveAs = KEY_CTRL | KEY_SHIFT | KEY_S;
+	constexpr KeyCombination cMenu = KEY_CTRL | KEY_SHIFT;
+	gMeasure("sIsDown combination x1000000", cCount, cRepeats, []() { },
+		[&]() { for (size_t i = 0; i < cCount; ++i) sink += Input::sIsDown((i & 1) != 0 ? cMenu : ((i & 2) != 0 ? cSave : cSaveAs)); }, []() { });
+
+	// Every key message translates its key code and sets the key with Input::sSetDown
+	const KeyCode cKeyCodes[] = { 'A', 'S', 'W', 'D', 0x20, 0x0D, 0x25, 0x70 };
+	const size_t cMessages = 2 * sizeof(cKeyCodes) * 128;
+	gMeasure("sSetDown via KeyDown + KeyUp x2048", cMessages, cRepeats, []() { sDrainInputEvents(); },
+		[&]()
+		{
+			for (size_t i = 0; i < cMessages / 2; ++i)
+			{
+				KeyCode key_code = cKeyCodes[i % sizeof(cKeyCodes)];
+				gDispatchMessage(sMakeMessage(windows[0], EMessage::KeyDown, key_code));
+				gDispatchMessage(sMakeMessage(windows[0], EMessage::KeyUp, key_code));
+			}
+		}, []() { });
+
+	gDispatchMessage(sMakeMessage(windows[0], EMessage::KeyUp, 0x11));
+	gDispatchMessage(sMakeMessage(windows[0], EMessage::KeyUp, 0x10));
+	sDrainInputEvents();
+	sDestroyWindows(windows);
+
+	gLog("  (%zu)\n", sink);
+}
+
+
+
+/**
+@brief Window lookup and dispatch of gDispatchMessage, the platform independent part of the window procedure
+**/
+BENCHMARK(Dispatch)
+{
+	const int cRepeats = 15;
+	const size_t cWindows = 1000;
+	const size_t cMessages = 10000;
+
+	Array<InputBenchmarkWindow*> windows;
+	for (size_t i = 0; i < cWindows; ++i)
+		windows.push_back(Window::sCreate<InputBenchmarkWindow>({ 0, 0, 320, 240 }, "Benchmark"));
+
+	// Handles that are not in the table, the dispatcher drops these after the lookup
+	Message unknown;
+	unknown.mType = EMessage::KeyDown;
+	gMeasure("gDispatchMessage unknown window x10000", cMessages, cRepeats, []() { },
+		[&]() { for (size_t i = 0; i < cMessages; ++i) gDispatchMessage(unknown); }, []() { });
+
+	// Wheel messages only add a sample to the batch of their window, so this is mostly lookup
+	Array<Message> wheel;
+	for (size_t i = 0; i < cMessages; ++i)
+	{
+		Message message = sMakeMessage(windows[(i * 7) % cWindows], EMessage::MouseWheel);
+		message.mWheel = 120;
+		wheel.push_back(message);
+	}
+	gMeasure("gDispatchMessage MouseWheel x10000 over 1000 windows", cMessages, cRepeats, []() { Pointer::sEndFrame(); },
+		[&]() { for (const Message& message : wheel) gDispatchMessage(message); }, []() { });
+
+	// Cursor messages to a window without OnPointerBatch only update the cursor state, the other one batches them
+	PointerBenchmarkWindow* pointer_window = Window::sCreate<PointerBenchmarkWindow>({ 0, 0, 320, 240 }, "Benchmark");
+	windows.push_back(pointer_window);
+	for (InputBenchmarkWindow* window : { windows[0], (InputBenchmarkWindow*)pointer_window })
+	{
+		Array<Message> move;
+		for (size_t i = 0; i < cMessages; ++i)
+		{
+			Message message = sMakeMessage(window, EMessage::MouseMove);
+			message.mX = (int)(i & 255);
+			message.mY = (int)(i >> 8);
+			move.push_back(message);
+		}
+		gMeasure(window == pointer_window ? "gDispatchMessage MouseMove x10000 with OnPointerBatch" : "gDispatchMessage MouseMove x10000 without handler", cMessages, cRepeats, []() { Pointer::sEndFrame(); },
+			[&]() { for (const Message& message : move) gDispatchMessage(message); }, []() { });
+	}
+
+	// Button messages go through the input state and the event queue as well
+	gMeasure("gDispatchMessage MouseDown + MouseUp x10000", cMessages, cRepeats, []() { sDrainInputEvents(); },
+		[&]()
+		{
+			for (size_t i = 0; i < cMessages / 2; ++i)
+			{
+				InputBenchmarkWindow* window = windows[(i * 7) % cWindows];
+				gDispatchMessage(sMakeMessage(window, EMessage::MouseDown, 0x01));
+				gDispatchMessage(sMakeMessage(window, EMessage::MouseUp, 0x01));
+			}
+		}, []() { });
+
+#ifdef WINDOW_PLATFORM_HEADLESS
+	// The whole path of a platform message: queue, pump and dispatch
+	gMeasure("Headless post + pump x10000", cMessages, cRepeats, []() { sDrainInputEvents(); },
+		[&]()
+		{
+			for (size_t i = 0; i < cMessages / 2; ++i)
+			{
+				InputBenchmarkWindow* window = windows[(i * 7) % cWindows];
+				Headless::sPostMouseDown(window, 0x01);
+				Headless::sPostMouseUp(window, 0x01);
+			}
+			Headless::sPumpMessages();
+		}, []() { });
+#endif
+
+	Pointer::sEndFrame();
+	sDrainInputEvents();
+	sDestroyWindows(windows);
+}
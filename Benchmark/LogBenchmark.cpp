@@ -0,0 +1,41 @@
+#include "Benchmark.h"
+
+// STL includes
+#include <cstdio>
+
+
+
+/**
+@brief Cost of a log line on the calling thread: the synchronous fprintf gLog used to be against the asynchronous logger
+**/
+BENCHMARK(Log)
+{
+	const int cRepeats = 15;
+	const size_t cCount = 1000;
+	const char* cTextPath = "LogBenchmark.txt";
+	const char* cBinaryPath = "LogBenchmark.bin";
+
+	// The paint handler line, written to a file so the console does not hide the difference
+	FILE* file = gOpenFile(cTextPath, "w");
+	if (file == nullptr)
+		return;
+	gMeasure("fprintf x1000 (old gLog)", cCount, cRepeats, []() { },
+		[&]() { for (size_t i = 0; i < cCount; ++i) { fprintf(file, "[REDRAW] \t%d\n", (int)i); fflush(file); } }, []() { });
+	fclose(file);
+
+	// Every repeat writes a fresh binary file, the report itself goes to the console
+	auto open_binary = [cBinaryPath]() { Log::sOpenBinary(cBinaryPath); };
+	auto close_binary = []() { Log::sOpenBinary(nullptr); };
+	gMeasure("gLog x1000 (binary)", cCount, cRepeats, open_binary,
+		[&]() { for (size_t i = 0; i < cCount; ++i) gLog("[REDRAW] \t%d\n", (int)i); }, close_binary);
+	gMeasure("gLog x1000 with a string (binary)", cCount, cRepeats, open_binary,
+		[&]() { for (size_t i = 0; i < cCount; ++i) gLog("[RESIZE] \t%s %dx%d\n", "main window", (int)i, (int)i); }, close_binary);
+	gMeasure("Log::sFlush of 1000 lines (binary)", cCount, cRepeats, [&]() { open_binary(); for (size_t i = 0; i < cCount; ++i) gLog("[REDRAW] \t%d\n", (int)i); },
+		[]() { Log::sFlush(); }, close_binary);
+
+	LogStats stats = Log::sGetStats();
+	gLog("  %llu messages, %llu dropped, %llu bytes\n", (unsigned long long)stats.mWritten, (unsigned long long)stats.mDropped, (unsigned long long)stats.mBytes);
+
+	remove(cTextPath);
+	remove(cBinaryPath);
+}
@@ -0,0 +1,165 @@
+#include "Benchmark.h"
+
+// STL includes
+#include <cstring>
+
+
+
+/**
+@brief Intrusive list of every registered benchmark
+**/
+Benchmark* Benchmark::sFirst = nullptr;
+
+
+
+/**
+@brief Target of gDoNotOptimize without inline assembly
+**/
+const void* volatile gBenchmarkEscape = nullptr;
+
+
+
+/**
+@brief Register a benchmark
+**/
+Benchmark::Benchmark(const char* inName, Function inFunction) :
+	mName(inName),
+	mFunction(inFunction),
+	mNext(sFirst)
+{
+	sFirst = this;
+}
+
+
+
+/**
+@brief Measurement of a gMeasure call, kept for the JSON output
+**/
+struct BenchmarkResult
+{
+	const char*			mBenchmark;			///< Name of the benchmark that made the measurement
+	String				mLabel;				///< Label passed to gMeasure
+	size_t				mOperations;		///< Operations per run
+	uint64_t			mBestNS;			///< Fastest run in nanoseconds
+	uint64_t			mMedianNS;			///< Median run in nanoseconds
+};
+
+
+
+/**
+@brief Every measurement so far and the benchmark that is running
+**/
+static Array<BenchmarkResult> gResults;
+static const char* gCurrentBenchmark = "";
+
+
+
+/**
+@brief Print a measurement
+**/
+void gReport(const char* inLabel, size_t inOperations, uint64_t inBestNS, uint64_t inMedianNS)
+{
+	gResults.push_back({ gCurrentBenchmark, inLabel, inOperations, inBestNS, inMedianNS });
+
+	gLog("  %-40s %8zu ops  best %10.1f us  median %10.1f us  %10.1f ns/op\n", inLabel, inOperations,
+		 inBestNS * 1e-3, inMedianNS * 1e-3, (double)inBestNS / (inOperations > 0 ? inOperations : 1));
+}
+
+
+
+/**
+@brief Write @a inString as a JSON string
+**/
+static void sWriteJSONString(FILE* inFile, const char* inString)
+{
+	fputc('"', inFile);
+	for (const char* c = inString; *c != 0; ++c)
+	{
+		if (*c == '"' || *c == '\\')
+			fprintf(inFile, "\\%c", *c);
+		else if ((unsigned char)*c < 0x20)
+			fprintf(inFile, "\\u%04x", (unsigned)*c);
+		else
+			fputc(*c, inFile);
+	}
+	fputc('"', inFile);
+}
+
+
+
+/**
+@brief Write every measurement as JSON, one object per gMeasure call, returns false if the file can't be written
+**/
+static bool sWriteJSON(const char* inPath)
+{
+	FILE* file = gOpenFile(inPath, "w");
+	if (file == nullptr)
+		return false;
+
+#ifdef WINDOW_PLATFORM_HEADLESS
+	const char* platform = "headless";
+#else
+	const char* platform = "win32";
+#endif
+#ifdef _DEBUG
+	const char* configuration = "debug";
+#else
+	const char* configuration = "release";
+#endif
+
+	fprintf(file, "{\n  \"platform\": \"%s\",\n  \"configuration\": \"%s\",\n  \"results\": [", platform, configuration);
+	for (size_t i = 0; i < gResults.size(); ++i)
+	{
+		const BenchmarkResult& result = gResults[i];
+		fprintf(file, "%s\n    { \"benchmark\": ", i > 0 ? "," : "");
+		sWriteJSONString(file, result.mBenchmark);
+		fprintf(file, ", \"name\": ");
+		sWriteJSONString(file, result.mLabel.c_str());
+		fprintf(file, ", \"operations\": %zu, \"best_ns\": %llu, \"median_ns\": %llu, \"ns_per_op\": %.3f }", result.mOperations,
+			(unsigned long long)result.mBestNS, (unsigned long long)result.mMedianNS, (double)result.mBestNS / (result.mOperations > 0 ? result.mOperations : 1));
+	}
+	fprintf(file, "\n  ]\n}\n");
+
+	bool ok = ferror(file) == 0;
+	fclose(file);
+	return ok;
+}
+
+
+
+/**
+@brief Entry Point: Benchmark [filter] [--json <output>]
+
+Runs every benchmark or only the ones whose name contains the filter. With --json every measurement is also
+written to a JSON file, so runs can be compared by tools to catch regressions.
+**/
+int main(int inArgCount, char** inArgs)
+{
+	const char* filter = nullptr;
+	const char* json_path = nullptr;
+	for (int i = 1; i < inArgCount; ++i)
+	{
+		if (strcmp(inArgs[i], "--json") == 0 && i + 1 < inArgCount)
+			json_path = inArgs[++i];
+		else
+			filter = inArgs[i];
+	}
+
+	for (Benchmark* benchmark = Benchmark::sGetFirst(); benchmark != nullptr; benchmark = benchmark->GetNext())
+	{
+		if (filter != nullptr && strstr(benchmark->GetName(), filter) == nullptr)
+			continue;
+
+		gLog("[BENCHMARK] \t%s\n", benchmark->GetName());
+		gCurrentBenchmark = benchmark->GetName();
+		benchmark->Run();
+	}
+
+	if (json_path != nullptr && !sWriteJSON(json_path))
+	{
+		gLogError("Can't write %s\n", json_path);
+		return 1;
+	}
+
+	return 0;
+}
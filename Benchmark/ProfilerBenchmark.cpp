@@ -0,0 +1,34 @@
+#include "Benchmark.h"
+
+// Additional includes
+#include "Profiler.h"
+
+
+
+/**
+@brief Cost of the instrumentation a profiled dispatch adds: a histogram record and a full begin and end
+**/
+BENCHMARK(Profiler)
+{
+	const int cRepeats = 15;
+	const size_t cCount = 1000000;
+
+	Histogram histogram;
+	gMeasure("Histogram::Record x1000000", cCount, cRepeats, [&]() { histogram.Reset(); },
+		[&]() { for (size_t i = 0; i < cCount; ++i) histogram.Record(i * 37); }, []() { });
+
+	// Messages for a handful of windows, so the per window lookup is part of the measurement
+	Message messages[4];
+	for (int i = 0; i < 4; ++i)
+	{
+		messages[i].mHandle	= WindowHandle(0x10000 + i);
+		messages[i].mType	= EMessage::MouseMove;
+	}
+
+	gMeasure("Profiler dispatch x1000000", cCount, cRepeats, []() { Profiler::sReset(); },
+		[&]() { for (size_t i = 0; i < cCount; ++i) { const Message& message = messages[(i >> 4) & 3]; Profiler::sEndDispatch(message, Profiler::sBeginDispatch(message)); } }, []() { });
+	gMeasure("Profiler dispatch x1000000 while tracing", cCount, cRepeats, []() { Profiler::sReset(); Profiler::sStartTrace(cCount); },
+		[&]() { for (size_t i = 0; i < cCount; ++i) { const Message& message = messages[(i >> 4) & 3]; Profiler::sEndDispatch(message, Profiler::sBeginDispatch(message)); } }, []() { Profiler::sStopTrace(); });
+
+	Profiler::sReset();
+}
@@ -0,0 +1,71 @@
+#include "Benchmark.h"
+
+// Additional includes
+#include "PlatformHeadless.h"
+#include "Replayer.h"
+
+
+
+/**
+@brief Window with cheap handlers, so the replay measures the dispatch path
+**/
+class ReplayBenchmarkWindow : public Window
+{
+public:
+	virtual bool		OnKeyDown() override							{ return true; }
+	virtual void		OnPointerBatch(PointerBatch inSamples) override	{ }
+};
+
+
+
+/**
+@brief Record a synthetic session and replay it as fast as possible, the load test for handler performance
+**/
+BENCHMARK(Replay)
+{
+#ifdef WINDOW_PLATFORM_HEADLESS
+	const int cRepeats = 9;
+	const char* cPath = "ReplayBenchmark.rec";
+	const size_t cWindows = 10;
+	const size_t cFrames = 1000;
+
+	// 10 windows getting cursor moves, key presses and paints for 1000 frames
+	Recorder::sStart(cPath);
+	Array<ReplayBenchmarkWindow*> windows;
+	for (size_t i = 0; i < cWindows; ++i)
+		windows.push_back(Window::sCreate<ReplayBenchmarkWindow>({ 0, 0, 320, 240 }, "Benchmark"));
+	for (size_t frame = 0; frame < cFrames; ++frame)
+	{
+		ReplayBenchmarkWindow* window = windows[frame % cWindows];
+		for (int i = 0; i < 8; ++i)
+			Headless::sPostMouseMove(window, (int)frame, i);
+		Headless::sPostKeyDown(window, 'A');
+		Headless::sPostKeyUp(window, 'A');
+		Headless::sPostPaint(window);
+		Headless::sPumpMessages();
+		gEndFrame();
+	}
+	for (ReplayBenchmarkWindow* window : windows)
+		Headless::sPostDestroy(window);
+	Headless::sPumpMessages();
+	Recorder::sStop();
+
+	RecorderStats recorded = Recorder::sGetStats();
+	gLog("  recorded %llu messages in %llu frames, %llu bytes\n", (unsigned long long)recorded.mMessages, (unsigned long long)recorded.mFrames, (unsigned long long)recorded.mBytes);
+
+	Replayer replayer;
+	if (!replayer.Open(cPath))
+		return;
+
+	ReplaySettings settings;
+	settings.mSpeed = 0.0;
+	settings.mCreateWindow = [](const ReplayWindow&) -> Window* { return Window::sCreate<ReplayBenchmarkWindow>({ 0, 0, 320, 240 }, "Benchmark"); };
+
+	String label = gFormat("Replayer::Run x%llu messages", (unsigned long long)recorded.mMessages);
+	gMeasure(label.c_str(), (size_t)recorded.mMessages, cRepeats, []() { },
+		[&]() { replayer.Run(settings); }, []() { });
+
+	replayer.Close();
+	remove(cPath);
+#endif
+}
@@ -0,0 +1,58 @@
+#include "Benchmark.h"
+
+// Additional includes
+#include "Registry.h"
+
+// STL includes
+#include <thread>
+
+
+
+/**
+@brief Create UIDs on one and on several threads at once, and look objects up by UID
+**/
+BENCHMARK(UID)
+{
+	const int cRepeats = 15;
+	const size_t cCount = 1000000;
+	uint64_t sink = 0;
+
+	gMeasure("UID::sCreate x1000000", cCount, cRepeats, []() { },
+		[&]() { for (size_t i = 0; i < cCount; ++i) sink ^= UID::sCreate().GetLow(); }, []() { });
+
+	// Every thread creates cCount UIDs, ns/op is per UID over all threads
+	const size_t cThreads = 4;
+	gMeasure("UID::sCreate x1000000 on 4 threads", cCount * cThreads, cRepeats, []() { },
+		[&]()
+		{
+			std::thread threads[cThreads];
+			uint64_t sinks[cThreads] = { };
+			for (size_t t = 0; t < cThreads; ++t)
+				threads[t] = std::thread([&sinks, t]() { uint64_t local = 0; for (size_t i = 0; i < cCount; ++i) local ^= UID::sCreate().GetLow(); sinks[t] = local; });
+			for (size_t t = 0; t < cThreads; ++t)
+			{
+				threads[t].join();
+				sink ^= sinks[t];
+			}
+		}, []() { });
+
+	// Registry lookups with UIDs that are and are not registered
+	const size_t cObjects = 10000;
+	Registry<uint64_t> registry;
+	Array<UID> registered;
+	Array<UID> missing;
+	registered.reserve(cObjects);
+	missing.reserve(cObjects);
+	for (size_t i = 0; i < cObjects; ++i)
+	{
+		registered.push_back(registry.Add(&sink));
+		missing.push_back(UID::sCreate());
+	}
+
+	gMeasure("Registry::Find hit x10000", cObjects, cRepeats, []() { },
+		[&]() { for (const UID& uid : registered) sink += registry.Find(uid) != nullptr; }, []() { });
+	gMeasure("Registry::Find miss x10000", cObjects, cRepeats, []() { },
+		[&]() { for (const UID& uid : missing) sink += registry.Find(uid) != nullptr; }, []() { });
+
+	gLog("  (%llu)\n", (unsigned long long)sink);
+}
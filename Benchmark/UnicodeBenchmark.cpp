@@ -0,0 +1,87 @@
+#include "Benchmark.h"
+
+// Additional includes
+#include "Unicode.h"
+
+// STL includes
+#include <string>
+
+
+
+/**
+@brief Test strings: a typical window title, a large ASCII text and a large text that mixes scripts
+**/
+static String sMakeText(const char* inPiece, size_t inSize)
+{
+	String text;
+	while (text.size() + strlen(inPiece) <= inSize)
+		text += inPiece;
+	return text;
+}
+
+
+
+/**
+@brief The conversion WString::sFromUTF8 did before, widening every byte into a temporary that is then copied
+**/
+static std::wstring sWidenBytes(const String& inUTF8Str)
+{
+	std::wstring temporary(inUTF8Str.begin(), inUTF8Str.end());
+	std::wstring result(temporary);
+	return result;
+}
+
+
+
+/**
+@brief Convert the test strings to wide strings and back
+**/
+BENCHMARK(Unicode)
+{
+	const int cRepeats = 15;
+
+	struct Input
+	{
+		const char*		mName;
+		String			mText;
+		int				mIterations;
+	};
+	Input inputs[] =
+	{
+		{ "title",	"Hello, Window!", 100000 },
+		{ "ascii",	sMakeText("The quick brown fox jumps over the lazy dog. ", 64 * 1024), 20 },
+		{ "mixed",	sMakeText("Venster \xC3\xA9\xC3\xA8 \xCE\xB1\xCE\xB2\xCE\xB3 \xE7\xAA\x97\xE5\x8F\xA3 \xF0\x9F\x98\x80 window ", 64 * 1024), 20 },
+	};
+
+	Array<wchar_t> wide_buffer(64 * 1024);
+	Array<char> utf8_buffer(64 * 1024 * Unicode::cMaxUTF8PerWide);
+	size_t sink = 0;
+
+	for (const Input& input : inputs)
+	{
+		size_t bytes = input.mText.size() * input.mIterations;
+		String label;
+
+		label = String(input.mName) + " widen bytes (old sFromUTF8)";
+		gMeasure(label.c_str(), bytes, cRepeats, []() { },
+			[&]() { for (int i = 0; i < input.mIterations; ++i) sink += sWidenBytes(input.mText).size(); }, []() { });
+
+		label = String(input.mName) + " WString::sFromUTF8";
+		gMeasure(label.c_str(), bytes, cRepeats, []() { },
+			[&]() { for (int i = 0; i < input.mIterations; ++i) sink += WString::sFromUTF8(input.mText).size(); }, []() { });
+
+		label = String(input.mName) + " Unicode::sUTF8ToWide";
+		gMeasure(label.c_str(), bytes, cRepeats, []() { },
+			[&]() { for (int i = 0; i < input.mIterations; ++i) sink += Unicode::sUTF8ToWide(input.mText.data(), input.mText.size(), wide_buffer.data(), wide_buffer.size()).mWritten; }, []() { });
+
+		size_t wide_length = Unicode::sUTF8ToWide(input.mText.data(), input.mText.size(), wide_buffer.data(), wide_buffer.size()).mWritten;
+		label = String(input.mName) + " Unicode::sWideToUTF8";
+		gMeasure(label.c_str(), bytes, cRepeats, []() { },
+			[&]() { for (int i = 0; i < input.mIterations; ++i) sink += Unicode::sWideToUTF8(wide_buffer.data(), wide_length, utf8_buffer.data(), utf8_buffer.size()).mWritten; }, []() { });
+	}
+
+	gMeasure("title WStringBuffer", 100000, cRepeats, []() { },
+		[&]() { for (int i = 0; i < 100000; ++i) sink += WStringBuffer<>(inputs[0].mText).size(); }, []() { });
+
+	gLog("  (%zu units converted)\n", sink);
+}
@@ -0,0 +1,124 @@
+#include "Benchmark.h"
+
+// Additional includes
+#include "Window.h"
+#include "Platform.h"
+#include "PlatformHeadless.h"
+
+#ifndef WINDOW_PLATFORM_HEADLESS
+	#include <windows.h>
+#endif
+
+
+
+/**
+@brief Window types to create, each one gets its own window class
+**/
+class BenchmarkWindow : public Window { };
+class OtherBenchmarkWindow : public Window { };
+
+
+
+/**
+@brief Destroy the windows of one repeat, not timed
+**/
+template<class T>
+static void sDestroyWindows(Array<T*>& ioWindows)
+{
+#ifdef WINDOW_PLATFORM_HEADLESS
+	for (T* window : ioWindows)
+		Headless::sPostDestroy(window);
+	Headless::sPumpMessages();
+#else
+	for (T* window : ioWindows)
+		DestroyWindow((HWND)window->GetNativeHandle());
+#endif
+	ioWindows.clear();
+}
+
+
+
+/**
+@brief Create windows one by one with Window::sCreate and in bulk with Window::sCreateMany
+**/
+BENCHMARK(WindowCreation)
+{
+	const int cRepeats = 9;
+
+	for (size_t count : { 1, 100, 1000 })
+	{
+		Array<IRect> rects;
+		for (size_t i = 0; i < count; ++i)
+			rects.push_back({ (int)(i % 32) * 10, (int)(i / 32) * 10, 320, 240 });
+
+		Array<BenchmarkWindow*> windows;
+		windows.reserve(count);
+
+		String label = gFormat("sCreate x%zu", count);
+		gMeasure(label.c_str(), count, cRepeats,
+			[]() { },
+			[&]()
+			{
+				for (size_t i = 0; i < count; ++i)
+					windows.push_back(Window::sCreate<BenchmarkWindow>(rects[i], "Benchmark"));
+			},
+			[&]() { sDestroyWindows(windows); });
+
+		label = gFormat("sCreateMany x%zu", count);
+		gMeasure(label.c_str(), count, cRepeats,
+			[&]() { windows.resize(count); },
+			[&]() { Window::sCreateMany<BenchmarkWindow>(rects.data(), count, "Benchmark", windows.data()); },
+			[&]() { sDestroyWindows(windows); });
+	}
+
+	// First window of a new type, includes registering its class
+	Array<OtherBenchmarkWindow*> other_windows;
+	gMeasure("sCreate first of a type", 1, 1,
+		[]() { },
+		[&]() { other_windows.push_back(Window::sCreate<OtherBenchmarkWindow>({ 0, 0, 320, 240 }, "Benchmark")); },
+		[&]() { sDestroyWindows(other_windows); });
+}
+
+
+
+/**
+@brief Destroy and recreate part of a set of windows every frame, like panels that come and go
+**/
+BENCHMARK(WindowChurn)
+{
+	const size_t cWindows = 1000;
+	const size_t cChurn = 100;
+
+	Array<BenchmarkWindow*> windows;
+	for (size_t i = 0; i < cWindows; ++i)
+		windows.push_back(Window::sCreate<BenchmarkWindow>({ 0, 0, 320, 240 }, "Benchmark"));
+
+	Array<BenchmarkWindow*> churned;
+	gMeasure("destroy + create x100", cChurn, 25,
+		[&]()
+		{
+			// Destroy every tenth window, spread over the pool
+			for (size_t i = 0; i < cChurn; ++i)
+				churned.push_back(windows[i * (cWindows / cChurn)]);
+			sDestroyWindows(churned);
+		},
+		[&]()
+		{
+			for (size_t i = 0; i < cChurn; ++i)
+				windows[i * (cWindows / cChurn)] = Window::sCreate<BenchmarkWindow>({ 0, 0, 320, 240 }, "Benchmark");
+		},
+		[]() { });
+
+	// Touch every window like a per frame update would
+	size_t visited = 0;
+	gMeasure("sForEach x1000", cWindows, 25,
+		[]() { },
+		[&]() { Window::sForEach<BenchmarkWindow>([&visited](BenchmarkWindow* inWindow) { visited += inWindow->GetHandle().GetIndex() != 0; }); },
+		[]() { });
+
+	PoolStats stats = Window::sGetPoolStats<BenchmarkWindow>();
+	gLog("  pool: %zu visited, %zu live, %zu peak, %zu slots in %zu blocks of %zu bytes per window, %llu allocations\n",
+		 visited, stats.mLive, stats.mPeakLive, stats.mCapacity, stats.mBlocks, stats.mObjectSize, (unsigned long long)stats.mAllocations);
+
+	sDestroyWindows(windows);
+}
@@ -0,0 +1,141 @@
+#include "Utility.h"
+
+
+
+/**
+@brief Reads the chunks of a binary log file
+**/
+class LogFileReader
+{
+public:
+	///@name Construction
+	explicit			LogFileReader(FILE* inFile) :		mFile(inFile) { }
+
+	///@name Reading
+	template<class T>
+	bool				Read(T& outValue)					{ return fread(&outValue, sizeof(T), 1, mFile) == 1; }	///< Read a value, false at the end of the file
+	bool				Read(void* outData, size_t inSize)	{ return inSize == 0 || fread(outData, inSize, 1, mFile) == 1; }	///< Read @a inSize bytes
+
+private:
+	FILE*				mFile;
+};
+
+
+
+/**
+@brief Print every message of a binary log file as text
+**/
+static int sDecode(FILE* inFile, FILE* inOutput)
+{
+	LogFileReader reader(inFile);
+
+	char magic[sizeof(cLogFileMagic)];
+	if (!reader.Read(magic, sizeof(magic)) || memcmp(magic, cLogFileMagic, sizeof(magic)) != 0)
+	{
+		fprintf(stderr, "Not a binary log file\n");
+		return 1;
+	}
+
+	Array<String> formats;
+	Array<uint8_t> arguments;
+	uint64_t first_time = 0;
+	bool has_first_time = false;
+
+	ELogChunk chunk;
+	while (reader.Read(chunk))
+	{
+		switch (chunk)
+		{
+			case ELogChunk::Format:
+			{
+				uint32_t id, length;
+				if (!reader.Read(id) || !reader.Read(length))
+					break;
+				String format(length, ' ');
+				if (!reader.Read(&format[0], length))
+					break;
+				if (id >= formats.size())
+					formats.resize(id + 1);
+				formats[id] = std::move(format);
+				continue;
+			}
+
+			case ELogChunk::Message:
+			{
+				uint32_t id, thread, size;
+				ELogLevel level;
+				uint64_t time;
+				uint8_t argument_count;
+				if (!reader.Read(id) || !reader.Read(level) || !reader.Read(thread) || !reader.Read(time) || !reader.Read(argument_count) || !reader.Read(size))
+					break;
+				arguments.resize(size);
+				if (!reader.Read(arguments.data(), size))
+					break;
+
+				// Times are relative to the first message
+				if (!has_first_time)
+				{
+					first_time = time;
+					has_first_time = true;
+				}
+
+				String text = id < formats.size() ? Log::sFormat(formats[id].c_str(), arguments.data(), arguments.size()) : gFormat("(unknown format %u)\n", id);
+				fprintf(inOutput, "%12.6f  T%-3u %-7s  %s", (time - first_time) * 1e-9, thread, Log::sGetLevelName(level), text.c_str());
+				if (text.empty() || text.back() != '\n')
+					fputc('\n', inOutput);
+				continue;
+			}
+
+			case ELogChunk::Dropped:
+			{
+				uint64_t dropped;
+				if (!reader.Read(dropped))
+					break;
+				fprintf(inOutput, "%12s  ---- %llu messages dropped\n", "", (unsigned long long)dropped);
+				continue;
+			}
+		}
+
+		// Unknown chunk or a file that was cut off
+		fprintf(stderr, "Log file is damaged or incomplete\n");
+		return 1;
+	}
+
+	return 0;
+}
+
+
+
+/**
+@brief Entry Point: LogDecoder <binary log> [text output]
+**/
+int main(int inArgCount, char** inArgs)
+{
+	if (inArgCount < 2)
+	{
+		fprintf(stderr, "Usage: LogDecoder <binary log> [text output]\n");
+		return 1;
+	}
+
+	FILE* file = gOpenFile(inArgs[1], "rb");
+	if (file == nullptr)
+	{
+		fprintf(stderr, "Can't open %s\n", inArgs[1]);
+		return 1;
+	}
+
+	FILE* output = inArgCount > 2 ? gOpenFile(inArgs[2], "w") : stdout;
+	if (output == nullptr)
+	{
+		fprintf(stderr, "Can't create %s\n", inArgs[2]);
+		fclose(file);
+		return 1;
+	}
+
+	int result = sDecode(file, output);
+
+	fclose(file);
+	if (output != stdout)
+		fclose(output);
+	return result;
+}
@@ -0,0 +1,84 @@
+#include "Test.h"
+
+// Additional includes
+#include "Framebuffer.h"
+#include "HelloWindow.h"
+#include "PlatformHeadless.h"
+
+
+
+/**
+@brief Compare @a inFrame with the golden image @a inName in the test data, or store it with --update
+
+On a mismatch the frame is written to <inName>.actual.tga in the working directory to compare by eye.
+**/
+static void sCheckGolden(const char* inName, const Framebuffer& inFrame)
+{
+	String path = String(gGetTestDataPath()) + inName + ".tga";
+	if (gIsUpdatingTestData())
+	{
+		CHECK(inFrame.SaveTGA(path));
+		return;
+	}
+
+	Framebuffer golden;
+	bool loaded = golden.LoadTGA(path);
+	CHECK(loaded);
+
+	// One step of tolerance for the rounding differences between the scalar, SSE2 and AVX2 blends
+	size_t differences = inFrame.CountDifferences(golden, 1);
+	CHECK(differences == 0);
+	if (!loaded || differences > 0)
+	{
+		String actual = String(inName) + ".actual.tga";
+		gLogError("  %s: %zu pixels differ, the frame is in %s\n", path.c_str(), differences, actual.c_str());
+		inFrame.SaveTGA(actual);
+	}
+}
+
+
+
+#ifdef WINDOW_PLATFORM_HEADLESS
+
+/**
+@brief Paint the example HelloWindow headless and compare what it presents with its golden image
+**/
+TEST(GoldenHelloWindow)
+{
+	// Just large enough for everything the window draws
+	HelloWindow* window = Window::sCreate<HelloWindow>({0, 0, 240, 180}, "Hello");
+	window->Show();
+	Headless::sPostPaint(window);
+	Headless::sPumpMessages();
+
+	Framebuffer frame;
+	CHECK(Headless::sGetPresentedFrame(window, frame));
+	CHECK(frame.GetWidth() == 240 && frame.GetHeight() == 180);
+	sCheckGolden("HelloWindow", frame);
+
+	gPlatformDestroyWindow(window->GetNativeHandle());
+}
+
+#endif // WINDOW_PLATFORM_HEADLESS
+
+
+
+/**
+@brief The primitives on their own against a golden image, clipped and blended at the edges
+**/
+TEST(GoldenPrimitives)
+{
+	Framebuffer frame(64, 48);
+	frame.Clear(gMakeColor(10, 20, 30));
+	frame.FillRect({-8, -8, 24, 20}, gMakeColor(200, 60, 60));
+	frame.BlendRect({8, 4, 70, 30}, gMakeColor(60, 200, 60, 100));
+	frame.DrawRect({2, 2, 60, 44}, gMakeColor(255, 255, 255));
+	frame.DrawLine(-10, 50, 70, -5, gMakeColor(255, 200, 0, 160));
+	frame.DrawLine(0, 24, 63, 24, gMakeColor(0, 0, 255));
+
+	Framebuffer sprite(9, 7);
+	sprite.Clear(gMakeColor(255, 0, 255, 128));
+	frame.BlendBlit(sprite, 50, 40);
+	frame.Blit(sprite, -3, 30);
+	sCheckGolden("Primitives", frame);
+}
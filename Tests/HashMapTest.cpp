@@ -0,0 +1,219 @@
+#include "Test.h"
+
+// Additional includes
+#include "HashMap.h"
+
+// STL includes
+#include <random>
+#include <unordered_map>
+
+
+
+/**
+@brief Key that picks its own probe group and 7 bit tag, so tests can make keys collide on purpose
+**/
+static uint32_t sMakeKey(uint32_t inGroup, uint32_t inTag, uint32_t inNumber)	{ return (inGroup << 16) | (inTag << 8) | inNumber; }
+
+struct PlacedHash
+{
+	uint64_t				operator()(uint32_t inKey) const	{ return ((uint64_t)(inKey >> 16) << 7) | ((inKey >> 8) & 0x7F); }
+};
+
+using Reference = std::unordered_map<uint32_t, uint32_t>;
+
+
+
+/**
+@brief Same elements in @a inMap as in @a inReference, found by lookup as well as by iteration
+**/
+template<class M>
+static bool sMatches(const M& inMap, const Reference& inReference)
+{
+	if (inMap.size() != inReference.size())
+		return false;
+
+	for (const Reference::value_type& value : inReference)
+	{
+		typename M::const_iterator i = inMap.find(value.first);
+		if (i == inMap.end() || i->second != value.second)
+			return false;
+	}
+
+	size_t iterated = 0;
+	for (const typename M::value_type& value : inMap)
+	{
+		Reference::const_iterator i = inReference.find(value.first);
+		if (i == inReference.end() || i->second != value.second)
+			return false;
+		++iterated;
+	}
+	return iterated == inReference.size();
+}
+
+
+
+/**
+@brief Random inserts, erases and lookups with keys from @a inMakeKey, checked against std::unordered_map
+**/
+template<class H, class F>
+static void sChurn(F inMakeKey, size_t inOperations)
+{
+	HashMap<uint32_t, uint32_t, H> map;
+	Reference reference;
+	std::mt19937 random(1234);
+
+	for (size_t i = 0; i < inOperations; ++i)
+	{
+		uint32_t key = inMakeKey(random);
+		switch (random() % 3)
+		{
+		case 0:
+			{
+				bool inserted = map.emplace(key, (uint32_t)i).second;
+				CHECK(inserted == reference.emplace(key, (uint32_t)i).second);
+				break;
+			}
+
+		case 1:
+			CHECK(map.erase(key) == reference.erase(key));
+			break;
+
+		default:
+			CHECK(map.contains(key) == (reference.count(key) != 0));
+			break;
+		}
+
+		if (i % 512 == 0)
+			CHECK(sMatches(map, reference));
+	}
+	CHECK(sMatches(map, reference));
+
+	// Erase through iterators until empty, the erased slot never moves the others
+	while (!map.empty())
+	{
+		typename HashMap<uint32_t, uint32_t, H>::iterator first = map.begin();
+		CHECK(reference.erase(first->first) == 1);
+		map.erase(first);
+	}
+	CHECK(reference.empty());
+}
+
+
+
+/**
+@brief Insert / erase churn where many keys share a group and a tag
+**/
+TEST(HashMapCollidingTags)
+{
+	// 8 groups and 2 tags for 1024 keys: every tag match needs a key compare and groups overflow into each other
+	sChurn<PlacedHash>([](std::mt19937& ioRandom) { return sMakeKey(ioRandom() % 8, ioRandom() % 2, ioRandom() % 64); }, 50000);
+
+	// One group and one tag for every key: every lookup walks the whole probe sequence
+	sChurn<PlacedHash>([](std::mt19937& ioRandom) { return sMakeKey(0, 0x2A, ioRandom() % 200); }, 20000);
+
+	// The default hash with a key range around the table size
+	sChurn<Hash<uint32_t>>([](std::mt19937& ioRandom) { return (uint32_t)(ioRandom() % 3000); }, 100000);
+}
+
+
+
+/**
+@brief Running out of growth with mostly deleted slots cleans up the table instead of doubling it
+**/
+TEST(HashMapRehashMostlyDeleted)
+{
+	HashMap<uint32_t, uint32_t, PlacedHash> map;
+	map.reserve(56);
+	CHECK(map.bucket_count() == 64);
+
+	// Fill groups 0 and 1 and part of 2 and 3, 56 elements uses up all growth
+	const uint32_t cFill[] = { 16, 16, 12, 12 };
+	for (uint32_t group = 0; group < 4; ++group)
+		for (uint32_t n = 0; n < cFill[group]; ++n)
+			map.emplace(sMakeKey(group, n, n), n);
+	CHECK(map.size() == 56 && map.bucket_count() == 64);
+
+	// Full groups leave deleted slots behind, and lookups must probe past them
+	for (uint32_t group = 0; group < 2; ++group)
+		for (uint32_t n = 0; n < 16; ++n)
+			CHECK(map.erase(sMakeKey(group, n, n)) == 1);
+	for (uint32_t group = 0; group < 2; ++group)
+		for (uint32_t n = 0; n < 16; ++n)
+			CHECK(!map.contains(sMakeKey(group, n, n)));
+	CHECK(map.size() == 24);
+
+	// The next insert into an empty slot finds no growth left, 25 elements fit without doubling
+	map.emplace(sMakeKey(2, 12, 12), 12);
+	CHECK(map.size() == 25 && map.bucket_count() == 64);
+	for (uint32_t group = 2; group < 4; ++group)
+		for (uint32_t n = 0; n < cFill[group]; ++n)
+			CHECK(map.contains(sMakeKey(group, n, n)) && map.find(sMakeKey(group, n, n))->second == n);
+	CHECK(map.contains(sMakeKey(2, 12, 12)));
+
+	// Churn at a steady size never grows the table
+	for (uint32_t i = 0; i < 10000; ++i)
+	{
+		uint32_t key = sMakeKey(i % 4, i % 128, (i / 4) % 256);
+		uint32_t old_key = sMakeKey((i + 2) % 4, (i + 2) % 128, ((i + 2) / 4 + 200) % 256);
+		map.emplace(key, i);
+		map.erase(old_key);
+		if (map.size() > 40)
+			map.erase(map.begin());
+	}
+	CHECK(map.bucket_count() == 64);
+}
+
+
+
+/**
+@brief Lookups stay correct after erasing most of the table
+**/
+TEST(HashMapLookupAfterErase)
+{
+	HashMap<uint32_t, uint32_t> map;
+	Reference reference;
+	for (uint32_t key = 0; key < 10000; ++key)
+	{
+		map.emplace(key, key * 3);
+		reference.emplace(key, key * 3);
+	}
+	size_t capacity = map.bucket_count();
+
+	for (uint32_t key = 0; key < 10000; ++key)
+		if (key % 10 != 0)
+		{
+			CHECK(map.erase(key) == 1);
+			reference.erase(key);
+		}
+	CHECK(map.bucket_count() == capacity);
+	CHECK(sMatches(map, reference));
+	for (uint32_t key = 0; key < 11000; ++key)
+		CHECK(map.contains(key) == (key < 10000 && key % 10 == 0));
+
+	// Erasing again is a no-op, inserting the erased keys back works
+	CHECK(map.erase(1) == 0);
+	for (uint32_t key = 1; key < 10000; key += 10)
+	{
+		CHECK(map.emplace(key, key).second);
+		reference.emplace(key, key);
+	}
+	CHECK(sMatches(map, reference));
+
+	// Same with every key in one group and one tag
+	HashMap<uint32_t, uint32_t, PlacedHash> colliding;
+	Reference colliding_reference;
+	for (uint32_t n = 0; n < 256; ++n)
+	{
+		colliding.emplace(sMakeKey(0, 0x2A, n), n);
+		colliding_reference.emplace(sMakeKey(0, 0x2A, n), n);
+	}
+	for (uint32_t n = 0; n < 256; ++n)
+		if (n % 7 != 0)
+		{
+			CHECK(colliding.erase(sMakeKey(0, 0x2A, n)) == 1);
+			colliding_reference.erase(sMakeKey(0, 0x2A, n));
+		}
+	CHECK(sMatches(colliding, colliding_reference));
+	for (uint32_t n = 0; n < 256; ++n)
+		CHECK(colliding.contains(sMakeKey(0, 0x2A, n)) == (n % 7 == 0));
+}
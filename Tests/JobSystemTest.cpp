@@ -0,0 +1,106 @@
+#include "Test.h"
+
+// Additional includes
+#include "JobSystem.h"
+#include "MessageLoop.h"
+#include "PlatformHeadless.h"
+
+// STL includes
+#include <atomic>
+#include <thread>
+
+
+
+/**
+@brief Fork and wait from a thread that is not a worker while the pool starts and stops under it
+**/
+TEST(JobSystemForkDuringShutdown)
+{
+	std::atomic<bool> stop { false };
+	std::atomic<uint32_t> forked { 0 }, done { 0 };
+	std::thread forker([&]()
+	{
+		while (!stop.load())
+		{
+			JobCounter counter;
+			for (int i = 0; i < 16; ++i)
+			{
+				forked.fetch_add(1);
+				JobSystem::sRun([&done]() { done.fetch_add(1); }, counter);
+			}
+			JobSystem::sWait(counter);
+		}
+	});
+
+	for (int i = 0; i < 50; ++i)
+	{
+		JobSystem::sInit(2);
+		std::this_thread::yield();
+		JobSystem::sShutdown();
+	}
+
+	stop = true;
+	forker.join();
+	CHECK(!JobSystem::sIsRunning());
+	CHECK(done.load() == forked.load());
+}
+
+
+
+#ifdef WINDOW_PLATFORM_HEADLESS
+
+/**
+@brief Window that forks and waits on jobs in every frame on its render thread, and quits the loop after a few frames
+**/
+class ForkingWindow : public Window
+{
+public:
+	static std::atomic<uint32_t> sForked;
+	static std::atomic<uint32_t> sDone;
+	static std::atomic<uint32_t> sFrames;
+
+	virtual void OnCreate() override
+	{
+		EnableRenderThread();
+	}
+
+	virtual void OnPaint() override
+	{
+		JobCounter counter;
+		for (int i = 0; i < 32; ++i)
+		{
+			sForked.fetch_add(1);
+			JobSystem::sRun([]() { sDone.fetch_add(1); }, counter);
+		}
+		JobSystem::sWait(counter);
+
+		// Keep painting, the quit lands while the render thread is forking
+		if (sFrames.fetch_add(1) == 8)
+			JobSystem::sRunOnMainThread([]() { gQuitApplication(); });
+		Headless::sPostPaint(this);
+	}
+};
+
+std::atomic<uint32_t> ForkingWindow::sForked { 0 };
+std::atomic<uint32_t> ForkingWindow::sDone { 0 };
+std::atomic<uint32_t> ForkingWindow::sFrames { 0 };
+
+
+
+/**
+@brief Quit the message loop while a render thread forks jobs, the loop has to return with every job run
+**/
+TEST(JobSystemRenderThreadQuit)
+{
+	ForkingWindow* window = Window::sCreate<ForkingWindow>({0, 0, 64, 64}, "Forking");
+	window->Show();
+	Headless::sPostPaint(window);
+
+	gProcessMessageLoop(LoopSettings());
+
+	CHECK(!JobSystem::sIsRunning());
+	CHECK(ForkingWindow::sFrames.load() > 8);
+	CHECK(ForkingWindow::sDone.load() == ForkingWindow::sForked.load());
+}
+
+#endif // WINDOW_PLATFORM_HEADLESS
@@ -0,0 +1,111 @@
+#include "Test.h"
+
+// STL includes
+#include <cstring>
+
+
+
+/**
+@brief Intrusive list of every registered test
+**/
+Test* Test::sFirst = nullptr;
+
+
+
+/**
+@brief Register a test
+**/
+Test::Test(const char* inName, Function inFunction) :
+	mName(inName),
+	mFunction(inFunction),
+	mNext(sFirst)
+{
+	sFirst = this;
+}
+
+
+
+/**
+@brief State of the run
+**/
+static size_t gFailures = 0;						///< Failed checks of the test that is running
+static String gTestDataPath = "Tests/Data/";		///< See gGetTestDataPath
+static bool gUpdateTestData = false;				///< See gIsUpdatingTestData
+
+
+
+/**
+@brief Report a failed check
+**/
+void gReportFailure(const char* inFile, int inLine, const char* inExpression)
+{
+	++gFailures;
+	gLogError("  %s(%d): CHECK(%s) failed\n", inFile, inLine, inExpression);
+}
+
+
+
+/**
+@brief Test data directory
+**/
+const char* gGetTestDataPath()
+{
+	return gTestDataPath.c_str();
+}
+
+
+
+/**
+@brief Check if stored test data is rewritten
+**/
+bool gIsUpdatingTestData()
+{
+	return gUpdateTestData;
+}
+
+
+
+/**
+@brief Entry Point: Tests [filter] [--data <directory>] [--update]
+
+Runs every test or only the ones whose name contains the filter, returns 1 if a check failed. --data points to
+Tests/Data when not running from the repository root, --update rewrites the stored data (e.g. golden images)
+instead of comparing against it.
+**/
+int main(int inArgCount, char** inArgs)
+{
+	const char* filter = nullptr;
+	for (int i = 1; i < inArgCount; ++i)
+	{
+		if (strcmp(inArgs[i], "--data") == 0 && i + 1 < inArgCount)
+		{
+			gTestDataPath = inArgs[++i];
+			if (!gTestDataPath.empty() && gTestDataPath.back() != '/' && gTestDataPath.back() != '\\')
+				gTestDataPath += '/';
+		}
+		else if (strcmp(inArgs[i], "--update") == 0)
+			gUpdateTestData = true;
+		else
+			filter = inArgs[i];
+	}
+
+	size_t failed_tests = 0, run_tests = 0;
+	for (Test* test = Test::sGetFirst(); test != nullptr; test = test->GetNext())
+	{
+		if (filter != nullptr && strstr(test->GetName(), filter) == nullptr)
+			continue;
+
+		gLog("[TEST] \t%s\n", test->GetName());
+		gFailures = 0;
+		test->Run();
+		++run_tests;
+		if (gFailures > 0)
+		{
+			++failed_tests;
+			gLogError("[FAILED] \t%s, %zu failed checks\n", test->GetName(), gFailures);
+		}
+	}
+
+	gLog("%zu of %zu tests passed\n", run_tests - failed_tests, run_tests);
+	return failed_tests > 0 || run_tests == 0 ? 1 : 0;
+}
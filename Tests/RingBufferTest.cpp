@@ -0,0 +1,195 @@
+#include "Test.h"
+
+// Additional includes
+#include "RingBuffer.h"
+
+// STL includes
+#include <memory>
+#include <thread>
+
+
+
+/**
+@brief Value pushed by the stress tests: the producer in the high bits, its sequence number in the low bits
+**/
+static uint64_t sMakeEvent(uint32_t inProducer, uint32_t inSequence)	{ return ((uint64_t)inProducer << 32) | inSequence; }
+static uint32_t sGetProducer(uint64_t inEvent)							{ return (uint32_t)(inEvent >> 32); }
+static uint32_t sGetSequence(uint64_t inEvent)							{ return (uint32_t)inEvent; }
+
+
+
+/**
+@brief Fill, drain and batch across the end of the ring on one thread
+**/
+TEST(RingBufferWrapAround)
+{
+	RingBuffer<uint32_t, 8> ring;
+	uint32_t values[16];
+	CHECK(!ring.Pop(values[0]));
+	CHECK(ring.PopBatch(values, 16) == 0);
+
+	// Full ring rejects the next push
+	for (uint32_t i = 0; i < 8; ++i)
+		CHECK(ring.Push(i));
+	CHECK(!ring.Push(8));
+	CHECK(ring.GetSizeApprox() == 8);
+
+	// Move the read position to the middle, then fill so the values wrap around the end
+	CHECK(ring.PopBatch(values, 5) == 5);
+	for (uint32_t i = 0; i < 5; ++i)
+		CHECK(values[i] == i);
+	for (uint32_t i = 8; i < 13; ++i)
+		CHECK(ring.Push(i));
+	CHECK(!ring.Push(13));
+
+	// One batch takes everything across the wrap, in order
+	CHECK(ring.PopBatch(values, 16) == 8);
+	for (uint32_t i = 0; i < 8; ++i)
+		CHECK(values[i] == 5 + i);
+	CHECK(!ring.Pop(values[0]));
+
+	// A batch limited by its size leaves the rest for the next one
+	for (uint32_t lap = 0; lap < 20; ++lap)
+	{
+		for (uint32_t i = 0; i < 6; ++i)
+			CHECK(ring.Push(lap * 6 + i));
+		CHECK(ring.PopBatch(values, 4) == 4);
+		CHECK(ring.PopBatch(values + 4, 4) == 2);
+		for (uint32_t i = 0; i < 6; ++i)
+			CHECK(values[i] == lap * 6 + i);
+	}
+}
+
+
+
+/**
+@brief Outcome of sStress
+**/
+struct StressResult
+{
+	std::atomic<size_t>		mOrderErrors { 0 };				///< Events that reached a consumer out of producer order, or were not pushed at all
+	std::atomic<bool>		mStalled { false };				///< A producer could not push for seconds, a broken ring loses cells instead of failing
+};
+
+
+
+/**
+@brief Run @a inProducers threads that push @a inEvents events each while @a inConsumers threads take them in batches
+
+Every consumer checks that the events of a producer reach it in order, @a ioSeen counts how often every event was
+taken. With one consumer it also checks that no event of a producer is skipped.
+**/
+template<size_t N>
+static void sStress(RingBuffer<uint64_t, N>& ioRing, uint32_t inProducers, uint32_t inConsumers, uint32_t inEvents, std::atomic<uint8_t>* ioSeen, StressResult& ioResult)
+{
+	std::atomic<uint32_t> producers_left { inProducers };
+	Array<std::thread> threads;
+
+	for (uint32_t p = 0; p < inProducers; ++p)
+		threads.emplace_back([&ioRing, &producers_left, &ioResult, p, inEvents]()
+		{
+			for (uint32_t s = 0; s < inEvents && !ioResult.mStalled.load(); ++s)
+			{
+				uint64_t give_up = gGetTimeNS() + 10000000000ull;
+				while (!ioRing.Push(sMakeEvent(p, s)))
+				{
+					if (gGetTimeNS() > give_up)
+						ioResult.mStalled = true;
+					if (ioResult.mStalled.load())
+						break;
+					std::this_thread::yield();
+				}
+			}
+			producers_left.fetch_sub(1);
+		});
+
+	for (uint32_t c = 0; c < inConsumers; ++c)
+		threads.emplace_back([&ioRing, &producers_left, &ioResult, ioSeen, c, inProducers, inConsumers, inEvents]()
+		{
+			Array<int64_t> last(inProducers, -1);
+			uint64_t batch[N + 3];
+			for (size_t round = c;; ++round)
+			{
+				// Batches of 1 up to more than the ring holds, so they end anywhere around the wrap
+				bool done = producers_left.load() == 0;
+				size_t taken = ioRing.PopBatch(batch, 1 + (round * 7) % (N + 3));
+				if (taken == 0)
+				{
+					if (done)
+						break;
+					std::this_thread::yield();
+					continue;
+				}
+
+				for (size_t i = 0; i < taken; ++i)
+				{
+					uint32_t producer = sGetProducer(batch[i]), sequence = sGetSequence(batch[i]);
+					if (producer >= inProducers || sequence >= inEvents)
+					{
+						ioResult.mOrderErrors.fetch_add(1);
+						continue;
+					}
+
+					bool in_order = inConsumers == 1 ? sequence == last[producer] + 1 : sequence > last[producer];
+					if (!in_order)
+						ioResult.mOrderErrors.fetch_add(1);
+					last[producer] = sequence;
+					ioSeen[(size_t)producer * inEvents + sequence].fetch_add(1);
+				}
+			}
+		});
+
+	for (std::thread& thread : threads)
+		thread.join();
+}
+
+
+
+/**
+@brief Check that every event was taken exactly once
+**/
+static size_t sCountNotOnce(const std::atomic<uint8_t>* inSeen, size_t inCount)
+{
+	size_t not_once = 0;
+	for (size_t i = 0; i < inCount; ++i)
+		not_once += inSeen[i].load() != 1;
+	return not_once;
+}
+
+
+
+/**
+@brief Many producers and one consumer, every event arrives once without gaps in the order of its producer
+**/
+TEST(RingBufferMPSC)
+{
+	const uint32_t cProducers = 4, cEvents = 100000;
+	std::unique_ptr<std::atomic<uint8_t>[]> seen(new std::atomic<uint8_t>[cProducers * cEvents]());
+	StressResult result;
+
+	RingBuffer<uint64_t, 64> ring;
+	sStress(ring, cProducers, 1, cEvents, seen.get(), result);
+	CHECK(!result.mStalled.load());
+	CHECK(result.mOrderErrors.load() == 0);
+	CHECK(sCountNotOnce(seen.get(), cProducers * cEvents) == 0);
+	CHECK(ring.GetSizeApprox() == 0);
+}
+
+
+
+/**
+@brief Many producers and consumers, every event is taken exactly once and in producer order per consumer
+**/
+TEST(RingBufferMPMC)
+{
+	const uint32_t cProducers = 4, cConsumers = 4, cEvents = 100000;
+	std::unique_ptr<std::atomic<uint8_t>[]> seen(new std::atomic<uint8_t>[cProducers * cEvents]());
+	StressResult result;
+
+	RingBuffer<uint64_t, 64> ring;
+	sStress(ring, cProducers, cConsumers, cEvents, seen.get(), result);
+	CHECK(!result.mStalled.load());
+	CHECK(result.mOrderErrors.load() == 0);
+	CHECK(sCountNotOnce(seen.get(), cProducers * cEvents) == 0);
+	CHECK(ring.GetSizeApprox() == 0);
+}
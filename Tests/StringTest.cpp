@@ -0,0 +1,21 @@
+#include "Test.h"
+
+// STL includes
+#include <string>
+
+
+
+/**
+@brief String orders like std::string, by unsigned unit value, so UTF-8 sorts after ASCII
+**/
+TEST(StringOrder)
+{
+	const char* cStrings[] = { "", "a", "ab", "b", "Z", "\x7F", "\xC3\xA9", "\xE2\x82\xAC", "a\xC3\xA9", "a\x7F", "\xFF", "\xC3" };
+	for (const char* left : cStrings)
+		for (const char* right : cStrings)
+			CHECK((String(left) < String(right)) == (std::string(left) < std::string(right)));
+
+	// Wide strings compare by code point
+	CHECK(BasicString<wchar_t>(L"a") < BasicString<wchar_t>(L"\x20AC"));
+	CHECK(!(BasicString<wchar_t>(L"\x20AC") < BasicString<wchar_t>(L"a")));
+}
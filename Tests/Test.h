@@ -0,0 +1,67 @@
+#pragma once
+
+// Additional includes
+#include "Utility.h"
+
+
+
+/**
+@brief A correctness check registered with TEST, run by the test executable (see Main.cpp)
+**/
+class Test
+{
+public:
+	using Function = void (*)();
+
+	///@name Construction
+						Test(const char* inName, Function inFunction);	///< Register a test, only used through TEST
+
+	///@name Registered tests
+	static Test*		sGetFirst()							{ return sFirst; }	///< First registered test, in no particular order
+	Test*				GetNext() const						{ return mNext; }	///< Next registered test, nullptr for the last one
+
+	///@name Properties
+	const char*			GetName() const						{ return mName; }
+	void				Run() const							{ mFunction(); }
+
+private:
+	///@name Properties
+	static Test*		sFirst;								///< Intrusive list of every test
+	const char*			mName;
+	Function			mFunction;
+	Test*				mNext;
+};
+
+
+
+/**
+@brief Define and register a test, the body verifies with CHECK
+**/
+#define TEST(inName)																	\
+	static void sTest##inName();														\
+	static Test g##inName##Test(#inName, sTest##inName);								\
+	static void sTest##inName()
+
+
+
+/**
+@brief Report a failed check, the test keeps running so one run shows every failure
+**/
+extern void gReportFailure(const char* inFile, int inLine, const char* inExpression);
+
+#define CHECK(inExpression)																\
+	do { if (!(inExpression)) gReportFailure(__FILE__, __LINE__, #inExpression); } while (false)
+
+
+
+/**
+@brief Test data directory (with a trailing slash), set with --data
+**/
+extern const char* gGetTestDataPath();
+
+
+
+/**
+@brief True when the test executable runs with --update, checks against stored data then rewrite it instead
+**/
+extern bool gIsUpdatingTestData();
@@ -0,0 +1,254 @@
+#include "Test.h"
+
+// Additional includes
+#include "Unicode.h"
+
+// STL includes
+#include <algorithm>
+#include <cstring>
+
+
+
+/**
+@brief Code points of a wide string, decoding surrogate pairs where wchar_t is UTF-16
+**/
+static Array<uint32_t> sToCodePoints(const wchar_t* inWide, size_t inLength)
+{
+	Array<uint32_t> code_points;
+	for (size_t i = 0; i < inLength; ++i)
+	{
+		uint32_t unit = (uint32_t)inWide[i];
+		if (sizeof(wchar_t) == 2 && unit >= 0xD800 && unit < 0xDC00 && i + 1 < inLength)
+		{
+			unit = 0x10000 + ((unit - 0xD800) << 10) + ((uint32_t)inWide[i + 1] - 0xDC00);
+			++i;
+		}
+		code_points.push_back(unit);
+	}
+	return code_points;
+}
+
+static bool sEqual(const Array<uint32_t>& inLeft, const Array<uint32_t>& inRight)
+{
+	return inLeft.size() == inRight.size() && std::equal(inLeft.begin(), inLeft.end(), inRight.begin());
+}
+
+
+
+/**
+@brief UTF-8 input with the code points it decodes to when every maximal invalid subpart becomes U+FFFD
+**/
+struct UTF8Case
+{
+	const char*				mName;
+	const char*				mUTF8;
+	size_t					mInvalid;										///< Replacement characters written
+	Array<uint32_t>			mCodePoints;
+};
+
+static const uint32_t R = Unicode::cReplacement;
+
+
+
+/**
+@brief Decode valid and invalid UTF-8 and count the replacements
+**/
+TEST(UnicodeDecodeUTF8)
+{
+	const UTF8Case cases[] =
+	{
+		{ "empty",						"",									0, { } },
+		{ "ascii",						"Hi!",								0, { 'H', 'i', '!' } },
+		{ "2 bytes",					"\xC3\xA9",							0, { 0xE9 } },
+		{ "3 bytes",					"\xE2\x82\xAC",						0, { 0x20AC } },
+		{ "4 bytes",					"\xF0\x9F\x98\x80",					0, { 0x1F600 } },
+		{ "largest code point",			"\xF4\x8F\xBF\xBF",					0, { 0x10FFFF } },
+		{ "last before surrogates",		"\xED\x9F\xBF",						0, { 0xD7FF } },
+		{ "first after surrogates",		"\xEE\x80\x80",						0, { 0xE000 } },
+
+		// Overlong forms, C0 and C1 never start a sequence and E0 / F0 need a large enough second byte
+		{ "overlong 2 bytes",			"\xC0\x80",							2, { R, R } },
+		{ "overlong 2 bytes max",		"\xC1\xBF",							2, { R, R } },
+		{ "overlong 3 bytes",			"\xE0\x80\x80",						3, { R, R, R } },
+		{ "overlong 3 bytes max",		"\xE0\x9F\xBF",						3, { R, R, R } },
+		{ "overlong 4 bytes",			"\xF0\x8F\xBF\xBF",					4, { R, R, R, R } },
+
+		// Surrogates encoded in UTF-8 (CESU-8)
+		{ "high surrogate",				"\xED\xA0\x80",						3, { R, R, R } },
+		{ "low surrogate",				"\xED\xBF\xBF",						3, { R, R, R } },
+		{ "surrogate pair",				"\xED\xA0\xBD\xED\xB8\x80",			6, { R, R, R, R, R, R } },
+
+		// Beyond U+10FFFF
+		{ "U+110000",					"\xF4\x90\x80\x80",					4, { R, R, R, R } },
+		{ "F5 lead",					"\xF5\x80\x80\x80",					4, { R, R, R, R } },
+		{ "FF byte",					"\xFF",								1, { R } },
+
+		// Truncated sequences are one maximal subpart each
+		{ "truncated 2 of 3",			"\xE2\x82",							1, { R } },
+		{ "truncated 3 of 4",			"\xF0\x9F\x98",						1, { R } },
+		{ "truncated 1 of 2",			"\xC3",								1, { R } },
+		{ "truncated then ascii",		"\xE2\x82" "A",						1, { R, 'A' } },
+		{ "truncated then lead",		"\xF0\x9F\xC3\xA9",					1, { R, 0xE9 } },
+		{ "lone continuation",			"\x80",								1, { R } },
+		{ "two continuations",			"\x80\xBF",							2, { R, R } },
+
+		// Mixed example from the Unicode standard on U+FFFD substitution of maximal subparts
+		{ "mixed",						"\x61\xF1\x80\x80\xE1\x80\xC2\x62\x80\x63\x80\xBF\x64",	6, { 0x61, R, R, R, 0x62, R, 0x63, R, R, 0x64 } },
+	};
+
+	for (const UTF8Case& test_case : cases)
+	{
+		size_t length = strlen(test_case.mUTF8);
+		wchar_t wide[32];
+		TranscodeResult result = Unicode::sUTF8ToWide(test_case.mUTF8, length, wide, 32);
+
+		bool ok = result.mRead == length && result.mInvalid == test_case.mInvalid && sEqual(sToCodePoints(wide, result.mWritten), test_case.mCodePoints)
+			&& Unicode::sGetWideLength(test_case.mUTF8, length) == result.mWritten
+			&& Unicode::sIsValidUTF8(test_case.mUTF8, length) == (test_case.mInvalid == 0);
+		if (!ok)
+			gLogError("  case '%s': read %zu of %zu, %zu invalid\n", test_case.mName, result.mRead, length, result.mInvalid);
+		CHECK(ok);
+
+		// Stop ends right before the first invalid sequence
+		if (test_case.mInvalid > 0)
+		{
+			TranscodeResult stop = Unicode::sUTF8ToWide(test_case.mUTF8, length, wide, 32, EInvalidUnicode::Stop);
+			size_t valid = 0;
+			while (valid < test_case.mCodePoints.size() && test_case.mCodePoints[valid] != R)
+				++valid;
+			CHECK(stop.mInvalid == 1);
+			CHECK(sToCodePoints(wide, stop.mWritten).size() == valid);
+			CHECK(Unicode::sIsValidUTF8(test_case.mUTF8, stop.mRead));
+		}
+	}
+}
+
+
+
+/**
+@brief ASCII with one other character at every position, so it lands before, on and after every vector boundary
+**/
+TEST(UnicodeVectorBoundaries)
+{
+	const char* cInserts[] = { "\xC3\xA9", "\xE2\x82\xAC", "\xF0\x9F\x98\x80", "\xC0", "\xE2\x82" };
+	const uint32_t cCodePoints[] = { 0xE9, 0x20AC, 0x1F600, R, R };
+
+	for (size_t insert = 0; insert < 5; ++insert)
+		for (size_t position = 0; position <= 70; ++position)
+		{
+			String utf8;
+			Array<uint32_t> expected;
+			for (size_t i = 0; i < position; ++i)
+			{
+				utf8 += (char)('a' + i % 26);
+				expected.push_back('a' + i % 26);
+			}
+			utf8 += cInserts[insert];
+			expected.push_back(cCodePoints[insert]);
+			for (size_t i = 0; i < 40; ++i)
+			{
+				utf8 += (char)('A' + i % 26);
+				expected.push_back('A' + i % 26);
+			}
+
+			wchar_t wide[128];
+			TranscodeResult result = Unicode::sUTF8ToWide(utf8.data(), utf8.size(), wide, 128);
+			CHECK(result.mRead == utf8.size());
+			CHECK(sEqual(sToCodePoints(wide, result.mWritten), expected));
+		}
+}
+
+
+
+/**
+@brief Too small output buffers: never written past, never split a character, and the rest converts on its own
+**/
+TEST(UnicodeCapacity)
+{
+	// Characters of every length around the 16 and 32 unit vector boundaries
+	String utf8;
+	for (size_t i = 0; i < 14; ++i)
+		utf8 += 'a';
+	utf8 += "\xF0\x9F\x98\x80";
+	for (size_t i = 0; i < 15; ++i)
+		utf8 += 'b';
+	utf8 += "\xC3\xA9\xE2\x82\xAC";
+	for (size_t i = 0; i < 33; ++i)
+		utf8 += 'c';
+	utf8 += "\xF0\x9F\x98\x80";
+
+	const size_t cSentinelCount = 4;
+	const wchar_t cSentinel = (wchar_t)0x5A5A;
+	wchar_t full[128];
+	TranscodeResult all = Unicode::sUTF8ToWide(utf8.data(), utf8.size(), full, 128);
+	CHECK(all.mRead == utf8.size() && all.mInvalid == 0);
+
+	for (size_t capacity = 0; capacity <= all.mWritten; ++capacity)
+	{
+		wchar_t wide[128 + cSentinelCount];
+		for (wchar_t& unit : wide)
+			unit = cSentinel;
+
+		TranscodeResult part = Unicode::sUTF8ToWide(utf8.data(), utf8.size(), wide, capacity);
+		CHECK(part.mWritten <= capacity);
+		CHECK(memcmp(wide, full, part.mWritten * sizeof(wchar_t)) == 0);
+		CHECK(wide[capacity] == cSentinel);
+
+		// At most one character is left out, and it starts exactly where reading stopped
+		CHECK(capacity - part.mWritten < (sizeof(wchar_t) == 2 ? 2u : 1u));
+		CHECK(Unicode::sGetWideLength(utf8.data(), part.mRead) == part.mWritten);
+		TranscodeResult rest = Unicode::sUTF8ToWide(utf8.data() + part.mRead, utf8.size() - part.mRead, wide + part.mWritten, 128 - part.mWritten);
+		CHECK(rest.mInvalid == 0 && part.mWritten + rest.mWritten == all.mWritten);
+		CHECK(memcmp(wide, full, all.mWritten * sizeof(wchar_t)) == 0);
+	}
+
+	// The same back to UTF-8
+	char utf8_full[256];
+	TranscodeResult back = Unicode::sWideToUTF8(full, all.mWritten, utf8_full, 256);
+	CHECK(back.mWritten == utf8.size() && memcmp(utf8_full, utf8.data(), utf8.size()) == 0);
+	for (size_t capacity = 0; capacity <= utf8.size(); ++capacity)
+	{
+		char part_utf8[256 + cSentinelCount];
+		memset(part_utf8, 0x5A, sizeof(part_utf8));
+
+		TranscodeResult part = Unicode::sWideToUTF8(full, all.mWritten, part_utf8, capacity);
+		CHECK(part.mWritten <= capacity && capacity - part.mWritten < 4);
+		CHECK(part_utf8[capacity] == 0x5A);
+		CHECK(memcmp(part_utf8, utf8.data(), part.mWritten) == 0);
+		CHECK(Unicode::sIsValidUTF8(part_utf8, part.mWritten));
+		CHECK(Unicode::sGetUTF8Length(full, part.mRead) == part.mWritten);
+	}
+}
+
+
+
+/**
+@brief UTF-8 to WString and back, and invalid wide input
+**/
+TEST(UnicodeRoundTrip)
+{
+	const char* cStrings[] = { "", "Hello, Window!", "Caf\xC3\xA9 \xE2\x82\xAC" "5", "\xF0\x9F\x98\x80\xF0\x9F\x98\x81 \xE4\xBD\xA0\xE5\xA5\xBD", "\xF4\x8F\xBF\xBF\xEE\x80\x80\xED\x9F\xBF" };
+	for (const char* text : cStrings)
+	{
+		String utf8(text);
+		WString wide = WString::sFromUTF8(utf8);
+		CHECK(wide.ToUTF8() == utf8);
+		CHECK(Unicode::sGetUTF8Length(wide.c_str(), wide.size()) == utf8.size());
+	}
+
+	// Long text that goes through the vector paths in both directions
+	String long_text;
+	for (size_t i = 0; i < 200; ++i)
+		long_text += i % 7 == 0 ? "\xC3\xA9" : i % 11 == 0 ? "\xF0\x9F\x98\x80" : "abc";
+	CHECK(WString::sFromUTF8(long_text).ToUTF8() == long_text);
+
+	// Invalid UTF-8 comes back with its replacements
+	CHECK(WString::sFromUTF8("a\xC0" "b").ToUTF8() == "a\xEF\xBF\xBD" "b");
+
+	// Surrogate code units on their own are invalid in either wide encoding
+	const wchar_t cLoneSurrogate[] = { L'A', (wchar_t)0xD800, L'B', (wchar_t)0xDC00 };
+	char utf8[32];
+	TranscodeResult result = Unicode::sWideToUTF8(cLoneSurrogate, 4, utf8, 32);
+	CHECK(result.mInvalid == 2 && String(utf8, result.mWritten) == "A\xEF\xBF\xBD" "B\xEF\xBF\xBD");
+	CHECK(Unicode::sWideToUTF8(cLoneSurrogate, 4, utf8, 32, EInvalidUnicode::Stop).mRead == 1);
+}
@@ -0,0 +1,236 @@
+#pragma once
+
+// STL includes
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <utility>
+
+
+
+/**
+@brief Allocators used by the containers (Array, SmallArray, HashMap, String)
+
+An allocator is any copyable type with:
+
+void*	Allocate(size_t inSize, size_t inAlignment);
+void	Free(void* inPointer, size_t inSize, size_t inAlignment);
+
+Containers keep a copy of their allocator (an empty one costs nothing) and hand back every block with the
+size and alignment it was allocated with, so allocators do not need to store block headers.
+**/
+
+
+
+/**
+@brief Heap allocator, the default of every container
+**/
+struct DefaultAllocator
+{
+	///@name Allocation
+	void*					Allocate(size_t inSize, size_t inAlignment);
+	void					Free(void* inPointer, size_t inSize, size_t inAlignment);
+};
+
+
+
+/**
+@brief Allocate @a inSize bytes aligned to @a inAlignment from the heap
+**/
+inline void* DefaultAllocator::Allocate(size_t inSize, size_t inAlignment)
+{
+	if (inAlignment <= alignof(std::max_align_t))
+		return ::operator new(inSize);
+
+	// Over aligned, keep the original pointer right in front of the aligned block
+	uint8_t* memory = (uint8_t*)::operator new(inSize + inAlignment + sizeof(void*));
+	uint8_t* aligned = (uint8_t*)(((uintptr_t)memory + sizeof(void*) + inAlignment - 1) & ~(uintptr_t)(inAlignment - 1));
+	((void**)aligned)[-1] = memory;
+	return aligned;
+}
+
+
+
+/**
+@brief Free a block of DefaultAllocator::Allocate
+**/
+inline void DefaultAllocator::Free(void* inPointer, size_t inSize, size_t inAlignment)
+{
+	if (inAlignment <= alignof(std::max_align_t))
+		::operator delete(inPointer);
+	else if (inPointer != nullptr)
+		::operator delete(((void**)inPointer)[-1]);
+}
+
+
+
+/**
+@brief Create an object through DefaultAllocator, for types with alignas members beyond what new guarantees before C++17
+**/
+template<class T, class... Args>
+inline T* gNewAligned(Args&&... inArgs)
+{
+	void* memory = DefaultAllocator().Allocate(sizeof(T), alignof(T));
+	return new (memory) T(std::forward<Args>(inArgs)...);
+}
+
+
+
+/**
+@brief Delete an object of gNewAligned
+**/
+template<class T>
+inline void gDeleteAligned(T* inObject)
+{
+	if (inObject == nullptr)
+		return;
+
+	inObject->~T();
+	DefaultAllocator().Free(inObject, sizeof(T), alignof(T));
+}
+
+
+
+/**
+@brief Owner of an object of gNewAligned
+**/
+template<class T>
+struct AlignedDeleter
+{
+	void					operator()(T* inObject) const	{ gDeleteAligned(inObject); }
+};
+
+template<class T>
+using AlignedPtr = std::unique_ptr<T, AlignedDeleter<T>>;
+
+
+
+/**
+@brief Linear allocator that hands out memory from large blocks and frees everything at once
+
+Good for data that lives exactly as long as a frame or a task, e.g. scratch arrays built while painting.
+Not thread safe.
+**/
+class Arena
+{
+public:
+	///@name Construction
+	explicit				Arena(size_t inBlockSize = 64 * 1024) :		mBlockSize(inBlockSize) { }
+							~Arena();
+							Arena(const Arena&) = delete;
+	Arena&					operator=(const Arena&) = delete;
+
+	///@name Allocation
+	void*					Allocate(size_t inSize, size_t inAlignment);	///< Get @a inSize bytes, allocates a new block when the current one is full
+	void					Reset();						///< Free every allocation at once, keeps the first block for reuse
+
+	///@name Statistics
+	size_t					GetUsed() const					{ return mUsed; }		///< Bytes handed out since the last reset
+	size_t					GetReserved() const				{ return mReserved; }	///< Bytes held in blocks
+
+private:
+	/**
+	@brief Header in front of every block
+	**/
+	struct Block
+	{
+		Block*				mPrevious;						///< Block allocated before this one
+		size_t				mSize;							///< Usable bytes after the header
+	};
+
+	///@name Properties
+	size_t					mBlockSize;						///< Minimum size of new blocks
+	Block*					mCurrent	= nullptr;			///< Block allocations come from
+	size_t					mOffset		= 0;				///< Bytes of mCurrent in use
+	size_t					mUsed		= 0;
+	size_t					mReserved	= 0;
+};
+
+
+
+/**
+@brief Allocator that takes memory from an Arena, freeing is a no-op until the arena is reset
+
+Array<PointerSample, ArenaAllocator> samples(ArenaAllocator(frame_arena));
+**/
+class ArenaAllocator
+{
+public:
+	///@name Construction
+	explicit				ArenaAllocator(Arena& inArena) :			mArena(&inArena) { }
+
+	///@name Allocation
+	void*					Allocate(size_t inSize, size_t inAlignment)	{ return mArena->Allocate(inSize, inAlignment); }
+	void					Free(void*, size_t, size_t)					{ }
+
+private:
+	///@name Properties
+	Arena*					mArena;
+};
+
+
+
+/**
+@brief Free every block
+**/
+inline Arena::~Arena()
+{
+	while (mCurrent != nullptr)
+	{
+		Block* previous = mCurrent->mPrevious;
+		::operator delete(mCurrent);
+		mCurrent = previous;
+	}
+}
+
+
+
+/**
+@brief Get @a inSize bytes aligned to @a inAlignment
+**/
+inline void* Arena::Allocate(size_t inSize, size_t inAlignment)
+{
+	// Align within the current block
+	if (mCurrent != nullptr)
+	{
+		uintptr_t base = (uintptr_t)(mCurrent + 1);
+		uintptr_t aligned = (base + mOffset + inAlignment - 1) & ~(uintptr_t)(inAlignment - 1);
+		if (aligned + inSize <= base + mCurrent->mSize)
+		{
+			mOffset = aligned + inSize - base;
+			mUsed += inSize;
+			return (void*)aligned;
+		}
+	}
+
+	// Start a new block that surely fits the allocation
+	size_t size = inSize + inAlignment > mBlockSize ? inSize + inAlignment : mBlockSize;
+	Block* block = (Block*)::operator new(sizeof(Block) + size);
+	block->mPrevious = mCurrent;
+	block->mSize = size;
+	mCurrent = block;
+	mOffset = 0;
+	mReserved += size;
+	return Allocate(inSize, inAlignment);
+}
+
+
+
+/**
+@brief Free every allocation at once
+**/
+inline void Arena::Reset()
+{
+	// Keep the oldest block, it is the one that was allocated for a typical frame
+	while (mCurrent != nullptr && mCurrent->mPrevious != nullptr)
+	{
+		Block* previous = mCurrent->mPrevious;
+		mReserved -= mCurrent->mSize;
+		::operator delete(mCurrent);
+		mCurrent = previous;
+	}
+	mOffset = 0;
+	mUsed = 0;
+}
@@ -0,0 +1,343 @@
+#pragma once
+
+// Additional includes
+#include "Allocator.h"
+#include "Assert.h"
+
+// STL includes
+#include <cstring>
+#include <initializer_list>
+#include <type_traits>
+#include <utility>
+
+
+
+/**
+@brief Inline element storage of a SmallArray, also holds the allocator so an empty one takes no space
+**/
+template<class T, size_t N, class Alloc>
+class ArrayInlineStorage : protected Alloc
+{
+protected:
+	explicit				ArrayInlineStorage(const Alloc& inAllocator) :	Alloc(inAllocator) { }
+	T*						GetInline()							{ return reinterpret_cast<T*>(mInline); }
+
+	alignas(T) unsigned char mInline[N * sizeof(T)];			///< Room for N elements, constructed on demand
+};
+
+template<class T, class Alloc>
+class ArrayInlineStorage<T, 0, Alloc> : protected Alloc
+{
+protected:
+	explicit				ArrayInlineStorage(const Alloc& inAllocator) :	Alloc(inAllocator) { }
+	T*						GetInline()							{ return nullptr; }
+};
+
+
+
+/**
+@brief Dynamic array that keeps up to N elements inline before it allocates
+
+With N = 0 this is the plain Array. Elements are moved (or copied when they cannot be moved) when the array
+grows, so pointers into the array are invalidated by growing just like with std::vector. The interface
+follows std::vector for the parts the project uses.
+
+SmallArray<WindowHandle, 8> hit_windows;	// No allocation for 8 or less
+**/
+template<class T, size_t N, class Alloc = DefaultAllocator>
+class SmallArray : private ArrayInlineStorage<T, N, Alloc>
+{
+	using Storage = ArrayInlineStorage<T, N, Alloc>;
+
+public:
+	using value_type		= T;
+	using size_type			= size_t;
+	using iterator			= T*;
+	using const_iterator	= const T*;
+
+	///@name Construction
+							SmallArray() :						SmallArray(Alloc()) { }
+	explicit				SmallArray(const Alloc& inAllocator) :	Storage(inAllocator), mData(this->GetInline()), mCapacity(N) { }
+	explicit				SmallArray(size_t inSize, const Alloc& inAllocator = Alloc()) : SmallArray(inAllocator) { resize(inSize); }
+							SmallArray(size_t inSize, const T& inValue, const Alloc& inAllocator = Alloc()) : SmallArray(inAllocator) { resize(inSize, inValue); }
+							SmallArray(std::initializer_list<T> inList, const Alloc& inAllocator = Alloc()) : SmallArray(inAllocator) { assign(inList.begin(), inList.end()); }
+							SmallArray(const SmallArray& inOther) :	SmallArray(inOther.GetAllocator()) { assign(inOther.begin(), inOther.end()); }
+							SmallArray(SmallArray&& inOther) noexcept : SmallArray(inOther.GetAllocator()) { MoveFrom(inOther); }
+							~SmallArray()						{ clear(); FreeData(); }
+
+	///@name Assignment
+	SmallArray&				operator=(const SmallArray& inOther);
+	SmallArray&				operator=(SmallArray&& inOther) noexcept;
+	SmallArray&				operator=(std::initializer_list<T> inList)	{ assign(inList.begin(), inList.end()); return *this; }
+	template<class I>
+	void					assign(I inBegin, I inEnd);			///< Replace the contents with a copy of [inBegin, inEnd)
+
+	///@name Properties
+	size_t					size() const						{ return mSize; }
+	size_t					capacity() const					{ return mCapacity; }
+	bool					empty() const						{ return mSize == 0; }
+	T*						data()								{ return mData; }
+	const T*				data() const						{ return mData; }
+	bool					IsInline() const					{ return mData == const_cast<SmallArray*>(this)->GetInline(); }	///< Check if the elements are in the inline storage
+	const Alloc&			GetAllocator() const				{ return *this; }
+
+	///@name Access
+	T&						operator[](size_t inIndex)			{ gAssert(inIndex < mSize); return mData[inIndex]; }
+	const T&				operator[](size_t inIndex) const	{ gAssert(inIndex < mSize); return mData[inIndex]; }
+	T&						front()								{ gAssert(mSize > 0); return mData[0]; }
+	const T&				front() const						{ gAssert(mSize > 0); return mData[0]; }
+	T&						back()								{ gAssert(mSize > 0); return mData[mSize - 1]; }
+	const T&				back() const						{ gAssert(mSize > 0); return mData[mSize - 1]; }
+
+	///@name Iteration
+	T*						begin()								{ return mData; }
+	T*						end()								{ return mData + mSize; }
+	const T*				begin() const						{ return mData; }
+	const T*				end() const							{ return mData + mSize; }
+
+	///@name Modification
+	void					reserve(size_t inCapacity)			{ if (inCapacity > mCapacity) Reallocate(inCapacity); }
+	void					resize(size_t inSize);				///< Grow with value initialized elements or shrink
+	void					resize(size_t inSize, const T& inValue);	///< Grow with copies of @a inValue or shrink
+	void					clear()								{ Destroy(mData, mData + mSize); mSize = 0; }
+	void					push_back(const T& inValue)			{ emplace_back(inValue); }
+	void					push_back(T&& inValue)				{ emplace_back(std::move(inValue)); }
+	template<class... A>
+	T&						emplace_back(A&&... inArgs);		///< Construct an element at the end
+	void					pop_back()							{ gAssert(mSize > 0); mData[--mSize].~T(); }
+	T*						erase(const T* inWhere);			///< Remove the element at @a inWhere keeping the order, returns the element after it
+	T*						erase(const T* inBegin, const T* inEnd);	///< Remove [inBegin, inEnd) keeping the order
+	void					swap(SmallArray& ioOther)			{ SmallArray temp(std::move(ioOther)); ioOther = std::move(*this); *this = std::move(temp); }
+	void					shrink_to_fit()						{ if (!IsInline() && mSize < mCapacity) Reallocate(mSize > N ? mSize : N); }
+
+private:
+	///@name Helpers
+	static void				Destroy(T* inBegin, T* inEnd)		{ if (!std::is_trivially_destructible<T>::value) for (T* i = inBegin; i < inEnd; ++i) i->~T(); }
+	void					Reallocate(size_t inCapacity);		///< Move the elements to storage for @a inCapacity elements
+	void					Grow()								{ Reallocate(mCapacity < 4 ? 4 : mCapacity + mCapacity / 2); }
+	void					FreeData()							{ if (!IsInline()) this->Free(mData, mCapacity * sizeof(T), alignof(T)); }
+	void					MoveFrom(SmallArray& ioOther);		///< Take the elements of @a ioOther, which must be empty afterwards
+
+	///@name Properties
+	T*						mData;								///< Elements, the inline storage until the array outgrows it
+	size_t					mSize = 0;
+	size_t					mCapacity;
+};
+
+
+
+/**
+@brief Dynamic array, the SmallArray without inline storage
+**/
+template<class T, class Alloc = DefaultAllocator>
+using Array = SmallArray<T, 0, Alloc>;
+
+
+
+/**
+@brief Copy assignment
+**/
+template<class T, size_t N, class Alloc>
+SmallArray<T, N, Alloc>& SmallArray<T, N, Alloc>::operator=(const SmallArray& inOther)
+{
+	if (this != &inOther)
+		assign(inOther.begin(), inOther.end());
+	return *this;
+}
+
+
+
+/**
+@brief Move assignment, the allocator moves along with the memory it allocated
+**/
+template<class T, size_t N, class Alloc>
+SmallArray<T, N, Alloc>& SmallArray<T, N, Alloc>::operator=(SmallArray&& inOther) noexcept
+{
+	if (this != &inOther)
+	{
+		clear();
+		FreeData();
+		mData = this->GetInline();
+		mCapacity = N;
+		static_cast<Alloc&>(*this) = inOther.GetAllocator();
+		MoveFrom(inOther);
+	}
+	return *this;
+}
+
+
+
+/**
+@brief Take the elements of @a ioOther
+**/
+template<class T, size_t N, class Alloc>
+void SmallArray<T, N, Alloc>::MoveFrom(SmallArray& ioOther)
+{
+	if (!ioOther.IsInline())
+	{
+		// Steal the heap block
+		mData = ioOther.mData;
+		mSize = ioOther.mSize;
+		mCapacity = ioOther.mCapacity;
+		ioOther.mData = ioOther.GetInline();
+		ioOther.mSize = 0;
+		ioOther.mCapacity = N;
+	}
+	else
+	{
+		// Inline elements have to be moved one by one, they fit in our inline storage
+		for (size_t i = 0; i < ioOther.mSize; ++i)
+			new (mData + i) T(std::move(ioOther.mData[i]));
+		mSize = ioOther.mSize;
+		ioOther.clear();
+	}
+}
+
+
+
+/**
+@brief Replace the contents with a copy of [inBegin, inEnd)
+**/
+template<class T, size_t N, class Alloc>
+template<class I>
+void SmallArray<T, N, Alloc>::assign(I inBegin, I inEnd)
+{
+	clear();
+	size_t count = 0;
+	for (I i = inBegin; i != inEnd; ++i)
+		++count;
+	reserve(count);
+	for (I i = inBegin; i != inEnd; ++i)
+		new (mData + mSize++) T(*i);
+}
+
+
+
+/**
+@brief Move the elements to storage for @a inCapacity elements
+**/
+template<class T, size_t N, class Alloc>
+void SmallArray<T, N, Alloc>::Reallocate(size_t inCapacity)
+{
+	gAssert(inCapacity >= mSize);
+
+	T* data = inCapacity <= N ? this->GetInline() : (T*)this->Allocate(inCapacity * sizeof(T), alignof(T));
+	if (data == mData)
+		return;
+
+	if (std::is_trivially_copyable<T>::value)
+	{
+		if (mSize > 0)
+			memcpy((void*)data, (const void*)mData, mSize * sizeof(T));
+	}
+	else
+	{
+		for (size_t i = 0; i < mSize; ++i)
+			new (data + i) T(std::move_if_noexcept(mData[i]));
+		Destroy(mData, mData + mSize);
+	}
+
+	FreeData();
+	mData = data;
+	mCapacity = inCapacity > N ? inCapacity : N;
+}
+
+
+
+/**
+@brief Grow with value initialized elements or shrink
+**/
+template<class T, size_t N, class Alloc>
+void SmallArray<T, N, Alloc>::resize(size_t inSize)
+{
+	if (inSize < mSize)
+	{
+		Destroy(mData + inSize, mData + mSize);
+		mSize = inSize;
+		return;
+	}
+
+	reserve(inSize);
+	for (; mSize < inSize; ++mSize)
+		new (mData + mSize) T();
+}
+
+
+
+/**
+@brief Grow with copies of @a inValue or shrink
+**/
+template<class T, size_t N, class Alloc>
+void SmallArray<T, N, Alloc>::resize(size_t inSize, const T& inValue)
+{
+	if (inSize < mSize)
+	{
+		Destroy(mData + inSize, mData + mSize);
+		mSize = inSize;
+		return;
+	}
+
+	if (inSize > mCapacity)
+	{
+		// inValue can live in this array, copy it before growing
+		T value(inValue);
+		Reallocate(inSize);
+		for (; mSize < inSize; ++mSize)
+			new (mData + mSize) T(value);
+		return;
+	}
+
+	for (; mSize < inSize; ++mSize)
+		new (mData + mSize) T(inValue);
+}
+
+
+
+/**
+@brief Construct an element at the end
+**/
+template<class T, size_t N, class Alloc>
+template<class... A>
+T& SmallArray<T, N, Alloc>::emplace_back(A&&... inArgs)
+{
+	if (mSize == mCapacity)
+	{
+		// The arguments can refer to an element of this array, construct before moving the elements
+		T value(std::forward<A>(inArgs)...);
+		Grow();
+		return *new (mData + mSize++) T(std::move(value));
+	}
+
+	return *new (mData + mSize++) T(std::forward<A>(inArgs)...);
+}
+
+
+
+/**
+@brief Remove the element at @a inWhere keeping the order
+**/
+template<class T, size_t N, class Alloc>
+T* SmallArray<T, N, Alloc>::erase(const T* inWhere)
+{
+	return erase(inWhere, inWhere + 1);
+}
+
+
+
+/**
+@brief Remove [inBegin, inEnd) keeping the order
+**/
+template<class T, size_t N, class Alloc>
+T* SmallArray<T, N, Alloc>::erase(const T* inBegin, const T* inEnd)
+{
+	T* begin = mData + (inBegin - mData);
+	T* end = mData + (inEnd - mData);
+	gAssert(begin >= mData && end <= mData + mSize && begin <= end);
+
+	T* out = begin;
+	for (T* i = end; i < mData + mSize; ++i, ++out)
+		*out = std::move(*i);
+	Destroy(out, mData + mSize);
+	mSize -= end - begin;
+	return begin;
+}
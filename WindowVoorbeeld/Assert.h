@@ -0,0 +1,11 @@
+#pragma once
+
+// STL includes
+#include <cassert>
+
+
+
+/**
+@brief Debug only check, in its own header so the containers (which Utility.h includes) can use it too
+**/
+#define gAssert(...)	assert(__VA_ARGS__)
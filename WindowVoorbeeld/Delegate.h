@@ -0,0 +1,311 @@
+#pragma once
+
+// Additional includes
+#include "Array.h"
+#include "Function.h"
+#include "HandleTable.h"
+
+// STL includes
+#include <mutex>
+
+
+
+/**
+@brief Token of a Delegate subscription, pass it to Delegate::Unsubscribe. The value 0 means "not subscribed"
+**/
+struct DelegateSubscription;
+using DelegateToken = Handle<DelegateSubscription>;
+
+
+
+/**
+@brief Event with any number of subscribers
+
+Delegate<bool(int)> key_down;
+DelegateToken token = key_down.Subscribe([this](int inKey) { return OnKey(inKey); });
+bool handled = key_down.Broadcast(5);
+key_down.Unsubscribe(token);
+
+Subscribers are InplaceFunctions stored next to each other in one array, so subscribing never allocates per
+subscriber and a broadcast walks contiguous memory. Subscribers return void or bool, Broadcast returns true if
+one of them returned true. The order in which subscribers are called is not defined.
+
+Subscribing and unsubscribing are O(1) through a generational token, a stale token is ignored. Both can be done
+from inside a subscriber: a subscriber added during a broadcast is first called by the next broadcast and an
+unsubscribed one is not called anymore, its callable is destroyed when the outermost broadcast returns.
+The delegate itself must outlive its broadcasts and is not thread safe. A delegate that is broadcast on another
+thread gets the mutex that thread holds while broadcasting through SetLock, changing the subscribers then takes it.
+**/
+template<class Signature, size_t N = 48>
+class Delegate;
+
+template<class R, class... Args, size_t N>
+class Delegate<R(Args...), N>
+{
+	static_assert(std::is_void<R>::value || std::is_same<R, bool>::value, "Subscribers return void or bool");
+
+public:
+	using Function			= InplaceFunction<R(Args...), N>;
+
+	///@name Construction
+							Delegate() = default;
+							Delegate(const Delegate&) = delete;
+	Delegate&				operator=(const Delegate&) = delete;
+
+	///@name Subscribers
+	DelegateToken			Subscribe(Function&& inFunction);			///< Add @a inFunction, keep the token to unsubscribe it
+	bool					Unsubscribe(DelegateToken inToken);			///< Remove the subscriber of @a inToken, false if it was already removed
+	void					Clear();									///< Remove all subscribers, every token becomes stale
+	bool					IsSubscribed(DelegateToken inToken) const	{ return sGetSlot(mSlots, inToken) != nullptr; }
+	bool					IsEmpty() const								{ return mCount == 0; }
+	size_t					GetSize() const								{ return mCount; }	///< Amount of subscribers
+
+	///@name Broadcast
+	bool					Broadcast(Args... inArgs);					///< Call every subscriber, true if one of them returned true
+	void					SetLock(std::recursive_mutex* inMutex)		{ mLock = inMutex; }	///< Lock @a inMutex in Subscribe, Unsubscribe and Clear, the broadcasting thread holds it around Broadcast. nullptr to stop locking
+
+private:
+	static constexpr uint16_t cNoSlot		= 0xFFFF;					///< Subscriber that was unsubscribed during a broadcast, also the end of the free list
+	static constexpr uint32_t cAddedIndex	= 0x80000000;				///< Slot index flag for subscribers in mAdded
+
+	/**
+	@brief A subscriber, in the order of the subscriber array
+	**/
+	struct Subscriber
+	{
+		Function			mFunction;
+		uint16_t			mSlot;										///< Slot of the token, cNoSlot once unsubscribed (its function is disabled then)
+	};
+
+	/**
+	@brief Where the subscriber of a token is, tokens are the slot index and its generation
+	**/
+	struct Slot
+	{
+		uint32_t			mIndex		= 0;							///< Index of the subscriber (with cAddedIndex if it is in mAdded), the next free slot when free
+		uint16_t			mGeneration	= 1;							///< Bumped when the subscriber is removed, never 0 so tokens are never 0
+	};
+
+	///@name Helpers
+	template<class S>
+	static S*				sGetSlot(Array<S>& inSlots, DelegateToken inToken);	///< Slot of @a inToken, nullptr if the token is stale
+	template<class S>
+	static const S*			sGetSlot(const Array<S>& inSlots, DelegateToken inToken)	{ return sGetSlot(const_cast<Array<S>&>(inSlots), inToken); }
+	static bool				sCall(const Function& inFunction, Args&... inArgs)	{ return sCall(std::is_void<R>(), inFunction, inArgs...); }
+	static bool				sCall(std::true_type, const Function& inFunction, Args&... inArgs)	{ inFunction(inArgs...); return false; }
+	static bool				sCall(std::false_type, const Function& inFunction, Args&... inArgs)	{ return inFunction(inArgs...); }
+	void					FreeSlot(uint16_t inSlot);					///< Put @a inSlot on the free list, its tokens become stale
+	void					Remove(Array<Subscriber>& ioSubscribers, size_t inIndex, uint32_t inFlag);	///< Swap the last subscriber into @a inIndex
+	void					EndBroadcast();								///< Drop the unsubscribed subscribers and move the added ones in
+	std::unique_lock<std::recursive_mutex> Lock()						{ return mLock != nullptr ? std::unique_lock<std::recursive_mutex>(*mLock) : std::unique_lock<std::recursive_mutex>(); }	///< Take mLock if there is one
+
+	///@name Properties
+	Array<Subscriber>		mSubscribers;								///< Subscribers, only marked and not moved during a broadcast
+	Array<Subscriber>		mAdded;										///< Subscribed during a broadcast, moved into mSubscribers once it ends
+	Array<Slot>				mSlots;										///< Token slots
+	uint16_t				mFreeSlot		= cNoSlot;					///< First free slot
+	uint32_t				mBroadcasting	= 0;						///< Nesting depth of Broadcast
+	bool					mRemoved		= false;					///< Subscribers were unsubscribed during the broadcast
+	size_t					mCount			= 0;						///< Subscribers that are not unsubscribed
+	std::recursive_mutex*	mLock			= nullptr;					///< See SetLock
+};
+
+
+
+/**
+@brief Add @a inFunction
+**/
+template<class R, class... Args, size_t N>
+DelegateToken Delegate<R(Args...), N>::Subscribe(Function&& inFunction)
+{
+	gAssert(inFunction);
+	std::unique_lock<std::recursive_mutex> lock = Lock();
+
+	uint16_t slot;
+	if (mFreeSlot != cNoSlot)
+	{
+		slot = mFreeSlot;
+		mFreeSlot = (uint16_t)mSlots[slot].mIndex;
+	}
+	else
+	{
+		gAssert(mSlots.size() < cNoSlot);
+		slot = (uint16_t)mSlots.size();
+		mSlots.emplace_back();
+	}
+
+	// Growing mSubscribers would move the subscriber that is running, so a broadcast adds to mAdded
+	Array<Subscriber>& subscribers = mBroadcasting > 0 ? mAdded : mSubscribers;
+	mSlots[slot].mIndex = (uint32_t)subscribers.size() | (mBroadcasting > 0 ? cAddedIndex : 0);
+	subscribers.push_back({ std::move(inFunction), slot });
+	++mCount;
+	return DelegateToken(slot, mSlots[slot].mGeneration);
+}
+
+
+
+/**
+@brief Remove the subscriber of @a inToken
+**/
+template<class R, class... Args, size_t N>
+bool Delegate<R(Args...), N>::Unsubscribe(DelegateToken inToken)
+{
+	std::unique_lock<std::recursive_mutex> lock = Lock();
+	Slot* slot = sGetSlot(mSlots, inToken);
+	if (slot == nullptr)
+		return false;
+
+	bool added = (slot->mIndex & cAddedIndex) != 0;
+	Array<Subscriber>& subscribers = added ? mAdded : mSubscribers;
+	size_t index = slot->mIndex & ~cAddedIndex;
+	FreeSlot(inToken.GetIndex());
+	--mCount;
+
+	// The subscriber can be the one that is running, so during a broadcast it is only disabled and marked
+	if (mBroadcasting > 0)
+	{
+		subscribers[index].mFunction.Disable();
+		subscribers[index].mSlot = cNoSlot;
+		mRemoved = true;
+	}
+	else
+		Remove(subscribers, index, added ? cAddedIndex : 0);
+	return true;
+}
+
+
+
+/**
+@brief Remove all subscribers
+**/
+template<class R, class... Args, size_t N>
+void Delegate<R(Args...), N>::Clear()
+{
+	std::unique_lock<std::recursive_mutex> lock = Lock();
+	for (Array<Subscriber>* subscribers : { &mSubscribers, &mAdded })
+		for (Subscriber& subscriber : *subscribers)
+			if (subscriber.mSlot != cNoSlot)
+			{
+				FreeSlot(subscriber.mSlot);
+				subscriber.mFunction.Disable();
+				subscriber.mSlot = cNoSlot;
+			}
+	mCount = 0;
+
+	if (mBroadcasting > 0)
+		mRemoved = true;
+	else
+	{
+		mSubscribers.clear();
+		mAdded.clear();
+	}
+}
+
+
+
+/**
+@brief Call every subscriber
+**/
+template<class R, class... Args, size_t N>
+bool Delegate<R(Args...), N>::Broadcast(Args... inArgs)
+{
+	if (mSubscribers.empty())
+		return false;
+
+	// Subscribers added by this broadcast are in mAdded, so the array does not change while walking it. Unsubscribed
+	// ones are disabled, so every subscriber is called without checking
+	bool handled = false;
+	++mBroadcasting;
+	for (const Subscriber* subscriber = mSubscribers.begin(), *end = mSubscribers.end(); subscriber < end; ++subscriber)
+		handled |= sCall(subscriber->mFunction, inArgs...);
+	if (--mBroadcasting == 0 && (mRemoved || !mAdded.empty()))
+		EndBroadcast();
+	return handled;
+}
+
+
+
+/**
+@brief Slot of @a inToken
+**/
+template<class R, class... Args, size_t N>
+template<class S>
+S* Delegate<R(Args...), N>::sGetSlot(Array<S>& inSlots, DelegateToken inToken)
+{
+	uint16_t index = inToken.GetIndex();
+	if (index >= inSlots.size())
+		return nullptr;
+
+	S& slot = inSlots[index];
+	return slot.mGeneration == inToken.GetGeneration() ? &slot : nullptr;
+}
+
+
+
+/**
+@brief Put @a inSlot on the free list
+**/
+template<class R, class... Args, size_t N>
+void Delegate<R(Args...), N>::FreeSlot(uint16_t inSlot)
+{
+	// Bump the generation (skipping 0) so the token of the slot becomes stale
+	Slot& slot = mSlots[inSlot];
+	if (++slot.mGeneration == 0)
+		slot.mGeneration = 1;
+	slot.mIndex = mFreeSlot;
+	mFreeSlot = inSlot;
+}
+
+
+
+/**
+@brief Swap the last subscriber into @a inIndex
+**/
+template<class R, class... Args, size_t N>
+void Delegate<R(Args...), N>::Remove(Array<Subscriber>& ioSubscribers, size_t inIndex, uint32_t inFlag)
+{
+	size_t last = ioSubscribers.size() - 1;
+	if (inIndex != last)
+	{
+		ioSubscribers[inIndex] = std::move(ioSubscribers[last]);
+		mSlots[ioSubscribers[inIndex].mSlot].mIndex = (uint32_t)inIndex | inFlag;
+	}
+	ioSubscribers.pop_back();
+}
+
+
+
+/**
+@brief Drop the unsubscribed subscribers and move the added ones in
+**/
+template<class R, class... Args, size_t N>
+void Delegate<R(Args...), N>::EndBroadcast()
+{
+	// Compact in place, this keeps the order of the remaining subscribers
+	size_t count = 0;
+	if (mRemoved)
+	{
+		for (size_t i = 0; i < mSubscribers.size(); ++i)
+		{
+			Subscriber& subscriber = mSubscribers[i];
+			if (subscriber.mSlot == cNoSlot)
+				continue;
+			if (i != count)
+			{
+				mSubscribers[count] = std::move(subscriber);
+				mSlots[mSubscribers[count].mSlot].mIndex = (uint32_t)count;
+			}
+			++count;
+		}
+		mSubscribers.resize(count);
+		mRemoved = false;
+	}
+
+	for (Subscriber& subscriber : mAdded)
+		if (subscriber.mSlot != cNoSlot)
+		{
+			mSlots[subscriber.mSlot].mIndex = (uint32_t)mSubscribers.size();
+			mSubscribers.push_back(std::move(subscriber));
+		}
+	mAdded.clear();
+}
@@ -0,0 +1,187 @@
+#include "DirtyRegion.h"
+
+// STL includes
+#include <algorithm>
+
+
+
+/**
+@brief Rectangle helpers, in 64 bit so huge rectangles (e.g. Window::Invalidate without arguments) cannot overflow
+**/
+static int64_t sGetArea(const IRect& inRect)				{ return (int64_t)inRect.mW * inRect.mH; }
+static int64_t sGetRight(const IRect& inRect)				{ return (int64_t)inRect.mX + inRect.mW; }
+static int64_t sGetBottom(const IRect& inRect)				{ return (int64_t)inRect.mY + inRect.mH; }
+
+static bool sContains(const IRect& inOuter, const IRect& inInner)
+{
+	return inInner.mX >= inOuter.mX && inInner.mY >= inOuter.mY && sGetRight(inInner) <= sGetRight(inOuter) && sGetBottom(inInner) <= sGetBottom(inOuter);
+}
+
+static bool sTouches(const IRect& inA, const IRect& inB)
+{
+	return inA.mX <= sGetRight(inB) && inB.mX <= sGetRight(inA) && inA.mY <= sGetBottom(inB) && inB.mY <= sGetBottom(inA);
+}
+
+static int64_t sGetOverlapArea(const IRect& inA, const IRect& inB)
+{
+	int64_t width = std::min(sGetRight(inA), sGetRight(inB)) - std::max(inA.mX, inB.mX);
+	int64_t height = std::min(sGetBottom(inA), sGetBottom(inB)) - std::max(inA.mY, inB.mY);
+	return width > 0 && height > 0 ? width * height : 0;
+}
+
+static IRect sGetUnion(const IRect& inA, const IRect& inB)
+{
+	int x = std::min(inA.mX, inB.mX);
+	int y = std::min(inA.mY, inB.mY);
+	int64_t width = std::min<int64_t>(std::max(sGetRight(inA), sGetRight(inB)) - x, INT32_MAX);
+	int64_t height = std::min<int64_t>(std::max(sGetBottom(inA), sGetBottom(inB)) - y, INT32_MAX);
+	return { x, y, (int)width, (int)height };
+}
+
+
+
+/**
+@brief Add @a inRect
+**/
+void DirtyRegion::Add(const IRect& inRect)
+{
+	if (inRect.mW <= 0 || inRect.mH <= 0)
+		return;
+
+	IRect rect = inRect;
+	size_t i = 0;
+	while (i < mCount)
+	{
+		const IRect& other = mRects[i];
+
+		// Already covered
+		if (sContains(other, rect))
+			return;
+
+		// Swallowed by the new rectangle
+		if (sContains(rect, other))
+		{
+			RemoveAt(i);
+			continue;
+		}
+
+		// Merge neighbours when the union wastes at most a quarter of its area, the merged rectangle can touch others so start over
+		if (sTouches(rect, other))
+		{
+			IRect merged = sGetUnion(rect, other);
+			int64_t covered = sGetArea(rect) + sGetArea(other) - sGetOverlapArea(rect, other);
+			if ((sGetArea(merged) - covered) * 4 <= sGetArea(merged))
+			{
+				rect = merged;
+				RemoveAt(i);
+				i = 0;
+				continue;
+			}
+		}
+
+		++i;
+	}
+
+	if (mCount < cMaxRects)
+	{
+		mRects[mCount++] = rect;
+		return;
+	}
+
+	// Full, merge into the rectangle that grows the least
+	size_t best_index = 0;
+	int64_t best_growth = INT64_MAX;
+	for (size_t j = 0; j < mCount; ++j)
+	{
+		int64_t growth = sGetArea(sGetUnion(mRects[j], rect)) - sGetArea(mRects[j]);
+		if (growth < best_growth)
+		{
+			best_growth = growth;
+			best_index = j;
+		}
+	}
+
+	// The grown rectangle may now cover others, add it again so those are swallowed
+	IRect merged = sGetUnion(mRects[best_index], rect);
+	RemoveAt(best_index);
+	Add(merged);
+}
+
+
+
+/**
+@brief Add every rectangle of @a inRegion
+**/
+void DirtyRegion::Add(const DirtyRegion& inRegion)
+{
+	for (const IRect& rect : inRegion)
+		Add(rect);
+}
+
+
+
+/**
+@brief Cut every rectangle to @a inBounds
+**/
+void DirtyRegion::Clip(const IRect& inBounds)
+{
+	size_t i = 0;
+	while (i < mCount)
+	{
+		IRect& rect = mRects[i];
+		int64_t left	= std::max(rect.mX, inBounds.mX);
+		int64_t top		= std::max(rect.mY, inBounds.mY);
+		int64_t right	= std::min(sGetRight(rect), sGetRight(inBounds));
+		int64_t bottom	= std::min(sGetBottom(rect), sGetBottom(inBounds));
+		if (left >= right || top >= bottom)
+		{
+			RemoveAt(i);
+			continue;
+		}
+
+		rect = { (int)left, (int)top, (int)(right - left), (int)(bottom - top) };
+		++i;
+	}
+}
+
+
+
+/**
+@brief Smallest rectangle containing the whole region
+**/
+IRect DirtyRegion::GetBounds() const
+{
+	if (mCount == 0)
+		return IRect();
+
+	IRect bounds = mRects[0];
+	for (size_t i = 1; i < mCount; ++i)
+		bounds = sGetUnion(bounds, mRects[i]);
+	return bounds;
+}
+
+
+
+/**
+@brief Sum of the areas of the rectangles
+**/
+int64_t DirtyRegion::GetArea() const
+{
+	int64_t area = 0;
+	for (const IRect& rect : *this)
+		area += sGetArea(rect);
+	return area;
+}
+
+
+
+/**
+@brief Check if any part of @a inRect needs repainting
+**/
+bool DirtyRegion::Intersects(const IRect& inRect) const
+{
+	for (const IRect& rect : *this)
+		if (sGetOverlapArea(rect, inRect) > 0)
+			return true;
+	return false;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+// Additional includes
+#include "Utility.h"
+
+
+
+/**
+@brief Set of rectangles that need repainting
+
+Added rectangles are merged with the ones they overlap or touch, as long as the merged rectangle does not
+cover much more than the two did. Up to cMaxRects rectangles are kept without allocating, beyond that new
+rectangles are merged into the one that grows the least.
+**/
+class DirtyRegion
+{
+public:
+	static constexpr size_t	cMaxRects = 16;					///< Maximum amount of separate rectangles
+
+	///@name Modification
+	void					Add(const IRect& inRect);		///< Add @a inRect, empty rectangles are ignored
+	void					Add(const DirtyRegion& inRegion);	///< Add every rectangle of @a inRegion
+	void					Clip(const IRect& inBounds);	///< Cut every rectangle to @a inBounds, removing the ones outside
+	void					Clear()							{ mCount = 0; }
+
+	///@name Properties
+	bool					IsEmpty() const					{ return mCount == 0; }
+	size_t					GetCount() const				{ return mCount; }
+	const IRect*			begin() const					{ return mRects; }
+	const IRect*			end() const						{ return mRects + mCount; }
+	const IRect&			operator[](size_t inIndex) const { gAssert(inIndex < mCount); return mRects[inIndex]; }
+	IRect					GetBounds() const;				///< Smallest rectangle containing the whole region
+	int64_t					GetArea() const;				///< Sum of the areas of the rectangles, overlap counts twice
+	bool					Intersects(const IRect& inRect) const;	///< Check if any part of @a inRect needs repainting
+
+private:
+	///@name Helpers
+	void					RemoveAt(size_t inIndex)		{ mRects[inIndex] = mRects[--mCount]; }
+
+	///@name Properties
+	IRect					mRects[cMaxRects];
+	size_t					mCount = 0;
+};
@@ -0,0 +1,482 @@
+#include "Framebuffer.h"
+
+// STL includes
+#include <algorithm>
+#include <cmath>
+
+// SIMD instruction sets, picked at compile time
+#if defined(__AVX2__)
+	#define FRAMEBUFFER_AVX2
+	#include <immintrin.h>
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define FRAMEBUFFER_SSE2
+	#include <emmintrin.h>
+#endif
+
+
+
+/**
+@brief Blend a single pixel, the exact scalar version of the SIMD kernels below
+
+Per channel: (src * a + dst * (255 - a) + 128) / 255, where the division rounds exactly through (x + (x >> 8)) >> 8.
+**/
+static inline uint32_t sBlendPixel(uint32_t inSource, uint32_t inDestination)
+{
+	uint32_t alpha = inSource >> 24;
+	uint32_t inverse_alpha = 255 - alpha;
+
+	uint32_t result = 0;
+	for (uint32_t shift = 0; shift < 32; shift += 8)
+	{
+		uint32_t sum = ((inSource >> shift) & 0xFF) * alpha + ((inDestination >> shift) & 0xFF) * inverse_alpha + 128;
+		result |= ((sum + (sum >> 8)) >> 8) << shift;
+	}
+	return result;
+}
+
+
+
+#ifdef FRAMEBUFFER_SSE2
+/**
+@brief Blend 2 pixels widened to 16 bits per channel
+**/
+static inline __m128i sBlendWide(__m128i inSource, __m128i inDestination)
+{
+	// Alpha is the highest channel of every pixel, broadcast it over the pixel's four channels
+	__m128i alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(inSource, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+	__m128i inverse_alpha = _mm_sub_epi16(_mm_set1_epi16(255), alpha);
+
+	__m128i sum = _mm_add_epi16(_mm_mullo_epi16(inSource, alpha), _mm_mullo_epi16(inDestination, inverse_alpha));
+	sum = _mm_add_epi16(sum, _mm_set1_epi16(128));
+	return _mm_srli_epi16(_mm_add_epi16(sum, _mm_srli_epi16(sum, 8)), 8);
+}
+
+
+
+/**
+@brief Blend 4 pixels
+**/
+static inline __m128i sBlend4(__m128i inSource, __m128i inDestination)
+{
+	__m128i zero = _mm_setzero_si128();
+	__m128i low = sBlendWide(_mm_unpacklo_epi8(inSource, zero), _mm_unpacklo_epi8(inDestination, zero));
+	__m128i high = sBlendWide(_mm_unpackhi_epi8(inSource, zero), _mm_unpackhi_epi8(inDestination, zero));
+	return _mm_packus_epi16(low, high);
+}
+#endif // FRAMEBUFFER_SSE2
+
+
+
+#ifdef FRAMEBUFFER_AVX2
+/**
+@brief Blend 8 pixels, same math as sBlendWide in each 128 bit lane
+**/
+static inline __m256i sBlend8(__m256i inSource, __m256i inDestination)
+{
+	__m256i zero = _mm256_setzero_si256();
+	__m256i source_low = _mm256_unpacklo_epi8(inSource, zero);
+	__m256i source_high = _mm256_unpackhi_epi8(inSource, zero);
+	__m256i destination_low = _mm256_unpacklo_epi8(inDestination, zero);
+	__m256i destination_high = _mm256_unpackhi_epi8(inDestination, zero);
+
+	auto blend = [](__m256i inSourceWide, __m256i inDestinationWide)
+	{
+		__m256i alpha = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(inSourceWide, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+		__m256i inverse_alpha = _mm256_sub_epi16(_mm256_set1_epi16(255), alpha);
+		__m256i sum = _mm256_add_epi16(_mm256_mullo_epi16(inSourceWide, alpha), _mm256_mullo_epi16(inDestinationWide, inverse_alpha));
+		sum = _mm256_add_epi16(sum, _mm256_set1_epi16(128));
+		return _mm256_srli_epi16(_mm256_add_epi16(sum, _mm256_srli_epi16(sum, 8)), 8);
+	};
+
+	// Unpack and pack both work per 128 bit lane, so the pixel order is preserved
+	return _mm256_packus_epi16(blend(source_low, destination_low), blend(source_high, destination_high));
+}
+#endif // FRAMEBUFFER_AVX2
+
+
+
+/**
+@brief Fill @a inCount pixels with @a inColor
+**/
+static void sFillRow(uint32_t* ioRow, size_t inCount, uint32_t inColor)
+{
+	size_t i = 0;
+#ifdef FRAMEBUFFER_AVX2
+	__m256i color8 = _mm256_set1_epi32((int)inColor);
+	for (; i + 8 <= inCount; i += 8)
+		_mm256_storeu_si256((__m256i*)(ioRow + i), color8);
+#endif
+#ifdef FRAMEBUFFER_SSE2
+	__m128i color4 = _mm_set1_epi32((int)inColor);
+	for (; i + 4 <= inCount; i += 4)
+		_mm_storeu_si128((__m128i*)(ioRow + i), color4);
+#endif
+	for (; i < inCount; ++i)
+		ioRow[i] = inColor;
+}
+
+
+
+/**
+@brief Blend @a inColor over @a inCount pixels
+**/
+static void sBlendRowColor(uint32_t* ioRow, size_t inCount, uint32_t inColor)
+{
+	size_t i = 0;
+#ifdef FRAMEBUFFER_AVX2
+	__m256i color8 = _mm256_set1_epi32((int)inColor);
+	for (; i + 8 <= inCount; i += 8)
+	{
+		__m256i* destination = (__m256i*)(ioRow + i);
+		_mm256_storeu_si256(destination, sBlend8(color8, _mm256_loadu_si256(destination)));
+	}
+#endif
+#ifdef FRAMEBUFFER_SSE2
+	__m128i color4 = _mm_set1_epi32((int)inColor);
+	for (; i + 4 <= inCount; i += 4)
+	{
+		__m128i* destination = (__m128i*)(ioRow + i);
+		_mm_storeu_si128(destination, sBlend4(color4, _mm_loadu_si128(destination)));
+	}
+#endif
+	for (; i < inCount; ++i)
+		ioRow[i] = sBlendPixel(inColor, ioRow[i]);
+}
+
+
+
+/**
+@brief Blend @a inCount pixels of @a inSource with their own alpha over @a ioRow
+**/
+static void sBlendRow(uint32_t* ioRow, const uint32_t* inSource, size_t inCount)
+{
+	size_t i = 0;
+#ifdef FRAMEBUFFER_AVX2
+	for (; i + 8 <= inCount; i += 8)
+	{
+		__m256i* destination = (__m256i*)(ioRow + i);
+		__m256i source = _mm256_loadu_si256((const __m256i*)(inSource + i));
+		_mm256_storeu_si256(destination, sBlend8(source, _mm256_loadu_si256(destination)));
+	}
+#endif
+#ifdef FRAMEBUFFER_SSE2
+	for (; i + 4 <= inCount; i += 4)
+	{
+		__m128i* destination = (__m128i*)(ioRow + i);
+		__m128i source = _mm_loadu_si128((const __m128i*)(inSource + i));
+		_mm_storeu_si128(destination, sBlend4(source, _mm_loadu_si128(destination)));
+	}
+#endif
+	for (; i < inCount; ++i)
+		ioRow[i] = sBlendPixel(inSource[i], ioRow[i]);
+}
+
+
+
+/**
+@brief Resize, the contents are undefined afterwards
+**/
+void Framebuffer::Resize(int inWidth, int inHeight)
+{
+	mWidth	= std::max(inWidth, 0);
+	mHeight	= std::max(inHeight, 0);
+	mPixels.resize((size_t)mWidth * mHeight);
+}
+
+
+
+/**
+@brief Fill every pixel with @a inColor
+**/
+void Framebuffer::Clear(uint32_t inColor)
+{
+	sFillRow(mPixels.data(), mPixels.size(), inColor);
+}
+
+
+
+/**
+@brief Fill @a inRect with @a inColor
+**/
+void Framebuffer::FillRect(const IRect& inRect, uint32_t inColor)
+{
+	IRect rect;
+	if (!ClipRect(inRect, rect))
+		return;
+
+	for (int y = rect.mY; y < rect.mY + rect.mH; ++y)
+		sFillRow(GetRow(y) + rect.mX, rect.mW, inColor);
+}
+
+
+
+/**
+@brief Copy @a inSource with its top left at @a inX, @a inY
+**/
+void Framebuffer::Blit(const Framebuffer& inSource, int inX, int inY)
+{
+	IRect rect;
+	if (!ClipRect({inX, inY, inSource.mWidth, inSource.mHeight}, rect))
+		return;
+
+	for (int y = rect.mY; y < rect.mY + rect.mH; ++y)
+		memcpy(GetRow(y) + rect.mX, inSource.GetRow(y - inY) + (rect.mX - inX), rect.mW * sizeof(uint32_t));
+}
+
+
+
+/**
+@brief Blend @a inColor over @a inRect
+**/
+void Framebuffer::BlendRect(const IRect& inRect, uint32_t inColor)
+{
+	// Opaque and fully transparent colors do not need the blend
+	uint32_t alpha = inColor >> 24;
+	if (alpha == 255)
+	{
+		FillRect(inRect, inColor);
+		return;
+	}
+
+	IRect rect;
+	if (alpha == 0 || !ClipRect(inRect, rect))
+		return;
+
+	for (int y = rect.mY; y < rect.mY + rect.mH; ++y)
+		sBlendRowColor(GetRow(y) + rect.mX, rect.mW, inColor);
+}
+
+
+
+/**
+@brief Blend @a inSource with its own alpha over this framebuffer
+**/
+void Framebuffer::BlendBlit(const Framebuffer& inSource, int inX, int inY)
+{
+	IRect rect;
+	if (!ClipRect({inX, inY, inSource.mWidth, inSource.mHeight}, rect))
+		return;
+
+	for (int y = rect.mY; y < rect.mY + rect.mH; ++y)
+		sBlendRow(GetRow(y) + rect.mX, inSource.GetRow(y - inY) + (rect.mX - inX), rect.mW);
+}
+
+
+
+/**
+@brief Draw a line from (@a inX0, @a inY0) to (@a inX1, @a inY1)
+**/
+void Framebuffer::DrawLine(int inX0, int inY0, int inX1, int inY1, uint32_t inColor)
+{
+	if (mWidth == 0 || mHeight == 0 || (inColor >> 24) == 0)
+		return;
+
+	// Axis aligned lines are rectangles
+	if (inY0 == inY1)
+	{
+		BlendRect({std::min(inX0, inX1), inY0, std::abs(inX1 - inX0) + 1, 1}, inColor);
+		return;
+	}
+	if (inX0 == inX1)
+	{
+		BlendRect({inX0, std::min(inY0, inY1), 1, std::abs(inY1 - inY0) + 1}, inColor);
+		return;
+	}
+
+	// Clip the parameter range against the framebuffer (Liang-Barsky), so long lines only walk their visible part
+	double dx = (double)inX1 - inX0;
+	double dy = (double)inY1 - inY0;
+	double t0 = 0.0, t1 = 1.0;
+	const double p[4] = { -dx, dx, -dy, dy };
+	const double q[4] = { (double)inX0, (double)(mWidth - 1 - inX0), (double)inY0, (double)(mHeight - 1 - inY0) };
+	for (int i = 0; i < 4; ++i)
+	{
+		if (p[i] == 0.0)
+		{
+			if (q[i] < 0.0)
+				return;
+			continue;
+		}
+
+		double t = q[i] / p[i];
+		if (p[i] < 0.0)
+			t0 = std::max(t0, t);
+		else
+			t1 = std::min(t1, t);
+		if (t0 > t1)
+			return;
+	}
+
+	int x0 = (int)std::lround(inX0 + t0 * dx), y0 = (int)std::lround(inY0 + t0 * dy);
+	int x1 = (int)std::lround(inX0 + t1 * dx), y1 = (int)std::lround(inY0 + t1 * dy);
+
+	// Bresenham, the clipped end points are inside but rounding may put a step outside so keep a cheap bounds check
+	int step_x = x0 < x1 ? 1 : -1;
+	int step_y = y0 < y1 ? 1 : -1;
+	int delta_x = std::abs(x1 - x0);
+	int delta_y = -std::abs(y1 - y0);
+	int error = delta_x + delta_y;
+	for (;;)
+	{
+		if ((unsigned)x0 < (unsigned)mWidth && (unsigned)y0 < (unsigned)mHeight)
+			PutPixel(x0, y0, inColor);
+		if (x0 == x1 && y0 == y1)
+			break;
+
+		int error2 = 2 * error;
+		if (error2 >= delta_y)
+		{
+			error += delta_y;
+			x0 += step_x;
+		}
+		if (error2 <= delta_x)
+		{
+			error += delta_x;
+			y0 += step_y;
+		}
+	}
+}
+
+
+
+/**
+@brief Draw the one pixel outline of @a inRect
+**/
+void Framebuffer::DrawRect(const IRect& inRect, uint32_t inColor)
+{
+	if (inRect.mW <= 0 || inRect.mH <= 0)
+		return;
+
+	// Top and bottom rows span the full width, the sides skip them so blended corners are not drawn twice
+	BlendRect({inRect.mX, inRect.mY, inRect.mW, 1}, inColor);
+	if (inRect.mH > 1)
+		BlendRect({inRect.mX, inRect.mY + inRect.mH - 1, inRect.mW, 1}, inColor);
+	if (inRect.mH > 2)
+	{
+		BlendRect({inRect.mX, inRect.mY + 1, 1, inRect.mH - 2}, inColor);
+		if (inRect.mW > 1)
+			BlendRect({inRect.mX + inRect.mW - 1, inRect.mY + 1, 1, inRect.mH - 2}, inColor);
+	}
+}
+
+
+
+/**
+@brief Amount of pixels with a channel that differs more than @a inTolerance
+**/
+size_t Framebuffer::CountDifferences(const Framebuffer& inOther, uint8_t inTolerance) const
+{
+	if (mWidth != inOther.mWidth || mHeight != inOther.mHeight)
+		return std::max(mPixels.size(), inOther.mPixels.size());
+
+	size_t differences = 0;
+	for (size_t i = 0; i < mPixels.size(); ++i)
+	{
+		uint32_t a = mPixels[i], b = inOther.mPixels[i];
+		if (a == b)
+			continue;
+
+		for (uint32_t shift = 0; shift < 32; shift += 8)
+		{
+			int difference = (int)((a >> shift) & 0xFF) - (int)((b >> shift) & 0xFF);
+			if (std::abs(difference) > inTolerance)
+			{
+				++differences;
+				break;
+			}
+		}
+	}
+	return differences;
+}
+
+
+
+/**
+@brief Write an uncompressed 32 bit TGA
+**/
+bool Framebuffer::SaveTGA(const String& inPath) const
+{
+	FILE* file = gOpenFile(inPath.c_str(), "wb");
+	if (file == nullptr)
+		return false;
+
+	// Uncompressed true color, top left origin with 8 alpha bits. TGA pixels are BGRA, which is our memory layout.
+	uint8_t header[18] = {};
+	header[2]	= 2;
+	header[12]	= (uint8_t)(mWidth & 0xFF);
+	header[13]	= (uint8_t)(mWidth >> 8);
+	header[14]	= (uint8_t)(mHeight & 0xFF);
+	header[15]	= (uint8_t)(mHeight >> 8);
+	header[16]	= 32;
+	header[17]	= 0x28;
+
+	bool written = fwrite(header, sizeof(header), 1, file) == 1
+		&& (mPixels.empty() || fwrite(mPixels.data(), mPixels.size() * sizeof(uint32_t), 1, file) == 1);
+	return fclose(file) == 0 && written;
+}
+
+
+
+/**
+@brief Read an uncompressed 32 bit TGA
+**/
+bool Framebuffer::LoadTGA(const String& inPath)
+{
+	Resize(0, 0);
+
+	FILE* file = gOpenFile(inPath.c_str(), "rb");
+	if (file == nullptr)
+		return false;
+
+	// Only what SaveTGA writes: no image ID or color map, true color with 32 bits per pixel
+	uint8_t header[18];
+	bool read = fread(header, sizeof(header), 1, file) == 1 && header[0] == 0 && header[1] == 0 && header[2] == 2 && header[16] == 32;
+	if (read)
+	{
+		Resize(header[12] | (header[13] << 8), header[14] | (header[15] << 8));
+		read = mPixels.empty() || fread(mPixels.data(), mPixels.size() * sizeof(uint32_t), 1, file) == 1;
+	}
+	fclose(file);
+	if (!read)
+	{
+		Resize(0, 0);
+		return false;
+	}
+
+	// Rows are stored bottom up unless the origin is at the top
+	if ((header[17] & 0x20) == 0)
+		for (int y = 0; y < mHeight / 2; ++y)
+			std::swap_ranges(GetRow(y), GetRow(y) + mWidth, GetRow(mHeight - 1 - y));
+	return true;
+}
+
+
+
+/**
+@brief Clip @a inRect to the framebuffer
+**/
+bool Framebuffer::ClipRect(const IRect& inRect, IRect& outRect) const
+{
+	// 64 bit so huge rectangles cannot overflow
+	int64_t left	= std::max<int64_t>(inRect.mX, 0);
+	int64_t top		= std::max<int64_t>(inRect.mY, 0);
+	int64_t right	= std::min<int64_t>((int64_t)inRect.mX + inRect.mW, mWidth);
+	int64_t bottom	= std::min<int64_t>((int64_t)inRect.mY + inRect.mH, mHeight);
+	if (left >= right || top >= bottom)
+		return false;
+
+	outRect = { (int)left, (int)top, (int)(right - left), (int)(bottom - top) };
+	return true;
+}
+
+
+
+/**
+@brief Write or blend a single pixel
+**/
+void Framebuffer::PutPixel(int inX, int inY, uint32_t inColor)
+{
+	uint32_t& pixel = GetRow(inY)[inX];
+	pixel = (inColor >> 24) == 255 ? inColor : sBlendPixel(inColor, pixel);
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+// Additional includes
+#include "Utility.h"
+
+
+
+/**
+@brief Pack a color into a 32 bit 0xAARRGGBB pixel (BGRA in memory, the layout of a Win32 32 bit DIB)
+**/
+constexpr uint32_t gMakeColor(uint8_t inR, uint8_t inG, uint8_t inB, uint8_t inA = 255)
+{
+	return ((uint32_t)inA << 24) | ((uint32_t)inR << 16) | ((uint32_t)inG << 8) | (uint32_t)inB;
+}
+
+
+
+/**
+@brief CPU framebuffer with SIMD drawing primitives
+
+Pixels are 0xAARRGGBB (see gMakeColor), rows are tightly packed top to bottom.
+Every primitive clips against the framebuffer, so any rectangle or line can be passed.
+Fills and blends use AVX2 when compiled with it (/arch:AVX2, -mavx2), SSE2 otherwise, with a scalar fallback
+on targets that have neither.
+
+Blending is "source over destination" with straight alpha: out = src * a + dst * (1 - a), for all four channels.
+
+Example:
+
+virtual void OnPaint() override
+{
+	Framebuffer& framebuffer = *GetFramebuffer();
+	framebuffer.Clear(gMakeColor(30, 30, 30));
+	framebuffer.FillRect({10, 10, 100, 20}, gMakeColor(200, 60, 60));
+	framebuffer.DrawLine(0, 0, framebuffer.GetWidth(), framebuffer.GetHeight(), gMakeColor(255, 255, 255, 128));
+}
+**/
+class Framebuffer
+{
+public:
+	///@name Construction
+							Framebuffer() = default;
+							Framebuffer(int inWidth, int inHeight)		{ Resize(inWidth, inHeight); }
+	void					Resize(int inWidth, int inHeight);			///< Resize, the contents are undefined afterwards
+
+	///@name Properties
+	int						GetWidth() const							{ return mWidth; }
+	int						GetHeight() const							{ return mHeight; }
+	uint32_t*				GetPixels()									{ return mPixels.data(); }
+	const uint32_t*			GetPixels() const							{ return mPixels.data(); }
+	uint32_t*				GetRow(int inY)								{ return mPixels.data() + (size_t)inY * mWidth; }
+	const uint32_t*			GetRow(int inY) const						{ return mPixels.data() + (size_t)inY * mWidth; }
+	uint32_t				GetPixel(int inX, int inY) const			{ return GetRow(inY)[inX]; }	///< No clipping, @a inX and @a inY must be inside
+
+	///@name Opaque primitives
+	void					Clear(uint32_t inColor);					///< Fill every pixel with @a inColor
+	void					FillRect(const IRect& inRect, uint32_t inColor);	///< Fill @a inRect with @a inColor
+	void					Blit(const Framebuffer& inSource, int inX, int inY);	///< Copy @a inSource with its top left at @a inX, @a inY
+
+	///@name Blended primitives
+	void					BlendRect(const IRect& inRect, uint32_t inColor);	///< Blend @a inColor over @a inRect
+	void					BlendBlit(const Framebuffer& inSource, int inX, int inY);	///< Blend @a inSource with its own alpha over this framebuffer with its top left at @a inX, @a inY
+
+	///@name Outlines (blended when the alpha of @a inColor is below 255)
+	void					DrawLine(int inX0, int inY0, int inX1, int inY1, uint32_t inColor);	///< Draw a line from (@a inX0, @a inY0) to (@a inX1, @a inY1), both ends included
+	void					DrawRect(const IRect& inRect, uint32_t inColor);	///< Draw the one pixel outline of @a inRect
+
+	///@name Comparison (golden images)
+	size_t					CountDifferences(const Framebuffer& inOther, uint8_t inTolerance = 0) const;	///< Amount of pixels with a channel that differs more than @a inTolerance, every pixel counts as different if the sizes do not match
+	bool					SaveTGA(const String& inPath) const;		///< Write an uncompressed 32 bit TGA, returns false if the file could not be written
+	bool					LoadTGA(const String& inPath);				///< Read an uncompressed 32 bit TGA like SaveTGA writes, returns false (and leaves this framebuffer empty) if it can't be read
+
+private:
+	///@name Helpers
+	bool					ClipRect(const IRect& inRect, IRect& outRect) const;	///< Clip @a inRect to the framebuffer, returns false if nothing is left
+	void					PutPixel(int inX, int inY, uint32_t inColor);			///< Write or blend a single pixel, no clipping
+
+	///@name Properties
+	int						mWidth	= 0;
+	int						mHeight	= 0;
+	Array<uint32_t>			mPixels;									///< mWidth * mHeight pixels
+};
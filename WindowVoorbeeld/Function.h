@@ -0,0 +1,151 @@
+#pragma once
+
+// Additional includes
+#include "Utility.h"
+
+// STL includes
+#include <cstddef>
+#include <new>
+#include <utility>
+
+
+
+/**
+@brief Callable stored inside the object itself, a std::function that never allocates
+
+The callable must fit in @a N bytes, which is checked at compile time. Move only, as callables
+usually capture by value and a copy would be a hidden cost.
+
+Example:
+
+InplaceFunction<void(int)> function = [this](int inValue) { mTotal += inValue; };
+function(5);
+**/
+template<class Signature, size_t N = 48>
+class InplaceFunction;
+
+template<class R, class... Args, size_t N>
+class InplaceFunction<R(Args...), N>
+{
+public:
+	///@name Construction
+							InplaceFunction() = default;
+							InplaceFunction(std::nullptr_t)			{ }
+							InplaceFunction(InplaceFunction&& ioOther)	{ MoveFrom(ioOther); }
+							~InplaceFunction()							{ Reset(); }
+
+	template<class F, class = typename std::enable_if<!std::is_same<typename std::decay<F>::type, InplaceFunction>::value>::type>
+							InplaceFunction(F&& inFunction);			///< Store @a inFunction
+
+	///@name Assignment
+	InplaceFunction&		operator=(InplaceFunction&& ioOther)		{ if (this != &ioOther) { Reset(); MoveFrom(ioOther); } return *this; }
+	InplaceFunction&		operator=(std::nullptr_t)					{ Reset(); return *this; }
+
+	///@name Call
+	R						operator()(Args... inArgs) const			{ gAssert(mInvoke != nullptr); return mInvoke(mStorage, std::forward<Args>(inArgs)...); }
+
+	///@name Properties
+	explicit				operator bool() const						{ return mInvoke != nullptr; }	///< Check if a callable is stored
+	void					Reset();									///< Destroy the stored callable
+	void					Disable()									{ if (mInvoke != nullptr) mInvoke = &sInvokeNothing; }	///< Make calls do nothing and return R(), the callable stays alive until Reset. Safe while the callable runs
+
+private:
+	/**
+	@brief Operations on the stored callable
+	**/
+	enum class EOperation : uint8_t
+	{
+		Move,				///< Move construct into the destination storage and destroy the source
+		Destroy,			///< Destroy the callable
+	};
+
+	using InvokeFunction	= R (*)(const void* inStorage, Args&&... inArgs);
+	using ManageFunction	= void (*)(EOperation inOperation, void* ioStorage, void* ioDestination);
+
+	template<class F>
+	static R				sInvoke(const void* inStorage, Args&&... inArgs)	{ return (*(F*)inStorage)(std::forward<Args>(inArgs)...); }
+	static R				sInvokeNothing(const void* inStorage, Args&&... inArgs)	{ return R(); }
+
+	template<class F>
+	static void				sManage(EOperation inOperation, void* ioStorage, void* ioDestination);
+
+	void					MoveFrom(InplaceFunction& ioOther);			///< Take the callable of @a ioOther
+
+	///@name Properties
+	alignas(std::max_align_t) unsigned char mStorage[N];				///< Callable storage
+	InvokeFunction			mInvoke = nullptr;							///< Calls the stored callable, nullptr when empty
+	ManageFunction			mManage = nullptr;							///< Moves or destroys the stored callable
+};
+
+
+
+/**
+@brief Store @a inFunction
+**/
+template<class R, class... Args, size_t N>
+template<class F, class>
+InplaceFunction<R(Args...), N>::InplaceFunction(F&& inFunction)
+{
+	using Callable = typename std::decay<F>::type;
+	static_assert(sizeof(Callable) <= N, "Callable does not fit in the InplaceFunction, capture less or increase N");
+	static_assert(alignof(Callable) <= alignof(std::max_align_t), "Callable is over aligned");
+
+	new (mStorage) Callable(std::forward<F>(inFunction));
+	mInvoke = &sInvoke<Callable>;
+	mManage = &sManage<Callable>;
+}
+
+
+
+/**
+@brief Destroy the stored callable
+**/
+template<class R, class... Args, size_t N>
+void InplaceFunction<R(Args...), N>::Reset()
+{
+	if (mManage != nullptr)
+		mManage(EOperation::Destroy, mStorage, nullptr);
+	mInvoke = nullptr;
+	mManage = nullptr;
+}
+
+
+
+/**
+@brief Take the callable of @a ioOther
+**/
+template<class R, class... Args, size_t N>
+void InplaceFunction<R(Args...), N>::MoveFrom(InplaceFunction& ioOther)
+{
+	if (ioOther.mManage == nullptr)
+		return;
+
+	ioOther.mManage(EOperation::Move, ioOther.mStorage, mStorage);
+	mInvoke = ioOther.mInvoke;
+	mManage = ioOther.mManage;
+	ioOther.mInvoke = nullptr;
+	ioOther.mManage = nullptr;
+}
+
+
+
+/**
+@brief Move or destroy a callable of type F
+**/
+template<class R, class... Args, size_t N>
+template<class F>
+void InplaceFunction<R(Args...), N>::sManage(EOperation inOperation, void* ioStorage, void* ioDestination)
+{
+	F* callable = (F*)ioStorage;
+	switch (inOperation)
+	{
+		case EOperation::Move:
+			new (ioDestination) F(std::move(*callable));
+			callable->~F();
+			break;
+
+		case EOperation::Destroy:
+			callable->~F();
+			break;
+	}
+}
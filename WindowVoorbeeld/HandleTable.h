@@ -0,0 +1,199 @@
+#pragma once
+
+// Additional includes
+#include "Utility.h"
+
+
+
+/**
+@brief Generational handle to an object in a HandleTable
+
+The low 16 bits are the slot index, the high 16 bits the generation of the slot.
+A slot's generation changes when its object is removed, so old handles to it stop resolving.
+The value 0 is never handed out and means "no handle".
+**/
+template<class T>
+class Handle
+{
+public:
+	///@name Construction
+	constexpr				Handle() = default;
+	constexpr explicit		Handle(uint32_t inValue) :							mValue(inValue) { }
+	constexpr				Handle(uint16_t inIndex, uint16_t inGeneration) :	mValue(((uint32_t)inGeneration << 16) | inIndex) { }
+
+	///@name Properties
+	constexpr uint32_t		GetValue() const			{ return mValue; }				///< Raw value, e.g. to store in platform user data
+	constexpr uint16_t		GetIndex() const			{ return (uint16_t)mValue; }	///< Slot index
+	constexpr uint16_t		GetGeneration() const		{ return (uint16_t)(mValue >> 16); } ///< Slot generation
+	constexpr bool			IsSet() const				{ return mValue != 0; }			///< Check if this is not the "no handle" value
+
+	///@name Operators
+	constexpr bool			operator==(Handle inOther) const { return mValue == inOther.mValue; }
+	constexpr bool			operator!=(Handle inOther) const { return mValue != inOther.mValue; }
+
+private:
+	///@name Properties
+	uint32_t				mValue = 0;					///< Generation and index packed together
+};
+
+
+
+/**
+@brief Dense table of object pointers addressed by generational handles
+
+Lookups are a bounds check, an index and a generation compare. Removed slots are recycled
+through a free list, with their generation bumped so stale handles resolve to nullptr.
+The table does not own its objects.
+**/
+template<class T>
+class HandleTable
+{
+public:
+	///@name Modification
+	Handle<T>				Add(T* inObject);			///< Add @a inObject and return its handle
+	void					Remove(Handle<T> inHandle);	///< Remove the object of @a inHandle, the handle becomes stale
+	void					Clear();					///< Remove all objects, every handle becomes stale
+	void					Reserve(size_t inCount);	///< Make room for @a inCount objects so adding them does not reallocate
+
+	///@name Lookup
+	T*						Get(Handle<T> inHandle) const;	///< Get the object of @a inHandle, nullptr if the handle is stale or unset
+	bool					IsValid(Handle<T> inHandle) const	{ return Get(inHandle) != nullptr; } ///< Check if @a inHandle resolves to an object
+	bool					IsStale(Handle<T> inHandle) const	{ return inHandle.IsSet() && !IsValid(inHandle); } ///< Check if @a inHandle was valid once but its object is gone
+
+	///@name Iteration
+	template<class F>
+	void					ForEach(F&& inFunction) const;	///< Call @a inFunction(T*) for every object in slot order
+	size_t					GetSize() const				{ return mSize; }	///< Amount of objects in the table
+
+private:
+	static constexpr uint16_t cNoFreeSlot = 0xFFFF;		///< End of the free list, also the maximum amount of slots
+
+	/**
+	@brief One slot in the table
+	**/
+	struct Slot
+	{
+		T*					mObject		= nullptr;		///< Object in this slot, nullptr when free
+		uint16_t			mGeneration = 1;			///< Current generation, never 0 so handles are never 0
+		uint16_t			mNextFree	= cNoFreeSlot;	///< Next free slot when this slot is free
+	};
+
+	///@name Properties
+	Array<Slot>				mSlots;						///< All slots
+	uint16_t				mFreeHead	= cNoFreeSlot;	///< First free slot
+	size_t					mSize		= 0;			///< Amount of objects in the table
+};
+
+
+
+/**
+@brief Add @a inObject and return its handle
+**/
+template<class T>
+Handle<T> HandleTable<T>::Add(T* inObject)
+{
+	gAssert(inObject != nullptr);
+
+	uint16_t index;
+	if (mFreeHead != cNoFreeSlot)
+	{
+		// Recycle a free slot
+		index = mFreeHead;
+		mFreeHead = mSlots[index].mNextFree;
+	}
+	else
+	{
+		// Grow the table
+		gAssert(mSlots.size() < cNoFreeSlot);
+		index = (uint16_t)mSlots.size();
+		mSlots.emplace_back();
+	}
+
+	Slot& slot = mSlots[index];
+	slot.mObject = inObject;
+	++mSize;
+	return Handle<T>(index, slot.mGeneration);
+}
+
+
+
+/**
+@brief Remove the object of @a inHandle
+**/
+template<class T>
+void HandleTable<T>::Remove(Handle<T> inHandle)
+{
+	if (!IsValid(inHandle))
+	{
+		gAssert(!"Removing a stale handle");
+		return;
+	}
+
+	// Bump the generation (skipping 0) so every outstanding handle to this slot becomes stale
+	Slot& slot = mSlots[inHandle.GetIndex()];
+	slot.mObject = nullptr;
+	if (++slot.mGeneration == 0)
+		slot.mGeneration = 1;
+
+	// Put the slot on the free list
+	slot.mNextFree = mFreeHead;
+	mFreeHead = inHandle.GetIndex();
+	--mSize;
+}
+
+
+
+/**
+@brief Remove all objects
+**/
+template<class T>
+void HandleTable<T>::Clear()
+{
+	for (size_t i = 0; i < mSlots.size(); ++i)
+		if (mSlots[i].mObject != nullptr)
+			Remove(Handle<T>((uint16_t)i, mSlots[i].mGeneration));
+}
+
+
+
+/**
+@brief Make room for @a inCount objects
+**/
+template<class T>
+void HandleTable<T>::Reserve(size_t inCount)
+{
+	gAssert(inCount <= cNoFreeSlot);
+
+	// Free slots are reused before growing, so the slot count only grows past inCount if it already is larger
+	mSlots.reserve(inCount);
+}
+
+
+
+/**
+@brief Get the object of @a inHandle
+**/
+template<class T>
+inline T* HandleTable<T>::Get(Handle<T> inHandle) const
+{
+	uint16_t index = inHandle.GetIndex();
+	if (index >= mSlots.size())
+		return nullptr;
+
+	const Slot& slot = mSlots[index];
+	return slot.mGeneration == inHandle.GetGeneration() ? slot.mObject : nullptr;
+}
+
+
+
+/**
+@brief Call @a inFunction(T*) for every object in slot order
+**/
+template<class T>
+template<class F>
+void HandleTable<T>::ForEach(F&& inFunction) const
+{
+	for (const Slot& slot : mSlots)
+		if (slot.mObject != nullptr)
+			inFunction(slot.mObject);
+}
@@ -0,0 +1,553 @@
+#pragma once
+
+// Additional includes
+#include "Allocator.h"
+#include "Assert.h"
+#include "String.h"
+
+// STL includes
+#include <cstring>
+#include <functional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#ifdef _MSC_VER
+	#include <intrin.h>
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define HASHMAP_SSE2
+	#include <emmintrin.h>
+#endif
+
+
+
+/**
+@brief Key/value pair
+**/
+template<class First, class Second>
+using Pair = std::pair<First, Second>;
+
+
+
+/**
+@brief Finish a 64 bit hash so every bit depends on every input bit (the MurmurHash3 finalizer)
+**/
+constexpr uint64_t gMixHash(uint64_t inHash)
+{
+	inHash ^= inHash >> 33;
+	inHash *= 0xFF51AFD7ED558CCDULL;
+	inHash ^= inHash >> 33;
+	inHash *= 0xC4CEB9FE1A85EC53ULL;
+	inHash ^= inHash >> 33;
+	return inHash;
+}
+
+
+
+/**
+@brief Hash of a byte range (FNV-1a, mixed)
+**/
+inline uint64_t gHashBytes(const void* inData, size_t inSize)
+{
+	const uint8_t* data = (const uint8_t*)inData;
+	uint64_t hash = 0xCBF29CE484222325ULL;
+	for (size_t i = 0; i < inSize; ++i)
+		hash = (hash ^ data[i]) * 0x100000001B3ULL;
+	return gMixHash(hash);
+}
+
+
+
+/**
+@brief Hash function object used by HashMap, integers, enums and pointers are mixed directly, other types go through std::hash
+**/
+template<class T, class = void>
+struct Hash
+{
+	uint64_t				operator()(const T& inValue) const	{ return gMixHash((uint64_t)std::hash<T>()(inValue)); }
+};
+
+template<class T>
+struct Hash<T, typename std::enable_if<std::is_integral<T>::value || std::is_enum<T>::value>::type>
+{
+	uint64_t				operator()(T inValue) const			{ return gMixHash((uint64_t)inValue); }
+};
+
+template<class T>
+struct Hash<T*>
+{
+	uint64_t				operator()(const T* inValue) const	{ return gMixHash((uint64_t)(uintptr_t)inValue); }
+};
+
+template<class Char, class Alloc>
+struct Hash<BasicString<Char, Alloc>>
+{
+	uint64_t				operator()(const BasicString<Char, Alloc>& inValue) const	{ return gHashBytes(inValue.data(), inValue.size() * sizeof(Char)); }
+};
+
+
+
+/**
+@brief Open addressing hash map with SIMD group probing
+
+Slots are split in groups of cGroupSize. Every slot has a control byte: empty, deleted, or the low 7 bits of
+the hash of its key. A lookup picks a group from the other hash bits and compares the 7 bit tag against all 16
+control bytes of the group at once (one SSE2 compare), so usually only the matching slot's key is ever compared.
+Probing moves on to the next group (triangular sequence) only when a group is full.
+
+Elements are stored inline in one array (no node per element). Inserting can move elements, so unlike
+std::unordered_map pointers and iterators are invalidated by inserting. The interface follows
+std::unordered_map for the parts the project uses, keys must not be changed through iterators.
+**/
+template<class K, class V, class H = Hash<K>, class Alloc = DefaultAllocator>
+class HashMap : private Alloc
+{
+public:
+	using key_type			= K;
+	using mapped_type		= V;
+	using value_type		= Pair<K, V>;
+	using size_type			= size_t;
+
+	static constexpr size_t	cGroupSize = 16;						///< Control bytes compared at once
+
+	/**
+	@brief Iterator over the occupied slots
+	**/
+	template<class M, class P>
+	class Iterator
+	{
+	public:
+							Iterator(M* inMap, size_t inIndex) :	mMap(inMap), mIndex(inIndex) { SkipFree(); }
+		P&					operator*() const					{ return mMap->mSlots[mIndex]; }
+		P*					operator->() const					{ return &mMap->mSlots[mIndex]; }
+		Iterator&			operator++()						{ ++mIndex; SkipFree(); return *this; }
+		bool				operator==(const Iterator& inOther) const	{ return mIndex == inOther.mIndex; }
+		bool				operator!=(const Iterator& inOther) const	{ return mIndex != inOther.mIndex; }
+
+	private:
+		friend class		HashMap;
+		void				SkipFree()							{ while (mIndex < mMap->mCapacity && !sIsFull(mMap->mControl[mIndex])) ++mIndex; }
+
+		M*					mMap;
+		size_t				mIndex;
+	};
+	using iterator			= Iterator<HashMap, value_type>;
+	using const_iterator	= Iterator<const HashMap, const value_type>;
+
+	///@name Construction
+							HashMap() :							HashMap(Alloc()) { }
+	explicit				HashMap(const Alloc& inAllocator) :	Alloc(inAllocator) { }
+							HashMap(const HashMap& inOther);
+							HashMap(HashMap&& inOther) noexcept :	Alloc(inOther.GetAllocator()) { MoveFrom(inOther); }
+							~HashMap()							{ clear(); FreeData(); }
+
+	///@name Assignment
+	HashMap&				operator=(const HashMap& inOther);
+	HashMap&				operator=(HashMap&& inOther) noexcept;
+
+	///@name Properties
+	size_t					size() const						{ return mSize; }
+	bool					empty() const						{ return mSize == 0; }
+	size_t					bucket_count() const				{ return mCapacity; }
+	const Alloc&			GetAllocator() const				{ return *this; }
+
+	///@name Lookup
+	iterator				find(const K& inKey)				{ return iterator(this, FindIndex(inKey)); }
+	const_iterator			find(const K& inKey) const			{ return const_iterator(this, FindIndex(inKey)); }
+	size_t					count(const K& inKey) const			{ return FindIndex(inKey) != mCapacity ? 1 : 0; }
+	bool					contains(const K& inKey) const		{ return FindIndex(inKey) != mCapacity; }
+	V&						operator[](const K& inKey)			{ return emplace(inKey).first->second; }
+
+	///@name Iteration
+	iterator				begin()								{ return iterator(this, 0); }
+	iterator				end()								{ return iterator(this, mCapacity); }
+	const_iterator			begin() const						{ return const_iterator(this, 0); }
+	const_iterator			end() const							{ return const_iterator(this, mCapacity); }
+
+	///@name Modification
+	template<class... A>
+	Pair<iterator, bool>	emplace(const K& inKey, A&&... inArgs);	///< Insert @a inKey with a value constructed from @a inArgs unless it is there already
+	Pair<iterator, bool>	insert(const value_type& inValue)	{ return emplace(inValue.first, inValue.second); }
+	size_t					erase(const K& inKey);				///< Remove @a inKey, returns the amount of removed elements
+	void					erase(iterator inWhere)				{ EraseAt(inWhere.mIndex); }	///< Remove the element at @a inWhere
+	void					clear();							///< Remove every element, keeps the memory
+	void					reserve(size_t inCount);			///< Make room for @a inCount elements without growing
+
+private:
+	///@name Control bytes
+	static constexpr uint8_t cEmpty		= 0x80;					///< Never used slot, ends a probe
+	static constexpr uint8_t cDeleted	= 0xFE;					///< Erased slot, probing continues past it
+	static bool				sIsFull(uint8_t inControl)			{ return (inControl & 0x80) == 0; }
+	static uint32_t			sMatch(const uint8_t* inGroup, uint8_t inValue);	///< Bit i set when control byte i of the group is @a inValue
+	static uint32_t			sMatchFree(const uint8_t* inGroup);	///< Bit i set when control byte i of the group is empty or deleted
+	static uint32_t			sLowestBit(uint32_t inMask);		///< Index of the lowest set bit, @a inMask must not be 0
+
+	///@name Helpers
+	size_t					FindIndex(const K& inKey) const;	///< Slot of @a inKey, mCapacity if it is not there
+	size_t					FindFreeIndex(uint64_t inHash) const;	///< First empty or deleted slot on the probe sequence of @a inHash
+	void					EraseAt(size_t inIndex);
+	void					Rehash(size_t inCapacity);			///< Move every element to a table with @a inCapacity slots
+	void					FreeData();
+	void					MoveFrom(HashMap& ioOther);
+	static size_t			sGetMaxLoad(size_t inCapacity)		{ return inCapacity - inCapacity / 8; }	///< Elements allowed at @a inCapacity, 7/8
+
+	///@name Properties
+	uint8_t*				mControl	= nullptr;				///< One control byte per slot
+	value_type*				mSlots		= nullptr;				///< Elements, constructed when their control byte is full
+	size_t					mCapacity	= 0;					///< Slots, a power of 2 and a multiple of cGroupSize
+	size_t					mSize		= 0;					///< Occupied slots
+	size_t					mGrowthLeft	= 0;					///< Empty slots that can still be filled before growing, deleted slots do not count
+};
+
+
+
+/**
+@brief Bit i set when control byte i of the group is @a inValue
+**/
+template<class K, class V, class H, class Alloc>
+inline uint32_t HashMap<K, V, H, Alloc>::sMatch(const uint8_t* inGroup, uint8_t inValue)
+{
+#ifdef HASHMAP_SSE2
+	__m128i group = _mm_loadu_si128((const __m128i*)inGroup);
+	return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8((char)inValue)));
+#else
+	uint32_t mask = 0;
+	for (size_t i = 0; i < cGroupSize; ++i)
+		mask |= uint32_t(inGroup[i] == inValue) << i;
+	return mask;
+#endif
+}
+
+
+
+/**
+@brief Bit i set when control byte i of the group is empty or deleted, both have the high bit set
+**/
+template<class K, class V, class H, class Alloc>
+inline uint32_t HashMap<K, V, H, Alloc>::sMatchFree(const uint8_t* inGroup)
+{
+#ifdef HASHMAP_SSE2
+	return (uint32_t)_mm_movemask_epi8(_mm_loadu_si128((const __m128i*)inGroup));
+#else
+	uint32_t mask = 0;
+	for (size_t i = 0; i < cGroupSize; ++i)
+		mask |= uint32_t(inGroup[i] >> 7) << i;
+	return mask;
+#endif
+}
+
+
+
+/**
+@brief Index of the lowest set bit
+**/
+template<class K, class V, class H, class Alloc>
+inline uint32_t HashMap<K, V, H, Alloc>::sLowestBit(uint32_t inMask)
+{
+	gAssert(inMask != 0);
+#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanForward(&index, inMask);
+	return (uint32_t)index;
+#elif defined(__GNUC__)
+	return (uint32_t)__builtin_ctz(inMask);
+#else
+	uint32_t index = 0;
+	while ((inMask & 1) == 0)
+	{
+		inMask >>= 1;
+		++index;
+	}
+	return index;
+#endif
+}
+
+
+
+/**
+@brief Copy construction
+**/
+template<class K, class V, class H, class Alloc>
+HashMap<K, V, H, Alloc>::HashMap(const HashMap& inOther) :
+	Alloc(inOther.GetAllocator())
+{
+	reserve(inOther.mSize);
+	for (const value_type& value : inOther)
+		emplace(value.first, value.second);
+}
+
+
+
+/**
+@brief Copy assignment
+**/
+template<class K, class V, class H, class Alloc>
+HashMap<K, V, H, Alloc>& HashMap<K, V, H, Alloc>::operator=(const HashMap& inOther)
+{
+	if (this != &inOther)
+	{
+		clear();
+		reserve(inOther.mSize);
+		for (const value_type& value : inOther)
+			emplace(value.first, value.second);
+	}
+	return *this;
+}
+
+
+
+/**
+@brief Move assignment, the allocator moves along with the memory it allocated
+**/
+template<class K, class V, class H, class Alloc>
+HashMap<K, V, H, Alloc>& HashMap<K, V, H, Alloc>::operator=(HashMap&& inOther) noexcept
+{
+	if (this != &inOther)
+	{
+		clear();
+		FreeData();
+		static_cast<Alloc&>(*this) = inOther.GetAllocator();
+		MoveFrom(inOther);
+	}
+	return *this;
+}
+
+
+
+/**
+@brief Take the table of @a ioOther
+**/
+template<class K, class V, class H, class Alloc>
+void HashMap<K, V, H, Alloc>::MoveFrom(HashMap& ioOther)
+{
+	mControl	= ioOther.mControl;
+	mSlots		= ioOther.mSlots;
+	mCapacity	= ioOther.mCapacity;
+	mSize		= ioOther.mSize;
+	mGrowthLeft	= ioOther.mGrowthLeft;
+	ioOther.mControl	= nullptr;
+	ioOther.mSlots		= nullptr;
+	ioOther.mCapacity	= 0;
+	ioOther.mSize		= 0;
+	ioOther.mGrowthLeft	= 0;
+}
+
+
+
+/**
+@brief Free the table, the elements must be destructed already
+**/
+template<class K, class V, class H, class Alloc>
+void HashMap<K, V, H, Alloc>::FreeData()
+{
+	if (mControl == nullptr)
+		return;
+
+	this->Free(mControl, mCapacity, 16);
+	this->Free(mSlots, mCapacity * sizeof(value_type), alignof(value_type));
+	mControl = nullptr;
+	mSlots = nullptr;
+	mCapacity = 0;
+	mGrowthLeft = 0;
+}
+
+
+
+/**
+@brief Slot of @a inKey
+**/
+template<class K, class V, class H, class Alloc>
+size_t HashMap<K, V, H, Alloc>::FindIndex(const K& inKey) const
+{
+	if (mSize == 0)
+		return mCapacity;
+
+	uint64_t hash = H()(inKey);
+	uint8_t tag = (uint8_t)(hash & 0x7F);
+	size_t group_mask = mCapacity / cGroupSize - 1;
+	size_t group = (size_t)(hash >> 7) & group_mask;
+
+	for (size_t step = 1; ; ++step)
+	{
+		const uint8_t* control = mControl + group * cGroupSize;
+		for (uint32_t match = sMatch(control, tag); match != 0; match &= match - 1)
+		{
+			size_t index = group * cGroupSize + sLowestBit(match);
+			if (mSlots[index].first == inKey)
+				return index;
+		}
+
+		// An empty slot means the key was never pushed further along the probe sequence
+		if (sMatch(control, cEmpty) != 0 || step > group_mask)
+			return mCapacity;
+
+		group = (group + step) & group_mask;
+	}
+}
+
+
+
+/**
+@brief First empty or deleted slot on the probe sequence of @a inHash, the table must have one
+**/
+template<class K, class V, class H, class Alloc>
+size_t HashMap<K, V, H, Alloc>::FindFreeIndex(uint64_t inHash) const
+{
+	size_t group_mask = mCapacity / cGroupSize - 1;
+	size_t group = (size_t)(inHash >> 7) & group_mask;
+
+	for (size_t step = 1; ; ++step)
+	{
+		uint32_t free = sMatchFree(mControl + group * cGroupSize);
+		if (free != 0)
+			return group * cGroupSize + sLowestBit(free);
+
+		group = (group + step) & group_mask;
+	}
+}
+
+
+
+/**
+@brief Insert @a inKey unless it is there already
+**/
+template<class K, class V, class H, class Alloc>
+template<class... A>
+Pair<typename HashMap<K, V, H, Alloc>::iterator, bool> HashMap<K, V, H, Alloc>::emplace(const K& inKey, A&&... inArgs)
+{
+	size_t index = FindIndex(inKey);
+	if (index != mCapacity)
+		return { iterator(this, index), false };
+
+	uint64_t hash = H()(inKey);
+	if (mCapacity == 0)
+		Rehash(cGroupSize);
+	index = FindFreeIndex(hash);
+
+	// Reusing a deleted slot is free, taking an empty one uses up growth
+	if (mControl[index] == cEmpty && mGrowthLeft == 0)
+	{
+		// Mostly deleted slots: clean up at the same size, otherwise double
+		Rehash(mSize + 1 > sGetMaxLoad(mCapacity) / 2 ? mCapacity * 2 : mCapacity);
+		index = FindFreeIndex(hash);
+	}
+	if (mControl[index] == cEmpty)
+		--mGrowthLeft;
+
+	new (&mSlots[index]) value_type(std::piecewise_construct, std::forward_as_tuple(inKey), std::forward_as_tuple(std::forward<A>(inArgs)...));
+	mControl[index] = (uint8_t)(hash & 0x7F);
+	++mSize;
+	return { iterator(this, index), true };
+}
+
+
+
+/**
+@brief Remove @a inKey
+**/
+template<class K, class V, class H, class Alloc>
+size_t HashMap<K, V, H, Alloc>::erase(const K& inKey)
+{
+	size_t index = FindIndex(inKey);
+	if (index == mCapacity)
+		return 0;
+
+	EraseAt(index);
+	return 1;
+}
+
+
+
+/**
+@brief Remove the element in slot @a inIndex
+**/
+template<class K, class V, class H, class Alloc>
+void HashMap<K, V, H, Alloc>::EraseAt(size_t inIndex)
+{
+	gAssert(inIndex < mCapacity && sIsFull(mControl[inIndex]));
+	mSlots[inIndex].~value_type();
+	--mSize;
+
+	// A group with an empty slot never made a probe move on, so the slot can become empty instead of deleted
+	size_t group = inIndex & ~(cGroupSize - 1);
+	if (sMatch(mControl + group, cEmpty) != 0)
+	{
+		mControl[inIndex] = cEmpty;
+		++mGrowthLeft;
+	}
+	else
+		mControl[inIndex] = cDeleted;
+}
+
+
+
+/**
+@brief Remove every element
+**/
+template<class K, class V, class H, class Alloc>
+void HashMap<K, V, H, Alloc>::clear()
+{
+	if (mCapacity == 0)
+		return;
+
+	if (!std::is_trivially_destructible<value_type>::value)
+		for (size_t i = 0; i < mCapacity; ++i)
+			if (sIsFull(mControl[i]))
+				mSlots[i].~value_type();
+
+	memset(mControl, cEmpty, mCapacity);
+	mSize = 0;
+	mGrowthLeft = sGetMaxLoad(mCapacity);
+}
+
+
+
+/**
+@brief Make room for @a inCount elements
+**/
+template<class K, class V, class H, class Alloc>
+void HashMap<K, V, H, Alloc>::reserve(size_t inCount)
+{
+	size_t capacity = cGroupSize;
+	while (sGetMaxLoad(capacity) < inCount)
+		capacity *= 2;
+	if (capacity > mCapacity)
+		Rehash(capacity);
+}
+
+
+
+/**
+@brief Move every element to a table with @a inCapacity slots
+**/
+template<class K, class V, class H, class Alloc>
+void HashMap<K, V, H, Alloc>::Rehash(size_t inCapacity)
+{
+	uint8_t* old_control = mControl;
+	value_type* old_slots = mSlots;
+	size_t old_capacity = mCapacity;
+
+	mControl = (uint8_t*)this->Allocate(inCapacity, 16);
+	mSlots = (value_type*)this->Allocate(inCapacity * sizeof(value_type), alignof(value_type));
+	mCapacity = inCapacity;
+	memset(mControl, cEmpty, inCapacity);
+
+	for (size_t i = 0; i < old_capacity; ++i)
+		if (sIsFull(old_control[i]))
+		{
+			uint64_t hash = H()(old_slots[i].first);
+			size_t index = FindFreeIndex(hash);
+			new (&mSlots[index]) value_type(std::move(old_slots[i]));
+			old_slots[i].~value_type();
+			mControl[index] = (uint8_t)(hash & 0x7F);
+		}
+	mGrowthLeft = sGetMaxLoad(inCapacity) - mSize;
+
+	if (old_control != nullptr)
+	{
+		this->Free(old_control, old_capacity, 16);
+		this->Free(old_slots, old_capacity * sizeof(value_type), alignof(value_type));
+	}
+}
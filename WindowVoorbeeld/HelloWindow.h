@@ -0,0 +1,44 @@
+#pragma once
+
+// Additional includes
+#include "Framebuffer.h"
+#include "Input.h"
+#include "Window.h"
+
+
+
+/**
+@brief Hello World window, a small tool panel drawn on the CPU. Its frames are compared with a golden image by the tests
+**/
+class HelloWindow : public Window 
+{
+	virtual void OnCreate() override
+	{
+		gLog("Hello, World!\n");
+
+		// Draw this window on the CPU
+		EnableFramebuffer();
+	}
+
+	virtual void OnPaint() override
+	{
+		// A simple tool panel: background, header, translucent overlay and a frame
+		Framebuffer& framebuffer = *GetFramebuffer();
+		framebuffer.Clear(gMakeColor(37, 37, 38));
+		framebuffer.FillRect({0, 0, framebuffer.GetWidth(), 24}, gMakeColor(0, 122, 204));
+		framebuffer.BlendRect({20, 40, 200, 120}, gMakeColor(255, 255, 255, 40));
+		framebuffer.DrawRect({20, 40, 200, 120}, gMakeColor(0, 122, 204));
+		framebuffer.DrawLine(20, 160, 220, 40, gMakeColor(255, 200, 0, 160));
+	}
+
+	virtual bool OnMouseDown() override 
+	{
+		// Only respond on CTRL + Click
+		if (Input::sIsDown(KEY_CTRL | MOUSE_R))
+			gLog("Party Time!\n");
+		else
+			gLog("Lame party");
+
+		return true;
+	}
+};
@@ -0,0 +1,139 @@
+#include "Histogram.h"
+
+// STL includes
+#include <climits>
+
+#ifdef _MSC_VER
+	#include <intrin.h>
+#endif
+
+
+
+/**
+@brief Index of the highest set bit of @a inValue, which must not be 0
+**/
+static inline int sHighestBit(uint64_t inValue)
+{
+#if defined(_MSC_VER) && defined(_M_X64)
+	unsigned long index;
+	_BitScanReverse64(&index, inValue);
+	return (int)index;
+#elif defined(_MSC_VER)
+	unsigned long index;
+	if (_BitScanReverse(&index, (unsigned long)(inValue >> 32)))
+		return (int)index + 32;
+	_BitScanReverse(&index, (unsigned long)inValue);
+	return (int)index;
+#else
+	return 63 - __builtin_clzll(inValue);
+#endif
+}
+
+
+
+/**
+@brief Bucket @a inValue is counted in
+**/
+int Histogram::sGetBucket(uint64_t inValue)
+{
+	if (inValue < (uint64_t)cSubBuckets)
+		return (int)inValue;
+
+	// The highest bit selects the power of two, the bits below it the sub bucket
+	int exponent = sHighestBit(inValue);
+	int sub_bucket = (int)(inValue >> (exponent - cSubBucketBits)) & (cSubBuckets - 1);
+	return (exponent - cSubBucketBits + 1) * cSubBuckets + sub_bucket;
+}
+
+
+
+/**
+@brief Highest value counted in @a inBucket
+**/
+uint64_t Histogram::sGetBucketLimit(int inBucket)
+{
+	if (inBucket < cSubBuckets)
+		return (uint64_t)inBucket;
+
+	int exponent = inBucket / cSubBuckets + cSubBucketBits - 1;
+	uint64_t sub_bucket = (uint64_t)(inBucket % cSubBuckets);
+	uint64_t first = (1ULL << exponent) | (sub_bucket << (exponent - cSubBucketBits));
+	return first + (1ULL << (exponent - cSubBucketBits)) - 1;
+}
+
+
+
+/**
+@brief Count @a inValue
+**/
+void Histogram::Record(uint64_t inValue)
+{
+	++mCounts[sGetBucket(inValue)];
+	++mCount;
+	mTotal += inValue;
+	if (inValue < mMin)
+		mMin = inValue;
+	if (inValue > mMax)
+		mMax = inValue;
+}
+
+
+
+/**
+@brief Add the counts of @a inOther
+**/
+void Histogram::Merge(const Histogram& inOther)
+{
+	for (int i = 0; i < cBucketCount; ++i)
+		mCounts[i] += inOther.mCounts[i];
+	mCount += inOther.mCount;
+	mTotal += inOther.mTotal;
+	if (inOther.mMin < mMin)
+		mMin = inOther.mMin;
+	if (inOther.mMax > mMax)
+		mMax = inOther.mMax;
+}
+
+
+
+/**
+@brief Forget every value
+**/
+void Histogram::Reset()
+{
+	memset(mCounts, 0, sizeof(mCounts));
+	mCount = 0;
+	mTotal = 0;
+	mMin = UINT64_MAX;
+	mMax = 0;
+}
+
+
+
+/**
+@brief Value below which @a inPercentile percent of the values are
+**/
+uint64_t Histogram::GetPercentile(double inPercentile) const
+{
+	if (mCount == 0)
+		return 0;
+
+	// Rank of the value we look for, at least the first value
+	double rank = inPercentile / 100.0 * mCount;
+	uint64_t target = rank < 1.0 ? 1 : (uint64_t)(rank + 0.5);
+	if (target > mCount)
+		target = mCount;
+
+	uint64_t seen = 0;
+	for (int i = 0; i < cBucketCount; ++i)
+	{
+		seen += mCounts[i];
+		if (seen >= target)
+		{
+			// The bucket limit can overshoot the values that were actually recorded
+			uint64_t limit = sGetBucketLimit(i);
+			return limit < mMax ? limit : mMax;
+		}
+	}
+	return mMax;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+// Additional includes
+#include "Utility.h"
+
+
+
+/**
+@brief Histogram of durations (or any other non-negative integers) with a fixed relative precision
+
+Values below cSubBuckets are counted exactly. Larger values are counted in buckets that split every power
+of two in cSubBuckets equal parts, so a value is known within 1/cSubBuckets (about 6%) of itself, from
+nanoseconds up to years, in a fixed amount of memory (the idea of HdrHistogram). Recording is a bit scan and
+an increment. Not thread safe.
+**/
+class Histogram
+{
+public:
+	static constexpr int	cSubBucketBits = 4;
+	static constexpr int	cSubBuckets = 1 << cSubBucketBits;
+	static constexpr int	cBucketCount = (64 - cSubBucketBits + 1) * cSubBuckets;
+
+	///@name Construction
+							Histogram()							{ Reset(); }
+
+	///@name Recording
+	void					Record(uint64_t inValue);			///< Count @a inValue
+	void					Merge(const Histogram& inOther);	///< Add the counts of @a inOther
+	void					Reset();							///< Forget every value
+
+	///@name Statistics
+	uint64_t				GetCount() const					{ return mCount; }
+	uint64_t				GetMin() const						{ return mCount > 0 ? mMin : 0; }
+	uint64_t				GetMax() const						{ return mMax; }
+	uint64_t				GetTotal() const					{ return mTotal; }	///< Sum of every value
+	double					GetMean() const						{ return mCount > 0 ? (double)mTotal / mCount : 0.0; }
+	uint64_t				GetPercentile(double inPercentile) const;	///< Value below which @a inPercentile percent of the values are, within the precision of the buckets
+
+	///@name Buckets
+	static int				sGetBucket(uint64_t inValue);		///< Bucket @a inValue is counted in
+	static uint64_t			sGetBucketLimit(int inBucket);		///< Highest value counted in @a inBucket
+
+private:
+	///@name Properties
+	uint32_t				mCounts[cBucketCount];
+	uint64_t				mCount;
+	uint64_t				mTotal;
+	uint64_t				mMin;
+	uint64_t				mMax;
+};
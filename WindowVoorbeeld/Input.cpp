@@ -1,14 +1,24 @@
 #include "Input.h"
 
+// STL includes
+#include <atomic>
+
 // Additional includes
 #include "Utility.h"
+#include "RingBuffer.h"
 
 
 
 /**
-@brief Lookup table for Win32 KeyCodes to Keys
+@brief Win32 virtual key codes and the Key they translate to, every Key appears exactly once
 **/
-static HashMap<KeyCode, Key> gKeyCodeToKeyLUT = 
+struct KeyCodeMapping
+{
+    KeyCode mKeyCode;
+    Key     mKey;
+};
+
+static constexpr KeyCodeMapping gKeyCodeMappings[] =
 {
     // Mouse Events
     { 0x01, MOUSE_L }, 
@@ -75,21 +85,198 @@ static HashMap<KeyCode, Key> gKeyCodeToKeyLUT =
     { 0x78, KEY_F9 },	
     { 0x79, KEY_F10 },	
     { 0x7A, KEY_F11 },	
-    { 0x7B, KEY_F12 }
+    { 0x7B, KEY_F12 },
+
+    // Extra Mouse Buttons
+    { 0x05, MOUSE_X1 },
+    { 0x06, MOUSE_X2 },
+
+    // Navigation
+    { 0x25, KEY_LEFT },
+    { 0x26, KEY_UP },
+    { 0x27, KEY_RIGHT },
+    { 0x28, KEY_DOWN },
+    { 0x21, KEY_PAGE_UP },
+    { 0x22, KEY_PAGE_DOWN },
+    { 0x23, KEY_END },
+    { 0x24, KEY_HOME },
+    { 0x2D, KEY_INSERT },
+
+    // Left/Right Modifiers
+    { 0xA0, KEY_LSHIFT },
+    { 0xA1, KEY_RSHIFT },
+    { 0xA2, KEY_LCTRL },
+    { 0xA3, KEY_RCTRL },
+    { 0xA4, KEY_LALT },
+    { 0xA5, KEY_RALT },
+    { 0x5B, KEY_LWIN },
+    { 0x5C, KEY_RWIN },
+    { 0x5D, KEY_APPS },
+
+    // Locks and System
+    { 0x14, KEY_CAPS_LOCK },
+    { 0x90, KEY_NUM_LOCK },
+    { 0x91, KEY_SCROLL_LOCK },
+    { 0x13, KEY_PAUSE },
+    { 0x2C, KEY_PRINT_SCREEN },
+    { 0x03, KEY_CANCEL },
+    { 0x0C, KEY_CLEAR },
+    { 0x29, KEY_SELECT },
+    { 0x2A, KEY_PRINT },
+    { 0x2B, KEY_EXECUTE },
+    { 0x2F, KEY_HELP },
+    { 0x5F, KEY_SLEEP },
+
+    // Numpad
+    { 0x60, KEY_NUMPAD_0 },
+    { 0x61, KEY_NUMPAD_1 },
+    { 0x62, KEY_NUMPAD_2 },
+    { 0x63, KEY_NUMPAD_3 },
+    { 0x64, KEY_NUMPAD_4 },
+    { 0x65, KEY_NUMPAD_5 },
+    { 0x66, KEY_NUMPAD_6 },
+    { 0x67, KEY_NUMPAD_7 },
+    { 0x68, KEY_NUMPAD_8 },
+    { 0x69, KEY_NUMPAD_9 },
+    { 0x6A, KEY_NUMPAD_MULTIPLY },
+    { 0x6B, KEY_NUMPAD_ADD },
+    { 0x6C, KEY_NUMPAD_SEPARATOR },
+    { 0x6D, KEY_NUMPAD_SUBTRACT },
+    { 0x6E, KEY_NUMPAD_DECIMAL },
+    { 0x6F, KEY_NUMPAD_DIVIDE },
+
+    // Extended Function Keys
+    { 0x7C, KEY_F13 },
+    { 0x7D, KEY_F14 },
+    { 0x7E, KEY_F15 },
+    { 0x7F, KEY_F16 },
+    { 0x80, KEY_F17 },
+    { 0x81, KEY_F18 },
+    { 0x82, KEY_F19 },
+    { 0x83, KEY_F20 },
+    { 0x84, KEY_F21 },
+    { 0x85, KEY_F22 },
+    { 0x86, KEY_F23 },
+    { 0x87, KEY_F24 },
+
+    // OEM Keys
+    { 0xBA, KEY_OEM_SEMICOLON },
+    { 0xBB, KEY_OEM_PLUS },
+    { 0xBC, KEY_OEM_COMMA },
+    { 0xBD, KEY_OEM_MINUS },
+    { 0xBE, KEY_OEM_PERIOD },
+    { 0xBF, KEY_OEM_SLASH },
+    { 0xC0, KEY_OEM_TILDE },
+    { 0xDB, KEY_OEM_LBRACKET },
+    { 0xDC, KEY_OEM_BACKSLASH },
+    { 0xDD, KEY_OEM_RBRACKET },
+    { 0xDE, KEY_OEM_QUOTE },
+    { 0xDF, KEY_OEM_8 },
+    { 0xE2, KEY_OEM_102 },
+    { 0xFE, KEY_OEM_CLEAR },
+
+    // Browser Keys
+    { 0xA6, KEY_BROWSER_BACK },
+    { 0xA7, KEY_BROWSER_FORWARD },
+    { 0xA8, KEY_BROWSER_REFRESH },
+    { 0xA9, KEY_BROWSER_STOP },
+    { 0xAA, KEY_BROWSER_SEARCH },
+    { 0xAB, KEY_BROWSER_FAVORITES },
+    { 0xAC, KEY_BROWSER_HOME },
+
+    // Media Keys
+    { 0xAD, KEY_VOLUME_MUTE },
+    { 0xAE, KEY_VOLUME_DOWN },
+    { 0xAF, KEY_VOLUME_UP },
+    { 0xB0, KEY_MEDIA_NEXT },
+    { 0xB1, KEY_MEDIA_PREVIOUS },
+    { 0xB2, KEY_MEDIA_STOP },
+    { 0xB3, KEY_MEDIA_PLAY_PAUSE },
+    { 0xB4, KEY_LAUNCH_MAIL },
+    { 0xB5, KEY_LAUNCH_MEDIA },
+    { 0xB6, KEY_LAUNCH_APP1 },
+    { 0xB7, KEY_LAUNCH_APP2 },
+    { 0xFA, KEY_PLAY },
+    { 0xFB, KEY_ZOOM },
+
+    // IME Keys
+    { 0x15, KEY_IME_KANA },
+    { 0x16, KEY_IME_ON },
+    { 0x17, KEY_IME_JUNJA },
+    { 0x18, KEY_IME_FINAL },
+    { 0x19, KEY_IME_KANJI },
+    { 0x1A, KEY_IME_OFF },
+    { 0x1C, KEY_IME_CONVERT },
+    { 0x1D, KEY_IME_NONCONVERT },
+    { 0x1E, KEY_IME_ACCEPT },
+    { 0x1F, KEY_IME_MODECHANGE },
+    { 0xE5, KEY_IME_PROCESS },
+    { 0xE7, KEY_PACKET },
+
+    // Terminal Keys
+    { 0xF6, KEY_ATTN },
+    { 0xF7, KEY_CRSEL },
+    { 0xF8, KEY_EXSEL },
+    { 0xF9, KEY_EREOF },
+    { 0xFD, KEY_PA1 }
 };
 
+static_assert(sizeof(gKeyCodeMappings) / sizeof(KeyCodeMapping) == cKeyCount, "Every key needs exactly one KeyCode mapping");
+
 
 
 /**
-@brief Warning for keys that have not been implemented yet
+@brief Lookup table for Win32 KeyCodes to key indices, built at compile time
+
+Covers all 256 KeyCodes, codes without a key (reserved or unassigned) map to cInvalid.
 **/
-#define gLogKeyNotImplemented(inKeyCode) gLog(R"(
-[WARNING]
-Key with KeyCode [0x%x] has not yet been implemented!
-To implement, please refer to https://docs.microsoft.com/en-us/windows/win32/inputdev/virtual-key-codes, 
-and implement in Input.h and Input.cpp. Thank you!
+class KeyCodeLUT
+{
+public:
+    static constexpr uint8_t cInvalid = 0xFF;
+
+    constexpr KeyCodeLUT() : mKeys()
+    {
+        for (uint8_t& key : mKeys)
+            key = cInvalid;
+        for (const KeyCodeMapping& mapping : gKeyCodeMappings)
+            mKeys[mapping.mKeyCode] = mapping.mKey.mIndex;
+    }
+
+    constexpr uint8_t operator[](KeyCode inKeyCode) const { return mKeys[inKeyCode]; }
+
+    /// Check that no KeyCode and no Key appears twice in gKeyCodeMappings, a duplicate would silently overwrite a LUT entry
+    static constexpr bool sAreMappingsUnique()
+    {
+        bool key_code_used[256] = { };
+        bool key_used[256] = { };
+        for (const KeyCodeMapping& mapping : gKeyCodeMappings)
+        {
+            if (key_code_used[mapping.mKeyCode] || key_used[mapping.mKey.mIndex])
+                return false;
+            key_code_used[mapping.mKeyCode] = true;
+            key_used[mapping.mKey.mIndex] = true;
+        }
+        return true;
+    }
 
-)", inKeyCode)
+private:
+    uint8_t mKeys[256];
+};
+
+static_assert(KeyCodeLUT::sAreMappingsUnique(), "A KeyCode or Key appears twice in the KeyCode mappings");
+
+static constexpr KeyCodeLUT gKeyCodeToKeyLUT;
+static_assert(gKeyCodeToKeyLUT[0x41] == 22 && gKeyCodeToKeyLUT[0x07] == KeyCodeLUT::cInvalid, "KeyCode LUT is not built correctly");
+
+
+
+/**
+@brief Generic modifier keys for the left/right modifier KeyCodes (VK_LSHIFT to VK_RMENU), in pairs of left and right
+**/
+static constexpr KeyCode    cFirstSidedModifier = 0xA0;
+static constexpr KeyCode    cLastSidedModifier  = 0xA5;
+static constexpr Key        gSidedModifierToGenericKey[] = { KEY_SHIFT, KEY_CTRL, KEY_ALT };
 
 
 
@@ -99,22 +286,7 @@ and implement in Input.h and Input.cpp. Thank you!
 static class KeyRegistry
 {
 public:
-    KeyRegistry()
-    {
-        // Allocate in blocks of 64 bits. Calculation works like this:
-        // Let LUT size be 100: 100 >> 6 = 1 + 1 = 2 blocks or 128 bits
-        // Let LUT size be 18:  18  >> 6 = 0 + 1 = 1 block or 64 bits
-        size_t size = ((gKeyCodeToKeyLUT.size() >> 6) + 1) * 64;
-        if (mData = (uint64_t*)malloc(size))
-            memset(mData, 0, size);
-    };
-
-    ~KeyRegistry()
-    {
-        free(mData);
-    }
-
-    void SetKeyDown(const Key& inKey, uint64_t inDown)
+    void SetKeyDown(const Key& inKey, uint64_t inDown, uint64_t inTimeNS)
     {
         // Get the block size from the index by right shifting to the 6th bit
         uint8_t block_index = inKey.mIndex >> 6;
@@ -130,7 +302,21 @@ public:
         // Bit 18 is set in the first data registry.
         uint64_t& data_registry = mData[block_index];
         uint8_t shifted_key_index = inKey.mIndex - (block_index * 64);
-        data_registry = (data_registry & ~(1ULL << shifted_key_index)) | (inDown << shifted_key_index);
+        uint64_t key_bit = 1ULL << shifted_key_index;
+
+        // Remember the edges until the end of the frame
+        bool was_down = (data_registry & key_bit) != 0;
+        if (inDown && !was_down)
+        {
+            mPressed[block_index] |= key_bit;
+            mPressTimeNS[inKey.mIndex] = inTimeNS;
+        }
+        else if (!inDown && was_down)
+        {
+            mReleased[block_index] |= key_bit;
+        }
+
+        data_registry = (data_registry & ~key_bit) | (inDown << shifted_key_index);
     }
 
     bool GetKeyDown(const Key& inKey) const
@@ -140,12 +326,104 @@ public:
         return mData[block_index] & 1ULL << (inKey.mIndex - (block_index * 64));
     }
 
+    bool GetAllDown(const uint64_t* inMask) const
+    {
+        // Collect the bits of the mask that are not down in every word, all keys are down if there are none
+        uint64_t missing = 0;
+        for (size_t i = 0; i < cKeyWordCount; ++i)
+            missing |= inMask[i] & ~mData[i];
+        return missing == 0;
+    }
+
+    void EndFrame(InputSnapshot& ioSnapshot)
+    {
+        // The previous frame is what the snapshot held until now
+        memcpy(ioSnapshot.mPrevious, ioSnapshot.mDown, sizeof(mData));
+        memcpy(ioSnapshot.mDown, mData, sizeof(mData));
+        memcpy(ioSnapshot.mPressed, mPressed, sizeof(mPressed));
+        memcpy(ioSnapshot.mReleased, mReleased, sizeof(mReleased));
+        memcpy(ioSnapshot.mPressTimeNS, mPressTimeNS, sizeof(mPressTimeNS));
+        ioSnapshot.mTimeNS = gGetTimeNS();
+        ++ioSnapshot.mFrame;
+
+        // Start collecting edges for the next frame
+        memset(mPressed, 0, sizeof(mPressed));
+        memset(mReleased, 0, sizeof(mReleased));
+    }
+
 private:
-    uint64_t* mData;
+    uint64_t mData[cKeyWordCount] = {};         ///< One bit per key that is down
+    uint64_t mPressed[cKeyWordCount] = {};      ///< Keys that went down since the last EndFrame
+    uint64_t mReleased[cKeyWordCount] = {};     ///< Keys that went up since the last EndFrame
+    uint64_t mPressTimeNS[cKeyCount] = {};      ///< Time every key last went down
 } gKeyRegistry;
 
 
 
+/**
+@brief Publishes snapshots from the message loop thread to any amount of reader threads without locking
+
+This is a sequence lock: the writer makes the sequence odd while it copies, readers retry when the
+sequence was odd or changed during their copy. The data is stored in atomic words so copies never race.
+**/
+static class SnapshotPublisher
+{
+public:
+    static constexpr size_t cWordCount = sizeof(InputSnapshot) / sizeof(uint64_t);
+    static_assert(sizeof(InputSnapshot) % sizeof(uint64_t) == 0, "InputSnapshot must only hold 64 bit words");
+
+    void Publish(const InputSnapshot& inSnapshot)
+    {
+        uint64_t words[cWordCount];
+        memcpy(words, &inSnapshot, sizeof(words));
+
+        uint64_t sequence = mSequence.load(std::memory_order_relaxed);
+        mSequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t i = 0; i < cWordCount; ++i)
+            mWords[i].store(words[i], std::memory_order_relaxed);
+        mSequence.store(sequence + 2, std::memory_order_release);
+    }
+
+    void Read(InputSnapshot& outSnapshot) const
+    {
+        uint64_t words[cWordCount];
+        uint64_t before, after;
+        do
+        {
+            before = mSequence.load(std::memory_order_acquire);
+            for (size_t i = 0; i < cWordCount; ++i)
+                words[i] = mWords[i].load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            after = mSequence.load(std::memory_order_relaxed);
+        }
+        while ((before & 1) != 0 || before != after);
+
+        memcpy(&outSnapshot, words, sizeof(words));
+    }
+
+private:
+    std::atomic<uint64_t> mSequence { 0 };
+    std::atomic<uint64_t> mWords[cWordCount] = {};
+} gSnapshotPublisher;
+
+
+
+/**
+@brief Snapshot being built on the message loop thread, holds the last published frame
+**/
+static InputSnapshot gCurrentSnapshot;
+
+
+
+/**
+@brief Queue of every input event for consumer threads
+**/
+static RingBuffer<InputEvent, Input::cEventQueueSize>	gEventQueue;
+static std::atomic<uint64_t>							gDroppedEventCount { 0 };
+
+
+
 /**
 @brief Check if @a inKey is down
 **/
@@ -161,51 +439,130 @@ bool Input::sIsDown(const Key& inKey)
 **/
 bool Input::sIsDown(const KeyCombination& inCombination)
 {
-    bool all_down = true;
-    for (const Key& key : inCombination.mKeys)
-    {
-        all_down &= gKeyRegistry.GetKeyDown(key);
-        if (!all_down)
-            return false;
-    }
-    return true;
+    return gKeyRegistry.GetAllDown(inCombination.mBits);
 }
 
 
 
 /**
-@brief Set @a inKeyCode to @a inDown
+@brief Publish the snapshot of the frame that just ended
 **/
-void Input::sSetDown(KeyCode inKeyCode, bool inDown)
+void Input::sEndFrame()
 {
-#ifdef _DEBUG
-    // In debug mode, check first if the KeyCode was implemented
-    if (gKeyCodeToKeyLUT.find(inKeyCode) == gKeyCodeToKeyLUT.end())
-    {
-        gLogKeyNotImplemented(inKeyCode);
-        return;
-    }
-#endif
-    gKeyRegistry.SetKeyDown(gKeyCodeToKeyLUT.at(inKeyCode), (uint8_t)inDown);
+    gKeyRegistry.EndFrame(gCurrentSnapshot);
+    gSnapshotPublisher.Publish(gCurrentSnapshot);
+}
+
+
+
+/**
+@brief Get the last published snapshot
+**/
+void Input::sGetSnapshot(InputSnapshot& outSnapshot)
+{
+    gSnapshotPublisher.Read(outSnapshot);
+}
+
+
+
+/**
+@brief Get the bit of @a inKey in @a inBits
+**/
+bool InputSnapshot::sGetBit(const uint64_t* inBits, const Key& inKey)
+{
+    return (inBits[inKey.mIndex >> 6] >> (inKey.mIndex & 63)) & 1;
+}
+
+
+
+/**
+@brief Check if every key of @a inCombination was down at the end of the frame
+**/
+bool InputSnapshot::IsDown(const KeyCombination& inCombination) const
+{
+    uint64_t missing = 0;
+    for (size_t i = 0; i < cKeyWordCount; ++i)
+        missing |= inCombination.mBits[i] & ~mDown[i];
+    return missing == 0;
+}
+
+
+
+/**
+@brief Seconds @a inKey has been down at the end of the frame
+**/
+double InputSnapshot::HeldFor(const Key& inKey) const
+{
+    if (!IsDown(inKey))
+        return 0.0;
+
+    uint64_t press_time = mPressTimeNS[inKey.mIndex];
+    return mTimeNS > press_time ? (mTimeNS - press_time) * 1e-9 : 0.0;
+}
+
+
+
+/**
+@brief Take up to @a inMaxEvents of the oldest queued events
+**/
+size_t Input::sDrainEvents(InputEvent* outEvents, size_t inMaxEvents)
+{
+    return gEventQueue.PopBatch(outEvents, inMaxEvents);
+}
+
+
+
+/**
+@brief Amount of events dropped because nobody drained the queue in time
+**/
+uint64_t Input::sGetDroppedEventCount()
+{
+    return gDroppedEventCount.load(std::memory_order_relaxed);
 }
 
 
 
 /**
-@brief OR keys together
+@brief Set @a inKeyCode to @a inDown at time @a inTimeNS
 **/
-KeyCombination& KeyCombination::operator|(const Key& inKey)
+void Input::sSetDown(KeyCode inKeyCode, bool inDown, uint64_t inTimeNS)
 {
-    mKeys.push_back(inKey);
-    return *this;
+    // Translation is a single load from the compile time LUT, sProcessEvent already dropped key codes without a key
+    uint8_t key_index = gKeyCodeToKeyLUT[inKeyCode];
+    gAssert(key_index != KeyCodeLUT::cInvalid);
+    gKeyRegistry.SetKeyDown(Key(key_index), (uint8_t)inDown, inTimeNS);
+
+    // A left/right modifier also drives its generic key, which is down while either side is down
+    if (inKeyCode >= cFirstSidedModifier && inKeyCode <= cLastSidedModifier)
+    {
+        uint8_t pair_index = (inKeyCode - cFirstSidedModifier) >> 1;
+        KeyCode left = cFirstSidedModifier + pair_index * 2;
+        bool either_down = gKeyRegistry.GetKeyDown(Key(gKeyCodeToKeyLUT[left])) || gKeyRegistry.GetKeyDown(Key(gKeyCodeToKeyLUT[left + 1]));
+        gKeyRegistry.SetKeyDown(gSidedModifierToGenericKey[pair_index], (uint8_t)either_down, inTimeNS);
+    }
 }
 
 
 
 /**
-@brief OR keys together
+@brief Set the key of @a ioEvent down or up and queue the event
 **/
-KeyCombination operator|(const Key& inFirst, const Key& inSecond)
+void Input::sProcessEvent(InputEvent& ioEvent)
 {
-    return ((KeyCombination)inFirst) | inSecond;
+    uint8_t key_index = gKeyCodeToKeyLUT[ioEvent.mKeyCode];
+    if (key_index == KeyCodeLUT::cInvalid)
+    {
+#ifdef _DEBUG
+        gLogWarning("KeyCode [0x%x] is not a virtual key code, ignored\n", ioEvent.mKeyCode);
+#endif
+        return;
+    }
+
+    bool down = ioEvent.mType == EInputEvent::KeyDown || ioEvent.mType == EInputEvent::MouseDown;
+    sSetDown(ioEvent.mKeyCode, down, ioEvent.mTimeNS);
+
+    // The state bits collapse fast presses, the queue keeps every event. Never block the message loop on a full queue.
+    ioEvent.mKey = Key(key_index);
+    if (!gEventQueue.Push(ioEvent))
+        gDroppedEventCount.fetch_add(1, std::memory_order_relaxed);
 }
@@ -2,73 +2,195 @@
 
 // Additional includes
 #include "Utility.h"
+#include "HandleTable.h"
+
+
+
+/**
+@brief Amount of keys in the key list at the bottom of this file, update this when adding a key
+**/
+constexpr uint8_t cKeyCount = 171;
+constexpr size_t cKeyWordCount = (cKeyCount + 63) / 64;		///< Amount of 64 bit words needed for one bit per key
+
+
+
+/**
+@brief Represents a keyboard key or mouse button
+**/
+class Key
+{
+public:
+	///@name Construction
+	constexpr				Key(uint8_t inIndex) :	mIndex(inIndex) { }
+
+	///@name Comparison
+	constexpr bool			operator==(const Key& inKey) const	{ return mIndex == inKey.mIndex; }
+	constexpr bool			operator!=(const Key& inKey) const	{ return mIndex != inKey.mIndex; }
+
+private:
+	friend class KeyRegistry;						///< KeyRegistry keys for indexing
+	friend class KeyCodeLUT;						///< KeyCodeLUT stores key indices
+	friend class KeyCombination;					///< KeyCombination sets the bit of the key
+	friend class InputSnapshot;						///< InputSnapshot reads the bit of the key
+
+	///@name Properties
+	uint8_t					mIndex;					///< Key index into the registry
+};
 
 
 
 /**
 @brief Simple helper class to combine key checks
+
+Stored as one bit per key with the same layout as the key registry, so checking a combination is a
+single masked compare per registry word and never allocates. Combinations can be built at compile time:
+
+constexpr KeyCombination cSave = KEY_CTRL | KEY_S;
 **/
-class Key;
+class InputSnapshot;
 class KeyCombination
 {
 public:
 	///@name Construction
-							KeyCombination(const Key& inKey)	{ mKeys.push_back(inKey); }
+	constexpr				KeyCombination(const Key& inKey) : mBits() { mBits[inKey.mIndex >> 6] |= 1ULL << (inKey.mIndex & 63); }
 
 	///@name Logic
-	KeyCombination&			operator|(const Key& inKey);		///< OR keys together
+	constexpr KeyCombination operator|(const Key& inKey) const							{ return *this | KeyCombination(inKey); } ///< OR keys together
+	constexpr KeyCombination operator|(const KeyCombination& inCombination) const;		///< OR combinations together
 
 private:
 	friend class Input;											///< Input uses KeyCombination for verification
+	friend class InputSnapshot;									///< InputSnapshot uses KeyCombination for verification
 
 	///@name Properties
-	Array<Key>				mKeys;								///< Combination of keys
+	uint64_t				mBits[cKeyWordCount];				///< One bit per key in the combination
 };
 
 
 
 /**
-@brief Represents a keyboard key or mouse button
+@brief OR combinations together
 **/
-class Key
+constexpr KeyCombination KeyCombination::operator|(const KeyCombination& inCombination) const
+{
+	KeyCombination combination = *this;
+	for (size_t i = 0; i < cKeyWordCount; ++i)
+		combination.mBits[i] |= inCombination.mBits[i];
+	return combination;
+}
+
+
+
+/**
+@brief OR keys together
+**/
+constexpr KeyCombination operator|(const Key& inFirst, const Key& inSecond)
+{
+	return KeyCombination(inFirst) | inSecond;
+}
+
+
+
+/**
+@brief Consistent copy of the input state, published by Input::sEndFrame at every frame boundary
+
+Besides the keys that are down it knows the keys of the previous frame and the keys that went
+down or up during the frame, so a press and release within one frame is not lost.
+**/
+class InputSnapshot
 {
 public:
-	///@name Construction
-							Key(uint8_t inIndex) :	mIndex(inIndex) { }
+	///@name State
+	bool					IsDown(const Key& inKey) const						{ return sGetBit(mDown, inKey); }		///< Check if @a inKey was down at the end of the frame
+	bool					IsDown(const KeyCombination& inCombination) const;	///< Check if every key of @a inCombination was down at the end of the frame
+	bool					WasDown(const Key& inKey) const						{ return sGetBit(mPrevious, inKey); }	///< Check if @a inKey was down at the end of the previous frame
 
-	///@name Conversion
-	operator				KeyCombination()		{ return KeyCombination(*this); } ///< Implicitly convert to a key combination for ORing keys together
+	///@name Edges
+	bool					WasPressed(const Key& inKey) const					{ return sGetBit(mPressed, inKey); }	///< Check if @a inKey went down during the frame
+	bool					WasReleased(const Key& inKey) const					{ return sGetBit(mReleased, inKey); }	///< Check if @a inKey went up during the frame
+	double					HeldFor(const Key& inKey) const;					///< Seconds @a inKey has been down at the end of the frame, 0 if it is up
+
+	///@name Properties
+	uint64_t				GetFrame() const									{ return mFrame; }						///< Frame number, starts at 1 for the first published snapshot
+	double					GetTime() const										{ return mTimeNS * 1e-9; }				///< Time of the frame boundary in gGetTime seconds
 
 private:
-	friend class KeyRegistry;						///< KeyRegistry keys for indexing
+	friend class Input;																							///< Input publishes snapshots
+	friend class KeyRegistry;																					///< KeyRegistry fills in snapshots
 
-	///@name Properties
-	uint8_t					mIndex;					///< Key index into the registry
+	static bool				sGetBit(const uint64_t* inBits, const Key& inKey);	///< Get the bit of @a inKey in @a inBits
+
+	///@name Properties, only 64 bit words so snapshots can be published word by word
+	uint64_t				mFrame = 0;											///< Frame number
+	uint64_t				mTimeNS = 0;										///< Time of the frame boundary in nanoseconds
+	uint64_t				mDown[cKeyWordCount] = {};							///< Keys down at the end of the frame
+	uint64_t				mPrevious[cKeyWordCount] = {};						///< Keys down at the end of the previous frame
+	uint64_t				mPressed[cKeyWordCount] = {};						///< Keys that went down during the frame
+	uint64_t				mReleased[cKeyWordCount] = {};						///< Keys that went up during the frame
+	uint64_t				mPressTimeNS[cKeyCount] = {};						///< Time every key last went down in nanoseconds
+};
+
+
+
+/**
+@brief Platform key code (Win32 virtual key code)
+**/
+using KeyCode = uint8_t;
+
+
+
+/**
+@brief Type of an InputEvent
+**/
+enum class EInputEvent : uint8_t
+{
+	KeyDown,
+	KeyUp,
+	MouseDown,
+	MouseUp,
 };
 
 
 
 /**
-@brief XOR keys together
+@brief Timestamped input event, every event the windows receive is queued for consumer threads (see Input::sDrainEvents)
 **/
-KeyCombination operator|(const Key& inFirst, const Key& inSecond);
+class Window;
+using WindowHandle = Handle<Window>;
+struct InputEvent
+{
+	uint64_t				mTimeNS		= 0;					///< gGetTimeNS time the platform received the event
+	WindowHandle			mWindow;							///< Window that received the event
+	EInputEvent				mType		= EInputEvent::KeyDown;	///< What happened
+	KeyCode					mKeyCode	= 0;					///< Platform key code
+	Key						mKey		= Key(0);				///< Key the key code translates to
+};
 
 
 
 /**
 @brief Input static class
 **/
-using KeyCode = uint8_t;
 class Input
 {
 public:
 	static bool sIsDown(const Key& inKey);						///< Check if a key is down (e.g. Input::sIsDown(KEY_TAB))
 	static bool sIsDown(const KeyCombination& inCombination);	///< Check if a key combination is down (e.g. Input::sIsDown(KEY_CTRL | KEY_ALT | KEY_DEL))
 
+	///@name Frame snapshots
+	static void sEndFrame();									///< Publish the snapshot of the frame that just ended, gProcessMessageLoop calls this after every pump
+	static void sGetSnapshot(InputSnapshot& outSnapshot);		///< Get the last published snapshot without locking, can be called from any thread
+
+	///@name Event queue
+	static constexpr size_t cEventQueueSize = 4096;				///< Maximum amount of queued events, older events are kept and new ones dropped when full
+	static size_t sDrainEvents(InputEvent* outEvents, size_t inMaxEvents); ///< Take up to @a inMaxEvents of the oldest queued events without locking, can be called from any thread
+	static uint64_t sGetDroppedEventCount();					///< Amount of events dropped because nobody drained the queue in time
+
 private:
 	friend struct InputKey;										///< Allow classes with an input key to be able to also set input
 
-	static void sSetDown(KeyCode inKeyCode, bool inDown);		///< Set @a inKeyCode to @a inDown
+	static void sSetDown(KeyCode inKeyCode, bool inDown, uint64_t inTimeNS);	///< Set @a inKeyCode to @a inDown at time @a inTimeNS
+	static void sProcessEvent(InputEvent& ioEvent);				///< Set the key of @a ioEvent down or up and queue the event
 };
 
 
@@ -143,3 +265,137 @@ private:
 #define  KEY_F10		Key(57)
 #define  KEY_F11		Key(58)
 #define  KEY_F12		Key(59)
+
+// Extra Mouse Buttons
+#define  MOUSE_X1              Key(60)
+#define  MOUSE_X2              Key(61)
+
+// Navigation
+#define  KEY_LEFT              Key(62)
+#define  KEY_UP                Key(63)
+#define  KEY_RIGHT             Key(64)
+#define  KEY_DOWN              Key(65)
+#define  KEY_PAGE_UP           Key(66)
+#define  KEY_PAGE_DOWN         Key(67)
+#define  KEY_END               Key(68)
+#define  KEY_HOME              Key(69)
+#define  KEY_INSERT            Key(70)
+
+// Left/Right Modifiers (KEY_SHIFT, KEY_CTRL and KEY_ALT are down when either side is down)
+#define  KEY_LSHIFT            Key(71)
+#define  KEY_RSHIFT            Key(72)
+#define  KEY_LCTRL             Key(73)
+#define  KEY_RCTRL             Key(74)
+#define  KEY_LALT              Key(75)
+#define  KEY_RALT              Key(76)
+#define  KEY_LWIN              Key(77)
+#define  KEY_RWIN              Key(78)
+#define  KEY_APPS              Key(79)
+
+// Locks and System
+#define  KEY_CAPS_LOCK         Key(80)
+#define  KEY_NUM_LOCK          Key(81)
+#define  KEY_SCROLL_LOCK       Key(82)
+#define  KEY_PAUSE             Key(83)
+#define  KEY_PRINT_SCREEN      Key(84)
+#define  KEY_CANCEL            Key(85)
+#define  KEY_CLEAR             Key(86)
+#define  KEY_SELECT            Key(87)
+#define  KEY_PRINT             Key(88)
+#define  KEY_EXECUTE           Key(89)
+#define  KEY_HELP              Key(90)
+#define  KEY_SLEEP             Key(91)
+
+// Numpad
+#define  KEY_NUMPAD_0          Key(92)
+#define  KEY_NUMPAD_1          Key(93)
+#define  KEY_NUMPAD_2          Key(94)
+#define  KEY_NUMPAD_3          Key(95)
+#define  KEY_NUMPAD_4          Key(96)
+#define  KEY_NUMPAD_5          Key(97)
+#define  KEY_NUMPAD_6          Key(98)
+#define  KEY_NUMPAD_7          Key(99)
+#define  KEY_NUMPAD_8          Key(100)
+#define  KEY_NUMPAD_9          Key(101)
+#define  KEY_NUMPAD_MULTIPLY   Key(102)
+#define  KEY_NUMPAD_ADD        Key(103)
+#define  KEY_NUMPAD_SEPARATOR  Key(104)
+#define  KEY_NUMPAD_SUBTRACT   Key(105)
+#define  KEY_NUMPAD_DECIMAL    Key(106)
+#define  KEY_NUMPAD_DIVIDE     Key(107)
+
+// Extended Function Keys
+#define  KEY_F13               Key(108)
+#define  KEY_F14               Key(109)
+#define  KEY_F15               Key(110)
+#define  KEY_F16               Key(111)
+#define  KEY_F17               Key(112)
+#define  KEY_F18               Key(113)
+#define  KEY_F19               Key(114)
+#define  KEY_F20               Key(115)
+#define  KEY_F21               Key(116)
+#define  KEY_F22               Key(117)
+#define  KEY_F23               Key(118)
+#define  KEY_F24               Key(119)
+
+// OEM Keys (names are for the US layout)
+#define  KEY_OEM_SEMICOLON     Key(120)
+#define  KEY_OEM_PLUS          Key(121)
+#define  KEY_OEM_COMMA         Key(122)
+#define  KEY_OEM_MINUS         Key(123)
+#define  KEY_OEM_PERIOD        Key(124)
+#define  KEY_OEM_SLASH         Key(125)
+#define  KEY_OEM_TILDE         Key(126)
+#define  KEY_OEM_LBRACKET      Key(127)
+#define  KEY_OEM_BACKSLASH     Key(128)
+#define  KEY_OEM_RBRACKET      Key(129)
+#define  KEY_OEM_QUOTE         Key(130)
+#define  KEY_OEM_8             Key(131)
+#define  KEY_OEM_102           Key(132)
+#define  KEY_OEM_CLEAR         Key(133)
+
+// Browser Keys
+#define  KEY_BROWSER_BACK      Key(134)
+#define  KEY_BROWSER_FORWARD   Key(135)
+#define  KEY_BROWSER_REFRESH   Key(136)
+#define  KEY_BROWSER_STOP      Key(137)
+#define  KEY_BROWSER_SEARCH    Key(138)
+#define  KEY_BROWSER_FAVORITES Key(139)
+#define  KEY_BROWSER_HOME      Key(140)
+
+// Media Keys
+#define  KEY_VOLUME_MUTE       Key(141)
+#define  KEY_VOLUME_DOWN       Key(142)
+#define  KEY_VOLUME_UP         Key(143)
+#define  KEY_MEDIA_NEXT        Key(144)
+#define  KEY_MEDIA_PREVIOUS    Key(145)
+#define  KEY_MEDIA_STOP        Key(146)
+#define  KEY_MEDIA_PLAY_PAUSE  Key(147)
+#define  KEY_LAUNCH_MAIL       Key(148)
+#define  KEY_LAUNCH_MEDIA      Key(149)
+#define  KEY_LAUNCH_APP1       Key(150)
+#define  KEY_LAUNCH_APP2       Key(151)
+#define  KEY_PLAY              Key(152)
+#define  KEY_ZOOM              Key(153)
+
+// IME Keys
+#define  KEY_IME_KANA          Key(154)
+#define  KEY_IME_ON            Key(155)
+#define  KEY_IME_JUNJA         Key(156)
+#define  KEY_IME_FINAL         Key(157)
+#define  KEY_IME_KANJI         Key(158)
+#define  KEY_IME_OFF           Key(159)
+#define  KEY_IME_CONVERT       Key(160)
+#define  KEY_IME_NONCONVERT    Key(161)
+#define  KEY_IME_ACCEPT        Key(162)
+#define  KEY_IME_MODECHANGE    Key(163)
+#define  KEY_IME_PROCESS       Key(164)
+#define  KEY_PACKET            Key(165)
+
+// Terminal Keys
+#define  KEY_ATTN              Key(166)
+#define  KEY_CRSEL             Key(167)
+#define  KEY_EXSEL             Key(168)
+#define  KEY_EREOF             Key(169)
+#define  KEY_PA1               Key(170)
+
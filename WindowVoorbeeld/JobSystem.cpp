@@ -0,0 +1,480 @@
+#include "JobSystem.h"
+
+// STL includes
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+// Additional includes
+#include "MessageLoop.h"
+#include "RingBuffer.h"
+
+
+
+/**
+@brief Forked job
+**/
+struct Job
+{
+	static void				sFinish(JobCounter& ioCounter)	{ ioCounter.mCount.fetch_sub(1, std::memory_order_release); }	///< Mark a job of @a ioCounter as finished
+
+	JobFunction				mFunction;						///< Work to do
+	JobCounter*				mCounter = nullptr;				///< Counter to decrement when done
+};
+
+
+
+/**
+@brief Fixed size work stealing deque (Chase-Lev)
+
+Only the owning worker pushes and pops at the bottom, any thread can steal from the top.
+**/
+class JobDeque
+{
+public:
+	static constexpr int64_t cCapacity = 4096;				///< Maximum amount of jobs, power of two
+
+	///@name Owner
+	bool					Push(Job* inJob);				///< Push @a inJob at the bottom, returns false if the deque is full
+	Job*					Pop();							///< Pop the newest job, nullptr if empty
+
+	///@name Thieves
+	Job*					Steal();						///< Steal the oldest job, nullptr if empty or another thread was faster
+
+private:
+	alignas(64) std::atomic<int64_t> mTop { 0 };			///< Next job to steal
+	alignas(64) std::atomic<int64_t> mBottom { 0 };			///< Next free slot of the owner
+	std::atomic<Job*>		mJobs[cCapacity];				///< Circular job storage
+};
+
+
+
+/**
+@brief Push @a inJob at the bottom
+**/
+bool JobDeque::Push(Job* inJob)
+{
+	int64_t bottom = mBottom.load(std::memory_order_relaxed);
+	int64_t top = mTop.load(std::memory_order_acquire);
+	if (bottom - top >= cCapacity)
+		return false;
+
+	mJobs[bottom & (cCapacity - 1)].store(inJob, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	mBottom.store(bottom + 1, std::memory_order_relaxed);
+	return true;
+}
+
+
+
+/**
+@brief Pop the newest job
+**/
+Job* JobDeque::Pop()
+{
+	// Reserve the bottom job before looking at the top, so a thief and the owner cannot both take the last job
+	int64_t bottom = mBottom.load(std::memory_order_relaxed) - 1;
+	mBottom.store(bottom, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	int64_t top = mTop.load(std::memory_order_relaxed);
+
+	if (top > bottom)
+	{
+		// Empty
+		mBottom.store(bottom + 1, std::memory_order_relaxed);
+		return nullptr;
+	}
+
+	Job* job = mJobs[bottom & (cCapacity - 1)].load(std::memory_order_relaxed);
+	if (top == bottom)
+	{
+		// Last job, race the thieves for it
+		if (!mTop.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+			job = nullptr;
+		mBottom.store(bottom + 1, std::memory_order_relaxed);
+	}
+	return job;
+}
+
+
+
+/**
+@brief Steal the oldest job
+**/
+Job* JobDeque::Steal()
+{
+	int64_t top = mTop.load(std::memory_order_acquire);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	int64_t bottom = mBottom.load(std::memory_order_acquire);
+	if (top >= bottom)
+		return nullptr;
+
+	Job* job = mJobs[top & (cCapacity - 1)].load(std::memory_order_relaxed);
+	if (!mTop.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+		return nullptr;
+	return job;
+}
+
+
+
+/**
+@brief Worker thread with its own deque
+**/
+struct Worker
+{
+	JobDeque				mDeque;							///< Jobs forked by this worker
+	std::thread				mThread;						///< The worker thread
+};
+
+
+
+/**
+@brief Job system state
+**/
+static Array<AlignedPtr<Worker>>		gWorkers;						///< All workers
+static std::atomic<bool>				gJobSystemRunning { false };	///< Workers are started
+static std::atomic<bool>				gJobSystemStopping { false };	///< Workers should exit once there is no work left
+static std::mutex						gJobSystemLifetimeMutex;		///< Serializes starting and stopping
+static std::atomic<uint32_t>			gJobSystemUsers { 0 };			///< Threads that are not workers and are pushing to or stealing from the pool, sShutdown waits for them
+static RingBuffer<Job*, 4096>			gSharedJobs;					///< Jobs forked from threads that are not workers
+static thread_local int					gWorkerIndex = -1;				///< Index of the calling worker, -1 for other threads
+
+static std::mutex						gSleepMutex;					///< Idle workers sleep on gSleepCondition
+static std::condition_variable			gSleepCondition;
+static std::atomic<uint32_t>			gSleepingWorkers { 0 };			///< Amount of workers that are (about to go) sleeping
+static std::atomic<uint64_t>			gWorkEpoch { 0 };				///< Bumped on every fork so a worker going to sleep can tell it missed a job
+
+static std::mutex						gMainThreadMutex;				///< Protects gMainThreadJobs
+static Array<JobFunction>				gMainThreadJobs;				///< Continuations for the message loop thread
+static Array<JobFunction>				gMainThreadRunning;				///< Continuations being run, swapped with gMainThreadJobs every frame
+
+
+
+/**
+@brief Run @a inJob and free it
+**/
+static void sExecute(Job* inJob)
+{
+	inJob->mFunction();
+
+	JobCounter* counter = inJob->mCounter;
+	delete inJob;
+
+	// Decrement last, a waiter may destroy the counter right after
+	if (counter != nullptr)
+		Job::sFinish(*counter);
+}
+
+
+
+/**
+@brief Find a job for the calling thread: its own deque first, then the shared queue, then steal from the others
+**/
+static Job* sFindJob()
+{
+	Job* job = nullptr;
+	if (gWorkerIndex >= 0)
+	{
+		job = gWorkers[gWorkerIndex]->mDeque.Pop();
+		if (job != nullptr)
+			return job;
+	}
+
+	if (gSharedJobs.Pop(job))
+		return job;
+
+	// Start stealing at the next worker, so thieves spread over the victims
+	size_t worker_count = gWorkers.size();
+	size_t start = gWorkerIndex >= 0 ? gWorkerIndex + 1 : 0;
+	for (size_t i = 0; i < worker_count; ++i)
+	{
+		size_t victim = (start + i) % worker_count;
+		if ((int)victim == gWorkerIndex)
+			continue;
+
+		job = gWorkers[victim]->mDeque.Steal();
+		if (job != nullptr)
+			return job;
+	}
+	return nullptr;
+}
+
+
+
+/**
+@brief Start using the pool from a thread that is not a worker, returns false if the workers don't run
+
+While entered gWorkers does not change and a pushed job is guaranteed to be run. Stopping is checked before
+running: sShutdown sets it before waiting for the users to leave, and clears it after clearing running.
+**/
+static bool sEnterPool()
+{
+	gJobSystemUsers.fetch_add(1);
+	if (!gJobSystemStopping.load() && gJobSystemRunning.load())
+		return true;
+
+	gJobSystemUsers.fetch_sub(1);
+	return false;
+}
+
+
+
+/**
+@brief Stop using the pool after a successful sEnterPool
+**/
+static void sLeavePool()
+{
+	gJobSystemUsers.fetch_sub(1);
+}
+
+
+
+/**
+@brief Wake up a sleeping worker after a fork
+**/
+static void sWakeWorker()
+{
+	gWorkEpoch.fetch_add(1);
+	if (gSleepingWorkers.load() > 0)
+	{
+		// Taking the lock makes sure the worker is either waiting or will see the new epoch
+		{ std::lock_guard<std::mutex> lock(gSleepMutex); }
+		gSleepCondition.notify_one();
+	}
+}
+
+
+
+/**
+@brief Worker thread entry point
+**/
+static void sWorkerMain(int inIndex)
+{
+	gWorkerIndex = inIndex;
+
+	for (;;)
+	{
+		uint64_t epoch = gWorkEpoch.load();
+
+		// Spin briefly before sleeping, jobs often come in bursts
+		Job* job = nullptr;
+		for (int attempt = 0; attempt < 64 && job == nullptr; ++attempt)
+		{
+			job = sFindJob();
+			if (job == nullptr)
+				std::this_thread::yield();
+		}
+
+		if (job != nullptr)
+		{
+			sExecute(job);
+			continue;
+		}
+
+		// Nothing was found, so every job forked before the stop request has been taken
+		if (gJobSystemStopping.load())
+			break;
+
+		std::unique_lock<std::mutex> lock(gSleepMutex);
+		gSleepingWorkers.fetch_add(1);
+		gSleepCondition.wait(lock, [epoch]() { return gWorkEpoch.load() != epoch || gJobSystemStopping.load(); });
+		gSleepingWorkers.fetch_sub(1);
+	}
+
+	gWorkerIndex = -1;
+}
+
+
+
+/**
+@brief Start the workers
+**/
+void JobSystem::sInit(uint32_t inWorkerCount)
+{
+	std::lock_guard<std::mutex> lock(gJobSystemLifetimeMutex);
+	if (gJobSystemRunning.load())
+		return;
+
+	// Keep a core for the message loop thread
+	if (inWorkerCount == 0)
+	{
+		uint32_t core_count = std::thread::hardware_concurrency();
+		inWorkerCount = core_count > 1 ? core_count - 1 : 1;
+	}
+
+	// Create every deque before the first worker can start stealing
+	gJobSystemStopping = false;
+	gWorkers.clear();
+	for (uint32_t i = 0; i < inWorkerCount; ++i)
+		gWorkers.push_back(AlignedPtr<Worker>(gNewAligned<Worker>()));
+	for (uint32_t i = 0; i < inWorkerCount; ++i)
+		gWorkers[i]->mThread = std::thread(sWorkerMain, (int)i);
+
+	gJobSystemRunning = true;
+}
+
+
+
+/**
+@brief Finish every forked job and stop the workers
+**/
+void JobSystem::sShutdown()
+{
+	{
+		std::lock_guard<std::mutex> lock(gJobSystemLifetimeMutex);
+		if (!gJobSystemRunning.load())
+			return;
+
+		gJobSystemStopping = true;
+
+		// Forks from other threads (e.g. a render thread) that saw the pool running finish their push first
+		while (gJobSystemUsers.load() > 0)
+			std::this_thread::yield();
+
+		{ std::lock_guard<std::mutex> sleep_lock(gSleepMutex); }
+		gSleepCondition.notify_all();
+
+		for (AlignedPtr<Worker>& worker : gWorkers)
+			worker->mThread.join();
+
+		// Jobs forked by the last running jobs after the other workers left end up here
+		Job* job;
+		while (gSharedJobs.Pop(job))
+			sExecute(job);
+
+		gWorkers.clear();
+		gJobSystemRunning = false;
+		gJobSystemStopping = false;
+	}
+
+	// The windows are still alive, so let the continuations of the finished jobs run. Outside of the lock,
+	// because a continuation can fork again (which runs inline now) or even call sInit.
+	while (sRunMainThreadJobs() > 0) { }
+}
+
+
+
+/**
+@brief Check if the workers run
+**/
+bool JobSystem::sIsRunning()
+{
+	return gJobSystemRunning.load();
+}
+
+
+
+/**
+@brief Fork @a inJob
+**/
+void JobSystem::sRun(JobFunction&& inJob, JobCounter* ioCounter)
+{
+	// Without workers (before sInit, during or after sShutdown) the job runs right away, the pool is never restarted
+	// from here because the workers would outlive the loop that joins them. gWorkers cannot change while a worker runs.
+	bool is_worker = gWorkerIndex >= 0;
+	if (is_worker ? gJobSystemStopping.load() : !sEnterPool())
+	{
+		inJob();
+		return;
+	}
+
+	Job* job = new Job;
+	job->mFunction	= std::move(inJob);
+	job->mCounter	= ioCounter;
+	if (ioCounter != nullptr)
+		ioCounter->mCount.fetch_add(1, std::memory_order_relaxed);
+
+	// Workers push on their own deque, everybody else on the shared queue. When full, run it right away.
+	bool queued = is_worker ? gWorkers[gWorkerIndex]->mDeque.Push(job) : gSharedJobs.Push(job);
+	if (queued)
+		sWakeWorker();
+	if (!is_worker)
+		sLeavePool();
+	if (!queued)
+		sExecute(job);
+}
+
+
+
+/**
+@brief Execute other jobs until every job of @a ioCounter finished
+**/
+void JobSystem::sWait(JobCounter& ioCounter)
+{
+	while (!ioCounter.IsDone())
+	{
+		// Help out instead of blocking, this also makes waiting inside a job safe. While the pool stops only the shared
+		// queue is safe to take from, it outlives the workers.
+		Job* job = nullptr;
+		if (gWorkerIndex >= 0)
+			job = sFindJob();
+		else if (sEnterPool())
+		{
+			job = sFindJob();
+			sLeavePool();
+		}
+		else if (!gSharedJobs.Pop(job))
+			job = nullptr;
+
+		if (job != nullptr)
+			sExecute(job);
+		else
+			std::this_thread::yield();
+	}
+}
+
+
+
+/**
+@brief Run @a inJob on the message loop thread in its next frame
+**/
+void JobSystem::sRunOnMainThread(JobFunction&& inJob)
+{
+	{
+		std::lock_guard<std::mutex> lock(gMainThreadMutex);
+		gMainThreadJobs.push_back(std::move(inJob));
+	}
+	gWakeMessageLoop();
+}
+
+
+
+/**
+@brief Run every posted continuation
+**/
+size_t JobSystem::sRunMainThreadJobs()
+{
+	{
+		std::lock_guard<std::mutex> lock(gMainThreadMutex);
+		gMainThreadRunning.swap(gMainThreadJobs);
+	}
+
+	// Continuations posted from here on wait for the next frame
+	for (JobFunction& job : gMainThreadRunning)
+		job();
+
+	size_t count = gMainThreadRunning.size();
+	gMainThreadRunning.clear();
+	return count;
+}
+
+
+
+/**
+@brief Amount of worker threads
+**/
+uint32_t JobSystem::sGetWorkerCount()
+{
+	return gJobSystemRunning.load() ? (uint32_t)gWorkers.size() : 0;
+}
+
+
+
+/**
+@brief Check if the calling thread is a worker
+**/
+bool JobSystem::sIsWorkerThread()
+{
+	return gWorkerIndex >= 0;
+}
+
@@ -0,0 +1,114 @@
+#pragma once
+
+// Additional includes
+#include "Utility.h"
+#include "Function.h"
+
+// STL includes
+#include <atomic>
+
+
+
+/**
+@brief Job as passed to the job system, captures must fit in 48 bytes
+**/
+using JobFunction = InplaceFunction<void(), 48>;
+
+
+
+/**
+@brief Counts unfinished jobs, pass it when forking and wait on it with JobSystem::sWait
+**/
+class JobCounter
+{
+public:
+	///@name Properties
+	bool					IsDone() const					{ return mCount.load(std::memory_order_acquire) == 0; }	///< Check if every job counted by this counter finished
+
+private:
+	friend class JobSystem;
+	friend struct Job;
+
+	std::atomic<uint32_t>	mCount { 0 };					///< Amount of unfinished jobs
+};
+
+
+
+/**
+@brief Work stealing job scheduler owned by the message loop
+
+Every worker has its own deque: it pushes and pops jobs at the bottom, idle workers steal from the top of the
+others. Jobs forked from threads that are not workers (e.g. a window event) go through a shared queue.
+Continuations that must touch windows are posted back with sRunOnMainThread and run in the next message loop frame.
+
+The workers start with sInit (gProcessMessageLoop calls it) and stop when the loop returns (e.g. after
+gQuitApplication), after the render threads stopped. Jobs that were already forked still finish. A fork while the workers don't run (before sInit,
+during or after sShutdown) runs the job on the calling thread before sRun returns.
+
+Example:
+
+virtual void OnPaint() override
+{
+	JobCounter counter;
+	JobSystem::sParallelFor(mObjects.size(), 64, [this](size_t inIndex) { mObjects[inIndex].Update(); }, counter);
+	JobSystem::sWait(counter);
+	// ...
+}
+
+virtual bool OnKeyDown() override
+{
+	JobSystem::sRun([this]()
+	{
+		Scene scene = sLoadScene();
+		JobSystem::sRunOnMainThread([this, scene]() { SetScene(scene); });
+	});
+	return true;
+}
+**/
+class JobSystem
+{
+public:
+	///@name Lifetime (message loop thread)
+	static void				sInit(uint32_t inWorkerCount = 0);	///< Start @a inWorkerCount workers, 0 means one less than the amount of cores. Does nothing if already running.
+	static void				sShutdown();					///< Finish every forked job and stop the workers
+	static bool				sIsRunning();					///< Check if the workers run
+
+	///@name Forking (any thread)
+	static void				sRun(JobFunction&& inJob, JobCounter* ioCounter = nullptr);	///< Fork @a inJob, @a ioCounter is decremented when it finished
+	static void				sRun(JobFunction&& inJob, JobCounter& ioCounter)			{ sRun(std::move(inJob), &ioCounter); }
+	template<class F>
+	static void				sParallelFor(size_t inCount, size_t inBatchSize, const F& inFunction, JobCounter& ioCounter); ///< Fork a job per batch that calls @a inFunction(index) for every index in [0, @a inCount), @a inFunction must live until @a ioCounter is done
+	static void				sWait(JobCounter& ioCounter);	///< Execute other jobs until every job of @a ioCounter finished
+
+	///@name Continuations (any thread)
+	static void				sRunOnMainThread(JobFunction&& inJob);	///< Run @a inJob on the message loop thread in its next frame, windows can only be touched from there
+	static size_t			sRunMainThreadJobs();			///< Run every posted continuation, called by the message loop every frame
+
+	///@name Properties
+	static uint32_t			sGetWorkerCount();				///< Amount of worker threads, 0 when not running
+	static bool				sIsWorkerThread();				///< Check if the calling thread is a worker
+};
+
+
+
+/**
+@brief Fork a job per batch that calls @a inFunction(index) for every index in [0, @a inCount)
+**/
+template<class F>
+void JobSystem::sParallelFor(size_t inCount, size_t inBatchSize, const F& inFunction, JobCounter& ioCounter)
+{
+	if (inBatchSize == 0)
+		inBatchSize = 1;
+
+	// Capture the function by pointer so every batch job fits in a JobFunction
+	const F* function = &inFunction;
+	for (size_t begin = 0; begin < inCount; begin += inBatchSize)
+	{
+		size_t end = begin + inBatchSize < inCount ? begin + inBatchSize : inCount;
+		sRun([function, begin, end]()
+		{
+			for (size_t i = begin; i < end; ++i)
+				(*function)(i);
+		}, &ioCounter);
+	}
+}
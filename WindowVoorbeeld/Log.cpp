@@ -0,0 +1,819 @@
+#include "Log.h"
+
+// Additional includes
+#include "Utility.h"
+
+// STL includes
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+
+
+/**
+@brief Single producer, single consumer ring of log records owned by one thread
+
+The owning thread appends records and publishes them by moving mHead, the flusher reads them and hands the
+space back by moving mTail. Both positions only grow, a record never wraps: when it does not fit in front of
+the end of the ring a padding record fills the rest and the record starts at the beginning.
+**/
+class LogBuffer
+{
+public:
+	static constexpr size_t	cCapacity = 256 * 1024;			///< Bytes, power of two
+
+	///@name Construction
+	explicit				LogBuffer(uint32_t inThread) :		mThread(inThread) { }
+
+	///@name Producer
+	uint8_t*				Begin(size_t inSize);				///< Claim @a inSize contiguous bytes (a multiple of 8), nullptr if the ring is full
+	void					End()								{ mHead.store(mPendingHead, std::memory_order_release); }	///< Publish the claimed record
+	bool					IsHalfFull() const					{ return mPendingHead - mCachedTail > cCapacity / 2; }	///< Check if the flusher should be woken up early
+	void					CountDropped()						{ mDropped.store(mDropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed); }
+
+	///@name Consumer
+	uint64_t				GetHead() const						{ return mHead.load(std::memory_order_acquire); }	///< End of the published records
+	uint64_t				GetTail() const						{ return mTail.load(std::memory_order_relaxed); }	///< Start of the unread records
+	const LogRecord*		GetRecord(uint64_t inPosition) const	{ return (const LogRecord*)(mData + (inPosition & (cCapacity - 1))); }
+	void					Release(uint64_t inPosition)		{ mTail.store(inPosition, std::memory_order_release); }	///< Hand the space before @a inPosition back to the producer
+
+	///@name Properties
+	uint32_t				GetThread() const					{ return mThread; }	///< Index of the owning thread, in order of their first message
+	bool					IsClosed() const					{ return mClosed.load(std::memory_order_acquire); }
+	void					Close()								{ mClosed.store(true, std::memory_order_release); }	///< The thread exited, the buffer can go once it is drained
+	std::atomic<uint64_t>	mWritten { 0 };						///< Records written by the owner
+	std::atomic<uint64_t>	mBytes { 0 };						///< Bytes written by the owner
+	std::atomic<uint64_t>	mDropped { 0 };						///< Records dropped by the owner
+	uint64_t				mReportedDropped = 0;				///< Part of mDropped the flusher already reported
+
+private:
+	///@name Properties
+	alignas(64) std::atomic<uint64_t> mHead { 0 };				///< Written by the producer
+	uint64_t				mPendingHead = 0;					///< Head after the claimed record, producer only
+	uint64_t				mCachedTail = 0;					///< Last tail the producer saw, saves reading the consumer's cache line
+	alignas(64) std::atomic<uint64_t> mTail { 0 };				///< Written by the consumer
+	std::atomic<bool>		mClosed { false };
+	uint32_t				mThread;
+	alignas(64) uint8_t		mData[cCapacity];
+};
+
+
+
+/**
+@brief Claim @a inSize contiguous bytes
+**/
+uint8_t* LogBuffer::Begin(size_t inSize)
+{
+	uint64_t head = mHead.load(std::memory_order_relaxed);
+	size_t offset = (size_t)(head & (cCapacity - 1));
+	size_t contiguous = cCapacity - offset;
+	size_t needed = inSize <= contiguous ? inSize : contiguous + inSize;
+
+	// Only look at the consumer's position when the space we know of is not enough
+	if (head + needed - mCachedTail > cCapacity)
+	{
+		mCachedTail = mTail.load(std::memory_order_acquire);
+		if (head + needed - mCachedTail > cCapacity)
+			return nullptr;
+	}
+
+	if (inSize > contiguous)
+	{
+		// Pad to the end of the ring, records are 8 byte aligned so the padding header always fits
+		LogRecord* padding = (LogRecord*)(mData + offset);
+		padding->mSize = (uint32_t)contiguous;
+		padding->mLevel = ELogLevel::Off;
+		head += contiguous;
+		offset = 0;
+	}
+
+	mPendingHead = head + inSize;
+	return mData + offset;
+}
+
+
+
+/**
+@brief Gives every thread its buffer and closes it when the thread exits
+**/
+struct LogThread
+{
+							~LogThread()						{ if (mBuffer != nullptr) mBuffer->Close(); mBuffer = nullptr; }
+
+	LogBuffer*				mBuffer = nullptr;
+};
+
+
+
+/**
+@brief Message drained from a buffer, waiting to be written in time order
+**/
+struct LogPending
+{
+	const LogRecord*		mRecord;
+	uint32_t				mThread;
+};
+
+
+
+/**
+@brief Logger state, created on the first message and destroyed (after a final flush) at exit
+**/
+struct LogState
+{
+							~LogState();
+
+	std::mutex				mMutex;								///< Guards everything below, taken by the flusher and when a thread registers
+	Array<AlignedPtr<LogBuffer>> mBuffers;				///< Buffer of every thread that logged and did not exit or was not drained yet
+	uint32_t				mThreadCount = 0;
+	uint64_t				mRetiredWritten = 0;				///< Counters of buffers that were removed
+	uint64_t				mRetiredBytes = 0;
+	uint64_t				mRetiredDropped = 0;
+	Array<LogPending>		mPending;							///< Scratch list of the flusher
+	Array<uint8_t>			mOutput;							///< Scratch output of the flusher, written with a single fwrite
+	FILE*					mBinaryFile = nullptr;				///< Binary output, nullptr for text on stdout
+	HashMap<const char*, uint32_t> mFormatIDs;				///< Formats already written to the binary file
+
+	std::thread				mFlusher;
+	std::mutex				mWakeMutex;
+	std::condition_variable	mWake;
+	std::atomic<bool>		mRunning { false };					///< Changed under mWakeMutex, read without it to see if the flusher has to be started
+};
+
+
+
+/**
+@brief Set when the logger is destroyed at exit, messages after that are written synchronously
+**/
+static std::atomic<bool> gLogDestroyed { false };
+
+
+
+/**
+@brief Buffer of the calling thread
+**/
+static thread_local LogThread gLogThread;
+
+
+
+/**
+@brief Interval at which the flusher wakes up on its own
+**/
+static constexpr std::chrono::milliseconds cLogFlushInterval(5);
+
+
+
+/**
+@brief Longest a thread waits for room in its full buffer before it drops the message
+**/
+static constexpr uint64_t cLogFullWaitNS = 100000000;
+
+
+
+/**
+@brief Logger state, created on first use
+**/
+static LogState& sGetState()
+{
+	static LogState state;
+	return state;
+}
+
+
+
+/**
+@brief Append @a inSize bytes to the flusher output
+**/
+static void sAppend(Array<uint8_t>& ioOutput, const void* inData, size_t inSize)
+{
+	size_t offset = ioOutput.size();
+	ioOutput.resize(offset + inSize);
+	memcpy(ioOutput.data() + offset, inData, inSize);
+}
+
+template<class T>
+static void sAppend(Array<uint8_t>& ioOutput, T inValue)
+{
+	sAppend(ioOutput, &inValue, sizeof(T));
+}
+
+
+
+/**
+@brief Add a record to the output, as text or as binary chunks
+**/
+static void sOutputRecord(LogState& ioState, const LogRecord& inRecord, uint32_t inThread)
+{
+	const uint8_t* arguments = (const uint8_t*)(&inRecord + 1);
+	uint32_t arguments_size = inRecord.mSize - (uint32_t)sizeof(LogRecord);
+
+	if (ioState.mBinaryFile == nullptr)
+	{
+		// Info is what gLog used to print, other levels get their name in front
+		if (inRecord.mLevel != ELogLevel::Info)
+		{
+			String prefix = gFormat("[%s] ", Log::sGetLevelName(inRecord.mLevel));
+			sAppend(ioState.mOutput, prefix.data(), prefix.size());
+		}
+		String text = Log::sFormat(inRecord.mFormat, arguments, arguments_size);
+		sAppend(ioState.mOutput, text.data(), text.size());
+		return;
+	}
+
+	// Send the format string the first time it is used
+	auto format = ioState.mFormatIDs.find(inRecord.mFormat);
+	if (format == ioState.mFormatIDs.end())
+	{
+		uint32_t id = (uint32_t)ioState.mFormatIDs.size();
+		uint32_t length = (uint32_t)strlen(inRecord.mFormat);
+		sAppend(ioState.mOutput, ELogChunk::Format);
+		sAppend(ioState.mOutput, id);
+		sAppend(ioState.mOutput, length);
+		sAppend(ioState.mOutput, inRecord.mFormat, length);
+		format = ioState.mFormatIDs.emplace(inRecord.mFormat, id).first;
+	}
+
+	sAppend(ioState.mOutput, ELogChunk::Message);
+	sAppend(ioState.mOutput, format->second);
+	sAppend(ioState.mOutput, inRecord.mLevel);
+	sAppend(ioState.mOutput, inThread);
+	sAppend(ioState.mOutput, inRecord.mTimeNS);
+	sAppend(ioState.mOutput, inRecord.mArgumentCount);
+	sAppend(ioState.mOutput, arguments_size);
+	sAppend(ioState.mOutput, arguments, arguments_size);
+}
+
+
+
+/**
+@brief Write every published record of every buffer, the caller holds the state mutex
+**/
+static void sDrain(LogState& ioState)
+{
+	// Collect the records, the heads are read once so records published meanwhile wait for the next drain
+	Array<uint64_t> heads;
+	heads.reserve(ioState.mBuffers.size());
+	ioState.mPending.clear();
+	uint64_t dropped = 0;
+	for (const AlignedPtr<LogBuffer>& buffer : ioState.mBuffers)
+	{
+		uint64_t head = buffer->GetHead();
+		for (uint64_t position = buffer->GetTail(); position < head; position += buffer->GetRecord(position)->mSize)
+			if (buffer->GetRecord(position)->mLevel != ELogLevel::Off)
+				ioState.mPending.push_back({ buffer->GetRecord(position), buffer->GetThread() });
+		heads.push_back(head);
+
+		uint64_t buffer_dropped = buffer->mDropped.load(std::memory_order_relaxed);
+		dropped += buffer_dropped - buffer->mReportedDropped;
+		buffer->mReportedDropped = buffer_dropped;
+	}
+
+	// Every buffer is in order already, merge them by time
+	std::stable_sort(ioState.mPending.begin(), ioState.mPending.end(), [](const LogPending& inLeft, const LogPending& inRight) { return inLeft.mRecord->mTimeNS < inRight.mRecord->mTimeNS; });
+
+	ioState.mOutput.clear();
+	for (const LogPending& pending : ioState.mPending)
+		sOutputRecord(ioState, *pending.mRecord, pending.mThread);
+
+	if (dropped > 0)
+	{
+		if (ioState.mBinaryFile == nullptr)
+		{
+			String text = gFormat("[WARNING] %llu log messages were dropped, a thread logged faster than they could be written\n", (unsigned long long)dropped);
+			sAppend(ioState.mOutput, text.data(), text.size());
+		}
+		else
+		{
+			sAppend(ioState.mOutput, ELogChunk::Dropped);
+			sAppend(ioState.mOutput, dropped);
+		}
+	}
+
+	if (!ioState.mOutput.empty())
+	{
+		FILE* file = ioState.mBinaryFile != nullptr ? ioState.mBinaryFile : stdout;
+		fwrite(ioState.mOutput.data(), 1, ioState.mOutput.size(), file);
+		fflush(file);
+	}
+
+	// Hand the space back, and forget the buffers of threads that exited
+	for (size_t i = 0; i < ioState.mBuffers.size(); ++i)
+		ioState.mBuffers[i]->Release(heads[i]);
+	for (size_t i = ioState.mBuffers.size(); i-- > 0; )
+	{
+		LogBuffer& buffer = *ioState.mBuffers[i];
+		if (buffer.IsClosed() && buffer.GetTail() == buffer.GetHead())
+		{
+			ioState.mRetiredWritten += buffer.mWritten.load(std::memory_order_relaxed);
+			ioState.mRetiredBytes += buffer.mBytes.load(std::memory_order_relaxed);
+			ioState.mRetiredDropped += buffer.mDropped.load(std::memory_order_relaxed);
+			ioState.mBuffers.erase(ioState.mBuffers.begin() + i);
+		}
+	}
+}
+
+
+
+/**
+@brief Background thread, drains the buffers every few milliseconds or when a buffer fills up
+**/
+static void sFlusherMain(LogState* ioState)
+{
+	std::unique_lock<std::mutex> wake_lock(ioState->mWakeMutex);
+	while (ioState->mRunning)
+	{
+		ioState->mWake.wait_for(wake_lock, cLogFlushInterval);
+		wake_lock.unlock();
+		{
+			std::lock_guard<std::mutex> lock(ioState->mMutex);
+			sDrain(*ioState);
+		}
+		wake_lock.lock();
+	}
+}
+
+
+
+/**
+@brief Start the flusher if it does not run, the caller holds the state mutex
+**/
+static void sStartFlusher(LogState& ioState)
+{
+	std::lock_guard<std::mutex> wake_lock(ioState.mWakeMutex);
+	if (ioState.mRunning)
+		return;
+
+	ioState.mRunning = true;
+	ioState.mFlusher = std::thread(sFlusherMain, &ioState);
+}
+
+
+
+/**
+@brief Stop the flusher and write what is left
+**/
+static void sStopFlusher(LogState& ioState)
+{
+	{
+		std::lock_guard<std::mutex> wake_lock(ioState.mWakeMutex);
+		ioState.mRunning = false;
+	}
+	ioState.mWake.notify_one();
+	if (ioState.mFlusher.joinable())
+		ioState.mFlusher.join();
+
+	std::lock_guard<std::mutex> lock(ioState.mMutex);
+	sDrain(ioState);
+}
+
+
+
+/**
+@brief Final flush at exit
+**/
+LogState::~LogState()
+{
+	sStopFlusher(*this);
+	if (mBinaryFile != nullptr)
+		fclose(mBinaryFile);
+	gLogDestroyed = true;
+}
+
+
+
+/**
+@brief Claim a record and fill in its header
+**/
+uint8_t* Log::sBeginRecord(ELogLevel inLevel, const char* inFormat, uint8_t inArgumentCount, size_t inSize, LogBuffer*& outBuffer)
+{
+	gAssert(inLevel < ELogLevel::Off);
+
+	if (gLogDestroyed)
+	{
+		// Too late for the flusher, format into a temporary record that sEndRecord prints
+		outBuffer = nullptr;
+		uint8_t* record = new uint8_t[inSize];
+		*(LogRecord*)record = { (uint32_t)inSize, inLevel, inArgumentCount, inFormat, gGetTimeNS() };
+		return record;
+	}
+
+	LogState& state = sGetState();
+	LogBuffer* buffer = gLogThread.mBuffer;
+	if (buffer == nullptr || !state.mRunning.load(std::memory_order_relaxed))
+	{
+		// First message of this thread (register a buffer) or the first one after sShutdown
+		std::lock_guard<std::mutex> lock(state.mMutex);
+		if (buffer == nullptr)
+		{
+			buffer = gNewAligned<LogBuffer>(state.mThreadCount++);
+			state.mBuffers.emplace_back(buffer);
+			gLogThread.mBuffer = buffer;
+		}
+		sStartFlusher(state);
+	}
+	outBuffer = buffer;
+
+	// Records that take more than half the ring would starve every other message
+	if (inSize > LogBuffer::cCapacity / 2)
+	{
+		buffer->CountDropped();
+		return nullptr;
+	}
+
+	uint8_t* record = buffer->Begin(inSize);
+	if (record == nullptr)
+	{
+		// The thread logs faster than the flusher writes, give the flusher a moment before dropping the message
+		uint64_t give_up = gGetTimeNS() + cLogFullWaitNS;
+		do
+		{
+			state.mWake.notify_one();
+			std::this_thread::yield();
+			record = buffer->Begin(inSize);
+		}
+		while (record == nullptr && gGetTimeNS() < give_up);
+
+		if (record == nullptr)
+		{
+			buffer->CountDropped();
+			return nullptr;
+		}
+	}
+
+	*(LogRecord*)record = { (uint32_t)inSize, inLevel, inArgumentCount, inFormat, gGetTimeNS() };
+	return record;
+}
+
+
+
+/**
+@brief Publish the record
+**/
+void Log::sEndRecord(LogBuffer* inBuffer, uint8_t* inRecord)
+{
+	const LogRecord& record = *(const LogRecord*)inRecord;
+
+	if (inBuffer == nullptr)
+	{
+		// Synchronous fallback after the logger was destroyed
+		String text = sFormat(record.mFormat, inRecord + sizeof(LogRecord), record.mSize - sizeof(LogRecord));
+		if (record.mLevel != ELogLevel::Info)
+			printf("[%s] ", sGetLevelName(record.mLevel));
+		fwrite(text.data(), 1, text.size(), stdout);
+		delete[] inRecord;
+		return;
+	}
+
+	inBuffer->mWritten.store(inBuffer->mWritten.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	inBuffer->mBytes.store(inBuffer->mBytes.load(std::memory_order_relaxed) + record.mSize, std::memory_order_relaxed);
+	inBuffer->End();
+
+	// Do not wait for the interval when the ring is filling up
+	if (inBuffer->IsHalfFull())
+		sGetState().mWake.notify_one();
+}
+
+
+
+/**
+@brief Write binary records to @a inPath from now on
+**/
+bool Log::sOpenBinary(const char* inPath)
+{
+	LogState& state = sGetState();
+	std::lock_guard<std::mutex> lock(state.mMutex);
+
+	// Everything queued so far goes to the old output
+	sDrain(state);
+	if (state.mBinaryFile != nullptr)
+	{
+		fclose(state.mBinaryFile);
+		state.mBinaryFile = nullptr;
+	}
+	state.mFormatIDs.clear();
+
+	if (inPath == nullptr)
+		return true;
+
+	state.mBinaryFile = gOpenFile(inPath, "wb");
+	if (state.mBinaryFile == nullptr)
+		return false;
+	fwrite(cLogFileMagic, 1, sizeof(cLogFileMagic), state.mBinaryFile);
+	return true;
+}
+
+
+
+/**
+@brief Write every message queued so far
+**/
+void Log::sFlush()
+{
+	if (gLogDestroyed)
+		return;
+
+	LogState& state = sGetState();
+	std::lock_guard<std::mutex> lock(state.mMutex);
+	sDrain(state);
+}
+
+
+
+/**
+@brief Flush and stop the background thread
+**/
+void Log::sShutdown()
+{
+	if (!gLogDestroyed)
+		sStopFlusher(sGetState());
+}
+
+
+
+/**
+@brief Counters of all threads together
+**/
+LogStats Log::sGetStats()
+{
+	LogStats stats;
+	if (gLogDestroyed)
+		return stats;
+
+	LogState& state = sGetState();
+	std::lock_guard<std::mutex> lock(state.mMutex);
+	stats.mWritten = state.mRetiredWritten;
+	stats.mBytes = state.mRetiredBytes;
+	stats.mDropped = state.mRetiredDropped;
+	for (const AlignedPtr<LogBuffer>& buffer : state.mBuffers)
+	{
+		stats.mWritten += buffer->mWritten.load(std::memory_order_relaxed);
+		stats.mBytes += buffer->mBytes.load(std::memory_order_relaxed);
+		stats.mDropped += buffer->mDropped.load(std::memory_order_relaxed);
+	}
+	stats.mThreads = state.mThreadCount;
+	return stats;
+}
+
+
+
+/**
+@brief Name of @a inLevel
+**/
+const char* Log::sGetLevelName(ELogLevel inLevel)
+{
+	switch (inLevel)
+	{
+		case ELogLevel::Trace:		return "TRACE";
+		case ELogLevel::Debug:		return "DEBUG";
+		case ELogLevel::Info:		return "INFO";
+		case ELogLevel::Warning:	return "WARNING";
+		case ELogLevel::Error:		return "ERROR";
+		case ELogLevel::Off:		break;
+	}
+	return "?";
+}
+
+
+
+/**
+@brief Reads encoded arguments back in order
+**/
+class LogArgumentReader
+{
+public:
+	///@name Construction
+							LogArgumentReader(const uint8_t* inData, size_t inSize) :	mData(inData), mEnd(inData + inSize) { }
+
+	///@name Reading, every function converts what is stored to the requested type
+	bool					Next(ELogArgument& outType, uint64_t& outBits, const char*& outString);	///< Read the next argument, false if there is none left
+	int64_t					NextSigned();
+	uint64_t				NextUnsigned()						{ return (uint64_t)NextSigned(); }
+	double					NextDouble();
+	const char*				NextString();
+	const void*				NextPointer()						{ return (const void*)(uintptr_t)NextSigned(); }
+
+private:
+	const uint8_t*			mData;
+	const uint8_t*			mEnd;
+};
+
+
+
+/**
+@brief Read the next argument
+**/
+bool LogArgumentReader::Next(ELogArgument& outType, uint64_t& outBits, const char*& outString)
+{
+	if (mData >= mEnd)
+		return false;
+
+	outType = (ELogArgument)*mData;
+	if (outType == ELogArgument::String)
+	{
+		uint32_t length;
+		if (mEnd - mData < 6)
+			return false;
+		memcpy(&length, mData + 1, 4);
+		if ((size_t)(mEnd - mData) < 6 + (size_t)length)
+			return false;
+		outString = (const char*)mData + 5;
+		outBits = 0;
+		mData += 6 + length;
+		return true;
+	}
+
+	if (mEnd - mData < 9)
+		return false;
+	memcpy(&outBits, mData + 1, 8);
+	outString = nullptr;
+	mData += 9;
+	return true;
+}
+
+int64_t LogArgumentReader::NextSigned()
+{
+	ELogArgument type;
+	uint64_t bits;
+	const char* string;
+	if (!Next(type, bits, string))
+		return 0;
+	if (type == ELogArgument::Double)
+	{
+		double value;
+		memcpy(&value, &bits, 8);
+		return (int64_t)value;
+	}
+	return (int64_t)bits;
+}
+
+double LogArgumentReader::NextDouble()
+{
+	ELogArgument type;
+	uint64_t bits;
+	const char* string;
+	if (!Next(type, bits, string))
+		return 0.0;
+	if (type == ELogArgument::Double)
+	{
+		double value;
+		memcpy(&value, &bits, 8);
+		return value;
+	}
+	return type == ELogArgument::Signed ? (double)(int64_t)bits : (double)bits;
+}
+
+const char* LogArgumentReader::NextString()
+{
+	ELogArgument type;
+	uint64_t bits;
+	const char* string;
+	if (!Next(type, bits, string))
+		return "(missing)";
+	return type == ELogArgument::String ? string : "(?)";
+}
+
+
+
+/**
+@brief Format one conversion with its optional * width and precision
+**/
+template<class T>
+static void sAppendConversion(String& ioText, const char* inSpecification, const int* inStars, int inStarCount, T inValue)
+{
+	switch (inStarCount)
+	{
+		case 0:		ioText += gFormat(inSpecification, inValue);							break;
+		case 1:		ioText += gFormat(inSpecification, inStars[0], inValue);				break;
+		default:	ioText += gFormat(inSpecification, inStars[0], inStars[1], inValue);	break;
+	}
+}
+
+
+
+/**
+@brief Format a message like printf from its encoded arguments
+
+Length modifiers of the format are ignored, integers were widened to 64 bits when they were encoded.
+**/
+String Log::sFormat(const char* inFormat, const uint8_t* inArguments, size_t inSize)
+{
+	LogArgumentReader reader(inArguments, inSize);
+	String text;
+
+	const char* format = inFormat;
+	for (;;)
+	{
+		const char* percent = strchr(format, '%');
+		if (percent == nullptr)
+		{
+			text += format;
+			return text;
+		}
+		text.append(format, percent - format);
+
+		const char* p = percent + 1;
+		if (*p == '%')
+		{
+			text += '%';
+			format = p + 1;
+			continue;
+		}
+
+		// Copy flags, width and precision into a specification of our own, taking * values from the arguments
+		char specification[32];
+		size_t length = 0;
+		int stars[2];
+		int star_count = 0;
+		specification[length++] = '%';
+		while (*p != 0 && strchr("-+ #0", *p) != nullptr && length < 8)
+			specification[length++] = *p++;
+		for (int part = 0; part < 2; ++part)
+		{
+			if (part == 1)
+			{
+				if (*p != '.')
+					break;
+				specification[length++] = *p++;
+			}
+			if (*p == '*')
+			{
+				stars[star_count++] = (int)reader.NextSigned();
+				specification[length++] = *p++;
+			}
+			else
+				for (int digits = 0; *p >= '0' && *p <= '9'; ++digits, ++p)
+					if (digits < 6)
+						specification[length++] = *p;
+		}
+
+		// Skip the length modifier, including the MSVC I32 and I64
+		while (*p != 0 && strchr("hljztLqI", *p) != nullptr)
+			if (*p++ == 'I' && ((p[0] == '3' && p[1] == '2') || (p[0] == '6' && p[1] == '4')))
+				p += 2;
+
+		char conversion = *p;
+		if (conversion == 0)
+			return text;
+		format = p + 1;
+
+		switch (conversion)
+		{
+			case 'd':
+			case 'i':
+				memcpy(specification + length, "ll", 2);
+				specification[length + 2] = conversion;
+				specification[length + 3] = 0;
+				sAppendConversion(text, specification, stars, star_count, (long long)reader.NextSigned());
+				break;
+
+			case 'o':
+			case 'u':
+			case 'x':
+			case 'X':
+				memcpy(specification + length, "ll", 2);
+				specification[length + 2] = conversion;
+				specification[length + 3] = 0;
+				sAppendConversion(text, specification, stars, star_count, (unsigned long long)reader.NextUnsigned());
+				break;
+
+			case 'c':
+				specification[length] = conversion;
+				specification[length + 1] = 0;
+				sAppendConversion(text, specification, stars, star_count, (int)reader.NextSigned());
+				break;
+
+			case 'e':
+			case 'E':
+			case 'f':
+			case 'F':
+			case 'g':
+			case 'G':
+			case 'a':
+			case 'A':
+				specification[length] = conversion;
+				specification[length + 1] = 0;
+				sAppendConversion(text, specification, stars, star_count, reader.NextDouble());
+				break;
+
+			case 's':
+				specification[length] = conversion;
+				specification[length + 1] = 0;
+				sAppendConversion(text, specification, stars, star_count, reader.NextString());
+				break;
+
+			case 'p':
+				specification[length] = conversion;
+				specification[length + 1] = 0;
+				sAppendConversion(text, specification, stars, star_count, reader.NextPointer());
+				break;
+
+			default:
+				// Unknown conversion, keep it as it is
+				text.append(percent, format - percent);
+				break;
+		}
+	}
+}
@@ -0,0 +1,272 @@
+#pragma once
+
+// Additional includes
+#include "String.h"
+
+// STL includes
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+
+
+/**
+@brief Severity of a log message
+**/
+enum class ELogLevel : uint8_t
+{
+	Trace,
+	Debug,
+	Info,			///< gLog
+	Warning,
+	Error,
+	Off,			///< Only for WINDOW_LOG_LEVEL, compiles out every message
+};
+
+
+
+/**
+@brief Lowest level that is compiled in, messages below it cost nothing (their arguments are not even evaluated)
+
+Define WINDOW_LOG_LEVEL as the number of an ELogLevel to override, e.g. 3 to keep only warnings and errors.
+**/
+#ifndef WINDOW_LOG_LEVEL
+	#ifdef _DEBUG
+		#define WINDOW_LOG_LEVEL	1
+	#else
+		#define WINDOW_LOG_LEVEL	2
+	#endif
+#endif
+
+
+
+/**
+@brief Logging macros, printf style formats and arguments
+
+gLogWarning("Window %u has no framebuffer\n", id);
+
+Messages are formatted and written on a background thread, so the calling thread only copies its arguments.
+Every message of a thread comes out in order, messages of different threads are ordered by time.
+**/
+#define gLogAt(inLevel, ...)	Log::sWrite(inLevel, __VA_ARGS__)
+
+#if WINDOW_LOG_LEVEL <= 0
+	#define gLogTrace(...)		gLogAt(ELogLevel::Trace, __VA_ARGS__)
+#else
+	#define gLogTrace(...)		((void)0)
+#endif
+
+#if WINDOW_LOG_LEVEL <= 1
+	#define gLogDebug(...)		gLogAt(ELogLevel::Debug, __VA_ARGS__)
+#else
+	#define gLogDebug(...)		((void)0)
+#endif
+
+#if WINDOW_LOG_LEVEL <= 2
+	#define gLogInfo(...)		gLogAt(ELogLevel::Info, __VA_ARGS__)
+#else
+	#define gLogInfo(...)		((void)0)
+#endif
+
+#if WINDOW_LOG_LEVEL <= 3
+	#define gLogWarning(...)	gLogAt(ELogLevel::Warning, __VA_ARGS__)
+#else
+	#define gLogWarning(...)	((void)0)
+#endif
+
+#if WINDOW_LOG_LEVEL <= 4
+	#define gLogError(...)		gLogAt(ELogLevel::Error, __VA_ARGS__)
+#else
+	#define gLogError(...)		((void)0)
+#endif
+
+#define gLog(...)				gLogInfo(__VA_ARGS__)
+
+
+
+/**
+@brief Header of a message in a log buffer, followed by its encoded arguments (see LogArgument)
+**/
+struct LogRecord
+{
+	uint32_t			mSize;								///< Bytes of the record including this header, a multiple of 8
+	ELogLevel			mLevel;								///< Level, ELogLevel::Off for the padding at the end of a buffer
+	uint8_t				mArgumentCount;						///< Amount of encoded arguments
+	const char*			mFormat;							///< Format string, must be a literal (or otherwise outlive the log)
+	uint64_t			mTimeNS;							///< gGetTimeNS when the message was written
+};
+
+
+
+/**
+@brief How an argument is encoded: a type byte and 8 bytes, or for strings a type byte, a uint32 length and the zero terminated bytes
+**/
+enum class ELogArgument : uint8_t
+{
+	Signed = 1,
+	Unsigned,
+	Double,
+	String,
+	Pointer,
+};
+
+
+
+/**
+@brief Encoding of the argument types printf accepts, other types do not compile
+**/
+template<class T, class = void>
+struct LogArgument;
+
+template<class T>
+struct LogArgument<T, typename std::enable_if<(std::is_integral<T>::value && std::is_signed<T>::value) || std::is_enum<T>::value>::type>
+{
+	static size_t		sGetSize(T)							{ return 9; }
+	static uint8_t*		sEncode(uint8_t* ioOut, T inValue)	{ int64_t value = (int64_t)inValue; *ioOut = (uint8_t)ELogArgument::Signed; memcpy(ioOut + 1, &value, 8); return ioOut + 9; }
+};
+
+template<class T>
+struct LogArgument<T, typename std::enable_if<std::is_integral<T>::value && std::is_unsigned<T>::value>::type>
+{
+	static size_t		sGetSize(T)							{ return 9; }
+	static uint8_t*		sEncode(uint8_t* ioOut, T inValue)	{ uint64_t value = (uint64_t)inValue; *ioOut = (uint8_t)ELogArgument::Unsigned; memcpy(ioOut + 1, &value, 8); return ioOut + 9; }
+};
+
+template<class T>
+struct LogArgument<T, typename std::enable_if<std::is_floating_point<T>::value>::type>
+{
+	static size_t		sGetSize(T)							{ return 9; }
+	static uint8_t*		sEncode(uint8_t* ioOut, T inValue)	{ double value = (double)inValue; *ioOut = (uint8_t)ELogArgument::Double; memcpy(ioOut + 1, &value, 8); return ioOut + 9; }
+};
+
+template<>
+struct LogArgument<const char*>
+{
+	static constexpr uint32_t cMaxLength = 4096;			///< Longer strings are cut off
+
+	static uint32_t		sGetLength(const char* inValue)		{ if (inValue == nullptr) return 6; size_t length = strlen(inValue); return length < cMaxLength ? (uint32_t)length : cMaxLength; }
+	static size_t		sGetSize(const char* inValue)		{ return 6 + sGetLength(inValue); }
+	static uint8_t*		sEncode(uint8_t* ioOut, const char* inValue, uint32_t inLength);
+	static uint8_t*		sEncode(uint8_t* ioOut, const char* inValue)	{ return sEncode(ioOut, inValue, sGetLength(inValue)); }
+};
+
+inline uint8_t* LogArgument<const char*>::sEncode(uint8_t* ioOut, const char* inValue, uint32_t inLength)
+{
+	*ioOut = (uint8_t)ELogArgument::String;
+	memcpy(ioOut + 1, &inLength, 4);
+	memcpy(ioOut + 5, inValue != nullptr ? inValue : "(null)", inLength);
+	ioOut[5 + inLength] = 0;
+	return ioOut + 6 + inLength;
+}
+
+template<>
+struct LogArgument<char*> : LogArgument<const char*> { };
+
+template<class Alloc>
+struct LogArgument<BasicString<char, Alloc>>
+{
+	static uint32_t		sGetLength(const BasicString<char, Alloc>& inValue)	{ return inValue.size() < LogArgument<const char*>::cMaxLength ? (uint32_t)inValue.size() : LogArgument<const char*>::cMaxLength; }
+	static size_t		sGetSize(const BasicString<char, Alloc>& inValue)	{ return 6 + sGetLength(inValue); }
+	static uint8_t*		sEncode(uint8_t* ioOut, const BasicString<char, Alloc>& inValue)	{ return LogArgument<const char*>::sEncode(ioOut, inValue.c_str(), sGetLength(inValue)); }
+};
+
+template<class T>
+struct LogArgument<T*, typename std::enable_if<!std::is_same<typename std::remove_cv<T>::type, char>::value>::type>
+{
+	static size_t		sGetSize(const T*)					{ return 9; }
+	static uint8_t*		sEncode(uint8_t* ioOut, const T* inValue)	{ uint64_t value = (uint64_t)(uintptr_t)inValue; *ioOut = (uint8_t)ELogArgument::Pointer; memcpy(ioOut + 1, &value, 8); return ioOut + 9; }
+};
+
+
+
+/**
+@brief Log counters, see Log::sGetStats
+**/
+struct LogStats
+{
+	uint64_t			mWritten		= 0;				///< Messages accepted
+	uint64_t			mDropped		= 0;				///< Messages lost because the buffer of their thread was full
+	uint64_t			mBytes			= 0;				///< Bytes of the accepted records
+	uint32_t			mThreads		= 0;				///< Threads that have a log buffer
+};
+
+
+
+/**
+@brief Binary log file layout, written after Log::sOpenBinary and read by the LogDecoder tool
+
+The file starts with cLogFileMagic, then a sequence of chunks that each start with an ELogChunk byte.
+All integers are little endian.
+**/
+static constexpr char	cLogFileMagic[8] = "WVLOG01";
+
+enum class ELogChunk : uint8_t
+{
+	Format = 1,			///< uint32 format ID, uint32 length, the format string (sent once per format before its first message)
+	Message,			///< uint32 format ID, uint8 level, uint32 thread, uint64 time in ns, uint8 argument count, uint32 argument bytes, the encoded arguments
+	Dropped,			///< uint64 amount of messages lost since the previous Dropped chunk
+};
+
+
+
+/**
+@brief Asynchronous logger behind gLog
+
+Every thread writes its messages into its own lock-free ring buffer: a record with the format pointer, a
+timestamp and a binary copy of the arguments. A background thread drains the buffers, orders the messages
+by time and formats them to stdout with a single write, or writes them to a compact binary file in which
+every format string is stored only once. A thread only waits when its buffer is full, and drops (and counts)
+the message if the flusher did not make room within 100 ms. The logger starts on the first message and
+flushes at exit.
+**/
+class LogBuffer;
+class Log
+{
+public:
+	///@name Writing (any thread)
+	template<class... A>
+	static void			sWrite(ELogLevel inLevel, const char* inFormat, const A&... inArgs);	///< Queue a message, use the gLog macros instead so levels can be compiled out
+
+	///@name Output (any thread)
+	static bool			sOpenBinary(const char* inPath);	///< Write binary records to @a inPath from now on, nullptr switches back to text on stdout
+	static void			sFlush();							///< Write every message queued so far before returning
+	static void			sShutdown();						///< Flush and stop the background thread, the next message starts it again
+	static LogStats		sGetStats();						///< Counters of all threads together
+
+	///@name Decoding
+	static String		sFormat(const char* inFormat, const uint8_t* inArguments, size_t inSize);	///< Format a message like printf from its encoded arguments
+	static const char*	sGetLevelName(ELogLevel inLevel);	///< Name of @a inLevel, e.g. "WARNING"
+
+private:
+	///@name Records
+	static uint8_t*		sBeginRecord(ELogLevel inLevel, const char* inFormat, uint8_t inArgumentCount, size_t inSize, LogBuffer*& outBuffer);	///< Claim a record of @a inSize bytes and fill in its header, nullptr if the message is dropped
+	static void			sEndRecord(LogBuffer* inBuffer, uint8_t* inRecord);	///< Publish the record
+};
+
+
+
+/**
+@brief Queue a message
+**/
+template<class... A>
+void Log::sWrite(ELogLevel inLevel, const char* inFormat, const A&... inArgs)
+{
+	// Size the record, arrays decay so string literals are encoded as strings
+	size_t sizes[] = { sizeof(LogRecord), LogArgument<typename std::decay<A>::type>::sGetSize(inArgs)... };
+	size_t size = 0;
+	for (size_t argument_size : sizes)
+		size += argument_size;
+	size = (size + 7) & ~(size_t)7;
+
+	LogBuffer* buffer;
+	uint8_t* out = sBeginRecord(inLevel, inFormat, (uint8_t)sizeof...(A), size, buffer);
+	if (out == nullptr)
+		return;
+
+	uint8_t* record = out;
+	out += sizeof(LogRecord);
+	int encode[] = { 0, (out = LogArgument<typename std::decay<A>::type>::sEncode(out, inArgs), 0)... };
+	(void)encode;
+
+	sEndRecord(buffer, record);
+}
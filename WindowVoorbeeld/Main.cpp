@@ -2,6 +2,8 @@
 #include "Utility.h"
 #include "Input.h"
 #include "Window.h"
+#include "HelloWindow.h"
+#include "PlatformHeadless.h"
 
 
 
@@ -15,6 +17,15 @@ public:
 	{
 		// Init D3D11
 		gLog("[CREATE] \tInitialized D3D11\n");
+
+		// Render on a separate thread, so a slow frame does not block input on the other windows
+		EnableRenderThread();
+	}
+
+	virtual void OnResize(int inWidth, int inHeight) override
+	{
+		// Resize the swap chain
+		gLog("[RESIZE] \t%dx%d\n", inWidth, inHeight);
 	}
 
 	virtual void OnPaint() override 
@@ -36,42 +47,9 @@ private:
 
 
 /**
-@brief Hello World window
+@brief Main window, its behavior is added by subscribing to its events in main
 **/
-class HelloWindow : public Window 
-{
-	virtual void OnCreate() override
-	{
-		gLog("Hello, World!\n");
-	}
-
-	virtual bool OnMouseDown() override 
-	{
-		// Only respond on CTRL + Click
-		if (Input::sIsDown(KEY_CTRL | MOUSE_R))
-			gLog("Party Time!\n");
-		else
-			gLog("Lame party");
-
-		return true;
-	}
-};
-
-
-
-/**
-@brief Main window
-**/
-class MainWindow : public Window
-{
-	virtual void OnDestroy() override 
-	{
-		gLog("Destroying main window destroys all!\n");
-
-		// OnDestroy quits the entire application!
-		gQuitApplication();
-	}
-};
+class MainWindow : public Window { };
 
 
 
@@ -88,12 +66,24 @@ int main()
 
 	// As another example, create a main window class that destroys all other windows when destroyed
 	MainWindow* main_window = Window::sCreate<MainWindow>({50, 50, 1820, 980}, "Main Window");
+	main_window->GetEvents().mDestroy.Subscribe([]()
+	{
+		gLog("Destroying main window destroys all!\n");
+
+		// Destroying the main window quits the entire application!
+		gQuitApplication();
+	});
 
 	// Show the windows in this order: MainWindow > Viewport > Hello, Window!
 	main_window->ShowAndActivate();
 	viewport_window->ShowAndActivate();
 	hello_window->ShowAndActivate();
 
+#ifdef WINDOW_PLATFORM_HEADLESS
+	// There is no desktop to close windows with, so close the main window right away to end the application
+	Headless::sPostClose(main_window);
+#endif
+
 	// Start the window message loop. This will run forever until all windows are closed.
 	gProcessMessageLoop();
 
@@ -0,0 +1,110 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+
+
+/**
+@brief Map the file at @a inPath, false if it can't be opened
+**/
+bool MappedFile::Open(const char* inPath)
+{
+	Close();
+
+#ifdef _WIN32
+	HANDLE file = CreateFileA(inPath, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size) || (uint64_t)size.QuadPart > (uint64_t)SIZE_MAX)
+	{
+		CloseHandle(file);
+		return false;
+	}
+
+	// A mapping of an empty file can't be created, there is nothing to map either
+	if (size.QuadPart > 0)
+	{
+		HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		const void* data = mapping != nullptr ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+		if (data == nullptr)
+		{
+			if (mapping != nullptr)
+				CloseHandle(mapping);
+			CloseHandle(file);
+			return false;
+		}
+		mMapping = mapping;
+		mData = (const uint8_t*)data;
+	}
+	mFile = file;
+	mSize = (size_t)size.QuadPart;
+#else
+	int file = open(inPath, O_RDONLY);
+	if (file < 0)
+		return false;
+
+	struct stat status;
+	if (fstat(file, &status) != 0)
+	{
+		close(file);
+		return false;
+	}
+
+	// mmap fails for a length of 0, there is nothing to map either
+	if (status.st_size > 0)
+	{
+		void* data = mmap(nullptr, (size_t)status.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+		if (data == MAP_FAILED)
+		{
+			close(file);
+			return false;
+		}
+		madvise(data, (size_t)status.st_size, MADV_SEQUENTIAL);
+		mData = (const uint8_t*)data;
+	}
+
+	// The mapping stays valid after closing the file
+	close(file);
+	mSize = (size_t)status.st_size;
+#endif
+
+	mOpen = true;
+	return true;
+}
+
+
+
+/**
+@brief Unmap the file
+**/
+void MappedFile::Close()
+{
+	if (!mOpen)
+		return;
+
+#ifdef _WIN32
+	if (mData != nullptr)
+		UnmapViewOfFile(mData);
+	if (mMapping != nullptr)
+		CloseHandle(mMapping);
+	CloseHandle(mFile);
+	mFile = nullptr;
+	mMapping = nullptr;
+#else
+	if (mData != nullptr)
+		munmap((void*)mData, mSize);
+#endif
+
+	mData = nullptr;
+	mSize = 0;
+	mOpen = false;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+// Additional includes
+#include "Utility.h"
+
+
+
+/**
+@brief Read only memory mapping of a whole file
+
+The operating system pages the file in on demand, so even large files open instantly and reading them
+does not copy them through a buffer.
+**/
+class MappedFile
+{
+public:
+	///@name Construction
+							MappedFile() = default;
+							~MappedFile()						{ Close(); }
+
+							MappedFile(const MappedFile&) = delete;
+	MappedFile&				operator=(const MappedFile&) = delete;
+
+	///@name Mapping
+	bool					Open(const char* inPath);			///< Map the file at @a inPath, false if it can't be opened
+	void					Close();							///< Unmap the file
+
+	///@name Properties
+	bool					IsOpen() const						{ return mOpen; }
+	const uint8_t*			GetData() const						{ return mData; }	///< Contents of the file, nullptr for an empty file
+	size_t					GetSize() const						{ return mSize; }	///< Size of the file in bytes
+
+private:
+	///@name Properties
+	const uint8_t*			mData = nullptr;
+	size_t					mSize = 0;
+	bool					mOpen = false;
+#ifdef _WIN32
+	void*					mFile = nullptr;					///< File handle
+	void*					mMapping = nullptr;					///< File mapping handle, nullptr for an empty file
+#endif
+};
@@ -0,0 +1,340 @@
+#include "MessageLoop.h"
+
+// STL includes
+#include <atomic>
+#include <thread>
+
+// Additional includes
+#include "Histogram.h"
+#include "Input.h"
+#include "JobSystem.h"
+#include "Platform.h"
+#include "Pointer.h"
+#include "Profiler.h"
+#include "Recorder.h"
+
+
+
+/**
+@brief Loop state
+**/
+static LoopStats				gLoopStats;						///< Statistics of the running (or last) loop
+static bool						gLoopRunning = false;			///< True while gProcessMessageLoop runs
+static double					gLoopStartTime = 0.0;			///< Time the loop started in seconds
+static double					gLoopStartCPUTime = 0.0;		///< CPU time of the loop thread when the loop started
+static std::atomic<uint64_t>	gWakeRequestTime { 0 };			///< Time of the oldest unhandled wakeup request in nanoseconds, 0 if there is none
+static Histogram				gFrameTimes;					///< Nanoseconds from frame start to frame start of the paced policies
+
+
+
+/**
+@brief Helper class to accumulate wake latency samples
+**/
+class WakeLatency
+{
+public:
+	void Add(double inSeconds)
+	{
+		mTotal += inSeconds;
+		++mSamples;
+		if (inSeconds > gLoopStats.mMaxWakeLatency)
+			gLoopStats.mMaxWakeLatency = inSeconds;
+		gLoopStats.mAverageWakeLatency = mTotal / mSamples;
+	}
+
+private:
+	double		mTotal		= 0.0;
+	uint64_t	mSamples	= 0;
+};
+
+
+
+/**
+@brief Fill in the wall and CPU time of the loop, must be called from the loop thread
+**/
+static void sUpdateTimes(LoopStats& ioStats)
+{
+	ioStats.mWallTime = gGetTime() - gLoopStartTime;
+	ioStats.mCPUTime = gPlatformGetThreadCPUTime() - gLoopStartCPUTime;
+	ioStats.mCPUUsage = ioStats.mWallTime > 0.0 ? ioStats.mCPUTime / ioStats.mWallTime : 0.0;
+
+	ioStats.mAverageFrameTime = gFrameTimes.GetMean() * 1e-9;
+	ioStats.mMedianFrameTime = gFrameTimes.GetPercentile(50.0) * 1e-9;
+	ioStats.mP99FrameTime = gFrameTimes.GetPercentile(99.0) * 1e-9;
+	ioStats.mMaxFrameTime = gFrameTimes.GetMax() * 1e-9;
+}
+
+
+
+/**
+@brief Consume the pending wakeup request and record its latency
+**/
+static void sConsumeWakeRequest(WakeLatency& ioLatency)
+{
+	uint64_t request_time = gWakeRequestTime.exchange(0);
+	if (request_time != 0)
+	{
+		uint64_t now = gGetTimeNS();
+		ioLatency.Add(now > request_time ? (now - request_time) * 1e-9 : 0.0);
+	}
+}
+
+
+
+/**
+@brief Close the frame of the messages dispatched so far
+**/
+void gEndFrame()
+{
+	// Continuations of jobs run between messages, like any other window event
+	JobSystem::sRunMainThreadJobs();
+
+	// Every frame boundary delivers the pointer batches and publishes the input snapshot
+	Pointer::sEndFrame();
+	Input::sEndFrame();
+
+	// Paints that were held back by a reduced rate and are due now
+	gReleaseDeferredPaints();
+
+	if (Recorder::sIsRecording())
+		Recorder::sRecordFrame();
+}
+
+
+
+/**
+@brief Pump all pending messages and close the frame, returns false when the loop should stop
+**/
+static bool sPumpFrame()
+{
+	gProfileFrameBegin();
+	bool keep_running = gPlatformPumpMessages();
+	gEndFrame();
+	gProfileFrameEnd();
+	return keep_running;
+}
+
+
+
+/**
+@brief Poll: pump as fast as possible
+**/
+static void sRunPoll(WakeLatency& ioLatency)
+{
+	while (sPumpFrame())
+	{
+		++gLoopStats.mIterations;
+		sConsumeWakeRequest(ioLatency);
+	}
+}
+
+
+
+/**
+@brief Event driven: sleep until something arrives
+**/
+static void sRunEventDriven(WakeLatency& ioLatency)
+{
+	while (sPumpFrame())
+	{
+		++gLoopStats.mIterations;
+
+		// A wakeup that came in while pumping was already served
+		gWakeRequestTime.store(0);
+
+		// Sleep no longer than the next paint a reduced rate held back
+		gPlatformWaitForMessages(gGetDeferredPaintTimeout());
+		++gLoopStats.mWakeups;
+		sConsumeWakeRequest(ioLatency);
+	}
+}
+
+
+
+/**
+@brief Wait for the frame @a ioDeadline: sleep for most of the remaining frame and spin for the tail end, then schedule the next frame
+**/
+static void sWaitForFrame(const LoopSettings& inSettings, double inFrameTime, double& ioDeadline, WakeLatency& ioLatency)
+{
+	// Sleep coarsely, the OS scheduler may oversleep so stop a bit before the deadline
+	double sleep_time = ioDeadline - gGetTime() - inSettings.mSpinTail;
+	if (sleep_time > 0.0)
+	{
+		gPlatformSleep(sleep_time);
+		++gLoopStats.mWakeups;
+	}
+
+	// Spin for the tail end of the frame
+	double now = gGetTime();
+	while (now < ioDeadline)
+	{
+		std::this_thread::yield();
+		now = gGetTime();
+	}
+
+	// The latency is how late we are for the frame
+	ioLatency.Add(now - ioDeadline);
+
+	// Schedule the next frame, if we fell more than a frame behind do not try to catch up
+	ioDeadline += inFrameTime;
+	if (now > ioDeadline)
+		ioDeadline = now + inFrameTime;
+}
+
+
+
+/**
+@brief Time since the start of the previous frame, recorded in the frame time statistics
+**/
+static uint64_t sBeginFrame(uint64_t& ioFrameStart)
+{
+	uint64_t now = gGetTimeNS();
+	uint64_t frame_time = now - ioFrameStart;
+	ioFrameStart = now;
+	gFrameTimes.Record(frame_time);
+	return frame_time;
+}
+
+
+
+/**
+@brief Fixed rate: pump once per frame
+**/
+static void sRunFixedRate(const LoopSettings& inSettings, WakeLatency& ioLatency)
+{
+	double frame_time = inSettings.mTargetFrameRate > 0.0 ? 1.0 / inSettings.mTargetFrameRate : 0.0;
+	double deadline = gGetTime() + frame_time;
+	uint64_t frame_start = gGetTimeNS();
+
+	while (sPumpFrame())
+	{
+		++gLoopStats.mIterations;
+		gWakeRequestTime.store(0);
+
+		sWaitForFrame(inSettings, frame_time, deadline, ioLatency);
+		sBeginFrame(frame_start);
+	}
+}
+
+
+
+/**
+@brief Fixed update: pump once per frame, then update with a fixed time step until the simulation caught up with the clock and render
+**/
+static void sRunFixedUpdate(const LoopSettings& inSettings, WakeLatency& ioLatency)
+{
+	double frame_time = inSettings.mTargetFrameRate > 0.0 ? 1.0 / inSettings.mTargetFrameRate : 0.0;
+	double deadline = gGetTime() + frame_time;
+
+	// The clock is accumulated in integer nanoseconds, so it does not drift over long sessions
+	uint64_t step = std::max<uint64_t>(1, (uint64_t)(1.0e9 / std::max(inSettings.mUpdateRate, 1.0e-3)));
+	double step_time = step * 1e-9;
+	uint64_t frame_start = gGetTimeNS();
+	uint64_t accumulator = 0;
+
+	while (sPumpFrame())
+	{
+		++gLoopStats.mIterations;
+		gWakeRequestTime.store(0);
+
+		// Steps due since the last frame, a frame that fell too far behind drops the rest
+		accumulator += sBeginFrame(frame_start);
+		uint64_t due = accumulator / step;
+		uint32_t updates = (uint32_t)std::min<uint64_t>(due, inSettings.mMaxUpdatesPerFrame);
+		accumulator -= due * step;
+		gLoopStats.mDroppedUpdates += due - updates;
+		gLoopStats.mMaxFrameUpdates = std::max(gLoopStats.mMaxFrameUpdates, updates);
+
+		uint64_t update_start = gGetTimeNS();
+		for (uint32_t i = 0; i < updates; ++i)
+			gUpdateWindows(step_time);
+		gLoopStats.mUpdates += updates;
+
+		// The fraction of a step the clock is ahead of the simulation
+		uint64_t render_start = gGetTimeNS();
+		gRenderWindows((double)accumulator / step);
+		uint64_t render_end = gGetTimeNS();
+		gLoopStats.mUpdateTime += (render_start - update_start) * 1e-9;
+		gLoopStats.mRenderTime += (render_end - render_start) * 1e-9;
+
+		if (frame_time > 0.0)
+			sWaitForFrame(inSettings, frame_time, deadline, ioLatency);
+	}
+}
+
+
+
+/**
+@brief Start the message loop for every created window
+**/
+void gProcessMessageLoop(const LoopSettings& inSettings)
+{
+	gLoopStats = LoopStats();
+	gLoopStats.mPolicy = inSettings.mPolicy;
+	gLoopStartTime = gGetTime();
+	gLoopStartCPUTime = gPlatformGetThreadCPUTime();
+	gFrameTimes.Reset();
+	gLoopRunning = true;
+
+	// The loop owns the job system, start it now in case no window forked a job yet
+	JobSystem::sInit();
+
+	WakeLatency latency;
+	switch (inSettings.mPolicy)
+	{
+		case ELoopPolicy::Poll:			sRunPoll(latency);						break;
+		case ELoopPolicy::EventDriven:	sRunEventDriven(latency);				break;
+		case ELoopPolicy::FixedRate:	sRunFixedRate(inSettings, latency);		break;
+		case ELoopPolicy::FixedUpdate:	sRunFixedUpdate(inSettings, latency);	break;
+	}
+
+	gLoopRunning = false;
+	sUpdateTimes(gLoopStats);
+
+	// Stop painting first, a render thread forks and waits on jobs until its last frame
+	gStopRenderThreads();
+
+	// Finish the jobs while the windows they may reference are still alive
+	JobSystem::sShutdown();
+
+	// Delete all windows
+	gDeleteAllWindows();
+}
+
+
+
+/**
+@brief Wake up a sleeping message loop
+**/
+void gWakeMessageLoop()
+{
+	// Only the oldest request is timed, later ones are served by the same wakeup
+	uint64_t expected = 0;
+	gWakeRequestTime.compare_exchange_strong(expected, gGetTimeNS());
+	gPlatformWakeUp();
+}
+
+
+
+/**
+@brief Get the statistics of the running (or last) message loop
+**/
+LoopStats gGetLoopStats()
+{
+	LoopStats stats = gLoopStats;
+
+	// The times are only stored when the loop returns, so calculate them when called from inside the loop
+	if (gLoopRunning)
+		sUpdateTimes(stats);
+	return stats;
+}
+
+
+
+/**
+@brief Kill all windows and shut down the application
+**/
+void gQuitApplication()
+{
+	gPlatformPostQuit();
+}
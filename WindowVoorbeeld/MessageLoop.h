@@ -0,0 +1,132 @@
+#pragma once
+
+// Additional includes
+#include "Utility.h"
+
+
+
+/**
+@brief How gProcessMessageLoop waits for new messages
+**/
+enum class ELoopPolicy : uint8_t
+{
+	Poll,				///< Pump messages as fast as possible, keeps a full core busy
+	EventDriven,		///< Sleep until a message or a gWakeMessageLoop call arrives
+	FixedRate,			///< Pump messages once per frame at LoopSettings::mTargetFrameRate
+	FixedUpdate,		///< Like FixedRate, but every frame also runs Window::OnUpdate at LoopSettings::mUpdateRate and then Window::OnRender
+};
+
+
+
+/**
+@brief Settings for gProcessMessageLoop
+**/
+struct LoopSettings
+{
+	ELoopPolicy			mPolicy				= ELoopPolicy::EventDriven;	///< How to wait for messages
+	double				mTargetFrameRate	= 60.0;						///< Frames per second for ELoopPolicy::FixedRate and FixedUpdate, 0 runs frames back to back
+	double				mSpinTail			= 0.002;					///< Seconds before a frame deadline in which ELoopPolicy::FixedRate spins instead of sleeping
+	double				mUpdateRate			= 60.0;						///< Updates per second for ELoopPolicy::FixedUpdate, independent of the frame rate
+	uint32_t			mMaxUpdatesPerFrame	= 5;						///< Updates a frame may run to catch up with the clock, time beyond that is dropped so a slow frame can't snowball
+};
+
+
+
+/**
+@brief Statistics of the running (or last) message loop
+**/
+struct LoopStats
+{
+	ELoopPolicy			mPolicy				= ELoopPolicy::EventDriven;	///< Policy the loop runs with
+	uint64_t			mIterations			= 0;	///< Amount of pumps (frames for ELoopPolicy::FixedRate and FixedUpdate)
+	uint64_t			mWakeups			= 0;	///< Amount of times the loop woke up from sleeping
+	double				mWallTime			= 0.0;	///< Seconds spent in the loop
+	double				mCPUTime			= 0.0;	///< CPU seconds used by the loop thread
+	double				mCPUUsage			= 0.0;	///< mCPUTime / mWallTime, 1 means a full core
+	double				mAverageWakeLatency	= 0.0;	///< Average seconds between a wakeup request (or frame deadline) and the loop running again
+	double				mMaxWakeLatency		= 0.0;	///< Worst seconds between a wakeup request (or frame deadline) and the loop running again
+
+	///@name Frame times, ELoopPolicy::FixedRate and FixedUpdate only
+	double				mAverageFrameTime	= 0.0;	///< Average seconds from the start of one frame to the start of the next
+	double				mMedianFrameTime	= 0.0;
+	double				mP99FrameTime		= 0.0;	///< 99% of the frames took less seconds than this
+	double				mMaxFrameTime		= 0.0;
+
+	///@name Fixed timestep, ELoopPolicy::FixedUpdate only
+	uint64_t			mUpdates			= 0;	///< Amount of OnUpdate steps
+	uint64_t			mDroppedUpdates		= 0;	///< Steps skipped because a frame hit LoopSettings::mMaxUpdatesPerFrame, the simulation runs behind the clock by this many steps
+	uint32_t			mMaxFrameUpdates	= 0;	///< Most steps a single frame ran
+	double				mUpdateTime			= 0.0;	///< Seconds spent in OnUpdate
+	double				mRenderTime			= 0.0;	///< Seconds spent in OnRender
+};
+
+
+
+/**
+@brief Start the message loop for every created window
+
+This should be called in every application that uses windows, in order for them to function.
+Make sure this is called after creating all the windows.
+Windows created after this call will not be processed.
+
+Example application entry point:
+
+int main(int inArgC, char** inArgV)
+{
+	// Initialize the windows
+	WindowA window_a = Window::sCreate<WindowA>({100, 100, 500, 500}, "WindowA");
+	WindowB window_b = Window::sCreate<WindowB>({100, 100, 500, 500}, "WindowB");
+
+	// ...
+
+	gProcessMessageLoop();
+
+	// ...
+
+	return 0;
+}
+
+By default the loop sleeps while no messages arrive, pass LoopSettings to poll or to run at a fixed frame rate.
+For animation and simulation, ELoopPolicy::FixedUpdate runs every frame as: pump the messages, run
+Window::OnUpdate with a fixed time step as often as the clock requires, then Window::OnRender with the fraction
+of a step that is left to interpolate with. The simulation then advances at the same rate no matter how many
+messages arrive or how long a frame takes.
+**/
+extern void gProcessMessageLoop(const LoopSettings& inSettings = LoopSettings());
+
+
+
+/**
+@brief Close a frame: run the main thread jobs, deliver the pointer batches and publish the input snapshot
+
+gProcessMessageLoop calls this after every pump. Only call it yourself when dispatching messages without the loop,
+like Replayer does at the frame boundaries of a recording.
+**/
+extern void gEndFrame();
+
+
+
+/**
+@brief Wake up a sleeping message loop, can be called from any thread
+**/
+extern void gWakeMessageLoop();
+
+
+
+/**
+@brief Get the statistics of the running (or last) message loop
+
+Only call this from the message loop thread (e.g. in a window event) or after the loop returned.
+**/
+extern LoopStats gGetLoopStats();
+
+
+
+/**
+@brief Kill all windows and shut down the application
+
+WARNING:
+Use with great care! This will close the entire application!
+
+**/
+extern void gQuitApplication();
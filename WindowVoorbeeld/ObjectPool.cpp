@@ -0,0 +1,164 @@
+#include "ObjectPool.h"
+
+// STL includes
+#include <algorithm>
+#include <new>
+
+
+
+/**
+@brief Accumulate the counters of another pool
+**/
+PoolStats& PoolStats::operator+=(const PoolStats& inOther)
+{
+	mObjectSize		= std::max(mObjectSize, inOther.mObjectSize);
+	mCapacity		+= inOther.mCapacity;
+	mLive			+= inOther.mLive;
+	mPeakLive		+= inOther.mPeakLive;
+	mBlocks			+= inOther.mBlocks;
+	mAllocations	+= inOther.mAllocations;
+	mFrees			+= inOther.mFrees;
+	mReservedBytes	+= inOther.mReservedBytes;
+	return *this;
+}
+
+
+
+/**
+@brief Create an empty pool, no memory is allocated until the first object
+**/
+ObjectPool::ObjectPool(size_t inObjectSize, size_t inAlignment) :
+	mAlignment(std::max(inAlignment, alignof(void*)))
+{
+	// Every slot must be able to hold the free list link and keep the alignment of the next slot
+	mStride = std::max(inObjectSize, sizeof(void*));
+	mStride = (mStride + mAlignment - 1) & ~(mAlignment - 1);
+}
+
+
+
+/**
+@brief Free the blocks, objects that are still alive are not destructed
+**/
+ObjectPool::~ObjectPool()
+{
+	for (Block& block : mBlocks)
+		::operator delete(block.mMemory);
+}
+
+
+
+/**
+@brief Add a block and put its slots on the free list
+**/
+void ObjectPool::AllocateBlock()
+{
+	Block block;
+	block.mMemory	= (uint8_t*)::operator new(cBlockSize * mStride + mAlignment - 1);
+	block.mSlots	= (uint8_t*)(((uintptr_t)block.mMemory + mAlignment - 1) & ~(uintptr_t)(mAlignment - 1));
+
+	// Keep the blocks sorted on address for FindBlock and ForEach, blocks are added rarely
+	mBlocks.push_back(block);
+	Block* position = std::upper_bound(mBlocks.begin(), mBlocks.end() - 1, block.mSlots, [](const uint8_t* inSlots, const Block& inBlock) { return inSlots < inBlock.mSlots; });
+	std::rotate(position, mBlocks.end() - 1, mBlocks.end());
+
+	// Link back to front so the lowest address is handed out first
+	for (size_t i = cBlockSize; i-- > 0; )
+	{
+		void* slot = block.mSlots + i * mStride;
+		*(void**)slot = mFreeHead;
+		mFreeHead = slot;
+	}
+}
+
+
+
+/**
+@brief Block that contains @a inObject
+**/
+ObjectPool::Block& ObjectPool::FindBlock(void* inObject)
+{
+	// Binary search for the last block that starts at or before the object, so allocating and freeing stay cheap with many blocks
+	const uint8_t* object = (const uint8_t*)inObject;
+	Block* block = std::upper_bound(mBlocks.begin(), mBlocks.end(), object, [](const uint8_t* inObject, const Block& inBlock) { return inObject < inBlock.mSlots; });
+	gAssert(block != mBlocks.begin() && object < (block - 1)->mSlots + cBlockSize * mStride && "Object does not belong to this pool");
+	return *(block - 1);
+}
+
+
+
+/**
+@brief Get an uninitialized slot
+**/
+void* ObjectPool::Allocate()
+{
+	if (mFreeHead == nullptr)
+		AllocateBlock();
+
+	void* slot = mFreeHead;
+	mFreeHead = *(void**)slot;
+
+	Block& block = FindBlock(slot);
+	block.mLiveMask |= uint64_t(1) << (((uint8_t*)slot - block.mSlots) / mStride);
+
+	++mAllocations;
+	mPeakLive = std::max(mPeakLive, ++mLive);
+	return slot;
+}
+
+
+
+/**
+@brief Return the slot of @a inObject
+**/
+void ObjectPool::Free(void* inObject)
+{
+	if (inObject == nullptr)
+		return;
+
+	Block& block = FindBlock(inObject);
+	uint64_t bit = uint64_t(1) << (((uint8_t*)inObject - block.mSlots) / mStride);
+	gAssert((block.mLiveMask & bit) != 0);
+	block.mLiveMask &= ~bit;
+
+	// Recycle the slot first, it is most likely still in the cache
+	*(void**)inObject = mFreeHead;
+	mFreeHead = inObject;
+
+	++mFrees;
+	--mLive;
+}
+
+
+
+/**
+@brief Make sure @a inCount more objects fit without allocating
+**/
+void ObjectPool::Reserve(size_t inCount)
+{
+	size_t free_slots = mBlocks.size() * cBlockSize - mLive;
+	while (free_slots < inCount)
+	{
+		AllocateBlock();
+		free_slots += cBlockSize;
+	}
+}
+
+
+
+/**
+@brief Allocation counters
+**/
+PoolStats ObjectPool::GetStats() const
+{
+	PoolStats stats;
+	stats.mObjectSize		= mStride;
+	stats.mCapacity			= mBlocks.size() * cBlockSize;
+	stats.mLive				= mLive;
+	stats.mPeakLive			= mPeakLive;
+	stats.mBlocks			= mBlocks.size();
+	stats.mAllocations		= mAllocations;
+	stats.mFrees			= mFrees;
+	stats.mReservedBytes	= mBlocks.size() * (cBlockSize * mStride + mAlignment - 1);
+	return stats;
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+// Additional includes
+#include "Utility.h"
+
+
+
+/**
+@brief Allocation counters of an ObjectPool
+**/
+struct PoolStats
+{
+	size_t				mObjectSize		= 0;				///< Bytes per slot, including alignment padding
+	size_t				mCapacity		= 0;				///< Slots in all blocks
+	size_t				mLive			= 0;				///< Slots holding an object
+	size_t				mPeakLive		= 0;				///< Highest mLive so far
+	size_t				mBlocks			= 0;				///< Blocks allocated from the heap
+	uint64_t			mAllocations	= 0;				///< Allocate calls since the pool was created
+	uint64_t			mFrees			= 0;				///< Free calls since the pool was created
+	size_t				mReservedBytes	= 0;				///< Heap memory held by the blocks
+
+	///@name Operators
+	PoolStats&			operator+=(const PoolStats& inOther);	///< Accumulate the counters of another pool, mObjectSize becomes the largest of the two
+};
+
+
+
+/**
+@brief Pool of fixed size slots for objects of one type
+
+Slots live in blocks of cBlockSize contiguous slots, blocks are never freed or moved so objects keep their
+address. Freed slots are recycled before a new block is allocated, so creating and destroying objects over and
+over does not touch the heap. The pool only hands out memory, constructing and destructing the objects is
+up to the caller. Not thread safe.
+**/
+class ObjectPool
+{
+public:
+	static constexpr size_t	cBlockSize = 64;				///< Slots per block, one bit each in the live mask
+
+	///@name Construction
+							ObjectPool(size_t inObjectSize, size_t inAlignment);
+							~ObjectPool();					///< Frees the blocks, objects that are still alive are not destructed
+							ObjectPool(const ObjectPool&) = delete;
+	ObjectPool&				operator=(const ObjectPool&) = delete;
+
+	///@name Allocation
+	void*					Allocate();						///< Get an uninitialized slot
+	void					Free(void* inObject);			///< Return the slot of @a inObject, the object must be destructed already
+	void					Reserve(size_t inCount);		///< Make sure @a inCount more objects fit without allocating
+
+	///@name Iteration
+	template<class F>
+	void					ForEach(F&& inFunction) const;	///< Call @a inFunction(void*) for every live slot in address order, must not allocate or free
+
+	///@name Properties
+	PoolStats				GetStats() const;				///< Allocation counters
+	size_t					GetObjectSize() const			{ return mStride; }
+
+private:
+	/**
+	@brief cBlockSize slots and which of them are in use
+	**/
+	struct Block
+	{
+		uint8_t*			mMemory		= nullptr;			///< As returned by operator new, the slots start at the first aligned address
+		uint8_t*			mSlots		= nullptr;			///< First slot
+		uint64_t			mLiveMask	= 0;				///< Bit i set when slot i holds an object
+	};
+
+	///@name Helpers
+	void					AllocateBlock();				///< Add a block and put its slots on the free list
+	Block&					FindBlock(void* inObject);		///< Block that contains @a inObject, a binary search on address
+
+	///@name Properties
+	size_t					mStride;						///< Bytes per slot
+	size_t					mAlignment;						///< Alignment of every slot
+	Array<Block>			mBlocks;						///< All blocks sorted on address
+	void*					mFreeHead	= nullptr;			///< First free slot, a free slot stores the next one in its first bytes
+	size_t					mLive		= 0;
+	size_t					mPeakLive	= 0;
+	uint64_t				mAllocations = 0;
+	uint64_t				mFrees		= 0;
+};
+
+
+
+/**
+@brief Call @a inFunction(void*) for every live slot in address order, block by block
+**/
+template<class F>
+void ObjectPool::ForEach(F&& inFunction) const
+{
+	for (const Block& block : mBlocks)
+	{
+		uint8_t* slot = block.mSlots;
+		for (uint64_t mask = block.mLiveMask; mask != 0; mask >>= 1, slot += mStride)
+			if (mask & 1)
+				inFunction(slot);
+	}
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+// Additional includes
+#include "Utility.h"
+#include "Input.h"
+#include "Window.h"
+#include "Framebuffer.h"
+
+
+
+/**
+@brief Platform independent window messages
+
+The platform backend translates its native messages (WM_PAINT, WM_KEYDOWN, ...) into these,
+so the dispatch logic in Window.cpp is the same for every backend.
+**/
+enum class EMessage : uint8_t
+{
+	Create,			///< Window was created, Message::mNativeHandle holds its platform handle
+	Paint,			///< Window requests a repaint, Message::mWidth and Message::mHeight hold its client size, Message::mDirtyRect what the platform wants repainted
+	Close,			///< Window was asked to close
+	Destroy,		///< Window is being destroyed
+	KeyDown,		///< Key was pressed, Message::mKeyCode holds the key
+	KeyUp,			///< Key was released, Message::mKeyCode holds the key
+	MouseDown,		///< Mouse button was pressed, Message::mKeyCode holds the button
+	MouseUp,		///< Mouse button was released, Message::mKeyCode holds the button
+	MouseMove,		///< Cursor moved, Message::mX and Message::mY hold its position in client coordinates
+	MouseWheel,		///< Wheel turned, Message::mWheel and Message::mWheelX hold the movement (120 per notch)
+	RawMouseMove,	///< Raw device movement, Message::mX and Message::mY hold the delta
+	StateChanged,	///< Window was minimized, hidden, focused, ..., Message::mState holds its new state
+};
+
+
+
+/**
+@brief Message as passed from the platform backend to the dispatcher
+**/
+struct Message
+{
+	WindowHandle		mHandle;							///< Window the message is for
+	EMessage			mType			= EMessage::Paint;	///< Message type
+	KeyCode				mKeyCode		= 0;				///< Virtual key code for key and mouse messages
+	WindowID			mNativeHandle	= nullptr;			///< Platform handle of the window that is being created (EMessage::Create only)
+	uint64_t			mTimeNS			= 0;				///< gGetTimeNS time the platform received the message, 0 if unknown
+	int					mWidth			= 0;				///< Client width of the window (EMessage::Paint only)
+	int					mHeight			= 0;				///< Client height of the window (EMessage::Paint only)
+	IRect				mDirtyRect;							///< Area the platform wants repainted, empty if it does not know (EMessage::Paint only)
+	int32_t				mX				= 0;				///< Cursor position or raw delta (EMessage::MouseMove and EMessage::RawMouseMove only)
+	int32_t				mY				= 0;
+	int16_t				mWheel			= 0;				///< Vertical wheel movement (EMessage::MouseWheel only)
+	int16_t				mWheelX			= 0;				///< Horizontal wheel movement (EMessage::MouseWheel only)
+	uint8_t				mState			= 0;				///< EWindowStateFlags (EMessage::StateChanged only)
+};
+
+
+
+/**
+@brief Dispatch a message to the window it belongs to (implemented in Window.cpp)
+
+Returns true if the window handled the message. If not, the backend should run its default behavior.
+**/
+extern bool gDispatchMessage(const Message& inMessage);
+
+
+
+/**
+@brief Stop the render thread of every window, used when the message loop quits before the job system stops (implemented in Window.cpp)
+**/
+extern void gStopRenderThreads();
+
+
+
+/**
+@brief Delete every window that is still alive, used when the message loop quits (implemented in Window.cpp)
+**/
+extern void gDeleteAllWindows();
+
+
+
+/**
+@brief Run the fixed timestep update and the render step of every window, used by ELoopPolicy::FixedUpdate (implemented in Window.cpp)
+**/
+extern void gUpdateWindows(double inDeltaTime);
+extern void gRenderWindows(double inAlpha);
+
+
+
+/**
+@brief Ask the platform for the paints the throttle held back and allows now, called by gEndFrame (implemented in Window.cpp)
+**/
+extern void gReleaseDeferredPaints();
+extern double gGetDeferredPaintTimeout();		///< Seconds until the next held back paint is allowed, negative if there is none
+
+
+
+/**
+@brief Functions every platform backend implements (PlatformWin32.cpp, PlatformHeadless.cpp)
+**/
+extern WindowID	gPlatformCreateWindow(const IRect& inRect, const String& inName, Window* inWindow, uint32_t inClassID);	///< Create a native window for @a inWindow (which already has its handle), must dispatch EMessage::Create before returning. Windows with the same @a inClassID share a native class
+extern void		gPlatformReserveWindows(size_t inCount);											///< Make room for @a inCount more native windows before a bulk creation
+extern void		gPlatformShowWindow(WindowID inHandle);												///< Show a native window
+extern void		gPlatformActivateWindow(WindowID inHandle);											///< Activate a native window
+extern void		gPlatformDestroyWindow(WindowID inHandle);											///< Destroy a native window, must dispatch EMessage::Destroy before returning
+extern void		gPlatformInvalidate(WindowID inHandle, const IRect& inRect);						///< Make the platform send EMessage::Paint for a native window, multiple invalidations before the paint result in a single paint
+extern void		gPlatformPresent(WindowID inHandle, const Framebuffer& inFramebuffer, const DirtyRegion& inRegion);	///< Copy @a inRegion of @a inFramebuffer to the client area of a native window, can be called from a render thread
+extern bool		gPlatformEnableRawInput(WindowID inHandle);											///< Send EMessage::RawMouseMove to a native window, returns false if the platform has no raw input
+extern bool		gPlatformPumpMessages();															///< Dispatch all pending messages, returns false when the loop should stop
+extern void		gPlatformPostQuit();																///< Make gPlatformPumpMessages return false
+extern bool		gPlatformWaitForMessages(double inTimeout);											///< Block until a message or wakeup arrives or @a inTimeout seconds passed (negative waits forever), returns false on timeout
+extern void		gPlatformWakeUp();																	///< Make gPlatformWaitForMessages return, can be called from any thread
+extern void		gPlatformSleep(double inSeconds);													///< Sleep with the highest resolution the platform offers
+extern double	gPlatformGetThreadCPUTime();														///< CPU seconds used by the calling thread
@@ -0,0 +1,672 @@
+#include "PlatformHeadless.h"
+
+#ifdef WINDOW_PLATFORM_HEADLESS
+
+// STL includes
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <ctime>
+#include <mutex>
+#include <thread>
+
+
+
+/**
+@brief Native window state as fabricated by the headless backend
+**/
+struct HeadlessWindow
+{
+	IRect				mRect;						///< Window rectangle
+	String				mName;						///< Window title
+	bool				mVisible	= false;		///< Window::Show was called
+	bool				mPaintPending = false;		///< gPlatformInvalidate queued a paint that was not dispatched yet
+};
+
+
+
+/**
+@brief Headless backend state
+**/
+static HashMap<WindowID, HeadlessWindow>	gHeadlessWindows;		///< All alive native windows
+static Array<bool>							gHeadlessClasses;		///< Registered window classes indexed by class ID
+static std::mutex							gHeadlessQueueMutex;	///< Protects gHeadlessQueue and gHeadlessWakeUp, messages can be posted from any thread
+static std::condition_variable				gHeadlessQueueCondition;///< Signaled when a message is posted or the loop is woken up
+static Array<Message>						gHeadlessQueue;			///< Messages waiting to be dispatched
+static bool									gHeadlessWakeUp = false;///< gPlatformWakeUp was called
+static bool									gHeadlessWaiting = false;///< The loop sleeps in gPlatformWaitForMessages
+static Array<Message>						gHeadlessDispatching;	///< Messages being dispatched, swapped with gHeadlessQueue on every pump
+static WindowID								gHeadlessActive = nullptr; ///< Currently active window
+static uint64_t								gHeadlessDispatchCount = 0;
+static std::atomic<bool>					gHeadlessQuit { false };
+
+
+
+/**
+@brief Frames presented to the headless windows, presenting can happen on a render thread
+**/
+struct HeadlessFrame
+{
+	Framebuffer			mFramebuffer;				///< Copy of the last presented framebuffer
+	uint64_t			mPresentCount = 0;			///< Amount of presented frames
+};
+static std::mutex								gHeadlessFrameMutex;	///< Protects gHeadlessFrames
+static HashMap<WindowID, HeadlessFrame>			gHeadlessFrames;		///< Presented frames of every window that presented
+
+
+
+/**
+@brief Fabricate the native handle of a window and back, the generational handle value is unique so it is used directly
+**/
+static WindowID sToWindowID(WindowHandle inHandle)
+{
+	return reinterpret_cast<WindowID>((uintptr_t)inHandle.GetValue());
+}
+
+static WindowHandle sToWindowHandle(WindowID inHandle)
+{
+	return WindowHandle((uint32_t)reinterpret_cast<uintptr_t>(inHandle));
+}
+
+
+
+/**
+@brief Dispatch a single message and run the default behavior if it was not handled
+**/
+static void sDispatch(const Message& inMessage)
+{
+	// Like WM_PAINT, a paint carries the current client size (posting can happen on any thread, so it is filled in here)
+	if (inMessage.mType == EMessage::Paint)
+	{
+		auto iter = gHeadlessWindows.find(sToWindowID(inMessage.mHandle));
+		if (iter != gHeadlessWindows.end())
+		{
+			iter->second.mPaintPending = false;
+
+			Message paint = inMessage;
+			paint.mWidth	= iter->second.mRect.mW;
+			paint.mHeight	= iter->second.mRect.mH;
+			gDispatchMessage(paint);
+			++gHeadlessDispatchCount;
+			return;
+		}
+	}
+
+	// Like WM_ACTIVATE, the focus belongs to the active window whatever state was posted
+	if (inMessage.mType == EMessage::StateChanged)
+	{
+		Message state = inMessage;
+		state.mState = (uint8_t)((state.mState & ~cWindowFocused) | (gHeadlessActive == sToWindowID(inMessage.mHandle) ? cWindowFocused : 0));
+		gDispatchMessage(state);
+		++gHeadlessDispatchCount;
+		return;
+	}
+
+	bool handled = gDispatchMessage(inMessage);
+	++gHeadlessDispatchCount;
+
+	switch (inMessage.mType)
+	{
+		// Like DefWindowProc, an unhandled close destroys the window right away
+		case EMessage::Close:
+		{
+			if (!handled && gHeadlessWindows.find(sToWindowID(inMessage.mHandle)) != gHeadlessWindows.end())
+			{
+				Message destroy;
+				destroy.mHandle = inMessage.mHandle;
+				destroy.mType	= EMessage::Destroy;
+				sDispatch(destroy);
+			}
+			break;
+		}
+
+		// The native window is gone after a destroy
+		case EMessage::Destroy:
+		{
+			WindowID native = sToWindowID(inMessage.mHandle);
+			gHeadlessWindows.erase(native);
+			{
+				std::lock_guard<std::mutex> lock(gHeadlessFrameMutex);
+				gHeadlessFrames.erase(native);
+			}
+			if (gHeadlessActive == native)
+				gHeadlessActive = nullptr;
+			break;
+		}
+
+		default:
+			break;
+	}
+}
+
+
+
+/**
+@brief Helper function to queue a message for a window
+**/
+static void sPost(Window* inWindow, EMessage inType, KeyCode inKeyCode = 0)
+{
+	Message message;
+	message.mHandle		= inWindow->GetHandle();
+	message.mType		= inType;
+	message.mKeyCode	= inKeyCode;
+	Headless::sPostMessage(message);
+}
+
+
+
+/**
+@brief Create a native window
+**/
+WindowID gPlatformCreateWindow(const IRect& inRect, const String& inName, Window* inWindow, uint32_t inClassID)
+{
+	// Like RegisterClass, a class is registered once on first use
+	if (inClassID >= gHeadlessClasses.size())
+		gHeadlessClasses.resize(inClassID + 1, false);
+	gHeadlessClasses[inClassID] = true;
+
+	// Fabricate a handle
+	WindowID handle = sToWindowID(inWindow->GetHandle());
+
+	HeadlessWindow& native = gHeadlessWindows[handle];
+	native.mRect = inRect;
+	native.mName = inName;
+
+	// Like CreateWindowEx, the create message is dispatched before returning
+	Message message;
+	message.mHandle			= inWindow->GetHandle();
+	message.mType			= EMessage::Create;
+	message.mNativeHandle	= handle;
+	sDispatch(message);
+
+	return handle;
+}
+
+
+
+/**
+@brief Make room for @a inCount more native windows
+**/
+void gPlatformReserveWindows(size_t inCount)
+{
+	gHeadlessWindows.reserve(gHeadlessWindows.size() + inCount);
+}
+
+
+
+/**
+@brief Show a native window
+**/
+void gPlatformShowWindow(WindowID inHandle)
+{
+	auto iter = gHeadlessWindows.find(inHandle);
+	if (iter != gHeadlessWindows.end())
+		iter->second.mVisible = true;
+}
+
+
+
+/**
+@brief Tell the window of @a inHandle it gained or lost the focus
+**/
+static void sDispatchFocus(WindowID inHandle, bool inFocused)
+{
+	Window* window = Window::sGet(sToWindowHandle(inHandle));
+	if (window == nullptr)
+		return;
+
+	Message message;
+	message.mHandle	= window->GetHandle();
+	message.mType	= EMessage::StateChanged;
+	message.mState	= (uint8_t)(inFocused ? window->GetState() | cWindowFocused : window->GetState() & ~cWindowFocused);
+	if (message.mState != window->GetState())
+		sDispatch(message);
+}
+
+
+
+/**
+@brief Activate a native window, like SetActiveWindow the focus change is dispatched before returning
+**/
+void gPlatformActivateWindow(WindowID inHandle)
+{
+	if (gHeadlessWindows.find(inHandle) == gHeadlessWindows.end() || gHeadlessActive == inHandle)
+		return;
+
+	WindowID previous = gHeadlessActive;
+	gHeadlessActive = inHandle;
+	if (previous != nullptr)
+		sDispatchFocus(previous, false);
+	sDispatchFocus(inHandle, true);
+}
+
+
+
+/**
+@brief Destroy a native window, like DestroyWindow the destroy message is dispatched before returning
+**/
+void gPlatformDestroyWindow(WindowID inHandle)
+{
+	if (gHeadlessWindows.find(inHandle) == gHeadlessWindows.end())
+		return;
+
+	Message message;
+	message.mHandle = sToWindowHandle(inHandle);
+	message.mType	= EMessage::Destroy;
+	sDispatch(message);
+}
+
+
+
+/**
+@brief Make the platform send EMessage::Paint for a native window
+**/
+void gPlatformInvalidate(WindowID inHandle, const IRect& inRect)
+{
+	// Like Windows, one paint per window is pending at most. The window merges the rectangles of later invalidations itself.
+	auto iter = gHeadlessWindows.find(inHandle);
+	if (iter == gHeadlessWindows.end() || iter->second.mPaintPending)
+		return;
+	iter->second.mPaintPending = true;
+
+	Message message;
+	message.mHandle		= sToWindowHandle(inHandle);
+	message.mType		= EMessage::Paint;
+	message.mDirtyRect	= inRect;
+	Headless::sPostMessage(message);
+}
+
+
+
+/**
+@brief Copy @a inRegion of @a inFramebuffer to the memory of a native window
+**/
+void gPlatformPresent(WindowID inHandle, const Framebuffer& inFramebuffer, const DirtyRegion& inRegion)
+{
+	std::lock_guard<std::mutex> lock(gHeadlessFrameMutex);
+	HeadlessFrame& frame = gHeadlessFrames[inHandle];
+	++frame.mPresentCount;
+
+	// Like a real window, only the region is updated. After a resize everything is copied.
+	Framebuffer& destination = frame.mFramebuffer;
+	if (destination.GetWidth() != inFramebuffer.GetWidth() || destination.GetHeight() != inFramebuffer.GetHeight())
+	{
+		destination = inFramebuffer;
+		return;
+	}
+
+	for (const IRect& rect : inRegion)
+		for (int y = rect.mY; y < rect.mY + rect.mH; ++y)
+			memcpy(destination.GetRow(y) + rect.mX, inFramebuffer.GetRow(y) + rect.mX, rect.mW * sizeof(uint32_t));
+}
+
+
+
+/**
+@brief Send EMessage::RawMouseMove to a native window
+**/
+bool gPlatformEnableRawInput(WindowID inHandle)
+{
+	// Raw samples are posted with Headless::sPostRawMouseMove, there is no device to register
+	return gHeadlessWindows.find(inHandle) != gHeadlessWindows.end();
+}
+
+
+
+/**
+@brief Dispatch all pending messages
+
+Once every window is gone and nothing is queued there is nothing left to drive, so that also stops the loop.
+**/
+bool gPlatformPumpMessages()
+{
+	Headless::sPumpMessages();
+	if (gHeadlessQuit)
+	{
+		gHeadlessQuit = false;
+		return false;
+	}
+	return !gHeadlessWindows.empty() || Headless::sGetQueueSize() > 0;
+}
+
+
+
+/**
+@brief Make gPlatformPumpMessages return false
+**/
+void gPlatformPostQuit()
+{
+	gHeadlessQuit = true;
+	gPlatformWakeUp();
+}
+
+
+
+/**
+@brief Block until a message or wakeup arrives or @a inTimeout seconds passed
+**/
+bool gPlatformWaitForMessages(double inTimeout)
+{
+	std::unique_lock<std::mutex> lock(gHeadlessQueueMutex);
+	auto ready = []() { return !gHeadlessQueue.empty() || gHeadlessWakeUp; };
+
+	bool woken = true;
+	gHeadlessWaiting = true;
+	if (inTimeout < 0.0)
+		gHeadlessQueueCondition.wait(lock, ready);
+	else
+		woken = gHeadlessQueueCondition.wait_for(lock, std::chrono::duration<double>(inTimeout), ready);
+
+	gHeadlessWaiting = false;
+	gHeadlessWakeUp = false;
+	return woken;
+}
+
+
+
+/**
+@brief Make gPlatformWaitForMessages return
+**/
+void gPlatformWakeUp()
+{
+	{
+		std::lock_guard<std::mutex> lock(gHeadlessQueueMutex);
+		gHeadlessWakeUp = true;
+	}
+	gHeadlessQueueCondition.notify_one();
+}
+
+
+
+/**
+@brief Sleep with the highest resolution the platform offers
+**/
+void gPlatformSleep(double inSeconds)
+{
+	std::this_thread::sleep_for(std::chrono::duration<double>(inSeconds));
+}
+
+
+
+/**
+@brief CPU seconds used by the calling thread
+**/
+double gPlatformGetThreadCPUTime()
+{
+#ifdef _WIN32
+	// Forced headless on Windows, fall back to process time
+	return (double)std::clock() / CLOCKS_PER_SEC;
+#else
+	timespec time;
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+	return time.tv_sec + time.tv_nsec * 1e-9;
+#endif
+}
+
+
+
+/**
+@brief Queue any message, can be called from any thread
+**/
+void Headless::sPostMessage(const Message& inMessage)
+{
+	// Synthetic messages are received when they are posted
+	Message message = inMessage;
+	if (message.mTimeNS == 0)
+		message.mTimeNS = gGetTimeNS();
+
+	bool waiting;
+	{
+		std::lock_guard<std::mutex> lock(gHeadlessQueueMutex);
+		gHeadlessQueue.push_back(message);
+		waiting = gHeadlessWaiting;
+	}
+
+	// Only pay for a wakeup when the loop actually sleeps
+	if (waiting)
+		gWakeMessageLoop();
+}
+
+
+
+/**
+@brief Queue a repaint
+**/
+void Headless::sPostPaint(Window* inWindow)
+{
+	sPost(inWindow, EMessage::Paint);
+}
+
+
+
+/**
+@brief Queue a key press
+**/
+void Headless::sPostKeyDown(Window* inWindow, KeyCode inKeyCode)
+{
+	sPost(inWindow, EMessage::KeyDown, inKeyCode);
+}
+
+
+
+/**
+@brief Queue a key release
+**/
+void Headless::sPostKeyUp(Window* inWindow, KeyCode inKeyCode)
+{
+	sPost(inWindow, EMessage::KeyUp, inKeyCode);
+}
+
+
+
+/**
+@brief Queue a mouse button press
+**/
+void Headless::sPostMouseDown(Window* inWindow, KeyCode inKeyCode)
+{
+	sPost(inWindow, EMessage::MouseDown, inKeyCode);
+}
+
+
+
+/**
+@brief Queue a mouse button release
+**/
+void Headless::sPostMouseUp(Window* inWindow, KeyCode inKeyCode)
+{
+	sPost(inWindow, EMessage::MouseUp, inKeyCode);
+}
+
+
+
+/**
+@brief Helper function to queue a pointer message for a window
+**/
+static void sPostPointer(Window* inWindow, EMessage inType, int inX, int inY, int inWheel, int inWheelX)
+{
+	Message message;
+	message.mHandle		= inWindow->GetHandle();
+	message.mType		= inType;
+	message.mX			= inX;
+	message.mY			= inY;
+	message.mWheel		= (int16_t)inWheel;
+	message.mWheelX		= (int16_t)inWheelX;
+	Headless::sPostMessage(message);
+}
+
+
+
+/**
+@brief Queue a cursor move
+**/
+void Headless::sPostMouseMove(Window* inWindow, int inX, int inY)
+{
+	sPostPointer(inWindow, EMessage::MouseMove, inX, inY, 0, 0);
+}
+
+
+
+/**
+@brief Queue a wheel turn
+**/
+void Headless::sPostMouseWheel(Window* inWindow, int inWheel, int inWheelX)
+{
+	sPostPointer(inWindow, EMessage::MouseWheel, 0, 0, inWheel, inWheelX);
+}
+
+
+
+/**
+@brief Queue raw device movement
+**/
+void Headless::sPostRawMouseMove(Window* inWindow, int inDeltaX, int inDeltaY)
+{
+	sPostPointer(inWindow, EMessage::RawMouseMove, inDeltaX, inDeltaY, 0, 0);
+}
+
+
+
+/**
+@brief Queue a close request
+**/
+void Headless::sPostClose(Window* inWindow)
+{
+	sPost(inWindow, EMessage::Close);
+}
+
+
+
+/**
+@brief Queue a destroy
+**/
+void Headless::sPostDestroy(Window* inWindow)
+{
+	sPost(inWindow, EMessage::Destroy);
+}
+
+
+
+/**
+@brief Queue a state change
+**/
+void Headless::sPostState(Window* inWindow, uint8_t inState)
+{
+	Message message;
+	message.mHandle	= inWindow->GetHandle();
+	message.mType	= EMessage::StateChanged;
+	message.mState	= inState;
+	Headless::sPostMessage(message);
+}
+
+
+
+/**
+@brief Dispatch every queued message
+
+Messages posted while dispatching are kept for the next pump, so a handler that posts to itself cannot starve the loop.
+**/
+size_t Headless::sPumpMessages()
+{
+	{
+		std::lock_guard<std::mutex> lock(gHeadlessQueueMutex);
+		gHeadlessDispatching.swap(gHeadlessQueue);
+	}
+	for (const Message& message : gHeadlessDispatching)
+		sDispatch(message);
+
+	size_t dispatched = gHeadlessDispatching.size();
+	gHeadlessDispatching.clear();
+	return dispatched;
+}
+
+
+
+/**
+@brief Amount of messages waiting to be dispatched
+**/
+size_t Headless::sGetQueueSize()
+{
+	std::lock_guard<std::mutex> lock(gHeadlessQueueMutex);
+	return gHeadlessQueue.size();
+}
+
+
+
+/**
+@brief Amount of messages dispatched since startup
+**/
+uint64_t Headless::sGetDispatchCount()
+{
+	return gHeadlessDispatchCount;
+}
+
+
+
+/**
+@brief Amount of native windows that are alive
+**/
+size_t Headless::sGetWindowCount()
+{
+	return gHeadlessWindows.size();
+}
+
+
+
+/**
+@brief Amount of window classes registered since startup
+**/
+size_t Headless::sGetClassCount()
+{
+	return std::count(gHeadlessClasses.begin(), gHeadlessClasses.end(), true);
+}
+
+
+
+/**
+@brief Check if Window::Show was called on @a inWindow
+**/
+bool Headless::sIsVisible(const Window* inWindow)
+{
+	auto iter = gHeadlessWindows.find(inWindow->GetNativeHandle());
+	return iter != gHeadlessWindows.end() && iter->second.mVisible;
+}
+
+
+
+/**
+@brief Check if @a inWindow is the active window
+**/
+bool Headless::sIsActive(const Window* inWindow)
+{
+	return inWindow->GetNativeHandle() != nullptr && gHeadlessActive == inWindow->GetNativeHandle();
+}
+
+
+
+/**
+@brief Copy the last framebuffer presented to @a inWindow
+**/
+bool Headless::sGetPresentedFrame(const Window* inWindow, Framebuffer& outFramebuffer)
+{
+	std::lock_guard<std::mutex> lock(gHeadlessFrameMutex);
+	auto iter = gHeadlessFrames.find(inWindow->GetNativeHandle());
+	if (iter == gHeadlessFrames.end())
+		return false;
+
+	outFramebuffer = iter->second.mFramebuffer;
+	return true;
+}
+
+
+
+/**
+@brief Amount of frames presented to @a inWindow
+**/
+uint64_t Headless::sGetPresentCount(const Window* inWindow)
+{
+	std::lock_guard<std::mutex> lock(gHeadlessFrameMutex);
+	auto iter = gHeadlessFrames.find(inWindow->GetNativeHandle());
+	return iter != gHeadlessFrames.end() ? iter->second.mPresentCount : 0;
+}
+
+#endif // WINDOW_PLATFORM_HEADLESS
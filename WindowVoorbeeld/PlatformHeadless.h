@@ -0,0 +1,59 @@
+#pragma once
+
+// Additional includes
+#include "Platform.h"
+
+#ifdef WINDOW_PLATFORM_HEADLESS
+
+
+
+/**
+@brief Headless platform backend
+
+Fabricates window handles and keeps a queue of synthetic messages instead of talking to a desktop.
+Messages go through the same gDispatchMessage as the Win32 backend, so the event core can be driven
+and profiled on machines without a display.
+
+Example:
+
+HelloWindow* window = Window::sCreate<HelloWindow>({0, 0, 400, 400}, "Hello");
+Headless::sPostMouseDown(window, 0x02);
+Headless::sPostMouseUp(window, 0x02);
+Headless::sPumpMessages();
+**/
+class Headless
+{
+public:
+	///@name Synthetic messages (queued until the next pump, can be posted from any thread)
+	static void		sPostMessage(const Message& inMessage);					///< Queue any message and wake up the message loop
+	static void		sPostPaint(Window* inWindow);							///< Queue a repaint
+	static void		sPostKeyDown(Window* inWindow, KeyCode inKeyCode);		///< Queue a key press
+	static void		sPostKeyUp(Window* inWindow, KeyCode inKeyCode);		///< Queue a key release
+	static void		sPostMouseDown(Window* inWindow, KeyCode inKeyCode);	///< Queue a mouse button press
+	static void		sPostMouseUp(Window* inWindow, KeyCode inKeyCode);		///< Queue a mouse button release
+	static void		sPostMouseMove(Window* inWindow, int inX, int inY);		///< Queue a cursor move to @a inX, @a inY in client coordinates
+	static void		sPostMouseWheel(Window* inWindow, int inWheel, int inWheelX = 0);	///< Queue a wheel turn, 120 per notch
+	static void		sPostRawMouseMove(Window* inWindow, int inDeltaX, int inDeltaY);	///< Queue raw device movement
+	static void		sPostClose(Window* inWindow);							///< Queue a close request, destroys the window unless handled
+	static void		sPostDestroy(Window* inWindow);							///< Queue a destroy
+	static void		sPostState(Window* inWindow, uint8_t inState);			///< Queue a minimize, restore or (un)cover with the EWindowStateFlags of @a inState, the focus follows gPlatformActivateWindow
+
+	///@name Dispatch
+	static size_t	sPumpMessages();										///< Dispatch every queued message, returns the amount of messages dispatched
+
+	///@name Statistics
+	static size_t	sGetQueueSize();										///< Amount of messages waiting to be dispatched
+	static uint64_t	sGetDispatchCount();									///< Amount of messages dispatched since startup
+	static size_t	sGetWindowCount();										///< Amount of native windows that are alive
+	static size_t	sGetClassCount();										///< Amount of window classes registered since startup, one per window type
+
+	///@name Window state
+	static bool		sIsVisible(const Window* inWindow);						///< Check if Window::Show was called on @a inWindow
+	static bool		sIsActive(const Window* inWindow);						///< Check if @a inWindow is the active window
+
+	///@name Presented frames (can be read from any thread)
+	static bool		sGetPresentedFrame(const Window* inWindow, Framebuffer& outFramebuffer);	///< Copy the last framebuffer presented to @a inWindow, returns false if nothing was presented yet
+	static uint64_t	sGetPresentCount(const Window* inWindow);				///< Amount of frames presented to @a inWindow
+};
+
+#endif // WINDOW_PLATFORM_HEADLESS
@@ -0,0 +1,507 @@
+#include "Platform.h"
+
+// Additional includes
+#include "Unicode.h"
+
+#ifndef WINDOW_PLATFORM_HEADLESS
+
+// Win32 includes
+#include <windows.h>
+#include <windowsx.h>
+
+// STL includes
+#include <algorithm>
+
+// Not defined by older SDKs (available since Windows 10 1803)
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+	#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+
+
+
+/**
+@brief Registered window classes indexed by class ID, the name is empty while the class is not registered yet
+**/
+static Array<WString> gWindowClasses;
+
+
+
+/**
+@brief Auto reset event used by gPlatformWakeUp to interrupt gPlatformWaitForMessages
+**/
+static HANDLE gWakeEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+
+
+
+/**
+@brief Convert between HWND and WindowID
+**/
+static HWND		sToHWND(WindowID inHandle)	{ return reinterpret_cast<HWND>(inHandle); }
+static WindowID	sToWindowID(HWND inHandle)	{ return reinterpret_cast<WindowID>(inHandle); }
+
+
+
+/**
+@brief Get the window handle that WM_CREATE stored in the user data of @a inHandle
+**/
+static WindowHandle sGetWindowHandle(HWND inHandle)
+{
+	return WindowHandle((uint32_t)GetWindowLongPtr(inHandle, GWLP_USERDATA));
+}
+
+
+
+/**
+@brief Get the name of the native class for @a inClassID, registering it on first use
+**/
+LRESULT CALLBACK gWindowProc(HWND inHandle, UINT inMsg, WPARAM inWParam, LPARAM inLParam);
+static const wchar_t* sGetWindowClass(uint32_t inClassID)
+{
+	if (inClassID >= gWindowClasses.size())
+		gWindowClasses.resize(inClassID + 1);
+
+	WString& class_name = gWindowClasses[inClassID];
+	if (class_name.size() == 0)
+	{
+		class_name = WString::sFromUTF8(gFormat("WindowVoorbeeldClass%u", inClassID));
+
+		WNDCLASS window_class = {};
+		window_class.style			= 0;
+		window_class.lpfnWndProc	= gWindowProc;
+		window_class.lpszClassName	= class_name;
+		window_class.hInstance		= GetModuleHandle(0);
+		window_class.hIcon			= LoadIcon(0, IDI_WINLOGO);
+		window_class.hCursor		= LoadCursor(0, IDC_ARROW);
+		if (RegisterClass(&window_class) == 0)
+			gLogWarning("RegisterClass failed for window class [%u]\n", inClassID);
+	}
+	return class_name;
+}
+
+
+
+/**
+@brief Helper function to dispatch a message from the window procedure
+**/
+static bool sDispatch(HWND inHandle, EMessage inType, KeyCode inKeyCode = 0)
+{
+	Message message;
+	message.mHandle		= sGetWindowHandle(inHandle);
+	message.mType		= inType;
+	message.mKeyCode	= inKeyCode;
+	message.mTimeNS		= gGetTimeNS();
+
+	// Messages before WM_CREATE and after WM_DESTROY have no window
+	if (!message.mHandle.IsSet())
+		return false;
+
+	return gDispatchMessage(message);
+}
+
+
+
+/**
+@brief Helper function to dispatch a pointer message from the window procedure
+**/
+static bool sDispatchPointer(HWND inHandle, EMessage inType, int inX, int inY, int inWheel = 0, int inWheelX = 0)
+{
+	Message message;
+	message.mHandle		= sGetWindowHandle(inHandle);
+	message.mType		= inType;
+	message.mTimeNS		= gGetTimeNS();
+	message.mX			= inX;
+	message.mY			= inY;
+	message.mWheel		= (int16_t)inWheel;
+	message.mWheelX		= (int16_t)inWheelX;
+	if (!message.mHandle.IsSet())
+		return false;
+
+	return gDispatchMessage(message);
+}
+
+
+
+/**
+@brief Helper function to dispatch a state change from the window procedure, only when the state actually changes
+
+A hidden window counts as occluded, DWM does not tell when other windows cover a window completely.
+**/
+static void sDispatchState(HWND inHandle, bool inFocused, bool inVisible)
+{
+	Window* window = Window::sGet(sGetWindowHandle(inHandle));
+	if (window == nullptr)
+		return;
+
+	Message message;
+	message.mHandle		= window->GetHandle();
+	message.mType		= EMessage::StateChanged;
+	message.mTimeNS		= gGetTimeNS();
+	message.mState		= (uint8_t)((IsIconic(inHandle) ? cWindowMinimized : 0) | (inVisible ? 0 : cWindowOccluded) | (inFocused ? cWindowFocused : 0));
+	if (message.mState != window->GetState())
+		gDispatchMessage(message);
+}
+
+
+
+/**
+@brief Read the relative movement of a WM_INPUT message, returns false if it is not relative mouse movement
+**/
+static bool sGetRawMouseDelta(LPARAM inLParam, int& outX, int& outY)
+{
+	RAWINPUT raw_input;
+	UINT size = sizeof(raw_input);
+	if (GetRawInputData((HRAWINPUT)inLParam, RID_INPUT, &raw_input, &size, sizeof(RAWINPUTHEADER)) == (UINT)-1)
+		return false;
+
+	// Tablets and remote desktop report absolute positions, the cursor messages already cover those
+	if (raw_input.header.dwType != RIM_TYPEMOUSE || (raw_input.data.mouse.usFlags & MOUSE_MOVE_ABSOLUTE) != 0)
+		return false;
+
+	outX = raw_input.data.mouse.lLastX;
+	outY = raw_input.data.mouse.lLastY;
+	return outX != 0 || outY != 0;
+}
+
+
+
+/**
+@brief Translate the generic modifier key codes of key messages to their left/right variants
+**/
+static KeyCode sTranslateKeyCode(WPARAM inWParam, LPARAM inLParam)
+{
+	bool extended = (inLParam & (1 << 24)) != 0;
+	switch (inWParam)
+	{
+		case VK_SHIFT:
+		{
+			// Both shifts are not extended keys, so the scan code tells them apart
+			UINT key_code = MapVirtualKey((inLParam >> 16) & 0xFF, MAPVK_VSC_TO_VK_EX);
+			return key_code != 0 ? (KeyCode)key_code : (KeyCode)VK_LSHIFT;
+		}
+		case VK_CONTROL:	return extended ? VK_RCONTROL : VK_LCONTROL;
+		case VK_MENU:		return extended ? VK_RMENU : VK_LMENU;
+	}
+	return (KeyCode)inWParam;
+}
+
+
+
+/**
+@brief General window procedure, translates Win32 messages and hands them to gDispatchMessage
+**/
+#define PROC_DEFAULT DefWindowProc(inHandle, inMsg, inWParam, inLParam)
+LRESULT CALLBACK gWindowProc(HWND inHandle, UINT inMsg, WPARAM inWParam, LPARAM inLParam)
+{
+	switch (inMsg)
+	{
+		// Create passes the window through the create params, store its handle so later messages resolve it without a lookup
+		case WM_CREATE:
+		{
+			Window* window = (Window*)((LPCREATESTRUCT)inLParam)->lpCreateParams;
+			SetWindowLongPtr(inHandle, GWLP_USERDATA, (LONG_PTR)window->GetHandle().GetValue());
+
+			Message message;
+			message.mHandle			= window->GetHandle();
+			message.mType			= EMessage::Create;
+			message.mNativeHandle	= sToWindowID(inHandle);
+			gDispatchMessage(message);
+			return PROC_DEFAULT;
+		}
+
+		// Destroy clears the stored handle, so the messages that follow (e.g. WM_NCDESTROY) go straight to the default
+		case WM_DESTROY:
+		{
+			sDispatch(inHandle, EMessage::Destroy);
+			SetWindowLongPtr(inHandle, GWLP_USERDATA, 0);
+			return PROC_DEFAULT;
+		}
+
+		// Paint carries the client size and the bounds of the update region, so a render thread can resize and redraw
+		// only what changed without calling back into the window. Validating here replaces the default, which would hide the region.
+		case WM_PAINT:
+		{
+			PAINTSTRUCT paint;
+			BeginPaint(inHandle, &paint);
+			EndPaint(inHandle, &paint);
+
+			RECT client_rect;
+			GetClientRect(inHandle, &client_rect);
+
+			Message message;
+			message.mHandle		= sGetWindowHandle(inHandle);
+			message.mType		= EMessage::Paint;
+			message.mTimeNS		= gGetTimeNS();
+			message.mWidth		= client_rect.right - client_rect.left;
+			message.mHeight		= client_rect.bottom - client_rect.top;
+			message.mDirtyRect	= { paint.rcPaint.left, paint.rcPaint.top, paint.rcPaint.right - paint.rcPaint.left, paint.rcPaint.bottom - paint.rcPaint.top };
+			if (message.mHandle.IsSet())
+				gDispatchMessage(message);
+			return 0;
+		}
+
+		// A framebuffer covers the whole client area, erasing first would only flicker
+		case WM_ERASEBKGND:
+		{
+			Window* window = Window::sGet(sGetWindowHandle(inHandle));
+			return window != nullptr && window->GetFramebuffer() != nullptr ? 1 : PROC_DEFAULT;
+		}
+
+		// Generic events
+		case WM_CLOSE:	sDispatch(inHandle, EMessage::Close);	return PROC_DEFAULT;
+
+		// State Events, they throttle painting (see ThrottlePolicy) and always go to the default as well
+		case WM_ACTIVATE:	sDispatchState(inHandle, LOWORD(inWParam) != WA_INACTIVE, IsWindowVisible(inHandle) != FALSE);	return PROC_DEFAULT;
+		case WM_SHOWWINDOW:	sDispatchState(inHandle, GetActiveWindow() == inHandle, inWParam != FALSE);						return PROC_DEFAULT;
+		case WM_SIZE:		sDispatchState(inHandle, GetActiveWindow() == inHandle, IsWindowVisible(inHandle) != FALSE);	return PROC_DEFAULT;
+
+		// Mouse Down
+		case WM_LBUTTONDOWN: return sDispatch(inHandle, EMessage::MouseDown, VK_LBUTTON) ? 0 : PROC_DEFAULT;
+		case WM_MBUTTONDOWN: return sDispatch(inHandle, EMessage::MouseDown, VK_MBUTTON) ? 0 : PROC_DEFAULT;
+		case WM_RBUTTONDOWN: return sDispatch(inHandle, EMessage::MouseDown, VK_RBUTTON) ? 0 : PROC_DEFAULT;
+		case WM_XBUTTONDOWN: return sDispatch(inHandle, EMessage::MouseDown, HIWORD(inWParam) == XBUTTON1 ? VK_XBUTTON1 : VK_XBUTTON2) ? TRUE : PROC_DEFAULT;
+
+		// Mouse Up
+		case WM_LBUTTONUP: return sDispatch(inHandle, EMessage::MouseUp, VK_LBUTTON) ? 0 : PROC_DEFAULT;
+		case WM_MBUTTONUP: return sDispatch(inHandle, EMessage::MouseUp, VK_MBUTTON) ? 0 : PROC_DEFAULT;
+		case WM_RBUTTONUP: return sDispatch(inHandle, EMessage::MouseUp, VK_RBUTTON) ? 0 : PROC_DEFAULT;
+		case WM_XBUTTONUP: return sDispatch(inHandle, EMessage::MouseUp, HIWORD(inWParam) == XBUTTON1 ? VK_XBUTTON1 : VK_XBUTTON2) ? TRUE : PROC_DEFAULT;
+
+		// Pointer Events, the wheel position is in screen coordinates but the batch uses the last cursor position anyway
+		case WM_MOUSEMOVE:	return sDispatchPointer(inHandle, EMessage::MouseMove, GET_X_LPARAM(inLParam), GET_Y_LPARAM(inLParam)) ? 0 : PROC_DEFAULT;
+		case WM_MOUSEWHEEL:	return sDispatchPointer(inHandle, EMessage::MouseWheel, 0, 0, GET_WHEEL_DELTA_WPARAM(inWParam), 0) ? 0 : PROC_DEFAULT;
+		case WM_MOUSEHWHEEL:return sDispatchPointer(inHandle, EMessage::MouseWheel, 0, 0, 0, GET_WHEEL_DELTA_WPARAM(inWParam)) ? 0 : PROC_DEFAULT;
+
+		// Raw input always goes to the default as well, which releases the input data
+		case WM_INPUT:
+		{
+			int delta_x, delta_y;
+			if (sGetRawMouseDelta(inLParam, delta_x, delta_y))
+				sDispatchPointer(inHandle, EMessage::RawMouseMove, delta_x, delta_y);
+			return PROC_DEFAULT;
+		}
+
+		// Key Events, system keys (ALT, F10) fall through to the default when unhandled so ALT+F4 keeps working
+		case WM_KEYDOWN:
+		case WM_SYSKEYDOWN:	return sDispatch(inHandle, EMessage::KeyDown, sTranslateKeyCode(inWParam, inLParam)) ? 0 : PROC_DEFAULT;
+		case WM_KEYUP:
+		case WM_SYSKEYUP:	return sDispatch(inHandle, EMessage::KeyUp, sTranslateKeyCode(inWParam, inLParam)) ? 0 : PROC_DEFAULT;
+	}
+
+	// Default case
+	return PROC_DEFAULT;
+}
+
+
+
+/**
+@brief Create a native window
+**/
+WindowID gPlatformCreateWindow(const IRect& inRect, const String& inName, Window* inWindow, uint32_t inClassID)
+{
+	const wchar_t* class_name = sGetWindowClass(inClassID);
+
+	// UTF-16 version of @a inName because windows expects this, converted on the stack
+	WStringBuffer<> title(inName);
+
+	// Create the window, WM_CREATE is sent before CreateWindowEx returns
+	HWND handle = CreateWindowEx(0, class_name, title, WS_OVERLAPPEDWINDOW | WS_VISIBLE,
+								inRect.mX, inRect.mY, inRect.mW, inRect.mH, 0, 0, GetModuleHandle(0), inWindow);
+	return sToWindowID(handle);
+}
+
+
+
+/**
+@brief Make room for @a inCount more native windows, windows keeps that storage itself
+**/
+void gPlatformReserveWindows(size_t inCount)
+{
+}
+
+
+
+/**
+@brief Show a native window
+**/
+void gPlatformShowWindow(WindowID inHandle)
+{
+	ShowWindow(sToHWND(inHandle), SW_NORMAL);
+}
+
+
+
+/**
+@brief Activate a native window
+**/
+void gPlatformActivateWindow(WindowID inHandle)
+{
+	SetActiveWindow(sToHWND(inHandle));
+}
+
+
+
+/**
+@brief Destroy a native window, DestroyWindow sends WM_DESTROY before it returns
+**/
+void gPlatformDestroyWindow(WindowID inHandle)
+{
+	DestroyWindow(sToHWND(inHandle));
+}
+
+
+
+/**
+@brief Make the platform send EMessage::Paint for a native window
+**/
+void gPlatformInvalidate(WindowID inHandle, const IRect& inRect)
+{
+	// Windows accumulates the update region itself and only generates WM_PAINT once the queue is empty
+	LONG right = (LONG)std::min<int64_t>((int64_t)inRect.mX + inRect.mW, LONG_MAX);
+	LONG bottom = (LONG)std::min<int64_t>((int64_t)inRect.mY + inRect.mH, LONG_MAX);
+	RECT rect = { inRect.mX, inRect.mY, right, bottom };
+	InvalidateRect(sToHWND(inHandle), &rect, FALSE);
+}
+
+
+
+/**
+@brief Copy @a inRegion of @a inFramebuffer to the client area of a native window
+**/
+void gPlatformPresent(WindowID inHandle, const Framebuffer& inFramebuffer, const DirtyRegion& inRegion)
+{
+	// GetDC works from any thread, so this is safe to call from a render thread
+	HWND handle = sToHWND(inHandle);
+	HDC dc = GetDC(handle);
+
+	for (const IRect& rect : inRegion)
+	{
+		// Describe only the rows of the rectangle as a top down DIB (negative height), so the source starts at its first row
+		BITMAPINFO info = {};
+		info.bmiHeader.biSize			= sizeof(BITMAPINFOHEADER);
+		info.bmiHeader.biWidth			= inFramebuffer.GetWidth();
+		info.bmiHeader.biHeight			= -rect.mH;
+		info.bmiHeader.biPlanes			= 1;
+		info.bmiHeader.biBitCount		= 32;
+		info.bmiHeader.biCompression	= BI_RGB;
+
+		StretchDIBits(dc, rect.mX, rect.mY, rect.mW, rect.mH, rect.mX, 0, rect.mW, rect.mH,
+					  inFramebuffer.GetRow(rect.mY), &info, DIB_RGB_COLORS, SRCCOPY);
+	}
+
+	ReleaseDC(handle, dc);
+}
+
+
+
+/**
+@brief Send EMessage::RawMouseMove to a native window
+**/
+bool gPlatformEnableRawInput(WindowID inHandle)
+{
+	// Generic desktop page, mouse usage. Raw input goes to one window per process, the last one registered.
+	RAWINPUTDEVICE device = {};
+	device.usUsagePage	= 0x01;
+	device.usUsage		= 0x02;
+	device.dwFlags		= 0;
+	device.hwndTarget	= sToHWND(inHandle);
+	return RegisterRawInputDevices(&device, 1, sizeof(device)) != FALSE;
+}
+
+
+
+/**
+@brief Dispatch all pending messages
+**/
+bool gPlatformPumpMessages()
+{
+	MSG message;
+
+	// Peek for the next message. This message can come from any window and is not filtered based on type.
+	while (PeekMessage(&message, 0, 0, 0, PM_REMOVE))
+	{
+		// If we received a quit message, stop the loop
+		if (message.message == WM_QUIT)
+			return false;
+
+		TranslateMessage(&message);
+		DispatchMessage(&message);
+	}
+	return true;
+}
+
+
+
+/**
+@brief Make gPlatformPumpMessages return false
+**/
+void gPlatformPostQuit()
+{
+	PostQuitMessage(0);
+}
+
+
+
+/**
+@brief Block until a message or wakeup arrives or @a inTimeout seconds passed
+**/
+bool gPlatformWaitForMessages(double inTimeout)
+{
+	DWORD timeout = inTimeout < 0.0 ? INFINITE : (DWORD)(inTimeout * 1000.0);
+	DWORD result = MsgWaitForMultipleObjectsEx(1, &gWakeEvent, timeout, QS_ALLINPUT, MWMO_INPUTAVAILABLE);
+	return result != WAIT_TIMEOUT;
+}
+
+
+
+/**
+@brief Make gPlatformWaitForMessages return
+**/
+void gPlatformWakeUp()
+{
+	SetEvent(gWakeEvent);
+}
+
+
+
+/**
+@brief Sleep with the highest resolution the platform offers
+**/
+void gPlatformSleep(double inSeconds)
+{
+	// A high resolution waitable timer sleeps with sub-millisecond precision, fall back to a regular one on older systems
+	static thread_local HANDLE timer = []()
+	{
+		HANDLE handle = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+		return handle != nullptr ? handle : CreateWaitableTimerExW(nullptr, nullptr, 0, TIMER_ALL_ACCESS);
+	}();
+
+	// Relative due time in 100 nanosecond units
+	LARGE_INTEGER due_time;
+	due_time.QuadPart = -(LONGLONG)(inSeconds * 1e7);
+	if (timer != nullptr && SetWaitableTimer(timer, &due_time, 0, nullptr, nullptr, FALSE))
+		WaitForSingleObject(timer, INFINITE);
+	else
+		Sleep((DWORD)(inSeconds * 1000.0));
+}
+
+
+
+/**
+@brief CPU seconds used by the calling thread
+**/
+double gPlatformGetThreadCPUTime()
+{
+	FILETIME creation_time, exit_time, kernel_time, user_time;
+	if (!GetThreadTimes(GetCurrentThread(), &creation_time, &exit_time, &kernel_time, &user_time))
+		return 0.0;
+
+	// FILETIMEs are in 100 nanosecond units
+	ULARGE_INTEGER kernel, user;
+	kernel.LowPart	= kernel_time.dwLowDateTime;
+	kernel.HighPart	= kernel_time.dwHighDateTime;
+	user.LowPart	= user_time.dwLowDateTime;
+	user.HighPart	= user_time.dwHighDateTime;
+	return (kernel.QuadPart + user.QuadPart) * 1e-7;
+}
+
+#endif // WINDOW_PLATFORM_HEADLESS
@@ -0,0 +1,266 @@
+#include "Pointer.h"
+
+// STL includes
+#include <algorithm>
+
+// Additional includes
+#include "Platform.h"
+
+
+
+/**
+@brief Samples of one window during the current frame, the buffers are reused every frame
+**/
+struct PendingBatch
+{
+	WindowHandle			mWindow;						///< Window the samples are for
+	Array<PointerSample>	mSamples;						///< Samples in the order they arrived
+};
+
+
+
+/**
+@brief Pointer state, only touched by the message loop thread
+**/
+static Array<PendingBatch>	gPendingBatches;				///< Batches, the first gPendingBatchCount are in use
+static size_t				gPendingBatchCount = 0;
+static bool					gDeliveringBatches = false;		///< Pointer::sEndFrame is calling the windows
+
+static WindowHandle			gCursorWindow;					///< Window of the last cursor sample
+static int					gCursorX = 0;					///< Position of the last cursor sample
+static int					gCursorY = 0;
+
+static int					gFrameDelta[2] = {};			///< Accumulated during the current frame
+static int					gFrameRawDelta[2] = {};
+static int					gFrameWheel = 0;
+static int					gLastFrameDelta[2] = {};		///< Totals of the last finished frame
+static int					gLastFrameRawDelta[2] = {};
+static int					gLastFrameWheel = 0;
+
+static uint64_t				gSampleCount = 0;
+static uint64_t				gMergedCount = 0;
+
+
+
+/**
+@brief Add two deltas without wrapping around the 16 bit range
+**/
+static int16_t sAddClamped(int16_t inA, int inB)
+{
+	return (int16_t)std::max(-32768, std::min(32767, inA + inB));
+}
+
+
+
+/**
+@brief Get the batch of @a inWindow for this frame
+**/
+static PendingBatch& sGetBatch(WindowHandle inWindow)
+{
+	// Usually only one or two windows receive pointer input per frame, so a linear search is fastest
+	for (size_t i = 0; i < gPendingBatchCount; ++i)
+		if (gPendingBatches[i].mWindow == inWindow)
+			return gPendingBatches[i];
+
+	if (gPendingBatchCount == gPendingBatches.size())
+	{
+		gPendingBatches.emplace_back();
+		gPendingBatches.back().mSamples.reserve(Pointer::cMaxBatchSize);
+	}
+
+	PendingBatch& batch = gPendingBatches[gPendingBatchCount++];
+	batch.mWindow = inWindow;
+	return batch;
+}
+
+
+
+/**
+@brief Update the cursor state with @a inSample and add it to the batch of @a inWindow if @a inBatch
+**/
+void Pointer::sAddSample(WindowHandle inWindow, const PointerSample& inSample, bool inBatch)
+{
+	gAssert(!gDeliveringBatches);
+	++gSampleCount;
+
+	// Complete the sample with the cursor state, cursor samples come with a position and get a delta
+	PointerSample sample = inSample;
+	switch (sample.mSource)
+	{
+		case EPointerSource::Cursor:
+		{
+			if (inWindow == gCursorWindow)
+			{
+				sample.mDeltaX = (int16_t)std::max(-32768, std::min(32767, sample.mX - gCursorX));
+				sample.mDeltaY = (int16_t)std::max(-32768, std::min(32767, sample.mY - gCursorY));
+			}
+			gCursorWindow	= inWindow;
+			gCursorX		= sample.mX;
+			gCursorY		= sample.mY;
+			gFrameDelta[0] += sample.mDeltaX;
+			gFrameDelta[1] += sample.mDeltaY;
+			break;
+		}
+
+		case EPointerSource::Wheel:
+		{
+			sample.mX = gCursorX;
+			sample.mY = gCursorY;
+			gFrameWheel += sample.mWheel;
+			break;
+		}
+
+		case EPointerSource::Raw:
+		{
+			sample.mX = gCursorX;
+			sample.mY = gCursorY;
+			gFrameRawDelta[0] += sample.mDeltaX;
+			gFrameRawDelta[1] += sample.mDeltaY;
+			break;
+		}
+	}
+
+	// Windows without OnPointerBatch get no batch, only the cursor state and frame totals are kept
+	if (!inBatch)
+		return;
+
+	PendingBatch& batch = sGetBatch(inWindow);
+	if (batch.mSamples.size() < cMaxBatchSize)
+	{
+		batch.mSamples.push_back(sample);
+		return;
+	}
+
+	// Full, merge into the newest sample of the same source so no movement is lost
+	++gMergedCount;
+	for (size_t i = batch.mSamples.size(); i-- > 0; )
+	{
+		PointerSample& merged = batch.mSamples[i];
+		if (merged.mSource != sample.mSource)
+			continue;
+
+		merged.mTimeNS	= sample.mTimeNS;
+		merged.mX		= sample.mX;
+		merged.mY		= sample.mY;
+		merged.mDeltaX	= sAddClamped(merged.mDeltaX, sample.mDeltaX);
+		merged.mDeltaY	= sAddClamped(merged.mDeltaY, sample.mDeltaY);
+		merged.mWheel	= sAddClamped(merged.mWheel, sample.mWheel);
+		merged.mWheelX	= sAddClamped(merged.mWheelX, sample.mWheelX);
+		return;
+	}
+}
+
+
+
+/**
+@brief Deliver the batches of the frame that just ended
+**/
+void Pointer::sEndFrame()
+{
+	gDeliveringBatches = true;
+	for (size_t i = 0; i < gPendingBatchCount; ++i)
+	{
+		PendingBatch& batch = gPendingBatches[i];
+
+		// The window can be gone by now, its samples are simply dropped
+		Window* window = Window::sGet(batch.mWindow);
+		if (window != nullptr)
+			window->SendPointerBatch(PointerBatch(batch.mSamples.data(), batch.mSamples.size()));
+		batch.mSamples.clear();
+	}
+	gPendingBatchCount = 0;
+	gDeliveringBatches = false;
+
+	// Close the frame totals
+	gLastFrameDelta[0]		= gFrameDelta[0];
+	gLastFrameDelta[1]		= gFrameDelta[1];
+	gLastFrameRawDelta[0]	= gFrameRawDelta[0];
+	gLastFrameRawDelta[1]	= gFrameRawDelta[1];
+	gLastFrameWheel			= gFrameWheel;
+	gFrameDelta[0] = gFrameDelta[1] = 0;
+	gFrameRawDelta[0] = gFrameRawDelta[1] = 0;
+	gFrameWheel = 0;
+}
+
+
+
+/**
+@brief Window the cursor was last seen over
+**/
+WindowHandle Pointer::sGetWindow()
+{
+	return gCursorWindow;
+}
+
+
+
+/**
+@brief Last cursor position in client coordinates of sGetWindow
+**/
+void Pointer::sGetPosition(int& outX, int& outY)
+{
+	outX = gCursorX;
+	outY = gCursorY;
+}
+
+
+
+/**
+@brief Cursor movement during the last frame
+**/
+void Pointer::sGetFrameDelta(int& outX, int& outY)
+{
+	outX = gLastFrameDelta[0];
+	outY = gLastFrameDelta[1];
+}
+
+
+
+/**
+@brief Raw device movement during the last frame
+**/
+void Pointer::sGetFrameRawDelta(int& outX, int& outY)
+{
+	outX = gLastFrameRawDelta[0];
+	outY = gLastFrameRawDelta[1];
+}
+
+
+
+/**
+@brief Vertical wheel movement during the last frame
+**/
+int Pointer::sGetFrameWheel()
+{
+	return gLastFrameWheel;
+}
+
+
+
+/**
+@brief Also deliver raw device movement to @a inWindow
+**/
+bool Pointer::sEnableRawInput(Window* inWindow)
+{
+	return gPlatformEnableRawInput(inWindow->GetNativeHandle());
+}
+
+
+
+/**
+@brief Amount of samples received since startup
+**/
+uint64_t Pointer::sGetSampleCount()
+{
+	return gSampleCount;
+}
+
+
+
+/**
+@brief Amount of samples merged because a batch was full
+**/
+uint64_t Pointer::sGetMergedCount()
+{
+	return gMergedCount;
+}
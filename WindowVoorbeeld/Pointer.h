@@ -0,0 +1,86 @@
+#pragma once
+
+// Additional includes
+#include "Utility.h"
+#include "HandleTable.h"
+#include "Span.h"
+
+
+
+/**
+@brief Where a pointer sample came from
+**/
+enum class EPointerSource : uint8_t
+{
+	Cursor,			///< Cursor moved, position is in client coordinates and ballistics (acceleration) are applied
+	Wheel,			///< Wheel turned, no movement
+	Raw,			///< Raw device movement without ballistics, only the delta is new (see Pointer::sEnableRawInput)
+};
+
+
+
+/**
+@brief A single pointer sample
+**/
+struct PointerSample
+{
+	uint64_t				mTimeNS		= 0;				///< gGetTimeNS time the platform received the sample
+	int32_t					mX			= 0;				///< Cursor position in client coordinates of the window, the last known one for wheel and raw samples
+	int32_t					mY			= 0;
+	int16_t					mDeltaX		= 0;				///< Movement since the previous sample of the same source, device counts for raw samples
+	int16_t					mDeltaY		= 0;
+	int16_t					mWheel		= 0;				///< Vertical wheel movement, 120 per notch (less on high resolution wheels), positive is away from the user
+	int16_t					mWheelX		= 0;				///< Horizontal wheel movement, 120 per notch, positive is to the right
+	EPointerSource			mSource		= EPointerSource::Cursor;
+};
+using PointerBatch = Span<const PointerSample>;
+
+
+
+/**
+@brief Pointer static class
+
+Pointer messages are not dispatched one by one. During a frame the samples of every window are collected,
+and at the end of the frame each window gets a single Window::OnPointerBatch call with all of them in order.
+A 1000 Hz mouse therefore costs one virtual call per frame. A batch holds up to cMaxBatchSize samples,
+after that new samples are merged into the last one of the same source, keeping the total movement.
+
+Example:
+
+virtual void OnPointerBatch(PointerBatch inSamples) override
+{
+	for (const PointerSample& sample : inSamples)
+		if (sample.mSource == EPointerSource::Cursor)
+			mStroke.push_back({sample.mX, sample.mY});
+	Invalidate();
+}
+**/
+class Window;
+using WindowHandle = Handle<Window>;
+class Pointer
+{
+public:
+	static constexpr size_t	cMaxBatchSize = 256;			///< Samples per window per frame before merging
+
+	///@name State (message loop thread)
+	static WindowHandle		sGetWindow();					///< Window the cursor was last seen over
+	static void				sGetPosition(int& outX, int& outY);		///< Last cursor position in client coordinates of sGetWindow
+	static void				sGetFrameDelta(int& outX, int& outY);	///< Cursor movement during the last frame
+	static void				sGetFrameRawDelta(int& outX, int& outY);	///< Raw device movement during the last frame, 0 without raw input
+	static int				sGetFrameWheel();				///< Vertical wheel movement during the last frame, 120 per notch
+
+	///@name Raw input
+	static bool				sEnableRawInput(Window* inWindow);	///< Also deliver raw device movement to @a inWindow, returns false if the platform has no raw input
+
+	///@name Statistics
+	static uint64_t			sGetSampleCount();				///< Amount of samples received since startup
+	static uint64_t			sGetMergedCount();				///< Amount of samples merged because a batch was full
+
+	///@name Frame
+	static void				sEndFrame();					///< Deliver the batches of the frame that just ended, called by the message loop after every pump
+
+private:
+	friend struct InputKey;									///< Window dispatch adds the samples
+
+	static void				sAddSample(WindowHandle inWindow, const PointerSample& inSample, bool inBatch);	///< Update the cursor state with @a inSample and add it to the batch of @a inWindow if @a inBatch
+};
@@ -0,0 +1,333 @@
+#include "Profiler.h"
+
+// STL includes
+#include <algorithm>
+
+
+
+/**
+@brief Timings per window and message type, the key is the handle value shifted left 8 bits or'ed with the message type
+**/
+static HashMap<uint64_t, DispatchStats*> gDispatchIndex;
+static Array<std::unique_ptr<DispatchStats>> gDispatchStats;
+
+
+
+/**
+@brief Last looked up timings, consecutive messages are mostly for the same window and type
+**/
+static uint64_t gLastDispatchKey = UINT64_MAX;
+static DispatchStats* gLastDispatchStats = nullptr;
+
+
+
+/**
+@brief Frame timings
+**/
+static Histogram gFrameTime;
+static Histogram gFrameInterval;
+static Histogram gFrameMessages;
+static uint64_t gFrameStartNS = 0;
+static uint32_t gFrameMessageCount = 0;
+
+
+
+/**
+@brief Trace that is being recorded
+**/
+static Array<TraceEvent> gTrace;
+static size_t gMaxTraceEvents = 0;
+static uint64_t gDroppedTraceEvents = 0;
+static bool gTracing = false;
+
+
+
+/**
+@brief Store a trace event if a trace is being recorded
+**/
+static void sAddTraceEvent(const TraceEvent& inEvent)
+{
+	if (!gTracing)
+		return;
+
+	if (gTrace.size() < gMaxTraceEvents)
+		gTrace.push_back(inEvent);
+	else
+		++gDroppedTraceEvents;
+}
+
+
+
+/**
+@brief Timings of @a inType messages for @a inWindow, created the first time
+**/
+static DispatchStats& sFindDispatchStats(WindowHandle inWindow, EMessage inType)
+{
+	uint64_t key = ((uint64_t)inWindow.GetValue() << 8) | (uint64_t)inType;
+	if (key == gLastDispatchKey)
+		return *gLastDispatchStats;
+
+	DispatchStats*& stats = gDispatchIndex[key];
+	if (stats == nullptr)
+	{
+		gDispatchStats.emplace_back(new DispatchStats());
+		stats = gDispatchStats.back().get();
+		stats->mWindow = inWindow;
+		stats->mType = inType;
+	}
+
+	gLastDispatchKey = key;
+	gLastDispatchStats = stats;
+	return *stats;
+}
+
+
+
+/**
+@brief Start timing a dispatch, returns the start time to pass to sEndDispatch
+**/
+uint64_t Profiler::sBeginDispatch(const Message&)
+{
+	return gGetTimeNS();
+}
+
+
+
+/**
+@brief Stop timing a dispatch
+**/
+void Profiler::sEndDispatch(const Message& inMessage, uint64_t inStartNS)
+{
+	uint64_t end = gGetTimeNS();
+
+	DispatchStats& stats = sFindDispatchStats(inMessage.mHandle, inMessage.mType);
+	stats.mDuration.Record(end - inStartNS);
+	if (inMessage.mTimeNS != 0 && inMessage.mTimeNS <= inStartNS)
+		stats.mQueueLatency.Record(inStartNS - inMessage.mTimeNS);
+
+	++gFrameMessageCount;
+
+	TraceEvent event;
+	event.mStartNS		= inStartNS;
+	event.mDurationNS	= end - inStartNS;
+	event.mValue		= inMessage.mHandle.GetValue();
+	event.mType			= TraceEvent::EType::Dispatch;
+	event.mMessage		= inMessage.mType;
+	sAddTraceEvent(event);
+}
+
+
+
+/**
+@brief Start timing a pump of the message loop
+**/
+void Profiler::sBeginFrame()
+{
+	uint64_t now = gGetTimeNS();
+	if (gFrameStartNS != 0)
+		gFrameInterval.Record(now - gFrameStartNS);
+	gFrameStartNS = now;
+	gFrameMessageCount = 0;
+}
+
+
+
+/**
+@brief Stop timing a pump of the message loop
+**/
+void Profiler::sEndFrame()
+{
+	uint64_t end = gGetTimeNS();
+	gFrameTime.Record(end - gFrameStartNS);
+	gFrameMessages.Record(gFrameMessageCount);
+
+	TraceEvent event;
+	event.mStartNS		= gFrameStartNS;
+	event.mDurationNS	= end - gFrameStartNS;
+	event.mValue		= gFrameMessageCount;
+	event.mType			= TraceEvent::EType::Frame;
+	sAddTraceEvent(event);
+}
+
+
+
+/**
+@brief Timings of every window and message type that was dispatched
+**/
+Span<const std::unique_ptr<DispatchStats>> Profiler::sGetDispatchStats()
+{
+	return Span<const std::unique_ptr<DispatchStats>>(gDispatchStats.data(), gDispatchStats.size());
+}
+
+
+
+/**
+@brief Frame histograms
+**/
+const Histogram& Profiler::sGetFrameTime()		{ return gFrameTime; }
+const Histogram& Profiler::sGetFrameInterval()	{ return gFrameInterval; }
+const Histogram& Profiler::sGetFrameMessages()	{ return gFrameMessages; }
+
+
+
+/**
+@brief Table of the frame timings and the @a inMaxRows handlers that took the most time in total
+**/
+String Profiler::sGetReport(size_t inMaxRows)
+{
+	String report = gFormat("Frames: %llu, time mean %.3f ms p99 %.3f ms max %.3f ms, interval mean %.3f ms, messages per frame mean %.1f max %llu\n",
+		(unsigned long long)gFrameTime.GetCount(), gFrameTime.GetMean() * 1e-6, gFrameTime.GetPercentile(99.0) * 1e-6, gFrameTime.GetMax() * 1e-6,
+		gFrameInterval.GetMean() * 1e-6, gFrameMessages.GetMean(), (unsigned long long)gFrameMessages.GetMax());
+
+	Array<const DispatchStats*> sorted;
+	sorted.reserve(gDispatchStats.size());
+	for (const std::unique_ptr<DispatchStats>& stats : gDispatchStats)
+		sorted.push_back(stats.get());
+	std::sort(sorted.begin(), sorted.end(), [](const DispatchStats* inLeft, const DispatchStats* inRight) { return inLeft->mDuration.GetTotal() > inRight->mDuration.GetTotal(); });
+	if (sorted.size() > inMaxRows)
+		sorted.resize(inMaxRows);
+
+	report += gFormat("%-10s  %-12s  %9s  %10s  %9s  %9s  %9s  %9s  %12s\n", "Window", "Message", "Count", "Total ms", "Mean us", "p50 us", "p99 us", "Max us", "Queue p99 us");
+	for (const DispatchStats* stats : sorted)
+	{
+		const Histogram& duration = stats->mDuration;
+		report += gFormat("0x%08x  %-12s  %9llu  %10.3f  %9.2f  %9.2f  %9.2f  %9.2f  %12.2f\n", stats->mWindow.GetValue(), sGetMessageName(stats->mType),
+			(unsigned long long)duration.GetCount(), duration.GetTotal() * 1e-6, duration.GetMean() * 1e-3, duration.GetPercentile(50.0) * 1e-3,
+			duration.GetPercentile(99.0) * 1e-3, duration.GetMax() * 1e-3, stats->mQueueLatency.GetPercentile(99.0) * 1e-3);
+	}
+	return report;
+}
+
+
+
+/**
+@brief Forget every timing
+**/
+void Profiler::sReset()
+{
+	gDispatchIndex.clear();
+	gDispatchStats.clear();
+	gLastDispatchKey = UINT64_MAX;
+	gLastDispatchStats = nullptr;
+
+	gFrameTime.Reset();
+	gFrameInterval.Reset();
+	gFrameMessages.Reset();
+	gFrameStartNS = 0;
+	gFrameMessageCount = 0;
+}
+
+
+
+/**
+@brief Start storing trace events, forgets the previous trace
+**/
+void Profiler::sStartTrace(size_t inMaxEvents)
+{
+	gTrace.clear();
+	gTrace.reserve(std::min<size_t>(inMaxEvents, 1 << 16));
+	gMaxTraceEvents = inMaxEvents;
+	gDroppedTraceEvents = 0;
+	gTracing = true;
+}
+
+
+
+/**
+@brief Stop storing trace events, the trace stays available
+**/
+void Profiler::sStopTrace()
+{
+	gTracing = false;
+}
+
+
+
+/**
+@brief Stored trace events
+**/
+Span<const TraceEvent> Profiler::sGetTrace()
+{
+	return Span<const TraceEvent>(gTrace.data(), gTrace.size());
+}
+
+
+
+/**
+@brief Events that did not fit in the trace
+**/
+uint64_t Profiler::sGetDroppedTraceEvents()
+{
+	return gDroppedTraceEvents;
+}
+
+
+
+/**
+@brief Write the stored trace as Chrome trace event JSON
+
+Dispatches and frames become complete events on the message loop thread, the messages per frame a counter.
+Times are in microseconds since the first event.
+**/
+bool Profiler::sWriteChromeTrace(const char* inPath)
+{
+	FILE* file = gOpenFile(inPath, "w");
+	if (file == nullptr)
+		return false;
+
+	uint64_t first = UINT64_MAX;
+	for (const TraceEvent& event : gTrace)
+		first = std::min(first, event.mStartNS);
+
+	fprintf(file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+	fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"Message loop\"}}");
+	for (const TraceEvent& event : gTrace)
+	{
+		double start = (event.mStartNS - first) * 1e-3;
+		double duration = event.mDurationNS * 1e-3;
+		switch (event.mType)
+		{
+			case TraceEvent::EType::Dispatch:
+				fprintf(file, ",\n{\"name\":\"%s\",\"cat\":\"dispatch\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":1,\"args\":{\"window\":\"0x%08x\"}}",
+					sGetMessageName(event.mMessage), start, duration, event.mValue);
+				break;
+
+			case TraceEvent::EType::Frame:
+				fprintf(file, ",\n{\"name\":\"Frame\",\"cat\":\"frame\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":1,\"args\":{\"messages\":%u}}",
+					start, duration, event.mValue);
+				fprintf(file, ",\n{\"name\":\"Messages per frame\",\"ph\":\"C\",\"ts\":%.3f,\"pid\":1,\"tid\":1,\"args\":{\"messages\":%u}}",
+					start, event.mValue);
+				break;
+		}
+	}
+	fprintf(file, "\n]}\n");
+
+	bool ok = ferror(file) == 0;
+	fclose(file);
+	return ok;
+}
+
+
+
+/**
+@brief Name of a message type, for reports and traces
+**/
+const char* Profiler::sGetMessageName(EMessage inType)
+{
+	switch (inType)
+	{
+		case EMessage::Create:			return "Create";
+		case EMessage::Paint:			return "Paint";
+		case EMessage::Close:			return "Close";
+		case EMessage::Destroy:			return "Destroy";
+		case EMessage::KeyDown:			return "KeyDown";
+		case EMessage::KeyUp:			return "KeyUp";
+		case EMessage::MouseDown:		return "MouseDown";
+		case EMessage::MouseUp:			return "MouseUp";
+		case EMessage::MouseMove:		return "MouseMove";
+		case EMessage::MouseWheel:		return "MouseWheel";
+		case EMessage::RawMouseMove:	return "RawMouseMove";
+		case EMessage::StateChanged:	return "StateChanged";
+	}
+	return "Unknown";
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+// Additional includes
+#include "Histogram.h"
+#include "Platform.h"
+#include "Span.h"
+
+
+
+/**
+@brief Whether the message loop is instrumented, 0 compiles every gProfile macro out
+
+Define WINDOW_PROFILER as 1 to profile a release build.
+**/
+#ifndef WINDOW_PROFILER
+	#ifdef _DEBUG
+		#define WINDOW_PROFILER		1
+	#else
+		#define WINDOW_PROFILER		0
+	#endif
+#endif
+
+
+
+/**
+@brief Timings of one message type of one window
+**/
+struct DispatchStats
+{
+	WindowHandle		mWindow;							///< Window the messages were for
+	EMessage			mType			= EMessage::Paint;	///< Message type
+	Histogram			mDuration;							///< Nanoseconds spent in gDispatchMessage, including the handler
+	Histogram			mQueueLatency;						///< Nanoseconds between the platform receiving the message and its dispatch
+};
+
+
+
+/**
+@brief Event of a recorded trace
+**/
+struct TraceEvent
+{
+	enum class EType : uint8_t
+	{
+		Dispatch,			///< gDispatchMessage call, mValue is the window handle
+		Frame,				///< Pump of the message loop, mValue is the amount of dispatched messages
+	};
+
+	uint64_t			mStartNS		= 0;				///< gGetTimeNS time the event started
+	uint64_t			mDurationNS		= 0;				///< Nanoseconds the event took
+	uint32_t			mValue			= 0;				///< Depends on mType
+	EType				mType			= EType::Dispatch;
+	EMessage			mMessage		= EMessage::Paint;	///< Dispatched message (EType::Dispatch only)
+};
+
+
+
+/**
+@brief Message loop profiler: handler durations per window and message type, frame times and a Chrome trace
+
+Every dispatched message is timed into a histogram of its window and message type, every pump of the
+message loop into the frame histograms. Between sStartTrace and sStopTrace every dispatch and frame is also
+stored as a trace event, sWriteChromeTrace writes those in the trace event format that chrome://tracing and
+Perfetto open. Only for the message loop thread, the instrumentation points are the gProfile macros.
+**/
+class Profiler
+{
+public:
+	static constexpr size_t	cDefaultMaxTraceEvents = 1 << 20;
+
+	///@name Instrumentation, use the gProfile macros instead
+	static uint64_t			sBeginDispatch(const Message& inMessage);						///< Returns the start time to pass to sEndDispatch
+	static void				sEndDispatch(const Message& inMessage, uint64_t inStartNS);
+	static void				sBeginFrame();
+	static void				sEndFrame();
+
+	///@name Statistics
+	static Span<const std::unique_ptr<DispatchStats>> sGetDispatchStats();					///< Timings of every window and message type that was dispatched
+	static const Histogram&	sGetFrameTime();			///< Nanoseconds spent pumping per frame
+	static const Histogram&	sGetFrameInterval();		///< Nanoseconds between the starts of two frames, including sleeping
+	static const Histogram&	sGetFrameMessages();		///< Messages dispatched per frame, how deep the platform queue was
+	static String			sGetReport(size_t inMaxRows = 20);							///< Table of the frame timings and the most expensive handlers
+	static void				sReset();					///< Forget every timing
+
+	///@name Trace
+	static void				sStartTrace(size_t inMaxEvents = cDefaultMaxTraceEvents);	///< Start storing trace events, forgets the previous trace
+	static void				sStopTrace();
+	static Span<const TraceEvent> sGetTrace();			///< Stored trace events
+	static uint64_t			sGetDroppedTraceEvents();	///< Events that did not fit in the trace
+	static bool				sWriteChromeTrace(const char* inPath);						///< Write the stored trace as Chrome trace event JSON, false if the file can't be created
+
+	///@name Helpers
+	static const char*		sGetMessageName(EMessage inType);
+};
+
+
+
+/**
+@brief Times a dispatch from its construction to its destruction
+**/
+class ProfileDispatchScope
+{
+public:
+	explicit				ProfileDispatchScope(const Message& inMessage) :	mMessage(inMessage), mStartNS(Profiler::sBeginDispatch(inMessage)) { }
+							~ProfileDispatchScope()								{ Profiler::sEndDispatch(mMessage, mStartNS); }
+
+							ProfileDispatchScope(const ProfileDispatchScope&) = delete;
+	ProfileDispatchScope&	operator=(const ProfileDispatchScope&) = delete;
+
+private:
+	const Message&			mMessage;
+	uint64_t				mStartNS;
+};
+
+
+
+/**
+@brief Instrumentation macros
+
+gProfileDispatch(inMessage);	// Times the rest of the scope as the dispatch of inMessage
+**/
+#if WINDOW_PROFILER
+	#define gProfileDispatch(inMessage)		ProfileDispatchScope profile_dispatch_scope(inMessage)
+	#define gProfileFrameBegin()			Profiler::sBeginFrame()
+	#define gProfileFrameEnd()				Profiler::sEndFrame()
+#else
+	#define gProfileDispatch(inMessage)		((void)0)
+	#define gProfileFrameBegin()			((void)0)
+	#define gProfileFrameEnd()				((void)0)
+#endif
@@ -0,0 +1,242 @@
+#include "Recorder.h"
+
+
+
+/**
+@brief Recording state, only touched by the message loop thread
+**/
+bool Recorder::sRecording = false;
+
+static FILE* gRecordFile = nullptr;
+static Array<uint8_t> gRecordBlock;						///< Chunks not written to the file yet
+static HashMap<uint32_t, bool> gRecordedWindows;		///< Handle values of the windows that have their window chunk
+static uint64_t gRecordTimeNS = 0;						///< Time of the last message or frame
+static uint32_t gRecordFrameMessages = 0;				///< Messages since the last frame chunk
+static RecorderStats gRecordStats;
+
+
+
+/**
+@brief Append values to the block
+**/
+static void sWrite(const void* inData, size_t inSize)
+{
+	size_t offset = gRecordBlock.size();
+	gRecordBlock.resize(offset + inSize);
+	memcpy(gRecordBlock.data() + offset, inData, inSize);
+}
+
+template<class T>
+static void sWrite(const T& inValue)
+{
+	sWrite(&inValue, sizeof(T));
+}
+
+static void sWriteVarint(uint64_t inValue)
+{
+	while (inValue >= 0x80)
+	{
+		gRecordBlock.push_back((uint8_t)(inValue | 0x80));
+		inValue >>= 7;
+	}
+	gRecordBlock.push_back((uint8_t)inValue);
+}
+
+static void sWriteSignedVarint(int64_t inValue)
+{
+	sWriteVarint(((uint64_t)inValue << 1) ^ (uint64_t)(inValue >> 63));
+}
+
+
+
+/**
+@brief Nanoseconds since the previous message or frame, @a inTimeNS can be older when a message waited in the queue
+**/
+static void sWriteTime(uint64_t inTimeNS)
+{
+	sWriteSignedVarint((int64_t)(inTimeNS - gRecordTimeNS));
+	gRecordTimeNS = inTimeNS;
+}
+
+
+
+/**
+@brief Write the block to the file, false if that failed
+**/
+static bool sFlushBlock()
+{
+	if (gRecordBlock.empty())
+		return true;
+
+	if (fwrite(gRecordBlock.data(), gRecordBlock.size(), 1, gRecordFile) != 1)
+	{
+		gRecordStats.mFailed = true;
+		gRecordBlock.clear();
+		return false;
+	}
+
+	gRecordStats.mBytes += gRecordBlock.size();
+	gRecordBlock.clear();
+	return true;
+}
+
+
+
+/**
+@brief Write the block once it is full, a failed write stops the recording
+**/
+static void sFlushFullBlock()
+{
+	if (gRecordBlock.size() >= Recorder::cBlockSize && !sFlushBlock())
+		Recorder::sStop();
+}
+
+
+
+/**
+@brief Start recording to a new file at @a inPath
+**/
+bool Recorder::sStart(const char* inPath)
+{
+	sStop();
+
+	gRecordFile = gOpenFile(inPath, "wb");
+	if (gRecordFile == nullptr)
+		return false;
+
+	gRecordBlock.reserve(cBlockSize + 256);
+	gRecordedWindows.clear();
+	gRecordTimeNS = gGetTimeNS();
+	gRecordFrameMessages = 0;
+	gRecordStats = RecorderStats();
+
+	sWrite(cRecordingMagic, sizeof(cRecordingMagic));
+	sWrite(gRecordTimeNS);
+
+	sRecording = true;
+	return true;
+}
+
+
+
+/**
+@brief Write what is left and close the file
+**/
+void Recorder::sStop()
+{
+	if (gRecordFile == nullptr)
+		return;
+
+	sRecording = false;
+	sFlushBlock();
+
+	fclose(gRecordFile);
+	gRecordFile = nullptr;
+}
+
+
+
+/**
+@brief Statistics of the running (or last) recording
+**/
+RecorderStats Recorder::sGetStats()
+{
+	RecorderStats stats = gRecordStats;
+	stats.mBytes += gRecordBlock.size();
+	return stats;
+}
+
+
+
+/**
+@brief Record a message for @a inWindow, preceded by the window chunk the first time the window shows up
+**/
+void Recorder::sRecordMessage(const Message& inMessage, const Window& inWindow)
+{
+	uint32_t handle = inMessage.mHandle.GetValue();
+
+	bool& recorded = gRecordedWindows[handle];
+	if (!recorded)
+	{
+		recorded = true;
+		++gRecordStats.mWindows;
+
+		gRecordBlock.push_back((uint8_t)ERecordChunk::Window);
+		sWrite(handle);
+		sWrite(inWindow.GetUID().GetHigh());
+		sWrite(inWindow.GetUID().GetLow());
+		sWriteVarint(inWindow.GetClassID());
+		gRecordBlock.push_back(inMessage.mType != EMessage::Create ? cRecordWindowExisted : 0);
+	}
+
+	gRecordBlock.push_back((uint8_t)ERecordChunk::Message);
+	sWriteTime(inMessage.mTimeNS != 0 ? inMessage.mTimeNS : gGetTimeNS());
+	sWrite(handle);
+	gRecordBlock.push_back((uint8_t)inMessage.mType);
+
+	switch (inMessage.mType)
+	{
+		case EMessage::Paint:
+			sWriteVarint((uint32_t)inMessage.mWidth);
+			sWriteVarint((uint32_t)inMessage.mHeight);
+			sWriteSignedVarint(inMessage.mDirtyRect.mX);
+			sWriteSignedVarint(inMessage.mDirtyRect.mY);
+			sWriteSignedVarint(inMessage.mDirtyRect.mW);
+			sWriteSignedVarint(inMessage.mDirtyRect.mH);
+			break;
+
+		case EMessage::KeyDown:
+		case EMessage::KeyUp:
+		case EMessage::MouseDown:
+		case EMessage::MouseUp:
+			gRecordBlock.push_back(inMessage.mKeyCode);
+			break;
+
+		case EMessage::MouseMove:
+		case EMessage::RawMouseMove:
+			sWriteSignedVarint(inMessage.mX);
+			sWriteSignedVarint(inMessage.mY);
+			break;
+
+		case EMessage::MouseWheel:
+			sWriteSignedVarint(inMessage.mWheel);
+			sWriteSignedVarint(inMessage.mWheelX);
+			break;
+
+		case EMessage::StateChanged:
+			gRecordBlock.push_back(inMessage.mState);
+			break;
+
+		case EMessage::Create:
+		case EMessage::Close:
+			break;
+
+		case EMessage::Destroy:
+			// The handle is never reused, but the set should not grow with every window that ever existed
+			gRecordedWindows.erase(handle);
+			break;
+	}
+
+	++gRecordStats.mMessages;
+	++gRecordFrameMessages;
+
+	sFlushFullBlock();
+}
+
+
+
+/**
+@brief Record the end of a frame, frames without messages are skipped
+**/
+void Recorder::sRecordFrame()
+{
+	if (gRecordFrameMessages == 0)
+		return;
+	gRecordFrameMessages = 0;
+
+	gRecordBlock.push_back((uint8_t)ERecordChunk::Frame);
+	sWriteTime(gGetTimeNS());
+	++gRecordStats.mFrames;
+
+	sFlushFullBlock();
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+// Additional includes
+#include "Platform.h"
+
+
+
+/**
+@brief Recording file format
+
+The file starts with cRecordingMagic and the gGetTimeNS time the recording started (uint64). After that it is
+only appended to, one chunk after the other, each starting with its ERecordChunk. Integers are little endian,
+varints are LEB128, signed varints zigzag encoded first. A recording that was cut off is valid up to its last
+complete chunk.
+
+Window:		uint32 handle value, uint64 UID high, uint64 UID low, varint class ID, uint8 flags (ERecordWindowFlags)
+Message:	signed varint nanoseconds since the previous message or frame, uint32 handle value, uint8 EMessage, then
+			Paint:								varint width, varint height, 4 signed varints dirty rectangle
+			KeyDown, KeyUp, MouseDown, MouseUp:	uint8 key code
+			MouseMove, RawMouseMove:			2 signed varints position or delta
+			MouseWheel:							2 signed varints vertical and horizontal movement
+			StateChanged:						uint8 state (EWindowStateFlags)
+Frame:		signed varint nanoseconds since the previous message or frame
+**/
+static constexpr char cRecordingMagic[8] = "WVREC01";
+
+enum class ERecordChunk : uint8_t
+{
+	Window = 1,		///< A window appeared in the recording, written before its first message
+	Message,		///< A dispatched message
+	Frame,			///< The message loop closed a frame (see gEndFrame)
+};
+
+enum ERecordWindowFlags : uint8_t
+{
+	cRecordWindowExisted = 1,	///< The window was created before the recording started, there is no EMessage::Create for it
+};
+
+
+
+/**
+@brief Statistics of the running (or last) recording
+**/
+struct RecorderStats
+{
+	uint64_t			mMessages		= 0;	///< Recorded messages
+	uint64_t			mFrames			= 0;	///< Recorded frame boundaries
+	uint64_t			mWindows		= 0;	///< Windows that appeared in the recording
+	uint64_t			mBytes			= 0;	///< Size of the recording file
+	bool				mFailed			= false;	///< Writing to the file failed, the recording stopped there
+};
+
+
+
+/**
+@brief Records every message that reaches gDispatchMessage to a file, for Replayer to feed back later
+
+Recorder::sStart("session.rec");
+gProcessMessageLoop();
+Recorder::sStop();
+
+Only for the message loop thread. Chunks are collected in memory and written in blocks of cBlockSize bytes,
+so recording costs a few bytes of copying per message. Frames without messages are not recorded.
+**/
+class Recorder
+{
+public:
+	static constexpr size_t	cBlockSize = 64 * 1024;
+
+	///@name Recording
+	static bool				sStart(const char* inPath);			///< Start recording to a new file at @a inPath, false if it can't be created
+	static void				sStop();							///< Write what is left and close the file
+	static bool				sIsRecording()						{ return sRecording; }
+	static RecorderStats	sGetStats();
+
+	///@name Instrumentation, called by gDispatchMessage and gEndFrame
+	static void				sRecordMessage(const Message& inMessage, const Window& inWindow);
+	static void				sRecordFrame();
+
+private:
+	static bool				sRecording;
+};
@@ -0,0 +1,82 @@
+#pragma once
+
+// Additional includes
+#include "Utility.h"
+#include "UID.h"
+
+
+
+/**
+@brief Table of objects addressed by their UID
+
+Unlike a Handle, a UID never gets reused and can be stored in files or sent to other processes, so it is the
+stable name of a resource (a window, a texture, a document) for its whole lifetime. Lookups are a single
+HashMap probe. The registry does not own its objects and is not thread safe.
+
+Registry<Texture> textures;
+UID id = textures.Add(texture);
+...
+if (Texture* texture = textures.Find(id))
+	texture->Bind();
+**/
+template<class T>
+class Registry
+{
+public:
+	///@name Modification
+	UID						Add(T* inObject);			///< Add @a inObject under a new UID and return it
+	bool					Add(const UID& inUID, T* inObject);	///< Add @a inObject under @a inUID, false if the UID is already taken
+	bool					Remove(const UID& inUID)	{ return mObjects.erase(inUID) != 0; }	///< Remove the object of @a inUID, false if there was none
+	void					Clear()						{ mObjects.clear(); }	///< Remove all objects
+	void					Reserve(size_t inCount)		{ mObjects.reserve(inCount); }	///< Make room for @a inCount objects so adding them does not rehash
+
+	///@name Lookup
+	T*						Find(const UID& inUID) const;	///< Get the object of @a inUID, nullptr if it is not registered
+	bool					Contains(const UID& inUID) const	{ return mObjects.contains(inUID); }	///< Check if @a inUID is registered
+
+	///@name Iteration
+	template<class F>
+	void					ForEach(F&& inFunction) const	{ for (const auto& entry : mObjects) inFunction(entry.first, entry.second); }	///< Call @a inFunction(UID, T*) for every object in no particular order
+	size_t					GetSize() const				{ return mObjects.size(); }	///< Amount of objects in the registry
+
+private:
+	///@name Properties
+	HashMap<UID, T*>		mObjects;					///< Objects by UID
+};
+
+
+
+/**
+@brief Add @a inObject under a new UID
+**/
+template<class T>
+UID Registry<T>::Add(T* inObject)
+{
+	UID uid = UID::sCreate();
+	Add(uid, inObject);
+	return uid;
+}
+
+
+
+/**
+@brief Add @a inObject under @a inUID
+**/
+template<class T>
+bool Registry<T>::Add(const UID& inUID, T* inObject)
+{
+	gAssert(inObject != nullptr);
+	return mObjects.emplace(inUID, inObject).second;
+}
+
+
+
+/**
+@brief Get the object of @a inUID
+**/
+template<class T>
+inline T* Registry<T>::Find(const UID& inUID) const
+{
+	auto i = mObjects.find(inUID);
+	return i != mObjects.end() ? i->second : nullptr;
+}
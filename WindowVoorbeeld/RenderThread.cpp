@@ -0,0 +1,95 @@
+#include "RenderThread.h"
+
+// Additional includes
+#include "Window.h"
+
+
+
+/**
+@brief Start the render thread of @a inWindow
+**/
+RenderThread::RenderThread(Window* inWindow) :
+	mWindow(inWindow),
+	mThread(&RenderThread::Run, this)
+{
+}
+
+
+
+/**
+@brief Stop the thread
+**/
+RenderThread::~RenderThread()
+{
+	Stop();
+}
+
+
+
+/**
+@brief Request a repaint of @a inRegion at @a inWidth x @a inHeight
+**/
+void RenderThread::RequestPaint(int inWidth, int inHeight, const DirtyRegion& inRegion)
+{
+	{
+		// Only overwrites the pending request, a frame in progress does not hold this lock
+		std::lock_guard<std::mutex> lock(mMutex);
+		if (mStop)
+			return;
+
+		mRequested	= true;
+		mWidth		= inWidth;
+		mHeight		= inHeight;
+		mRegion.Add(inRegion);
+	}
+	mCondition.notify_one();
+}
+
+
+
+/**
+@brief Finish the frame that is being painted and join the thread
+**/
+void RenderThread::Stop()
+{
+	gAssert(!IsRenderThread());
+
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mStop = true;
+	}
+	mCondition.notify_one();
+
+	if (mThread.joinable())
+		mThread.join();
+}
+
+
+
+/**
+@brief Thread entry point
+**/
+void RenderThread::Run()
+{
+	for (;;)
+	{
+		// Take the latest request, everything requested while the previous frame was painting collapses into it
+		int width, height;
+		DirtyRegion region;
+		{
+			std::unique_lock<std::mutex> lock(mMutex);
+			mCondition.wait(lock, [this]() { return mRequested || mStop; });
+			if (mStop)
+				return;
+
+			mRequested	= false;
+			width		= mWidth;
+			height		= mHeight;
+			region		= mRegion;
+			mRegion.Clear();
+		}
+
+		std::lock_guard<std::recursive_mutex> paint_lock(mPaintMutex);
+		mWindow->Paint(width, height, region);
+	}
+}
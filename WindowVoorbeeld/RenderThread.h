@@ -0,0 +1,55 @@
+#pragma once
+
+// Additional includes
+#include "Utility.h"
+#include "DirtyRegion.h"
+
+// STL includes
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+
+
+/**
+@brief Thread that paints a single window, so a slow OnPaint never blocks the message loop
+
+The message loop only posts "repaint requested, with this size and region" through RequestPaint. Requests that arrive
+while a frame is being painted are coalesced into one repaint with the latest size and the merged region.
+Created through Window::EnableRenderThread, stopped (and joined) before the window is destroyed.
+**/
+class Window;
+class RenderThread
+{
+public:
+	///@name Construction
+	explicit				RenderThread(Window* inWindow);
+							~RenderThread();				///< Stops the thread
+							RenderThread(const RenderThread&) = delete;
+	RenderThread&			operator=(const RenderThread&) = delete;
+
+	///@name Message loop thread
+	void					RequestPaint(int inWidth, int inHeight, const DirtyRegion& inRegion);	///< Request a repaint of @a inRegion at @a inWidth x @a inHeight, never waits for painting
+	void					Stop();							///< Finish the frame that is being painted and join the thread, later requests are ignored
+
+	///@name Properties
+	bool					IsRenderThread() const			{ return std::this_thread::get_id() == mThread.get_id(); }	///< Check if the calling thread is this render thread
+	std::recursive_mutex&	GetPaintMutex()					{ return mPaintMutex; }		///< Held while a frame is painted, recursive so OnPaint can (un)subscribe the paint events
+
+private:
+	///@name Render thread
+	void					Run();							///< Thread entry point
+
+	///@name Properties
+	Window*					mWindow;						///< Window to paint
+	std::mutex				mMutex;							///< Protects the request below, only held to copy it
+	std::condition_variable	mCondition;						///< Signaled on a request or stop
+	bool					mRequested	= false;			///< A repaint is pending
+	bool					mStop		= false;			///< The thread should exit
+	int						mWidth		= 0;				///< Size of the pending repaint
+	int						mHeight		= 0;
+	DirtyRegion				mRegion;						///< Merged region of the pending repaints
+	std::recursive_mutex	mPaintMutex;					///< See GetPaintMutex
+	std::thread				mThread;						///< The render thread itself, started last
+};
@@ -0,0 +1,265 @@
+#include "Replayer.h"
+
+
+
+/**
+@brief Window that is created for a recorded window when ReplaySettings::mCreateWindow is not set, it handles nothing
+**/
+class ReplayedWindow : public Window { };
+
+
+
+/**
+@brief Decodes the chunks of a mapped recording, every read fails once the data runs out
+**/
+class RecordingReader
+{
+public:
+	///@name Construction
+							RecordingReader(const uint8_t* inData, size_t inSize) :	mPosition(inData), mEnd(inData + inSize) { }
+
+	///@name Reading
+	bool					IsAtEnd() const						{ return mPosition == mEnd; }
+
+	template<class T>
+	bool					Read(T& outValue)					///< Read a fixed size value
+	{
+		if ((size_t)(mEnd - mPosition) < sizeof(T))
+			return false;
+		memcpy(&outValue, mPosition, sizeof(T));
+		mPosition += sizeof(T);
+		return true;
+	}
+
+	bool					ReadVarint(uint64_t& outValue)		///< Read an unsigned LEB128 value
+	{
+		outValue = 0;
+		for (int shift = 0; shift < 64 && mPosition < mEnd; shift += 7)
+		{
+			uint8_t byte = *mPosition++;
+			outValue |= (uint64_t)(byte & 0x7f) << shift;
+			if ((byte & 0x80) == 0)
+				return true;
+		}
+		return false;
+	}
+
+	template<class T>
+	bool					ReadSignedVarint(T& outValue)		///< Read a zigzag encoded LEB128 value
+	{
+		uint64_t value;
+		if (!ReadVarint(value))
+			return false;
+		outValue = (T)(int64_t)((value >> 1) ^ (0 - (value & 1)));
+		return true;
+	}
+
+	template<class T>
+	bool					ReadVarint(T& outValue)				///< Read an unsigned LEB128 value into a smaller type
+	{
+		uint64_t value;
+		if (!ReadVarint(value))
+			return false;
+		outValue = (T)value;
+		return true;
+	}
+
+private:
+	const uint8_t*			mPosition;
+	const uint8_t*			mEnd;
+};
+
+
+
+/**
+@brief Read the payload of a message chunk after its type
+**/
+static bool sReadPayload(RecordingReader& ioReader, Message& ioMessage)
+{
+	switch (ioMessage.mType)
+	{
+		case EMessage::Paint:
+			return ioReader.ReadVarint(ioMessage.mWidth) && ioReader.ReadVarint(ioMessage.mHeight)
+				&& ioReader.ReadSignedVarint(ioMessage.mDirtyRect.mX) && ioReader.ReadSignedVarint(ioMessage.mDirtyRect.mY)
+				&& ioReader.ReadSignedVarint(ioMessage.mDirtyRect.mW) && ioReader.ReadSignedVarint(ioMessage.mDirtyRect.mH);
+
+		case EMessage::KeyDown:
+		case EMessage::KeyUp:
+		case EMessage::MouseDown:
+		case EMessage::MouseUp:
+			return ioReader.Read(ioMessage.mKeyCode);
+
+		case EMessage::MouseMove:
+		case EMessage::RawMouseMove:
+			return ioReader.ReadSignedVarint(ioMessage.mX) && ioReader.ReadSignedVarint(ioMessage.mY);
+
+		case EMessage::MouseWheel:
+			return ioReader.ReadSignedVarint(ioMessage.mWheel) && ioReader.ReadSignedVarint(ioMessage.mWheelX);
+
+		case EMessage::StateChanged:
+			return ioReader.Read(ioMessage.mState);
+
+		case EMessage::Create:
+		case EMessage::Close:
+		case EMessage::Destroy:
+			return true;
+	}
+
+	// Not a message type of this version
+	return false;
+}
+
+
+
+/**
+@brief Map the recording at @a inPath
+**/
+bool Replayer::Open(const char* inPath)
+{
+	Close();
+	if (!mFile.Open(inPath))
+		return false;
+
+	RecordingReader reader(mFile.GetData(), mFile.GetSize());
+	char magic[sizeof(cRecordingMagic)];
+	if (!reader.Read(magic) || memcmp(magic, cRecordingMagic, sizeof(magic)) != 0 || !reader.Read(mStartTimeNS))
+	{
+		Close();
+		return false;
+	}
+	return true;
+}
+
+
+
+/**
+@brief Unmap the recording
+**/
+void Replayer::Close()
+{
+	mFile.Close();
+	mStartTimeNS = 0;
+}
+
+
+
+/**
+@brief Replay the whole recording
+**/
+ReplayStats Replayer::Run(const ReplaySettings& inSettings)
+{
+	ReplayStats stats;
+	if (!mFile.IsOpen())
+		return stats;
+
+	// Open checked the header already
+	const size_t header_size = sizeof(cRecordingMagic) + sizeof(uint64_t);
+	RecordingReader reader(mFile.GetData() + header_size, mFile.GetSize() - header_size);
+	uint64_t recorded_time = mStartTimeNS;
+
+	// Recorded handle value to the window that replays it
+	HashMap<uint32_t, WindowHandle> windows;
+
+	uint64_t start = gGetTimeNS();
+	uint64_t first_time = recorded_time;
+	double time_scale = inSettings.mSpeed > 0.0 ? 1.0 / inSettings.mSpeed : 0.0;
+
+	// Time of a recorded event on the replay clock, waits until it is due when replaying at a pace
+	auto wait_until = [&](uint64_t inRecordedTime) -> uint64_t
+	{
+		if (time_scale == 0.0)
+			return gGetTimeNS();
+
+		uint64_t due = start + (uint64_t)((int64_t)(inRecordedTime - first_time) * time_scale);
+		uint64_t now = gGetTimeNS();
+		if (due > now)
+			gPlatformSleep((due - now) * 1e-9);
+		return due;
+	};
+
+	bool complete = false;
+	for (;;)
+	{
+		if (reader.IsAtEnd())
+		{
+			complete = true;
+			break;
+		}
+
+		ERecordChunk chunk;
+		if (!reader.Read(chunk))
+			break;
+
+		if (chunk == ERecordChunk::Window)
+		{
+			ReplayWindow recorded;
+			uint64_t uid_high, uid_low;
+			uint8_t flags;
+			if (!reader.Read(recorded.mHandle) || !reader.Read(uid_high) || !reader.Read(uid_low) || !reader.ReadVarint(recorded.mClassID) || !reader.Read(flags))
+				break;
+			recorded.mUID = UID::sFromParts(uid_high, uid_low);
+			recorded.mExisted = (flags & cRecordWindowExisted) != 0;
+
+			// Creating the window dispatches its own EMessage::Create, the recorded one is skipped
+			Window* window = inSettings.mCreateWindow ? inSettings.mCreateWindow(recorded) : Window::sCreate<ReplayedWindow>({ 0, 0, 640, 480 }, "Replay");
+			if (window != nullptr)
+			{
+				windows[recorded.mHandle] = window->GetHandle();
+				++stats.mWindows;
+			}
+			continue;
+		}
+
+		int64_t delta;
+		if (!reader.ReadSignedVarint(delta))
+			break;
+		recorded_time += (uint64_t)delta;
+
+		if (chunk == ERecordChunk::Frame)
+		{
+			wait_until(recorded_time);
+			gEndFrame();
+			++stats.mFrames;
+			continue;
+		}
+
+		if (chunk != ERecordChunk::Message)
+			break;
+
+		uint32_t handle;
+		Message message;
+		if (!reader.Read(handle) || !reader.Read(message.mType) || !sReadPayload(reader, message))
+			break;
+
+		auto iter = windows.find(handle);
+		Window* window = iter != windows.end() ? Window::sGet(iter->second) : nullptr;
+		if (window == nullptr || message.mType == EMessage::Create)
+		{
+			stats.mSkipped += message.mType != EMessage::Create;
+			continue;
+		}
+
+		message.mHandle = window->GetHandle();
+		message.mTimeNS = wait_until(recorded_time);
+
+		// Destroying goes through the platform, so the native window goes away with it
+		if (message.mType == EMessage::Destroy)
+		{
+			gPlatformDestroyWindow(window->GetNativeHandle());
+			windows.erase(iter);
+		}
+		else
+			gDispatchMessage(message);
+		++stats.mMessages;
+	}
+
+	// Windows that outlived the recording
+	if (inSettings.mDestroyWindows)
+		for (auto& window : windows)
+			if (Window* alive = Window::sGet(window.second))
+				gPlatformDestroyWindow(alive->GetNativeHandle());
+
+	stats.mDuration = (gGetTimeNS() - start) * 1e-9;
+	stats.mComplete = complete;
+	return stats;
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+// Additional includes
+#include "Function.h"
+#include "MappedFile.h"
+#include "Recorder.h"
+
+
+
+/**
+@brief Window as it appears in a recording, passed to ReplaySettings::mCreateWindow
+**/
+struct ReplayWindow
+{
+	uint32_t			mHandle			= 0;		///< Handle value of the window in the recording
+	UID					mUID			= UID::sFromParts(0, 0);	///< UID of the window in the recording
+	uint32_t			mClassID		= 0;		///< Class ID of the window type in the recording, see Window::sGetClassID
+	bool				mExisted		= false;	///< The window was created before the recording started
+};
+
+
+
+/**
+@brief Settings for Replayer::Run
+**/
+struct ReplaySettings
+{
+	using WindowFactory = InplaceFunction<Window*(const ReplayWindow&)>;
+
+	double				mSpeed			= 1.0;		///< 1 replays at the recorded pace, 2 twice as fast, 0 as fast as possible
+	WindowFactory		mCreateWindow;				///< Creates the window for a recorded window, usually by class ID. Without it windows without handlers are created
+	bool				mDestroyWindows	= true;		///< Destroy the windows that are still alive at the end of the recording
+};
+
+
+
+/**
+@brief Statistics of a replay
+**/
+struct ReplayStats
+{
+	uint64_t			mMessages		= 0;		///< Messages dispatched
+	uint64_t			mFrames			= 0;		///< Frames closed with gEndFrame
+	uint64_t			mWindows		= 0;		///< Windows created
+	uint64_t			mSkipped		= 0;		///< Messages for windows that were not created or already destroyed
+	double				mDuration		= 0.0;		///< Seconds the replay took
+	bool				mComplete		= false;	///< The whole recording was replayed, false if it was cut off or damaged
+};
+
+
+
+/**
+@brief Feeds a recording of Recorder back through gDispatchMessage
+
+Replayer replayer;
+if (replayer.Open("session.rec"))
+	ReplayStats stats = replayer.Run(ReplaySettings());
+
+The file is memory mapped and decoded while replaying, so recordings of any length replay without loading
+them first. Every recorded window gets a new window, created through ReplaySettings::mCreateWindow. Messages go
+to gDispatchMessage like the platform backend sends them, destroys go through gPlatformDestroyWindow, and the
+recorded frame boundaries call gEndFrame. Call Run on the message loop thread, outside of gProcessMessageLoop.
+**/
+class Replayer
+{
+public:
+	///@name Recording
+	bool				Open(const char* inPath);	///< Map the recording at @a inPath, false if it can't be opened or is not a recording
+	void				Close();
+	bool				IsOpen() const				{ return mFile.IsOpen(); }
+	uint64_t			GetStartTimeNS() const		{ return mStartTimeNS; }	///< gGetTimeNS time the recording started, in the recording process
+
+	///@name Replay
+	ReplayStats			Run(const ReplaySettings& inSettings);	///< Replay the whole recording, can be called more than once
+
+private:
+	///@name Properties
+	MappedFile			mFile;
+	uint64_t			mStartTimeNS = 0;
+};
@@ -0,0 +1,167 @@
+#pragma once
+
+// STL includes
+#include <atomic>
+
+// Additional includes
+#include "Utility.h"
+
+
+
+/**
+@brief Bounded lock-free ring buffer for any amount of producer and consumer threads
+
+Every cell carries a sequence number that tells whether it is ready to be written or read for
+the current lap around the ring, so producers and consumers only contend on their own index.
+Push never blocks: when the ring is full it returns false and the caller decides what to drop.
+@a N must be a power of two.
+**/
+template<class T, size_t N>
+class RingBuffer
+{
+public:
+	static_assert(N >= 2 && (N & (N - 1)) == 0, "RingBuffer size must be a power of two");
+
+	///@name Construction
+							RingBuffer();
+
+	///@name Producer
+	bool					Push(const T& inValue);							///< Add @a inValue, returns false if the ring is full
+
+	///@name Consumer
+	bool					Pop(T& outValue)								{ return PopBatch(&outValue, 1) == 1; } ///< Take the oldest value, returns false if the ring is empty
+	size_t					PopBatch(T* outValues, size_t inMaxValues);		///< Take up to @a inMaxValues of the oldest values in order, returns the amount taken
+
+	///@name Properties
+	static constexpr size_t	sGetCapacity()									{ return N; }	///< Maximum amount of values in the ring
+	size_t					GetSizeApprox() const;							///< Amount of values in the ring, only exact when no thread is pushing or popping
+
+private:
+	/**
+	@brief One value in the ring
+	**/
+	struct Cell
+	{
+		std::atomic<size_t>	mSequence;										///< Position this cell is ready for: writable at pos, readable at pos + 1
+		T					mValue;											///< Stored value
+	};
+
+	///@name Properties, producer and consumer index on their own cache lines
+	alignas(64) Cell		mCells[N];
+	alignas(64) std::atomic<size_t> mEnqueuePos { 0 };
+	alignas(64) std::atomic<size_t> mDequeuePos { 0 };
+};
+
+
+
+/**
+@brief Construct an empty ring
+**/
+template<class T, size_t N>
+RingBuffer<T, N>::RingBuffer()
+{
+	for (size_t i = 0; i < N; ++i)
+		mCells[i].mSequence.store(i, std::memory_order_relaxed);
+}
+
+
+
+/**
+@brief Add @a inValue
+**/
+template<class T, size_t N>
+bool RingBuffer<T, N>::Push(const T& inValue)
+{
+	size_t pos = mEnqueuePos.load(std::memory_order_relaxed);
+	for (;;)
+	{
+		Cell& cell = mCells[pos & (N - 1)];
+		size_t sequence = cell.mSequence.load(std::memory_order_acquire);
+		intptr_t difference = (intptr_t)sequence - (intptr_t)pos;
+		if (difference == 0)
+		{
+			// The cell is free for this lap, claim it
+			if (mEnqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+			{
+				cell.mValue = inValue;
+				cell.mSequence.store(pos + 1, std::memory_order_release);
+				return true;
+			}
+		}
+		else if (difference < 0)
+		{
+			// The cell still holds a value of the previous lap, the ring is full
+			return false;
+		}
+		else
+		{
+			// Another producer claimed this position, try the next one
+			pos = mEnqueuePos.load(std::memory_order_relaxed);
+		}
+	}
+}
+
+
+
+/**
+@brief Take up to @a inMaxValues of the oldest values in order
+
+The whole batch is claimed with a single compare exchange.
+**/
+template<class T, size_t N>
+size_t RingBuffer<T, N>::PopBatch(T* outValues, size_t inMaxValues)
+{
+	size_t pos = mDequeuePos.load(std::memory_order_relaxed);
+	for (;;)
+	{
+		// Count how many consecutive cells are readable
+		size_t count = 0;
+		intptr_t difference = 0;
+		while (count < inMaxValues)
+		{
+			size_t sequence = mCells[(pos + count) & (N - 1)].mSequence.load(std::memory_order_acquire);
+			difference = (intptr_t)sequence - (intptr_t)(pos + count + 1);
+			if (difference != 0)
+				break;
+			++count;
+		}
+
+		if (count == 0)
+		{
+			// Nothing written yet at the read position, the ring is empty
+			if (difference < 0 || inMaxValues == 0)
+				return 0;
+
+			// Another consumer took this position, try again from the new one
+			pos = mDequeuePos.load(std::memory_order_relaxed);
+			continue;
+		}
+
+		// Claim the batch, on failure pos holds the current position and we count again
+		if (mDequeuePos.compare_exchange_weak(pos, pos + count, std::memory_order_relaxed))
+		{
+			for (size_t i = 0; i < count; ++i)
+			{
+				Cell& cell = mCells[(pos + i) & (N - 1)];
+				outValues[i] = cell.mValue;
+
+				// Make the cell writable for the next lap
+				cell.mSequence.store(pos + i + N, std::memory_order_release);
+			}
+			return count;
+		}
+	}
+}
+
+
+
+/**
+@brief Amount of values in the ring
+**/
+template<class T, size_t N>
+size_t RingBuffer<T, N>::GetSizeApprox() const
+{
+	size_t enqueue_pos = mEnqueuePos.load(std::memory_order_relaxed);
+	size_t dequeue_pos = mDequeuePos.load(std::memory_order_relaxed);
+	return enqueue_pos > dequeue_pos ? enqueue_pos - dequeue_pos : 0;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+// Additional includes
+#include "Utility.h"
+
+
+
+/**
+@brief Non owning view of contiguous elements, passed by value
+**/
+template<class T>
+class Span
+{
+public:
+	///@name Construction
+	constexpr				Span() = default;
+	constexpr				Span(T* inData, size_t inSize) :	mData(inData), mSize(inSize) { }
+
+	///@name Properties
+	constexpr T*			data() const						{ return mData; }
+	constexpr size_t		size() const						{ return mSize; }
+	constexpr bool			empty() const						{ return mSize == 0; }
+
+	///@name Access
+	constexpr T&			operator[](size_t inIndex) const	{ return mData[inIndex]; }
+	constexpr T&			front() const						{ return mData[0]; }
+	constexpr T&			back() const						{ return mData[mSize - 1]; }
+	constexpr T*			begin() const						{ return mData; }
+	constexpr T*			end() const							{ return mData + mSize; }
+
+private:
+	///@name Properties
+	T*						mData = nullptr;
+	size_t					mSize = 0;
+};
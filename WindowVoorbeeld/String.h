@@ -0,0 +1,282 @@
+#pragma once
+
+// Additional includes
+#include "Allocator.h"
+#include "Assert.h"
+
+// STL includes
+#include <cstring>
+#include <cwchar>
+#include <type_traits>
+#include <utility>
+
+
+
+/**
+@brief Zero terminated string with small string optimization
+
+Strings of up to cInlineCapacity units are stored inside the object, so window titles, class names and most
+log fragments never allocate. The interface follows std::basic_string for the parts the project uses.
+No encoding is implied, String holds UTF-8 by convention (see Unicode.h to convert).
+**/
+template<class Char, class Alloc = DefaultAllocator>
+class BasicString : private Alloc
+{
+public:
+	static constexpr size_t	cInlineCapacity = 24 / sizeof(Char) - 1;	///< Units that fit without allocating, excluding the terminator
+
+	using value_type		= Char;
+	using size_type			= size_t;
+	using iterator			= Char*;
+	using const_iterator	= const Char*;
+
+	///@name Construction
+							BasicString() :						BasicString(Alloc()) { }
+	explicit				BasicString(const Alloc& inAllocator) :	Alloc(inAllocator), mData(mInline) { mInline[0] = 0; }
+							BasicString(const Char* inString, const Alloc& inAllocator = Alloc()) : BasicString(inAllocator) { append(inString, sLength(inString)); }
+							BasicString(const Char* inString, size_t inLength, const Alloc& inAllocator = Alloc()) : BasicString(inAllocator) { append(inString, inLength); }
+							BasicString(size_t inLength, Char inChar, const Alloc& inAllocator = Alloc()) : BasicString(inAllocator) { resize(inLength, inChar); }
+							BasicString(const BasicString& inOther) :	BasicString(inOther.GetAllocator()) { append(inOther.mData, inOther.mSize); }
+							BasicString(BasicString&& inOther) noexcept : BasicString(inOther.GetAllocator()) { MoveFrom(inOther); }
+							~BasicString()						{ FreeData(); }
+
+	///@name Assignment
+	BasicString&			operator=(const BasicString& inOther)	{ if (this != &inOther) assign(inOther.mData, inOther.mSize); return *this; }
+	BasicString&			operator=(BasicString&& inOther) noexcept;
+	BasicString&			operator=(const Char* inString)		{ return assign(inString, sLength(inString)); }
+	BasicString&			assign(const Char* inString, size_t inLength)	{ clear(); return append(inString, inLength); }
+
+	///@name Properties
+	size_t					size() const						{ return mSize; }
+	size_t					length() const						{ return mSize; }
+	size_t					capacity() const					{ return IsInline() ? cInlineCapacity : mCapacity; }
+	bool					empty() const						{ return mSize == 0; }
+	const Char*				c_str() const						{ return mData; }
+	const Char*				data() const						{ return mData; }
+	Char*					data()								{ return mData; }
+	bool					IsInline() const					{ return mData == mInline; }	///< Check if the string is stored inside the object
+	const Alloc&			GetAllocator() const				{ return *this; }
+
+	///@name Access
+	Char&					operator[](size_t inIndex)			{ gAssert(inIndex <= mSize); return mData[inIndex]; }
+	const Char&				operator[](size_t inIndex) const	{ gAssert(inIndex <= mSize); return mData[inIndex]; }
+	Char&					back()								{ gAssert(mSize > 0); return mData[mSize - 1]; }
+	const Char&				back() const						{ gAssert(mSize > 0); return mData[mSize - 1]; }
+
+	///@name Iteration
+	Char*					begin()								{ return mData; }
+	Char*					end()								{ return mData + mSize; }
+	const Char*				begin() const						{ return mData; }
+	const Char*				end() const							{ return mData + mSize; }
+
+	///@name Modification
+	void					reserve(size_t inCapacity)			{ if (inCapacity > capacity()) Reallocate(inCapacity); }
+	void					resize(size_t inLength, Char inChar = Char());	///< Grow with @a inChar or shrink
+	void					clear()								{ mSize = 0; mData[0] = 0; }
+	void					push_back(Char inChar)				{ append(&inChar, 1); }
+	BasicString&			append(const Char* inString, size_t inLength);	///< Append @a inLength units of @a inString, which can point into this string
+
+	///@name Operators
+	BasicString&			operator+=(const BasicString& inOther)	{ return append(inOther.mData, inOther.mSize); }
+	BasicString&			operator+=(const Char* inString)	{ return append(inString, sLength(inString)); }
+	BasicString&			operator+=(Char inChar)				{ return append(&inChar, 1); }
+	bool					operator==(const BasicString& inOther) const	{ return mSize == inOther.mSize && memcmp(mData, inOther.mData, mSize * sizeof(Char)) == 0; }
+	bool					operator!=(const BasicString& inOther) const	{ return !(*this == inOther); }
+	bool					operator<(const BasicString& inOther) const;	///< Lexicographic order by unit value
+
+	///@name Helpers
+	static size_t			sLength(const Char* inString)		{ size_t length = 0; while (inString[length] != 0) ++length; return length; }	///< Length of a zero terminated string
+
+private:
+	///@name Helpers
+	void					Reallocate(size_t inCapacity);		///< Move to heap storage for @a inCapacity units plus the terminator
+	void					FreeData()							{ if (!IsInline()) this->Free(mData, (mCapacity + 1) * sizeof(Char), alignof(Char)); }
+	void					MoveFrom(BasicString& ioOther);		///< Take the contents of @a ioOther, which is empty afterwards
+
+	///@name Properties
+	Char*					mData;								///< Units, mInline for short strings
+	size_t					mSize = 0;							///< Units excluding the terminator
+	union
+	{
+		size_t				mCapacity;							///< Heap capacity excluding the terminator
+		Char				mInline[cInlineCapacity + 1];		///< Inline units and terminator
+	};
+};
+
+
+
+/**
+@brief UTF-8 string, see WString in Utility.h for the wide version
+**/
+using String = BasicString<char>;
+
+
+
+/**
+@brief Concatenate
+**/
+template<class Char, class Alloc>
+BasicString<Char, Alloc> operator+(const BasicString<Char, Alloc>& inLeft, const BasicString<Char, Alloc>& inRight)
+{
+	BasicString<Char, Alloc> result(inLeft.GetAllocator());
+	result.reserve(inLeft.size() + inRight.size());
+	result.append(inLeft.data(), inLeft.size());
+	result.append(inRight.data(), inRight.size());
+	return result;
+}
+
+template<class Char, class Alloc>
+BasicString<Char, Alloc> operator+(const BasicString<Char, Alloc>& inLeft, const Char* inRight)
+{
+	size_t right_length = BasicString<Char, Alloc>::sLength(inRight);
+	BasicString<Char, Alloc> result(inLeft.GetAllocator());
+	result.reserve(inLeft.size() + right_length);
+	result.append(inLeft.data(), inLeft.size());
+	result.append(inRight, right_length);
+	return result;
+}
+
+template<class Char, class Alloc>
+BasicString<Char, Alloc> operator+(const Char* inLeft, const BasicString<Char, Alloc>& inRight)
+{
+	size_t left_length = BasicString<Char, Alloc>::sLength(inLeft);
+	BasicString<Char, Alloc> result(inRight.GetAllocator());
+	result.reserve(left_length + inRight.size());
+	result.append(inLeft, left_length);
+	result.append(inRight.data(), inRight.size());
+	return result;
+}
+
+template<class Char, class Alloc>
+BasicString<Char, Alloc> operator+(BasicString<Char, Alloc>&& inLeft, const Char* inRight)
+{
+	inLeft += inRight;
+	return std::move(inLeft);
+}
+
+template<class Char, class Alloc>
+BasicString<Char, Alloc> operator+(BasicString<Char, Alloc>&& inLeft, const BasicString<Char, Alloc>& inRight)
+{
+	inLeft += inRight;
+	return std::move(inLeft);
+}
+
+
+
+/**
+@brief Move assignment, the allocator moves along with the memory it allocated
+**/
+template<class Char, class Alloc>
+BasicString<Char, Alloc>& BasicString<Char, Alloc>::operator=(BasicString&& inOther) noexcept
+{
+	if (this != &inOther)
+	{
+		FreeData();
+		mData = mInline;
+		static_cast<Alloc&>(*this) = inOther.GetAllocator();
+		MoveFrom(inOther);
+	}
+	return *this;
+}
+
+
+
+/**
+@brief Take the contents of @a ioOther
+**/
+template<class Char, class Alloc>
+void BasicString<Char, Alloc>::MoveFrom(BasicString& ioOther)
+{
+	if (ioOther.IsInline())
+	{
+		memcpy(mInline, ioOther.mInline, (ioOther.mSize + 1) * sizeof(Char));
+		mData = mInline;
+	}
+	else
+	{
+		mData = ioOther.mData;
+		mCapacity = ioOther.mCapacity;
+		ioOther.mData = ioOther.mInline;
+	}
+	mSize = ioOther.mSize;
+	ioOther.mSize = 0;
+	ioOther.mData[0] = 0;
+}
+
+
+
+/**
+@brief Move to heap storage for @a inCapacity units plus the terminator
+**/
+template<class Char, class Alloc>
+void BasicString<Char, Alloc>::Reallocate(size_t inCapacity)
+{
+	// Grow by at least half so appending in a loop stays linear
+	size_t current = capacity();
+	if (inCapacity < current + current / 2)
+		inCapacity = current + current / 2;
+
+	Char* data = (Char*)this->Allocate((inCapacity + 1) * sizeof(Char), alignof(Char));
+	memcpy(data, mData, (mSize + 1) * sizeof(Char));
+	FreeData();
+	mData = data;
+	mCapacity = inCapacity;
+}
+
+
+
+/**
+@brief Grow with @a inChar or shrink
+**/
+template<class Char, class Alloc>
+void BasicString<Char, Alloc>::resize(size_t inLength, Char inChar)
+{
+	reserve(inLength);
+	for (size_t i = mSize; i < inLength; ++i)
+		mData[i] = inChar;
+	mSize = inLength;
+	mData[mSize] = 0;
+}
+
+
+
+/**
+@brief Append @a inLength units of @a inString
+**/
+template<class Char, class Alloc>
+BasicString<Char, Alloc>& BasicString<Char, Alloc>::append(const Char* inString, size_t inLength)
+{
+	if (mSize + inLength > capacity())
+	{
+		// The source can be part of this string, keep it alive while reallocating
+		if (inString >= mData && inString <= mData + mSize)
+		{
+			size_t offset = inString - mData;
+			Reallocate(mSize + inLength);
+			inString = mData + offset;
+		}
+		else
+			Reallocate(mSize + inLength);
+	}
+
+	memmove(mData + mSize, inString, inLength * sizeof(Char));
+	mSize += inLength;
+	mData[mSize] = 0;
+	return *this;
+}
+
+
+
+/**
+@brief Lexicographic order by unsigned unit value, like std::string, so UTF-8 lead bytes sort after ASCII even where char is signed
+**/
+template<class Char, class Alloc>
+bool BasicString<Char, Alloc>::operator<(const BasicString& inOther) const
+{
+	using Unit = typename std::make_unsigned<Char>::type;
+	size_t length = mSize < inOther.mSize ? mSize : inOther.mSize;
+	for (size_t i = 0; i < length; ++i)
+		if (mData[i] != inOther.mData[i])
+			return (Unit)mData[i] < (Unit)inOther.mData[i];
+	return mSize < inOther.mSize;
+}
@@ -1,37 +1,89 @@
 #include "UID.h"
 
-// Win32 includes
-#include <windows.h>
+// STL includes
+#include <atomic>
+#include <random>
+
 
 
-#pragma warning (push)
-#pragma warning (disable : 6031)
 /**
-@brief Create a unique identifier
+@brief xoshiro256** generator, one per thread so creating a UID needs no synchronization
 **/
-UID UID::sCreate()
+class UIDGenerator
 {
-	GUID id;
-	CoCreateGuid(&id);
-	return *(UID*)&id;
+public:
+	///@name Construction
+						UIDGenerator();						///< Seed from the operating system's random source
+
+	///@name Generation
+	uint64_t			Next();								///< Next 64 random bits
+
+private:
+	///@name Helpers
+	static uint64_t		sRotate(uint64_t inValue, int inBits)	{ return (inValue << inBits) | (inValue >> (64 - inBits)); }
+	static uint64_t		sSplitMix(uint64_t& ioState);		///< Expand a 64 bit seed into well distributed values
+
+	///@name Properties
+	uint64_t			mState[4];
+};
+
+
+
+/**
+@brief Seed from the operating system's random source
+**/
+UIDGenerator::UIDGenerator()
+{
+	// random_device is cryptographic on the platforms we target, the thread index and clock are mixed in
+	// as well so two threads can never share a stream even if it would not be
+	static std::atomic<uint64_t> thread_index { 0 };
+	std::random_device device;
+	uint64_t seed = ((uint64_t)device() << 32) ^ device() ^ gGetTimeNS();
+	uint64_t salt = gMixHash(++thread_index);
+
+	for (uint64_t& state : mState)
+		state = sSplitMix(seed) ^ ((uint64_t)device() << 32) ^ salt;
 }
-#pragma warning (pop)
+
+
+
+/**
+@brief Expand a 64 bit seed (SplitMix64)
+**/
+uint64_t UIDGenerator::sSplitMix(uint64_t& ioState)
+{
+	ioState += 0x9E3779B97F4A7C15ULL;
+	return gMixHash(ioState);
+}
+
 
 
 /**
-@brief Compare UIDs
+@brief Next 64 random bits
 **/
-bool UID::operator==(const UID& inUID)
+uint64_t UIDGenerator::Next()
 {
-	return IsEqualGUID(*(GUID*)this, *(GUID*)&inUID);
+	uint64_t result = sRotate(mState[1] * 5, 7) * 9;
+	uint64_t t = mState[1] << 17;
+
+	mState[2] ^= mState[0];
+	mState[3] ^= mState[1];
+	mState[1] ^= mState[2];
+	mState[0] ^= mState[3];
+	mState[2] ^= t;
+	mState[3] = sRotate(mState[3], 45);
+
+	return result;
 }
 
 
 
 /**
-@brief Compare UIDs
+@brief Create a unique identifier
 **/
-bool UID::operator!=(const UID& inUID)
+UID UID::sCreate()
 {
-	return !(*this == inUID);
+	thread_local UIDGenerator generator;
+	uint64_t high = generator.Next();
+	return UID(high, generator.Next());
 }
@@ -1,30 +1,69 @@
 #pragma once
 
-// 
+// Additional includes
 #include "Utility.h"
 
+// STL includes
+#include <functional>
+
 
 /**
 @brief UID is a 128-bit integer that can be used to uniquely identify resources
+
+The bits come from a per-thread xoshiro256** generator seeded from the operating system's random source,
+so creating one takes a few nanoseconds, never locks and never calls into the platform.
+UIDs can key a HashMap (or std::unordered_map) and be sorted.
 **/
 class UID
 {
 public:
 	///@name Static create function
-	static UID	sCreate();
+	static UID	sCreate();									///< Create a unique identifier, can be called from any thread
+	static UID	sFromParts(uint64_t inHigh, uint64_t inLow)	{ return UID(inHigh, inLow); }	///< Rebuild a UID from GetHigh and GetLow, e.g. after reading it from a file
 
 	///@name No constructor, use UID::sCreate instead
 				UID() = delete;
 
+	///@name Properties
+	uint64_t	GetHigh() const								{ return mHigh; }	///< Upper 64 bits
+	uint64_t	GetLow() const								{ return mLow; }	///< Lower 64 bits
+	uint64_t	GetHash() const								{ return mHigh ^ mLow; }	///< Hash for lookup tables, the bits are random so no mixing is needed
+
 	///@name Operators
-	bool		operator==(const UID& inUID); ///< Compare UIDs
-	bool		operator!=(const UID& inUID); ///< Compare UIDs
+	bool		operator==(const UID& inUID) const			{ return mHigh == inUID.mHigh && mLow == inUID.mLow; } ///< Compare UIDs
+	bool		operator!=(const UID& inUID) const			{ return !(*this == inUID); } ///< Compare UIDs
+	bool		operator<(const UID& inUID) const			{ return mHigh != inUID.mHigh ? mHigh < inUID.mHigh : mLow < inUID.mLow; } ///< Order UIDs, e.g. to sort or store them in a std::map
 
 private:
+	///@name Constructor
+				UID(uint64_t inHigh, uint64_t inLow) :		mHigh(inHigh), mLow(inLow) { }
+
 	///@name Properties
-	uint32_t	mData1;
-	uint16_t	mData2;
-	uint16_t	mData3;
-	uint64_t	mData4;
+	uint64_t	mHigh;
+	uint64_t	mLow;
 };
 
+
+
+/**
+@brief Hash a UID for HashMap
+**/
+template<>
+struct Hash<UID>
+{
+	uint64_t	operator()(const UID& inUID) const			{ return inUID.GetHash(); }
+};
+
+
+
+/**
+@brief Hash a UID for the STL containers
+**/
+namespace std
+{
+	template<>
+	struct hash<UID>
+	{
+		size_t	operator()(const UID& inUID) const			{ return (size_t)inUID.GetHash(); }
+	};
+}
@@ -0,0 +1,468 @@
+#include "Unicode.h"
+
+// STL includes
+#include <algorithm>
+
+// Select the widest instruction set the compiler targets, the same way Framebuffer.cpp does
+#if defined(__AVX2__)
+	#define UNICODE_AVX2
+	#include <immintrin.h>
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define UNICODE_SSE2
+	#include <emmintrin.h>
+#endif
+
+
+
+/**
+@brief Wide strings are UTF-16 when wchar_t is 16 bits, UTF-32 otherwise
+**/
+static constexpr bool cWide16 = sizeof(wchar_t) == 2;
+
+
+
+#ifdef UNICODE_SSE2
+
+/**
+@brief Widen 16 ASCII bytes in @a inBytes to 16 wide units at @a outWide
+**/
+static inline void sWidenASCII16(__m128i inBytes, wchar_t* outWide)
+{
+	__m128i zero	= _mm_setzero_si128();
+	__m128i low		= _mm_unpacklo_epi8(inBytes, zero);
+	__m128i high	= _mm_unpackhi_epi8(inBytes, zero);
+	if (cWide16)
+	{
+		_mm_storeu_si128((__m128i*)outWide, low);
+		_mm_storeu_si128((__m128i*)(outWide + 8), high);
+	}
+	else
+	{
+		_mm_storeu_si128((__m128i*)outWide, _mm_unpacklo_epi16(low, zero));
+		_mm_storeu_si128((__m128i*)(outWide + 4), _mm_unpackhi_epi16(low, zero));
+		_mm_storeu_si128((__m128i*)(outWide + 8), _mm_unpacklo_epi16(high, zero));
+		_mm_storeu_si128((__m128i*)(outWide + 12), _mm_unpackhi_epi16(high, zero));
+	}
+}
+
+
+
+/**
+@brief Narrow 16 wide units at @a inWide to 16 bytes if they are all ASCII, returns false otherwise
+**/
+static inline bool sNarrowASCII16(const wchar_t* inWide, char* outUTF8)
+{
+	__m128i bytes;
+	if (cWide16)
+	{
+		__m128i a = _mm_loadu_si128((const __m128i*)inWide);
+		__m128i b = _mm_loadu_si128((const __m128i*)(inWide + 8));
+		if (_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(_mm_or_si128(a, b), _mm_set1_epi16((short)0xFF80)), _mm_setzero_si128())) != 0xFFFF)
+			return false;
+		bytes = _mm_packus_epi16(a, b);
+	}
+	else
+	{
+		__m128i a = _mm_loadu_si128((const __m128i*)inWide);
+		__m128i b = _mm_loadu_si128((const __m128i*)(inWide + 4));
+		__m128i c = _mm_loadu_si128((const __m128i*)(inWide + 8));
+		__m128i d = _mm_loadu_si128((const __m128i*)(inWide + 12));
+		__m128i all = _mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d));
+		if (_mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(all, _mm_set1_epi32((int)0xFFFFFF80)), _mm_setzero_si128())) != 0xFFFF)
+			return false;
+		bytes = _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d));
+	}
+	_mm_storeu_si128((__m128i*)outUTF8, bytes);
+	return true;
+}
+
+#endif // UNICODE_SSE2
+
+
+
+/**
+@brief Copy the ASCII run at the start of the input, as far as it goes in whole vectors, returns the amount of units copied
+**/
+static size_t sWidenASCII(const uint8_t* inUTF8, size_t inLength, wchar_t* outWide)
+{
+	size_t i = 0;
+
+#ifdef UNICODE_AVX2
+	for (; i + 32 <= inLength; i += 32)
+	{
+		__m256i bytes = _mm256_loadu_si256((const __m256i*)(inUTF8 + i));
+		if (_mm256_movemask_epi8(bytes) != 0)
+			break;
+
+		if (cWide16)
+		{
+			_mm256_storeu_si256((__m256i*)(outWide + i), _mm256_cvtepu8_epi16(_mm256_castsi256_si128(bytes)));
+			_mm256_storeu_si256((__m256i*)(outWide + i + 16), _mm256_cvtepu8_epi16(_mm256_extracti128_si256(bytes, 1)));
+		}
+		else
+		{
+			for (size_t j = 0; j < 32; j += 8)
+				_mm256_storeu_si256((__m256i*)(outWide + i + j), _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(inUTF8 + i + j))));
+		}
+	}
+#endif
+
+#ifdef UNICODE_SSE2
+	for (; i + 16 <= inLength; i += 16)
+	{
+		__m128i bytes = _mm_loadu_si128((const __m128i*)(inUTF8 + i));
+		if (_mm_movemask_epi8(bytes) != 0)
+			break;
+		sWidenASCII16(bytes, outWide + i);
+	}
+#endif
+
+	return i;
+}
+
+
+
+/**
+@brief Length of the ASCII run at the start of the input, counted in whole vectors
+**/
+static size_t sCountASCII(const uint8_t* inUTF8, size_t inLength)
+{
+	size_t i = 0;
+
+#ifdef UNICODE_AVX2
+	for (; i + 32 <= inLength; i += 32)
+		if (_mm256_movemask_epi8(_mm256_loadu_si256((const __m256i*)(inUTF8 + i))) != 0)
+			break;
+#endif
+
+#ifdef UNICODE_SSE2
+	for (; i + 16 <= inLength; i += 16)
+		if (_mm_movemask_epi8(_mm_loadu_si128((const __m128i*)(inUTF8 + i))) != 0)
+			break;
+#endif
+
+	return i;
+}
+
+
+
+/**
+@brief Copy the ASCII run at the start of the wide input, as far as it goes in whole vectors, returns the amount of units copied
+**/
+static size_t sNarrowASCII(const wchar_t* inWide, size_t inLength, char* outUTF8)
+{
+	size_t i = 0;
+
+#ifdef UNICODE_SSE2
+	for (; i + 16 <= inLength; i += 16)
+		if (!sNarrowASCII16(inWide + i, outUTF8 + i))
+			break;
+#endif
+
+	return i;
+}
+
+
+
+/**
+@brief Decode one code point from UTF-8
+
+Returns the amount of bytes used and the code point in @a outCodePoint. For invalid input @a outCodePoint is
+UINT32_MAX and the return value is the length of the maximal invalid subpart (at least 1).
+**/
+static size_t sDecodeUTF8(const uint8_t* inUTF8, size_t inLength, uint32_t& outCodePoint)
+{
+	uint8_t lead = inUTF8[0];
+	outCodePoint = UINT32_MAX;
+
+	// Length and the valid range of the second byte, which rules out overlong forms, surrogates and values above U+10FFFF
+	size_t length;
+	uint8_t low = 0x80, high = 0xBF;
+	if (lead < 0x80)
+	{
+		outCodePoint = lead;
+		return 1;
+	}
+	else if (lead >= 0xC2 && lead <= 0xDF)
+		length = 2;
+	else if (lead >= 0xE0 && lead <= 0xEF)
+	{
+		length = 3;
+		if (lead == 0xE0)
+			low = 0xA0;
+		else if (lead == 0xED)
+			high = 0x9F;
+	}
+	else if (lead >= 0xF0 && lead <= 0xF4)
+	{
+		length = 4;
+		if (lead == 0xF0)
+			low = 0x90;
+		else if (lead == 0xF4)
+			high = 0x8F;
+	}
+	else
+		return 1;
+
+	uint32_t code_point = lead & (0x7F >> length);
+	for (size_t i = 1; i < length; ++i)
+	{
+		if (i >= inLength)
+			return i;
+
+		uint8_t byte = inUTF8[i];
+		if (byte < low || byte > high)
+			return i;
+		low = 0x80;
+		high = 0xBF;
+
+		code_point = (code_point << 6) | (byte & 0x3F);
+	}
+
+	outCodePoint = code_point;
+	return length;
+}
+
+
+
+/**
+@brief Decode one code point from a wide string, same contract as sDecodeUTF8
+**/
+static size_t sDecodeWide(const wchar_t* inWide, size_t inLength, uint32_t& outCodePoint)
+{
+	uint32_t unit = (uint32_t)inWide[0];
+	outCodePoint = UINT32_MAX;
+
+	if (cWide16)
+	{
+		unit &= 0xFFFF;
+		if (unit < 0xD800 || unit > 0xDFFF)
+			outCodePoint = unit;
+		else if (unit <= 0xDBFF && inLength > 1)
+		{
+			uint32_t trail = (uint32_t)inWide[1] & 0xFFFF;
+			if (trail >= 0xDC00 && trail <= 0xDFFF)
+			{
+				outCodePoint = 0x10000 + ((unit - 0xD800) << 10) + (trail - 0xDC00);
+				return 2;
+			}
+		}
+	}
+	else if (unit < 0xD800 || (unit > 0xDFFF && unit <= 0x10FFFF))
+		outCodePoint = unit;
+
+	return 1;
+}
+
+
+
+/**
+@brief Amount of wide units for @a inCodePoint
+**/
+static inline size_t sGetWideSize(uint32_t inCodePoint)
+{
+	return cWide16 && inCodePoint >= 0x10000 ? 2 : 1;
+}
+
+
+
+/**
+@brief Amount of UTF-8 bytes for @a inCodePoint
+**/
+static inline size_t sGetUTF8Size(uint32_t inCodePoint)
+{
+	return inCodePoint < 0x80 ? 1 : inCodePoint < 0x800 ? 2 : inCodePoint < 0x10000 ? 3 : 4;
+}
+
+
+
+/**
+@brief Convert UTF-8 to wide units
+**/
+TranscodeResult Unicode::sUTF8ToWide(const char* inUTF8, size_t inLength, wchar_t* outWide, size_t inCapacity, EInvalidUnicode inInvalid)
+{
+	const uint8_t* in = (const uint8_t*)inUTF8;
+	TranscodeResult result;
+	size_t& read = result.mRead;
+	size_t& written = result.mWritten;
+
+	while (read < inLength)
+	{
+		// Vectorized ASCII runs, then the rest of the run one byte at a time, limited so they never write past the output
+		size_t end = read + std::min(inLength - read, inCapacity - written);
+		size_t ascii = sWidenASCII(in + read, end - read, outWide + written);
+		read += ascii;
+		written += ascii;
+		while (read < end && in[read] < 0x80)
+			outWide[written++] = (wchar_t)in[read++];
+		if (read == inLength)
+			break;
+
+		uint32_t code_point;
+		size_t length = sDecodeUTF8(in + read, inLength - read, code_point);
+		if (code_point == UINT32_MAX)
+		{
+			++result.mInvalid;
+			if (inInvalid == EInvalidUnicode::Stop)
+				break;
+			code_point = cReplacement;
+		}
+
+		// Stop at the last complete code point that fits
+		if (written + sGetWideSize(code_point) > inCapacity)
+			break;
+
+		if (cWide16 && code_point >= 0x10000)
+		{
+			outWide[written++] = (wchar_t)(0xD800 + ((code_point - 0x10000) >> 10));
+			outWide[written++] = (wchar_t)(0xDC00 + ((code_point - 0x10000) & 0x3FF));
+		}
+		else
+			outWide[written++] = (wchar_t)code_point;
+		read += length;
+	}
+
+	return result;
+}
+
+
+
+/**
+@brief Wide units sUTF8ToWide writes for the input
+**/
+size_t Unicode::sGetWideLength(const char* inUTF8, size_t inLength, EInvalidUnicode inInvalid)
+{
+	const uint8_t* in = (const uint8_t*)inUTF8;
+	size_t length = 0;
+	for (size_t read = 0; read < inLength; )
+	{
+		// Every ASCII byte is one unit
+		size_t ascii = sCountASCII(in + read, inLength - read);
+		read += ascii;
+		length += ascii;
+		if (read == inLength)
+			break;
+
+		uint32_t code_point;
+		read += sDecodeUTF8(in + read, inLength - read, code_point);
+		if (code_point == UINT32_MAX)
+		{
+			if (inInvalid == EInvalidUnicode::Stop)
+				break;
+			code_point = cReplacement;
+		}
+		length += sGetWideSize(code_point);
+	}
+	return length;
+}
+
+
+
+/**
+@brief Convert wide units to UTF-8
+**/
+TranscodeResult Unicode::sWideToUTF8(const wchar_t* inWide, size_t inLength, char* outUTF8, size_t inCapacity, EInvalidUnicode inInvalid)
+{
+	TranscodeResult result;
+	size_t& read = result.mRead;
+	size_t& written = result.mWritten;
+
+	while (read < inLength)
+	{
+		size_t end = read + std::min(inLength - read, inCapacity - written);
+		size_t ascii = sNarrowASCII(inWide + read, end - read, outUTF8 + written);
+		read += ascii;
+		written += ascii;
+		while (read < end && (uint32_t)inWide[read] < 0x80)
+			outUTF8[written++] = (char)inWide[read++];
+		if (read == inLength)
+			break;
+
+		uint32_t code_point;
+		size_t length = sDecodeWide(inWide + read, inLength - read, code_point);
+		if (code_point == UINT32_MAX)
+		{
+			++result.mInvalid;
+			if (inInvalid == EInvalidUnicode::Stop)
+				break;
+			code_point = cReplacement;
+		}
+
+		size_t size = sGetUTF8Size(code_point);
+		if (written + size > inCapacity)
+			break;
+
+		uint8_t* out = (uint8_t*)outUTF8 + written;
+		switch (size)
+		{
+		case 1:
+			out[0] = (uint8_t)code_point;
+			break;
+		case 2:
+			out[0] = (uint8_t)(0xC0 | (code_point >> 6));
+			out[1] = (uint8_t)(0x80 | (code_point & 0x3F));
+			break;
+		case 3:
+			out[0] = (uint8_t)(0xE0 | (code_point >> 12));
+			out[1] = (uint8_t)(0x80 | ((code_point >> 6) & 0x3F));
+			out[2] = (uint8_t)(0x80 | (code_point & 0x3F));
+			break;
+		default:
+			out[0] = (uint8_t)(0xF0 | (code_point >> 18));
+			out[1] = (uint8_t)(0x80 | ((code_point >> 12) & 0x3F));
+			out[2] = (uint8_t)(0x80 | ((code_point >> 6) & 0x3F));
+			out[3] = (uint8_t)(0x80 | (code_point & 0x3F));
+			break;
+		}
+		written += size;
+		read += length;
+	}
+
+	return result;
+}
+
+
+
+/**
+@brief Bytes sWideToUTF8 writes for the input
+**/
+size_t Unicode::sGetUTF8Length(const wchar_t* inWide, size_t inLength, EInvalidUnicode inInvalid)
+{
+	size_t length = 0;
+	for (size_t read = 0; read < inLength; )
+	{
+		uint32_t code_point;
+		read += sDecodeWide(inWide + read, inLength - read, code_point);
+		if (code_point == UINT32_MAX)
+		{
+			if (inInvalid == EInvalidUnicode::Stop)
+				break;
+			code_point = cReplacement;
+		}
+		length += sGetUTF8Size(code_point);
+	}
+	return length;
+}
+
+
+
+/**
+@brief Check if @a inUTF8 is valid UTF-8
+**/
+bool Unicode::sIsValidUTF8(const char* inUTF8, size_t inLength)
+{
+	const uint8_t* in = (const uint8_t*)inUTF8;
+	for (size_t read = 0; read < inLength; )
+	{
+		read += sCountASCII(in + read, inLength - read);
+		if (read == inLength)
+			break;
+
+		uint32_t code_point;
+		read += sDecodeUTF8(in + read, inLength - read, code_point);
+		if (code_point == UINT32_MAX)
+			return false;
+	}
+	return true;
+}
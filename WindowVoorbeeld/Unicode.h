@@ -0,0 +1,117 @@
+#pragma once
+
+// Additional includes
+#include "Utility.h"
+
+
+
+/**
+@brief Outcome of a Unicode conversion
+**/
+struct TranscodeResult
+{
+	size_t					mRead		= 0;				///< Input units consumed, less than the input length when the output was full or (with EInvalidUnicode::Stop) at the first invalid sequence
+	size_t					mWritten	= 0;				///< Output units written
+	size_t					mInvalid	= 0;				///< Invalid sequences found
+};
+
+
+
+/**
+@brief What to do with input that is not valid Unicode
+**/
+enum class EInvalidUnicode : uint8_t
+{
+	Stop,					///< Stop before the invalid sequence
+	Replace,				///< Write U+FFFD for every maximal invalid subpart and continue
+};
+
+
+
+/**
+@brief Validating conversion between UTF-8 and wide strings
+
+Wide strings are UTF-16 where wchar_t is 16 bits (Windows) and UTF-32 where it is 32 bits.
+UTF-8 is validated strictly (RFC 3629): overlong forms, surrogates and code points above U+10FFFF are invalid,
+as are unpaired surrogates in UTF-16. Runs of ASCII are converted 32 (AVX2) or 16 (SSE2) units at a time.
+
+Converting never allocates, the output goes into caller provided storage:
+- UTF-8 to wide needs at most one wide unit per UTF-8 byte
+- Wide to UTF-8 needs at most cMaxUTF8PerWide bytes per wide unit
+A conversion stops at the last complete code point that fits, so too small buffers never split a character.
+**/
+class Unicode
+{
+public:
+	static constexpr size_t	cMaxUTF8PerWide = sizeof(wchar_t) == 2 ? 3 : 4;	///< Worst case UTF-8 bytes per wide unit
+	static constexpr uint32_t cReplacement = 0xFFFD;		///< Written for invalid input with EInvalidUnicode::Replace
+
+	///@name UTF-8 to wide
+	static TranscodeResult	sUTF8ToWide(const char* inUTF8, size_t inLength, wchar_t* outWide, size_t inCapacity, EInvalidUnicode inInvalid = EInvalidUnicode::Replace);	///< Convert @a inLength bytes into at most @a inCapacity wide units, no terminator is written
+	static size_t			sGetWideLength(const char* inUTF8, size_t inLength, EInvalidUnicode inInvalid = EInvalidUnicode::Replace);	///< Wide units sUTF8ToWide writes for the input
+
+	///@name Wide to UTF-8
+	static TranscodeResult	sWideToUTF8(const wchar_t* inWide, size_t inLength, char* outUTF8, size_t inCapacity, EInvalidUnicode inInvalid = EInvalidUnicode::Replace);	///< Convert @a inLength wide units into at most @a inCapacity bytes, no terminator is written
+	static size_t			sGetUTF8Length(const wchar_t* inWide, size_t inLength, EInvalidUnicode inInvalid = EInvalidUnicode::Replace);	///< Bytes sWideToUTF8 writes for the input
+
+	///@name Validation
+	static bool				sIsValidUTF8(const char* inUTF8, size_t inLength);	///< Check if @a inUTF8 is valid UTF-8
+};
+
+
+
+/**
+@brief Zero terminated wide copy of a UTF-8 string, kept on the stack when shorter than N units
+
+Meant for the short lived conversions platform calls need, like window titles:
+
+WStringBuffer<> title(inName);
+SetWindowText(handle, title);
+**/
+template<size_t N = 256>
+class WStringBuffer
+{
+public:
+	///@name Construction
+	explicit				WStringBuffer(const String& inUTF8)	: WStringBuffer(inUTF8.data(), inUTF8.size()) { }
+							WStringBuffer(const char* inUTF8, size_t inLength);
+							WStringBuffer(const WStringBuffer&) = delete;
+	WStringBuffer&			operator=(const WStringBuffer&) = delete;
+
+	///@name Properties
+	const wchar_t*			c_str() const						{ return mData; }
+	size_t					size() const						{ return mSize; }
+	bool					IsInline() const					{ return mHeap == nullptr; }	///< Check if the string fit in the inline storage
+
+	///@name Overloads
+	operator				const wchar_t*() const				{ return mData; }
+
+private:
+	///@name Properties
+	wchar_t					mInline[N];							///< Storage for short strings
+	std::unique_ptr<wchar_t[]> mHeap;							///< Storage for long strings
+	wchar_t*				mData;
+	size_t					mSize;
+};
+
+
+
+/**
+@brief Convert @a inLength bytes of @a inUTF8
+**/
+template<size_t N>
+WStringBuffer<N>::WStringBuffer(const char* inUTF8, size_t inLength)
+{
+	// A UTF-8 byte never becomes more than one wide unit, only count exactly when the upper bound does not fit
+	size_t length = inLength < N ? inLength : Unicode::sGetWideLength(inUTF8, inLength);
+	if (length < N)
+		mData = mInline;
+	else
+	{
+		mHeap.reset(new wchar_t[length + 1]);
+		mData = mHeap.get();
+	}
+
+	mSize = Unicode::sUTF8ToWide(inUTF8, inLength, mData, length).mWritten;
+	mData[mSize] = 0;
+}
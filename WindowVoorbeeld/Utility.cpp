@@ -1,5 +1,12 @@
 #include "Utility.h"
 
+// Additional includes
+#include "Unicode.h"
+
+// STL includes
+#include <chrono>
+#include <cstdarg>
+
 
 
 /**
@@ -7,5 +14,84 @@
 **/
 WString WString::sFromUTF8(const String& inUTF8Str)
 {
-	return WString(std::wstring(inUTF8Str.begin(), inUTF8Str.end()));
+	// A UTF-8 byte never becomes more than one wide unit, so convert in place and trim instead of counting first
+	WString result;
+	result.mBase.resize(inUTF8Str.size());
+	size_t length = Unicode::sUTF8ToWide(inUTF8Str.data(), inUTF8Str.size(), &result.mBase[0], result.mBase.size()).mWritten;
+	result.mBase.resize(length);
+	return result;
+}
+
+
+
+/**
+@brief Convert back to a UTF-8 String
+**/
+String WString::ToUTF8() const
+{
+	String result;
+	result.resize(mBase.size() * Unicode::cMaxUTF8PerWide);
+	size_t length = Unicode::sWideToUTF8(mBase.data(), mBase.size(), &result[0], result.size()).mWritten;
+	result.resize(length);
+	return result;
+}
+
+
+
+/**
+@brief Format like printf into a String
+**/
+String gFormat(const char* inFormat, ...)
+{
+	// Most results fit the inline storage or a small stack buffer, only measure twice for long ones
+	char buffer[256];
+	va_list args;
+	va_start(args, inFormat);
+	int length = vsnprintf(buffer, sizeof(buffer), inFormat, args);
+	va_end(args);
+	if (length < 0)
+		return String();
+	if ((size_t)length < sizeof(buffer))
+		return String(buffer, (size_t)length);
+
+	String result((size_t)length, ' ');
+	va_start(args, inFormat);
+	vsnprintf(&result[0], (size_t)length + 1, inFormat, args);
+	va_end(args);
+	return result;
+}
+
+
+
+/**
+@brief Open a file like fopen
+**/
+FILE* gOpenFile(const char* inPath, const char* inMode)
+{
+#ifdef _MSC_VER
+	FILE* file = nullptr;
+	return fopen_s(&file, inPath, inMode) == 0 ? file : nullptr;
+#else
+	return fopen(inPath, inMode);
+#endif
+}
+
+
+
+/**
+@brief Nanoseconds since an arbitrary point in time
+**/
+uint64_t gGetTimeNS()
+{
+	return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+
+
+/**
+@brief Seconds since an arbitrary point in time
+**/
+double gGetTime()
+{
+	return gGetTimeNS() * 1e-9;
 }
@@ -1,28 +1,54 @@
 #pragma once 
 
+// Additional includes
+#include "Array.h"
+#include "Assert.h"
+#include "HashMap.h"
+#include "Log.h"
+#include "String.h"
+
 // STL includes
-#include <cassert>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
 #include <memory>
 #include <type_traits>
-#include <unordered_map>
-#include <vector>
 
 
 
 /**
-@brief Dirty typedefs for STL stuff. Macros are sometimes used over typedef for generic types.
-TODO: Write our own version instead of using STL
+@brief Logging: gLog, gLogWarning etc. (Log.h)
 **/
-#define	HashMap			std::unordered_map
-#define	Array			std::vector
-#define	Pair			std::pair
-using	String			= std::string;
 
 /**
-@brief Same as above but for functions
+@brief Containers: Array, SmallArray (Array.h), HashMap, Pair (HashMap.h) and String (String.h), all with pluggable allocators (Allocator.h)
+**/
+
+/**
+@brief Dirty typedefs for functions, gAssert lives in Assert.h
+**/
+extern String	gFormat(const char* inFormat, ...);	///< Format like printf into a String
+extern FILE*	gOpenFile(const char* inPath, const char* inMode);	///< fopen that also compiles with the secure CRT, nullptr on failure
+
+
+
+/**
+@brief Monotonic high resolution clock
 **/
-#define gLog(...)		printf(__VA_ARGS__)
-#define gAssert(...)	assert(__VA_ARGS__)
+extern uint64_t	gGetTimeNS();		///< Nanoseconds since an arbitrary point in time
+extern double	gGetTime();			///< Seconds since an arbitrary point in time
+
+
+
+/**
+@brief Platform selection
+
+Win32 is used on Windows, every other target uses the headless backend (see PlatformHeadless.h).
+Define WINDOW_PLATFORM_HEADLESS to force the headless backend on Windows as well.
+**/
+#if !defined(_WIN32) && !defined(WINDOW_PLATFORM_HEADLESS)
+	#define WINDOW_PLATFORM_HEADLESS
+#endif
 
 
 
@@ -40,24 +66,28 @@ struct IRect
 
 
 /**
-@brief WString STL wrapper
-TODO: Write our own version instead of wrapping STL
+@brief Wide string for platform calls, UTF-16 on Windows
 **/
 class WString 
 {
 public:
 	///@name Construction
 					WString()									= default;
-					WString(std::wstring inUTF16Str) :			mBase(inUTF16Str) {}
+					WString(const wchar_t* inWideStr) :			mBase(inWideStr) {}
 
 	///@name Format conversion
-	static WString	sFromUTF8(const String& inUTF8Str);			///< Create a WString from a String
+	static WString	sFromUTF8(const String& inUTF8Str);			///< Create a WString from a String, invalid UTF-8 becomes U+FFFD
+	String			ToUTF8() const;								///< Convert back to a UTF-8 String, unpaired surrogates become U+FFFD
+
+	///@name Properties
+	const wchar_t*	c_str() const								{ return mBase.c_str(); }
+	size_t			size() const								{ return mBase.size(); }
 
 	///@name Overloads
 	operator		const wchar_t*() const						{ return mBase.c_str(); } ///< Implicitly convert to a c-style wide char pointer
-	WString			operator+(const WString& inOther) const		{ return mBase + inOther.mBase; } ///< Concatenate two WStrings and return the result
+	WString			operator+(const WString& inOther) const		{ WString result; result.mBase = mBase + inOther.mBase; return result; } ///< Concatenate two WStrings and return the result
 
 private:
 	///@name Properties
-	std::wstring mBase;											///< STL base
+	BasicString<wchar_t> mBase;									///< Wide units
 };
@@ -1,24 +1,43 @@
 #include "Window.h"
 
-// Win32 includes
-#include <windows.h>
-
 // Additional includes
 #include "Input.h"
+#include "Framebuffer.h"
+#include "Platform.h"
+#include "Profiler.h"
+#include "Recorder.h"
+#include "Registry.h"
+#include "RenderThread.h"
+
+
+
+/**
+@brief Table that tracks windows by their generational handles
+**/
+static HandleTable<Window> gWindows;
+
 
 
 /**
-@brief Typedef HWND for WindowID
+@brief Windows by their stable UID
 **/
-typedef HWND__* WindowID;
+static Registry<Window> gWindowRegistry;
 
 
 
 /**
-@brief HashMap that tracks windows by window handles
+@brief Throttling state shared by all windows
 **/
-class Window;
-HashMap<WindowID, Window*> gWindows;
+static ThrottlePolicy gDefaultThrottlePolicy;			///< Policy of new windows
+static ThrottleStats gThrottleStats;					///< Counters of every window together
+static Array<WindowHandle> gDeferredPaints;				///< Windows with a paint held back by a reduced rate
+
+
+
+/**
+@brief Window memory, one pool per window type indexed by class ID
+**/
+static Array<std::unique_ptr<ObjectPool>> gWindowPools;
 
 
 
@@ -29,109 +48,181 @@ WARNING:
 Please use this class structure carefully, as this directly modifies the key registry
 
 **/
-struct InputKey { static void sSetDown(KeyCode inKeyCode, bool inDown) { Input::sSetDown(inKeyCode, inDown); } };
+struct InputKey
+{
+	static void sProcessEvent(InputEvent& ioEvent)											{ Input::sProcessEvent(ioEvent); }
+	static void sAddPointerSample(WindowHandle inWindow, const PointerSample& inSample, bool inBatch)	{ Pointer::sAddSample(inWindow, inSample, inBatch); }
+};
 
 
 
 /**
-@brief Helper function for when a mouse button is pressed
+@brief Helper function to update the input state and queue an input event for a message
 **/
-static bool sOnMouseDown(Window* inWindow, KeyCode inKeyCode)
+static void sProcessInput(const Message& inMessage, EInputEvent inType)
 {
-	InputKey::sSetDown(inKeyCode, true);
-	return inWindow->OnMouseDown();
+	InputEvent event;
+	event.mTimeNS	= inMessage.mTimeNS != 0 ? inMessage.mTimeNS : gGetTimeNS();
+	event.mWindow	= inMessage.mHandle;
+	event.mType		= inType;
+	event.mKeyCode	= inMessage.mKeyCode;
+	InputKey::sProcessEvent(event);
 }
 
 
 
 /**
-@brief Helper function for when a mouse button is released
+@brief Helper function to add a pointer message to the batch of its window if @a inBatch, returns @a inBatch
 **/
-static bool sOnMouseUp(Window* inWindow, KeyCode inKeyCode)
+static bool sAddPointerSample(const Message& inMessage, EPointerSource inSource, bool inBatch)
 {
-	InputKey::sSetDown(inKeyCode, false);
-	return inWindow->OnMouseUp();
+	PointerSample sample;
+	sample.mTimeNS	= inMessage.mTimeNS != 0 ? inMessage.mTimeNS : gGetTimeNS();
+	sample.mSource	= inSource;
+	switch (inSource)
+	{
+		case EPointerSource::Cursor:	sample.mX = inMessage.mX;					sample.mY = inMessage.mY;					break;
+		case EPointerSource::Raw:		sample.mDeltaX = (int16_t)inMessage.mX;		sample.mDeltaY = (int16_t)inMessage.mY;		break;
+		case EPointerSource::Wheel:		sample.mWheel = inMessage.mWheel;			sample.mWheelX = inMessage.mWheelX;			break;
+	}
+	InputKey::sAddPointerSample(inMessage.mHandle, sample, inBatch);
+	return inBatch;
 }
 
 
 
 /**
-@brief General window procedure
+@brief Dispatch a platform independent message to its window
 **/
-#define PROC_DEFAULT DefWindowProc(inHandle, inMsg, inWParam, inLParam)
-LRESULT CALLBACK gWindowProc(HWND inHandle, UINT inMsg, WPARAM inWParam, LPARAM inLParam)
+bool gDispatchMessage(const Message& inMessage)
 {
-	Window* window = nullptr;
+	// Resolve the handle, this is an index and a generation compare
+	Window* window = gWindows.Get(inMessage.mHandle);
+	if (window == nullptr)
+	{
+#ifdef _DEBUG
+		// Messages can still be queued for a window that is gone, but they should never be dispatched
+		if (gWindows.IsStale(inMessage.mHandle))
+			gLogWarning("Dropped message %d for destroyed window 0x%x\n", (int)inMessage.mType, inMessage.mHandle.GetValue());
+#endif
+		return false;
+	}
+
+	// Every message that reaches a window goes into the recording, if one is running
+	if (Recorder::sIsRecording())
+		Recorder::sRecordMessage(inMessage, *window);
+
+	// Times the rest of the dispatch, compiled out unless WINDOW_PROFILER is set
+	gProfileDispatch(inMessage);
 
-	// Find or create the window associated with inHandle
-	auto iter = gWindows.find(inHandle);
-	if (iter == gWindows.end())
+	// Handle callbacks based on the input message, handlers the window type does not override are nullptr.
+	// Subscribers only exist once GetEvents was called, and are raised after the handler
+	const WindowHandlers& handlers = *window->mHandlers;
+	WindowEvents* events = window->mEvents;
+	switch (inMessage.mType)
 	{
-		if (inMsg == WM_CREATE)
+		// Generic events
+		case EMessage::Create:
 		{
-			// Get the window from the LParams
-			window = (Window*)((LPCREATESTRUCT)inLParam)->lpCreateParams;
-
-			// Add to gWindows to keep track of the pointer
-			gWindows.insert({inHandle, window});
+			// The native handle is already needed in OnCreate, before the platform create function returns
+			window->mNativeHandle = inMessage.mNativeHandle;
+			if (handlers.mOnCreate != nullptr)
+				handlers.mOnCreate(window);
+			return false;
 		}
-		else
+
+		case EMessage::Paint:
 		{
-			// Do not handle any window messages before WM_CREATE
-			return PROC_DEFAULT;
+			// A throttled window keeps the region for a later paint
+			if (window->DeferPaint(inMessage))
+				return false;
+
+			// Everything invalidated since the last paint plus what the platform wants, nothing known means everything
+			DirtyRegion region = window->mDirtyRegion;
+			window->mDirtyRegion.Clear();
+			region.Add(inMessage.mDirtyRect);
+			if (region.IsEmpty())
+				region.Add({0, 0, inMessage.mWidth, inMessage.mHeight});
+
+			// A window with a render thread only gets signaled, the loop never waits for painting
+			window->mPaintRequested.fetch_add(1, std::memory_order_relaxed);
+			if (window->mRenderThread != nullptr)
+				window->mRenderThread->RequestPaint(inMessage.mWidth, inMessage.mHeight, region);
+			else
+				window->Paint(inMessage.mWidth, inMessage.mHeight, region);
+			return false;
 		}
-	}
-	else
-	{
-		// Get the created window from gWindows
-		window = iter->second;
-	}
 
-	// Handle callbacks based on the input message
-	switch (inMsg)
-	{
-		// Generic events
-		case WM_CREATE: window->OnCreate(); return PROC_DEFAULT;
-		case WM_PAINT:  window->OnPaint();  return PROC_DEFAULT;
-		case WM_CLOSE:  window->OnClose();  return PROC_DEFAULT;
+		case EMessage::Close:
+		{
+			if (handlers.mOnClose != nullptr)
+				handlers.mOnClose(window);
+			if (events != nullptr)
+				events->mClose.Broadcast();
+			return false;
+		}
 
-		// Mouse Down
-		case WM_LBUTTONDOWN: return sOnMouseDown(window, VK_LBUTTON) ? 0 : PROC_DEFAULT;
-		case WM_MBUTTONDOWN: return sOnMouseDown(window, VK_MBUTTON) ? 0 : PROC_DEFAULT;
-		case WM_RBUTTONDOWN: return sOnMouseDown(window, VK_RBUTTON) ? 0 : PROC_DEFAULT;
+		// Mouse Events
+		case EMessage::MouseDown:
+		{
+			sProcessInput(inMessage, EInputEvent::MouseDown);
+			bool handled = handlers.mOnMouseDown != nullptr && handlers.mOnMouseDown(window);
+			return events != nullptr ? events->mMouseDown.Broadcast() || handled : handled;
+		}
+		case EMessage::MouseUp:
+		{
+			sProcessInput(inMessage, EInputEvent::MouseUp);
+			bool handled = handlers.mOnMouseUp != nullptr && handlers.mOnMouseUp(window);
+			return events != nullptr ? events->mMouseUp.Broadcast() || handled : handled;
+		}
 
-		// Mouse Up
-		case WM_LBUTTONUP: return sOnMouseUp(window, VK_LBUTTON) ? 0 : PROC_DEFAULT;
-		case WM_MBUTTONUP: return sOnMouseUp(window, VK_MBUTTON) ? 0 : PROC_DEFAULT;
-		case WM_RBUTTONUP: return sOnMouseUp(window, VK_RBUTTON) ? 0 : PROC_DEFAULT;
+		// Pointer Events, batched and delivered once per frame by Pointer::sEndFrame
+		case EMessage::MouseMove:		return sAddPointerSample(inMessage, EPointerSource::Cursor, window->WantsPointerBatch());
+		case EMessage::MouseWheel:		return sAddPointerSample(inMessage, EPointerSource::Wheel, window->WantsPointerBatch());
+		case EMessage::RawMouseMove:	sAddPointerSample(inMessage, EPointerSource::Raw, window->WantsPointerBatch());	return false;
 
 		// Key Events
-		case WM_KEYDOWN:
+		case EMessage::KeyDown:
 		{
-			InputKey::sSetDown((KeyCode)inWParam, true);
-			return window->OnKeyDown() ? 0 : PROC_DEFAULT;
+			sProcessInput(inMessage, EInputEvent::KeyDown);
+			bool handled = handlers.mOnKeyDown != nullptr && handlers.mOnKeyDown(window);
+			return events != nullptr ? events->mKeyDown.Broadcast() || handled : handled;
 		}
-		case WM_KEYUP:
+		case EMessage::KeyUp:
 		{
-			InputKey::sSetDown((KeyCode)inWParam, false);
-			return window->OnKeyUp() ? 0 : PROC_DEFAULT;
+			sProcessInput(inMessage, EInputEvent::KeyUp);
+			bool handled = handlers.mOnKeyUp != nullptr && handlers.mOnKeyUp(window);
+			return events != nullptr ? events->mKeyUp.Broadcast() || handled : handled;
 		}
 
-		// Destroy
-		case WM_DESTROY:	
+		// Minimized, occluded and focus changes, which change the throttle of the window
+		case EMessage::StateChanged:
 		{
-			window->OnDestroy();	
-
-			// Also remove the window from gWindows and free its memory
-			gWindows.erase(gWindows.find(inHandle));
-			delete window;
+			window->SetState(inMessage.mState);
+			return false;
+		}
 
-			return PROC_DEFAULT;
+		// Destroy
+		case EMessage::Destroy:
+		{
+			// Hand off from the render thread first, so OnDestroy can release what OnPaint uses
+			window->StopRenderThread();
+			if (handlers.mOnDestroy != nullptr)
+				handlers.mOnDestroy(window);
+			if (events != nullptr)
+				events->mDestroy.Broadcast();
+
+			// Also remove the window from gWindows and the registry and free its memory, its handle becomes stale
+			gWindows.Remove(inMessage.mHandle);
+			gWindowRegistry.Remove(window->mUID);
+			Window::sFree(window);
+
+			return false;
 		}
 	}
 
 	// Default case
-	return PROC_DEFAULT;
+	return false;
 }
 
 
@@ -139,37 +230,127 @@ LRESULT CALLBACK gWindowProc(HWND inHandle, UINT inMsg, WPARAM inWParam, LPARAM
 /**
 @brief Create and allocate a window
 **/
-Window* Window::sCreate(const IRect& inRect, const String& inName, void* inParent)
+Window* Window::sCreate(const IRect& inRect, const String& inName, void* inParent, uint32_t inClassID, const WindowHandlers& inHandlers)
 {
 	Window* window	= (Window*)inParent;
+	window->mClassID = inClassID;
+	window->mHandlers = &inHandlers;
+	window->mThrottlePolicy = gDefaultThrottlePolicy;
+
+	// Register the window first so the create message can already find it
+	window->mHandle = gWindows.Add(window);
+	gWindowRegistry.Add(window->mUID, window);
 
-	// UTF-16 version of @a inName because windows expects this
-	WString wname = WString::sFromUTF8(inName);
-
-	// Initialize a window class and register it
-	WNDCLASS window_class = {};
-	window_class.style			= 0;
-	window_class.lpfnWndProc	= gWindowProc;
-	window_class.lpszClassName	= wname + WString(L"WindowClass");
-	window_class.hInstance		= GetModuleHandle(0);
-	window_class.hIcon			= LoadIcon(0, IDI_WINLOGO);
-	window_class.hCursor		= LoadCursor(0, IDC_ARROW);
-	RegisterClass(&window_class);
-
-	// Create the window
-	window->mHandle = CreateWindowEx(0, window_class.lpszClassName, wname, WS_OVERLAPPEDWINDOW | WS_VISIBLE,
-									inRect.mX, inRect.mY, inRect.mW, inRect.mH, 0, 0, window_class.hInstance, window);
+	// Create the native window, this dispatches EMessage::Create before returning
+	window->mNativeHandle = gPlatformCreateWindow(inRect, inName, window, inClassID);
 	return window;
 }
 
 
 
+/**
+@brief Hand out the next class ID, called once per window type
+**/
+uint32_t Window::sAllocateClassID()
+{
+	static std::atomic<uint32_t> next_class_id { 0 };
+	return next_class_id++;
+}
+
+
+
+/**
+@brief Pool of the windows with class @a inClassID
+**/
+ObjectPool& Window::sGetPool(uint32_t inClassID, size_t inSize, size_t inAlignment)
+{
+	if (inClassID >= gWindowPools.size())
+		gWindowPools.resize(inClassID + 1);
+
+	std::unique_ptr<ObjectPool>& pool = gWindowPools[inClassID];
+	if (pool == nullptr)
+		pool.reset(new ObjectPool(inSize, inAlignment));
+	return *pool;
+}
+
+
+
+/**
+@brief Destruct @a inWindow and return its memory to its pool
+**/
+void Window::sFree(Window* inWindow)
+{
+	uint32_t class_id = inWindow->mClassID;
+	inWindow->~Window();
+	gWindowPools[class_id]->Free(inWindow);
+}
+
+
+
+/**
+@brief Allocation counters of all window types together
+**/
+PoolStats Window::sGetPoolStats()
+{
+	PoolStats stats;
+	for (const std::unique_ptr<ObjectPool>& pool : gWindowPools)
+		if (pool != nullptr)
+			stats += pool->GetStats();
+	return stats;
+}
+
+
+
+/**
+@brief Make room for @a inCount more windows
+**/
+void Window::sReserve(size_t inCount)
+{
+	gWindows.Reserve(gWindows.GetSize() + inCount);
+	gWindowRegistry.Reserve(gWindowRegistry.GetSize() + inCount);
+	gPlatformReserveWindows(inCount);
+}
+
+
+
+/**
+@brief Free what the window owns, the render thread was already stopped on destroy
+**/
+Window::~Window()
+{
+	gAssert(mRenderThread == nullptr);
+	delete mFramebuffer;
+	delete mEvents;
+}
+
+
+
+/**
+@brief Get the window of @a inHandle
+**/
+Window* Window::sGet(WindowHandle inHandle)
+{
+	return gWindows.Get(inHandle);
+}
+
+
+
+/**
+@brief Get the window of @a inUID
+**/
+Window* Window::sFind(const UID& inUID)
+{
+	return gWindowRegistry.Find(inUID);
+}
+
+
+
 /**
 @brief Force the window to be shown
 **/
 void Window::Show()
 {
-	ShowWindow(mHandle, SW_NORMAL);
+	gPlatformShowWindow(mNativeHandle);
 }
 
 
@@ -179,7 +360,7 @@ void Window::Show()
 **/
 void Window::Activate()
 {
-	SetActiveWindow(mHandle);
+	gPlatformActivateWindow(mNativeHandle);
 }
 
 
@@ -196,38 +377,505 @@ void Window::ShowAndActivate()
 
 
 /**
-@brief Start the message loop for every created window
+@brief Repaint the whole window in the next frame
+**/
+void Window::Invalidate()
+{
+	// The client size is only known to the painting thread, the region gets clipped there
+	Invalidate({0, 0, INT32_MAX, INT32_MAX});
+}
+
+
+
+/**
+@brief Repaint @a inRect in the next frame
+**/
+void Window::Invalidate(const IRect& inRect)
+{
+	if (inRect.mW <= 0 || inRect.mH <= 0)
+		return;
+
+	// Only the first invalidation of a frame asks the platform for a paint, the rest is merged into the region
+	bool paint_pending = !mDirtyRegion.IsEmpty();
+	mDirtyRegion.Add(inRect);
+	if (!paint_pending)
+		gPlatformInvalidate(mNativeHandle, inRect);
+}
+
+
+
+/**
+@brief Paint this window on its own thread from now on
+**/
+void Window::EnableRenderThread()
+{
+	if (mRenderThread != nullptr)
+		return;
+
+	// The render thread reads mEvents, so it must never change after this. Starting the thread publishes it.
+	WindowEvents& events = GetEvents();
+	mRenderThread = new RenderThread(this);
+	events.mResize.SetLock(&mRenderThread->GetPaintMutex());
+	events.mPaint.SetLock(&mRenderThread->GetPaintMutex());
+}
+
+
+
+/**
+@brief Wait for the frame in progress and stop the render thread
+**/
+void Window::StopRenderThread()
+{
+	if (mRenderThread == nullptr)
+		return;
+
+	mRenderThread->Stop();
+	mEvents->mResize.SetLock(nullptr);
+	mEvents->mPaint.SetLock(nullptr);
+	delete mRenderThread;
+	mRenderThread = nullptr;
+}
+
+
+
+/**
+@brief Give this window a CPU framebuffer
+**/
+void Window::EnableFramebuffer()
+{
+	if (mFramebuffer == nullptr)
+		mFramebuffer = new Framebuffer;
+}
+
+
+
+/**
+@brief Check if the window type or a subscriber takes pointer batches, without one the samples are not batched
+**/
+bool Window::WantsPointerBatch() const
+{
+	return mHandlers->mOnPointerBatch != nullptr || (mEvents != nullptr && !mEvents->mPointerBatch.IsEmpty());
+}
+
+
+
+/**
+@brief Call OnPointerBatch and its subscribers
 **/
-void gProcessMessageLoop()
+void Window::SendPointerBatch(PointerBatch inSamples)
 {
-	MSG message;
-	while (true) 
+	if (mHandlers->mOnPointerBatch != nullptr)
+		mHandlers->mOnPointerBatch(this, inSamples);
+	if (mEvents != nullptr)
+		mEvents->mPointerBatch.Broadcast(inSamples);
+}
+
+
+
+/**
+@brief Call OnResize if needed and OnPaint, and update the paint counters
+**/
+void Window::Paint(int inWidth, int inHeight, const DirtyRegion& inRegion)
+{
+	uint64_t start_time = gGetTimeNS();
+
+	// A new size means every pixel is new
+	DirtyRegion region = inRegion;
+	if (inWidth != mPaintWidth || inHeight != mPaintHeight)
 	{
-		// Peek for the next message. This message can come from any window and is not filtered based on type.
-		while (PeekMessage(&message, 0, 0, 0, PM_REMOVE))
-		{
-			// If we received a quit message, delete the windows we have and break out
-			if (message.message == WM_QUIT) 
-				goto quit;
+		mPaintWidth		= inWidth;
+		mPaintHeight	= inHeight;
+		if (mFramebuffer != nullptr)
+			mFramebuffer->Resize(inWidth, inHeight);
+		if (mHandlers->mOnResize != nullptr)
+			mHandlers->mOnResize(this, inWidth, inHeight);
+		if (mEvents != nullptr)
+			mEvents->mResize.Broadcast(inWidth, inHeight);
+
+		region.Clear();
+		region.Add({0, 0, inWidth, inHeight});
+	}
 
-			TranslateMessage(&message);
-			DispatchMessage(&message);
-		}
+	// Nothing visible to repaint
+	region.Clip({0, 0, inWidth, inHeight});
+	if (region.IsEmpty())
+		return;
+
+	if (mHandlers->mOnPaint != nullptr)
+		mHandlers->mOnPaint(this, region);
+	if (mEvents != nullptr)
+		mEvents->mPaint.Broadcast(region);
+
+	if (mFramebuffer != nullptr)
+		gPlatformPresent(mNativeHandle, *mFramebuffer, region);
+
+	// Only the painting thread writes these, so a plain load + store is enough for the maximum
+	uint64_t paint_time = gGetTimeNS() - start_time;
+	mLastPaintNS.store(paint_time, std::memory_order_relaxed);
+	if (paint_time > mMaxPaintNS.load(std::memory_order_relaxed))
+		mMaxPaintNS.store(paint_time, std::memory_order_relaxed);
+	mPaintedArea.fetch_add((uint64_t)region.GetArea(), std::memory_order_relaxed);
+	mPaintNS.fetch_add(paint_time, std::memory_order_relaxed);
+	mPainted.fetch_add(1, std::memory_order_release);
+}
+
+
+
+/**
+@brief Get the paint counters
+**/
+PaintStats Window::GetPaintStats() const
+{
+	PaintStats stats;
+	stats.mPainted			= mPainted.load(std::memory_order_acquire);
+	stats.mRequested		= mPaintRequested.load(std::memory_order_relaxed);
+	stats.mPaintedArea		= mPaintedArea.load(std::memory_order_relaxed);
+	stats.mLastPaintTime	= mLastPaintNS.load(std::memory_order_relaxed) * 1e-9;
+	stats.mMaxPaintTime		= mMaxPaintNS.load(std::memory_order_relaxed) * 1e-9;
+	return stats;
+}
+
+
+
+/**
+@brief Add the counters of @a inOther
+**/
+ThrottleStats& ThrottleStats::operator+=(const ThrottleStats& inOther)
+{
+	mStateChanges	+= inOther.mStateChanges;
+	mDeferredPaints	+= inOther.mDeferredPaints;
+	mSkippedUpdates	+= inOther.mSkippedUpdates;
+	mSkippedRenders	+= inOther.mSkippedRenders;
+	mSavedTime		+= inOther.mSavedTime;
+	return *this;
+}
+
+
+
+/**
+@brief Get the throttle that applies to the current state
+**/
+EThrottle Window::GetThrottle() const
+{
+	if ((mState & cWindowMinimized) != 0)
+		return mThrottlePolicy.mMinimized;
+	if ((mState & cWindowOccluded) != 0)
+		return mThrottlePolicy.mOccluded;
+	return (mState & cWindowFocused) != 0 ? mThrottlePolicy.mFocused : mThrottlePolicy.mBackground;
+}
+
+
+
+/**
+@brief Set the throttle per state
+**/
+void Window::SetThrottlePolicy(const ThrottlePolicy& inPolicy)
+{
+	mThrottlePolicy = inPolicy;
+	QueueDeferredPaint();
+}
+
+
+
+/**
+@brief Set the policy of the windows created from now on
+**/
+void Window::sSetDefaultThrottlePolicy(const ThrottlePolicy& inPolicy)
+{
+	gDefaultThrottlePolicy = inPolicy;
+}
+
+
+
+/**
+@brief Get the throttling counters of every window together
+**/
+ThrottleStats Window::sGetThrottleStats()
+{
+	return gThrottleStats;
+}
+
+
+
+/**
+@brief Nanoseconds between paints and renders for EThrottle::Reduced
+**/
+uint64_t Window::GetReducedIntervalNS() const
+{
+	return (uint64_t)(1.0e9 / std::max(mThrottlePolicy.mReducedRate, 1.0e-3));
+}
+
+
+
+/**
+@brief Apply a state reported by the platform
+**/
+void Window::SetState(uint8_t inState)
+{
+	if (inState == mState)
+		return;
+
+	mState = inState;
+	++mThrottleStats.mStateChanges;
+	++gThrottleStats.mStateChanges;
+
+	// Coming back from a suspended or reduced state paints what was held back right away when allowed
+	QueueDeferredPaint();
+}
+
+
+
+/**
+@brief Hold back a paint the throttle does not allow now
+**/
+bool Window::DeferPaint(const Message& inMessage)
+{
+	EThrottle throttle = GetThrottle();
+	uint64_t now = gGetTimeNS();
+	if (throttle == EThrottle::Full || (throttle == EThrottle::Reduced && now - mLastPaintDispatchNS >= GetReducedIntervalNS()))
+	{
+		mLastPaintDispatchNS = now;
+		mPaintDeferred = false;
+		return false;
+	}
+
+	// The paint that is let through later repaints this as well, the platform considers it painted now
+	IRect rect = inMessage.mDirtyRect;
+	if (rect.mW <= 0 || rect.mH <= 0)
+		rect = { 0, 0, inMessage.mWidth, inMessage.mHeight };
+	mDirtyRegion.Add(rect);
+	mPaintDeferred = true;
+
+	uint64_t painted = mPainted.load(std::memory_order_relaxed);
+	CountThrottled(&ThrottleStats::mDeferredPaints, mPaintNS.load(std::memory_order_relaxed), painted);
+
+	// Suspended windows wait for SetState, reduced ones for gReleaseDeferredPaints
+	if (throttle == EThrottle::Reduced)
+		QueueDeferredPaint();
+	return true;
+}
+
+
+
+/**
+@brief Ask the platform for the held back paint if the throttle allows it
+**/
+bool Window::ReleaseDeferredPaint(uint64_t inTimeNS)
+{
+	if (!mPaintDeferred)
+		return true;
+
+	EThrottle throttle = GetThrottle();
+	if (throttle == EThrottle::Suspended)
+		return true;
+	if (throttle == EThrottle::Reduced && inTimeNS - mLastPaintDispatchNS < GetReducedIntervalNS())
+		return false;
+
+	mPaintDeferred = false;
+	if (!mDirtyRegion.IsEmpty())
+		gPlatformInvalidate(mNativeHandle, mDirtyRegion.GetBounds());
+	return true;
+}
+
+
+
+/**
+@brief Release the held back paint now or queue it for gReleaseDeferredPaints
+**/
+void Window::QueueDeferredPaint()
+{
+	if (mPaintQueued || ReleaseDeferredPaint(gGetTimeNS()))
+		return;
+
+	mPaintQueued = true;
+	gDeferredPaints.push_back(mHandle);
+}
+
+
+
+/**
+@brief Count held back work in the window and global counters
+**/
+void Window::CountThrottled(uint64_t ThrottleStats::*inCounter, uint64_t inTotalNS, uint64_t inCount)
+{
+	double saved = inCount > 0 ? inTotalNS * 1e-9 / inCount : 0.0;
+	++(mThrottleStats.*inCounter);
+	++(gThrottleStats.*inCounter);
+	mThrottleStats.mSavedTime += saved;
+	gThrottleStats.mSavedTime += saved;
+}
+
+
+
+/**
+@brief Ask the platform for the held back paints that are allowed now
+**/
+void gReleaseDeferredPaints()
+{
+	if (gDeferredPaints.empty())
+		return;
+
+	uint64_t now = gGetTimeNS();
+	size_t count = 0;
+	for (WindowHandle handle : gDeferredPaints)
+	{
+		Window* window = gWindows.Get(handle);
+		if (window == nullptr)
+			continue;
+
+		if (window->ReleaseDeferredPaint(now))
+			window->mPaintQueued = false;
+		else
+			gDeferredPaints[count++] = handle;
 	}
+	gDeferredPaints.resize(count);
+}
+
+
+
+/**
+@brief Seconds until the next held back paint is allowed
+**/
+double gGetDeferredPaintTimeout()
+{
+	uint64_t now = gGetTimeNS();
+	uint64_t timeout = UINT64_MAX;
+	for (WindowHandle handle : gDeferredPaints)
+		if (const Window* window = gWindows.Get(handle))
+		{
+			uint64_t due = window->mLastPaintDispatchNS + window->GetReducedIntervalNS();
+			timeout = std::min(timeout, due > now ? due - now : 0);
+		}
+	return timeout != UINT64_MAX ? timeout * 1e-9 : -1.0;
+}
+
+
+
+/**
+@brief Stop the render thread of every window
+**/
+void gStopRenderThreads()
+{
+	gWindows.ForEach([](Window* inWindow) { inWindow->StopRenderThread(); });
+}
+
+
+
+/**
+@brief Delete every window that is still alive
+**/
+void gDeleteAllWindows()
+{
+	gWindows.ForEach([](Window* inWindow)
+	{
+		// Stop painting before the derived window is torn down
+		inWindow->StopRenderThread();
+		Window::sFree(inWindow);
+	});
+	gWindows.Clear();
+	gWindowRegistry.Clear();
+}
+
+
+
+/**
+@brief Windows of the running fixed timestep step, collected first so windows can be created and destroyed during the step
+**/
+static Array<WindowHandle> gStepWindows;
+
+
 
-quit:
-	// Delete all windows
-	for (Pair<WindowID, Window*> pair : gWindows)
-		delete pair.second;
-	gWindows.clear();
+/**
+@brief Collect the windows for which @a inFilter(const Window*) returns true in gStepWindows
+
+Walks the pools type by type in address order, so the scan reads contiguous window memory instead of following
+a pointer per handle.
+**/
+template<class F>
+static void sCollectStepWindows(const F& inFilter)
+{
+	gStepWindows.clear();
+	for (const std::unique_ptr<ObjectPool>& pool : gWindowPools)
+		if (pool != nullptr)
+			pool->ForEach([&inFilter](void* inWindow)
+			{
+				const Window* window = (const Window*)inWindow;
+				if (inFilter(window))
+					gStepWindows.push_back(window->GetHandle());
+			});
 }
 
 
 
 /**
-@brief Kill all windows and shut down the application
+@brief Call OnUpdate of every window that overrides it or has subscribers
 **/
-void gQuitApplication()
+void gUpdateWindows(double inDeltaTime)
 {
-	PostQuitMessage(0);
+	sCollectStepWindows([](const Window* inWindow)
+	{
+		return inWindow->mHandlers->mOnUpdate != nullptr || (inWindow->mEvents != nullptr && !inWindow->mEvents->mUpdate.IsEmpty());
+	});
+
+	for (WindowHandle handle : gStepWindows)
+		if (Window* window = gWindows.Get(handle))
+		{
+			// A suspended window does not advance, it continues where it was when it comes back
+			if (window->GetThrottle() == EThrottle::Suspended)
+			{
+				window->CountThrottled(&ThrottleStats::mSkippedUpdates, window->mUpdateNS, window->mUpdates);
+				continue;
+			}
+
+			uint64_t start = gGetTimeNS();
+			if (window->mHandlers->mOnUpdate != nullptr)
+				window->mHandlers->mOnUpdate(window, inDeltaTime);
+			if (window->mEvents != nullptr)
+				window->mEvents->mUpdate.Broadcast(inDeltaTime);
+
+			// The window can be destroyed by its own update
+			if (gWindows.Get(handle) == window)
+			{
+				window->mUpdateNS += gGetTimeNS() - start;
+				++window->mUpdates;
+			}
+		}
+}
+
+
+
+/**
+@brief Call OnRender of every window that overrides it or has subscribers
+**/
+void gRenderWindows(double inAlpha)
+{
+	sCollectStepWindows([](const Window* inWindow)
+	{
+		return inWindow->mHandlers->mOnRender != nullptr || (inWindow->mEvents != nullptr && !inWindow->mEvents->mRender.IsEmpty());
+	});
+
+	uint64_t now = gGetTimeNS();
+	for (WindowHandle handle : gStepWindows)
+		if (Window* window = gWindows.Get(handle))
+		{
+			EThrottle throttle = window->GetThrottle();
+			if (throttle == EThrottle::Suspended || (throttle == EThrottle::Reduced && now - window->mLastRenderNS < window->GetReducedIntervalNS()))
+			{
+				window->CountThrottled(&ThrottleStats::mSkippedRenders, window->mRenderNS, window->mRenders);
+				continue;
+			}
+
+			uint64_t start = gGetTimeNS();
+			window->mLastRenderNS = start;
+			if (window->mHandlers->mOnRender != nullptr)
+				window->mHandlers->mOnRender(window, inAlpha);
+			if (window->mEvents != nullptr)
+				window->mEvents->mRender.Broadcast(inAlpha);
+
+			if (gWindows.Get(handle) == window)
+			{
+				window->mRenderNS += gGetTimeNS() - start;
+				++window->mRenders;
+			}
+		}
 }
@@ -2,67 +2,201 @@
 
 // Additional includes
 #include "Utility.h"
+#include "Delegate.h"
+#include "MessageLoop.h"
+#include "HandleTable.h"
+#include "DirtyRegion.h"
+#include "Pointer.h"
+#include "ObjectPool.h"
+#include "UID.h"
+
+// STL includes
+#include <atomic>
+
+
+
+/**
+@brief Opaque platform window handle (the HWND on Win32, a fabricated handle on the headless backend)
+**/
+using WindowID = struct NativeWindow__*;
 
 
 
 /**
-@brief Start the message loop for every created window
+@brief Generational handle to a window, resolves to nullptr once the window is destroyed
+**/
+class Window;
+using WindowHandle = Handle<Window>;
 
-This should be called in every application that uses windows, in order for them to function.
-Make sure this is called after creating all the windows.
-Windows created after this call will not be processed.
 
-Example application entry point:
 
-int main(int inArgC, char** inArgV)
+/**
+@brief Paint counters of a window, see Window::GetPaintStats
+**/
+struct PaintStats
 {
-	// Initialize the windows
-	WindowA window_a = Window::sCreate<WindowA>({100, 100, 500, 500}, "WindowA");
-	WindowB window_b = Window::sCreate<WindowB>({100, 100, 500, 500}, "WindowB");
+	uint64_t			mRequested		= 0;				///< Repaints requested by the platform
+	uint64_t			mPainted		= 0;				///< Frames painted, lower than mRequested when the render thread coalesced requests or nothing visible was dirty
+	uint64_t			mPaintedArea	= 0;				///< Sum of the dirty areas passed to OnPaint, in pixels
+	double				mLastPaintTime	= 0.0;				///< Seconds the last frame took to paint
+	double				mMaxPaintTime	= 0.0;				///< Seconds the slowest frame took to paint
+};
 
-	// ...
-	
-	gProcessMessageLoop();
 
-	// ...
 
-	return 0;
-}
+/**
+@brief State of a window as the platform reports it, see Window::GetState. A window without flags is visible and in the background
+**/
+enum EWindowStateFlags : uint8_t
+{
+	cWindowMinimized	= 1,	///< The window is minimized
+	cWindowOccluded		= 2,	///< Nothing of the window can be seen, it is hidden (Win32) or reported covered (Headless::sPostState)
+	cWindowFocused		= 4,	///< The window is the active window
+};
+
+
+
+/**
+@brief How often a window paints and updates
+**/
+enum class EThrottle : uint8_t
+{
+	Full,				///< Every paint, OnUpdate and OnRender
+	Reduced,			///< At most ThrottlePolicy::mReducedRate paints and OnRender calls per second, OnUpdate keeps its fixed rate
+	Suspended,			///< No paints, OnUpdate or OnRender. What was not painted is painted when the window leaves the state
+};
+
+
+
+/**
+@brief Throttle of a window per state, see Window::SetThrottlePolicy. Minimized wins over occluded, occluded over focus
 **/
-extern void gProcessMessageLoop();
+struct ThrottlePolicy
+{
+	EThrottle			mFocused		= EThrottle::Full;
+	EThrottle			mBackground		= EThrottle::Full;			///< Visible but not focused, set to Reduced for panels that don't need to animate smoothly
+	EThrottle			mOccluded		= EThrottle::Suspended;
+	EThrottle			mMinimized		= EThrottle::Suspended;
+	double				mReducedRate	= 15.0;						///< Paints and OnRender calls per second for EThrottle::Reduced
+};
 
 
 
 /**
-@brief Kill all windows and shut down the application
+@brief Throttling counters, see Window::GetThrottleStats
+**/
+struct ThrottleStats
+{
+	uint64_t			mStateChanges	= 0;						///< State changes reported by the platform
+	uint64_t			mDeferredPaints	= 0;						///< Paints held back, their region is painted by a later paint
+	uint64_t			mSkippedUpdates	= 0;						///< OnUpdate steps skipped while suspended
+	uint64_t			mSkippedRenders	= 0;						///< OnRender calls skipped while reduced or suspended
+	double				mSavedTime		= 0.0;						///< Estimated seconds saved, from the average time of the paints, updates and renders that did run
+
+	ThrottleStats&		operator+=(const ThrottleStats& inOther);
+};
 
-WARNING:
-Use with great care! This will close the entire application!
 
+
+/**
+@brief Subscribers to the events of one window, see Window::GetEvents
+
+Every event is raised after the handler of the window type, bool events are handled when the handler or one of the
+subscribers returns true. Resize and Paint are raised on the render thread when the window has one, subscribing to
+them from the message loop thread then waits for the frame in progress. Subscribe on the message loop thread only.
 **/
-extern void gQuitApplication();
+struct WindowEvents
+{
+	Delegate<void(int, int)>				mResize;				///< Same as Window::OnResize
+	Delegate<void(const DirtyRegion&)>		mPaint;					///< Same as Window::OnPaint
+	Delegate<void()>						mClose;					///< Same as Window::OnClose
+	Delegate<void()>						mDestroy;				///< Same as Window::OnDestroy
+	Delegate<bool()>						mKeyDown;				///< Same as Window::OnKeyDown
+	Delegate<bool()>						mKeyUp;					///< Same as Window::OnKeyUp
+	Delegate<bool()>						mMouseDown;				///< Same as Window::OnMouseDown
+	Delegate<bool()>						mMouseUp;				///< Same as Window::OnMouseUp
+	Delegate<void(PointerBatch)>			mPointerBatch;			///< Same as Window::OnPointerBatch
+	Delegate<void(double)>					mUpdate;				///< Same as Window::OnUpdate
+	Delegate<void(double)>					mRender;				///< Same as Window::OnRender
+};
 
 
 
 /**
-@brief Base Win32 window class
+@brief Base window class
 **/
-struct WindowID;
+struct Message;
+struct WindowHandlers;
+class RenderThread;
+class Framebuffer;
 class Window
 {
 public:
 	///@name Create function + awful STL type traits stuff, which ensures that T inherits from Window
 	template<class T>
-	static typename std::enable_if<std::is_base_of<Window, T>::value, T*>::type sCreate(const IRect& inRect, const String& inName) { return (T*)sCreate(inRect, inName, new T); }
+	static typename std::enable_if<std::is_base_of<Window, T>::value, T*>::type sCreate(const IRect& inRect, const String& inName) { uint32_t class_id = sGetClassID<T>(); return (T*)sCreate(inRect, inName, new (sAllocate(class_id, sizeof(T), alignof(T))) T, class_id, sGetHandlers<T>()); }
+
+	///@name Bulk creation, reserves the window table and native storage once and registers the class once for all @a inCount windows
+	template<class T>
+	static typename std::enable_if<std::is_base_of<Window, T>::value, void>::type sCreateMany(const IRect* inRects, size_t inCount, const String& inName, T** outWindows);
+
+	///@name Destruction
+	virtual				~Window();							///< Windows are destructed through their base pointer on destroy, their memory goes back to the pool of their type
+
+	///@name Pooled storage, windows of the same type are allocated next to each other and their slots are recycled on destroy
+	template<class T, class F>
+	static void			sForEach(F&& inFunction)			{ sGetPool(sGetClassID<T>(), sizeof(T), alignof(T)).ForEach([&inFunction](void* inWindow) { inFunction((T*)inWindow); }); }	///< Call @a inFunction(T*) for every window of type T in address order, must not create or destroy windows
+	template<class T>
+	static PoolStats	sGetPoolStats()						{ return sGetPool(sGetClassID<T>(), sizeof(T), alignof(T)).GetStats(); }	///< Allocation counters of the windows of type T
+	static PoolStats	sGetPoolStats();					///< Allocation counters of all window types together
 
 	///@name Interaction
 	void				Show();								///< Force the window to be shown
 	void				Activate();							///< Activate the window
 	void				ShowAndActivate();					///< Show and activate the window
 
+	///@name Rendering
+	void				Invalidate();						///< Repaint the whole window in the next frame
+	void				Invalidate(const IRect& inRect);	///< Repaint @a inRect (client coordinates) in the next frame, every invalidation of a frame ends up in a single paint
+	void				EnableRenderThread();				///< Paint this window on its own thread from now on, OnResize and OnPaint are then called on that thread. Creates the events first, the render thread reads them
+	bool				HasRenderThread() const				{ return mRenderThread != nullptr; }	///< Check if this window paints on its own thread
+	PaintStats			GetPaintStats() const;				///< Get the paint counters, can be called from any thread
+	void				EnableFramebuffer();				///< Give this window a CPU framebuffer (call from OnCreate), it is sized to the client area before OnResize and presented after every OnPaint
+	Framebuffer*		GetFramebuffer() const				{ return mFramebuffer; }	///< Framebuffer to draw into in OnPaint, nullptr if not enabled
+
+	///@name Throttling, paints and fixed timestep events slow down or stop depending on the state of the window
+	uint8_t				GetState() const					{ return mState; }			///< Get the EWindowStateFlags the platform last reported
+	EThrottle			GetThrottle() const;				///< Get the throttle that applies to the current state
+	void				SetThrottlePolicy(const ThrottlePolicy& inPolicy);	///< Set the throttle per state, windows start with the policy of sSetDefaultThrottlePolicy
+	const ThrottlePolicy& GetThrottlePolicy() const			{ return mThrottlePolicy; }
+	const ThrottleStats& GetThrottleStats() const			{ return mThrottleStats; }	///< Get the throttling counters of this window, only on the message loop thread
+	static void			sSetDefaultThrottlePolicy(const ThrottlePolicy& inPolicy);	///< Set the policy of the windows created from now on
+	static ThrottleStats sGetThrottleStats();				///< Get the throttling counters of every window together, including destroyed ones
+
+	///@name Properties
+	WindowHandle		GetHandle() const					{ return mHandle; }			///< Get the handle of this window
+	WindowID			GetNativeHandle() const				{ return mNativeHandle; }	///< Get the platform window handle
+	const UID&			GetUID() const						{ return mUID; }			///< Get the stable ID of this window, unlike the handle it is never reused
+	uint32_t			GetClassID() const					{ return mClassID; }		///< Get the class of the window type, every window of a type has the same one
+	const WindowHandlers& GetHandlers() const				{ return *mHandlers; }		///< Get the handlers the window type overrides
+
+	///@name Event subscribers, to add behavior to a window without deriving from its type
+	WindowEvents&		GetEvents()							{ if (mEvents == nullptr) mEvents = new WindowEvents; return *mEvents; }	///< Get the subscribers of this window, created on first use or by EnableRenderThread
+	bool				HasEvents() const					{ return mEvents != nullptr; }	///< Check if GetEvents was ever called, windows without subscribers skip them at no cost
+
+	///@name Lookup
+	static Window*		sGet(WindowHandle inHandle);		///< Get the window of @a inHandle, nullptr if it was destroyed
+	static Window*		sFind(const UID& inUID);			///< Get the window of @a inUID, nullptr if it was destroyed
+
+	///@name Window classes
+	template<class T>
+	static uint32_t		sGetClassID()						{ static const uint32_t class_id = sAllocateClassID(); return class_id; }	///< Class ID of window type T, handed out in order of first use, the platform registers one native class per ID
+
 	///@name Events 
 	virtual void		OnCreate()							{ }	///< Occurs when the window is created
-	virtual void		OnPaint()							{ }	///< Occurs every time the window requests a repaint
+	virtual void		OnResize(int inWidth, int inHeight)	{ }	///< Occurs before a repaint when the client size changed, on the render thread if there is one
+	virtual void		OnPaint()							{ }	///< Occurs every time the window requests a repaint, on the render thread if there is one
+	virtual void		OnPaint(const DirtyRegion& inRegion)	{ OnPaint(); }	///< Same as OnPaint, but only @a inRegion (clipped to the client area) has to be redrawn
 	virtual void		OnClose()							{ }	///< Occurs when the window is closed
 	virtual void		OnDestroy()							{ }	///< Occurs when the window is finally destroyed
 
@@ -72,13 +206,259 @@ public:
 	virtual bool 		OnMouseDown()						{ return false; }	///< Occurs when a mouse button is down
 	virtual bool 		OnMouseUp()							{ return false; }	///< Occurs when a mouse button is released
 
+	///@name Batched events
+	virtual void		OnPointerBatch(PointerBatch inSamples)	{ }	///< Occurs once per frame with every cursor, wheel and raw sample the window received during the frame
+
+	///@name Fixed timestep events, only with ELoopPolicy::FixedUpdate
+	virtual void		OnUpdate(double inDeltaTime)		{ }	///< Occurs LoopSettings::mUpdateRate times per second after the messages of the frame, @a inDeltaTime is always 1 / mUpdateRate seconds
+	virtual void		OnRender(double inAlpha)			{ }	///< Occurs once per frame after the updates, @a inAlpha (0 to 1) is how far the clock is from the last update to the next one, to interpolate the drawn state with (usually followed by Invalidate)
+
 protected:
 	///@name Constructor
 						Window() = default;					///< Private default constructor as we want windows to be created with Window::sCreate
 
 private:
-	static Window*		sCreate(const IRect& inRect, const String& inName, void* inParent); ///< Create a window internally
+	friend bool			gDispatchMessage(const Message& inMessage);	///< Dispatch assigns the native handle on create
+	friend void			gStopRenderThreads();				///< The loop stops painting before the job system
+	friend void			gDeleteAllWindows();				///< Deleting stops the render thread first
+	friend void			gUpdateWindows(double inDeltaTime);	///< The loop calls OnUpdate
+	friend void			gRenderWindows(double inAlpha);		///< The loop calls OnRender
+	friend void			gReleaseDeferredPaints();			///< The loop lets held back paints through
+	friend double		gGetDeferredPaintTimeout();			///< The loop sleeps until the next held back paint
+	friend class		RenderThread;						///< The render thread calls Paint
+	friend class		Pointer;							///< Pointer delivers the batches
+
+	static Window*		sCreate(const IRect& inRect, const String& inName, void* inParent, uint32_t inClassID, const WindowHandlers& inHandlers); ///< Create a window internally
+
+	///@name Event routing
+	template<class T>
+	static const WindowHandlers& sGetHandlers();			///< Handlers of window type T, found at compile time
+
+	///@name Window classes
+	static uint32_t		sAllocateClassID();					///< Hand out the next class ID
+	static void			sReserve(size_t inCount);			///< Make room for @a inCount more windows
+
+	///@name Allocation
+	static ObjectPool&	sGetPool(uint32_t inClassID, size_t inSize, size_t inAlignment);	///< Pool of the windows with class @a inClassID, created on first use
+	static void*		sAllocate(uint32_t inClassID, size_t inSize, size_t inAlignment)	{ return sGetPool(inClassID, inSize, inAlignment).Allocate(); }	///< Memory for a window of class @a inClassID
+	static void			sFree(Window* inWindow);			///< Destruct @a inWindow and return its memory to its pool
+
+	///@name Pointer batches
+	bool				WantsPointerBatch() const;			///< Check if the window type or a subscriber takes pointer batches
+	void				SendPointerBatch(PointerBatch inSamples);	///< Call OnPointerBatch and its subscribers
+
+	///@name Rendering
+	void				Paint(int inWidth, int inHeight, const DirtyRegion& inRegion);	///< Call OnResize if needed and OnPaint, and update the paint counters
+	void				StopRenderThread();					///< Wait for the frame in progress and stop the render thread, painting stays off until a new render thread is enabled
+
+	///@name Throttling
+	void				SetState(uint8_t inState);			///< Apply a state reported by the platform
+	bool				DeferPaint(const Message& inMessage);	///< Hold back a paint the throttle does not allow now, true if it was held back
+	bool				ReleaseDeferredPaint(uint64_t inTimeNS);	///< Ask the platform for the held back paint if the throttle allows it, false if it has to wait longer
+	void				QueueDeferredPaint();				///< Release the held back paint now or queue it for gReleaseDeferredPaints
+	uint64_t			GetReducedIntervalNS() const;		///< Nanoseconds between paints and renders for EThrottle::Reduced
+	void				CountThrottled(uint64_t ThrottleStats::*inCounter, uint64_t inTotalNS, uint64_t inCount);	///< Count held back work in the window and global counters, its saved time is the average of @a inTotalNS over @a inCount
 
 	///@name Properties
-	WindowID			mHandle;							///< Win32 window handle
+	WindowHandle		mHandle;							///< Handle into the window table
+	WindowID			mNativeHandle = nullptr;			///< Platform window handle
+	UID					mUID = UID::sCreate();				///< Stable ID, key of the window registry
+	uint32_t			mClassID = 0;						///< Class of the window type, selects the pool the window lives in
+	const WindowHandlers* mHandlers = nullptr;				///< Handlers of the window type, dispatch skips the ones it does not override
+	WindowEvents*		mEvents = nullptr;					///< Subscribers, nullptr until GetEvents is called
+	RenderThread*		mRenderThread = nullptr;			///< Render thread, nullptr when painting on the message loop thread
+	Framebuffer*		mFramebuffer = nullptr;				///< CPU framebuffer, nullptr when not enabled
+	int					mPaintWidth = -1;					///< Client size of the last paint, only touched by the painting thread
+	int					mPaintHeight = -1;
+	DirtyRegion			mDirtyRegion;						///< Invalidated since the last paint, only touched by the message loop thread
+
+	///@name Throttling, only touched by the message loop thread
+	uint8_t				mState = 0;							///< EWindowStateFlags
+	bool				mPaintDeferred = false;				///< A paint was held back, its region is in mDirtyRegion
+	bool				mPaintQueued = false;				///< The window is in the list of gReleaseDeferredPaints
+	ThrottlePolicy		mThrottlePolicy;
+	ThrottleStats		mThrottleStats;
+	uint64_t			mLastPaintDispatchNS = 0;			///< Time the last paint was let through
+	uint64_t			mLastRenderNS = 0;					///< Time OnRender was last called
+	uint64_t			mUpdateNS = 0;						///< Time spent in OnUpdate, to estimate what a skipped step saves
+	uint64_t			mUpdates = 0;
+	uint64_t			mRenderNS = 0;						///< Time spent in OnRender
+	uint64_t			mRenders = 0;
+
+	///@name Paint counters
+	std::atomic<uint64_t> mPaintRequested { 0 };
+	std::atomic<uint64_t> mPainted { 0 };
+	std::atomic<uint64_t> mPaintedArea { 0 };
+	std::atomic<uint64_t> mLastPaintNS { 0 };
+	std::atomic<uint64_t> mMaxPaintNS { 0 };
+	std::atomic<uint64_t> mPaintNS { 0 };					///< Time spent painting
 };
+
+
+
+/**
+@brief How a window type implements one of the event handlers of Window
+**/
+enum class EWindowHandler : uint8_t
+{
+	Default,		///< The type keeps the empty default of Window
+	Overridden,		///< The type, or a class between it and Window, overrides the handler
+	Unknown,		///< The handler can't be named through the type (e.g. OnPaint() hides OnPaint(const DirtyRegion&)), it is called virtually
+};
+
+
+
+/**
+@brief Class that declared the member function with signature S that &T::Name resolves to, for WINDOW_HANDLER
+**/
+template<class S>
+struct WindowMemberClass;
+
+template<class R, class... A>
+struct WindowMemberClass<R(A...)>
+{
+	template<class C>
+	static C*			sGet(R (C::*)(A...));
+};
+
+
+
+/**
+@brief Defines the override check and the call of one event handler
+
+WindowHandler<Id><T>::cState tells how T implements the handler. WindowCall<Id><T>::sCall calls the handler of T
+without going through the vtable, WindowCall<Id><Window>::sCall calls it virtually.
+**/
+#define WINDOW_HANDLER(inId, inName, inReturn, inSignature, inParameters, inArguments)																\
+	template<class T, class = void>																													\
+	struct WindowHandler##inId { static constexpr EWindowHandler cState = EWindowHandler::Unknown; };												\
+	template<class T>																																\
+	struct WindowHandler##inId<T, decltype((void)WindowMemberClass<inReturn inSignature>::sGet(&T::inName))>											\
+	{																																				\
+		static constexpr EWindowHandler cState = std::is_same<decltype(WindowMemberClass<inReturn inSignature>::sGet(&T::inName)), Window*>::value	\
+			? EWindowHandler::Default : EWindowHandler::Overridden;																					\
+	};																																				\
+	template<class T>																																\
+	struct WindowCall##inId { static inReturn sCall inParameters { return static_cast<T*>(inWindow)->T::inName inArguments; } };					\
+	template<>																																		\
+	struct WindowCall##inId<Window> { static inReturn sCall inParameters { return inWindow->inName inArguments; } };
+
+WINDOW_HANDLER(Create,			OnCreate,		void,	(),						(Window* inWindow),								())
+WINDOW_HANDLER(Close,			OnClose,		void,	(),						(Window* inWindow),								())
+WINDOW_HANDLER(Destroy,			OnDestroy,		void,	(),						(Window* inWindow),								())
+WINDOW_HANDLER(KeyDown,			OnKeyDown,		bool,	(),						(Window* inWindow),								())
+WINDOW_HANDLER(KeyUp,			OnKeyUp,		bool,	(),						(Window* inWindow),								())
+WINDOW_HANDLER(MouseDown,		OnMouseDown,	bool,	(),						(Window* inWindow),								())
+WINDOW_HANDLER(MouseUp,			OnMouseUp,		bool,	(),						(Window* inWindow),								())
+WINDOW_HANDLER(Resize,			OnResize,		void,	(int, int),				(Window* inWindow, int inWidth, int inHeight),	(inWidth, inHeight))
+WINDOW_HANDLER(Paint,			OnPaint,		void,	(),						(Window* inWindow, const DirtyRegion&),			())
+WINDOW_HANDLER(PaintRegion,		OnPaint,		void,	(const DirtyRegion&),	(Window* inWindow, const DirtyRegion& inRegion),	(inRegion))
+WINDOW_HANDLER(PointerBatch,	OnPointerBatch,	void,	(PointerBatch),			(Window* inWindow, PointerBatch inSamples),		(inSamples))
+WINDOW_HANDLER(Update,			OnUpdate,		void,	(double),				(Window* inWindow, double inDeltaTime),			(inDeltaTime))
+WINDOW_HANDLER(Render,			OnRender,		void,	(double),				(Window* inWindow, double inAlpha),				(inAlpha))
+
+#undef WINDOW_HANDLER
+
+
+
+/**
+@brief Event handlers of a window type, built at compile time by Window::sCreate
+
+An entry is nullptr when the type keeps the empty default, dispatch then skips the handler and lets the platform run
+its default behavior. The other entries call the handler of the type directly instead of through the vtable, so
+messages a window type does not handle cost a null check. A type that overrides OnPaint() but not
+OnPaint(const DirtyRegion&) can add "using Window::OnPaint;" to have its paints called directly as well.
+**/
+struct WindowHandlers
+{
+	void				(*mOnCreate)(Window*)								= nullptr;
+	void				(*mOnClose)(Window*)								= nullptr;
+	void				(*mOnDestroy)(Window*)								= nullptr;
+	bool				(*mOnKeyDown)(Window*)								= nullptr;
+	bool				(*mOnKeyUp)(Window*)								= nullptr;
+	bool				(*mOnMouseDown)(Window*)							= nullptr;
+	bool				(*mOnMouseUp)(Window*)								= nullptr;
+	void				(*mOnResize)(Window*, int, int)						= nullptr;
+	void				(*mOnPaint)(Window*, const DirtyRegion&)			= nullptr;	///< OnPaint(const DirtyRegion&) or OnPaint(), whichever the type overrides
+	void				(*mOnPointerBatch)(Window*, PointerBatch)			= nullptr;
+	void				(*mOnUpdate)(Window*, double)						= nullptr;
+	void				(*mOnRender)(Window*, double)						= nullptr;
+
+	///@name Construction
+	template<class T>
+	static WindowHandlers sCreate();						///< Find the handlers that T overrides
+
+private:
+	template<EWindowHandler S, template<class> class C, class T>
+	static auto			sSelect() -> decltype(&C<T>::sCall);	///< nullptr for a default handler, the direct call for an overridden one and the virtual call otherwise
+};
+
+
+
+/**
+@brief Select the call of a handler with state S
+**/
+template<EWindowHandler S, template<class> class C, class T>
+auto WindowHandlers::sSelect() -> decltype(&C<T>::sCall)
+{
+	// Only the selected call is instantiated, the direct call would not compile for a handler that can't be named through T
+	using Call = typename std::conditional<S == EWindowHandler::Overridden, C<T>, C<Window>>::type;
+	return S == EWindowHandler::Default ? nullptr : &Call::sCall;
+}
+
+
+
+/**
+@brief Find the handlers that T overrides
+**/
+template<class T>
+WindowHandlers WindowHandlers::sCreate()
+{
+	WindowHandlers handlers;
+	handlers.mOnCreate			= sSelect<WindowHandlerCreate<T>::cState, WindowCallCreate, T>();
+	handlers.mOnClose			= sSelect<WindowHandlerClose<T>::cState, WindowCallClose, T>();
+	handlers.mOnDestroy			= sSelect<WindowHandlerDestroy<T>::cState, WindowCallDestroy, T>();
+	handlers.mOnKeyDown			= sSelect<WindowHandlerKeyDown<T>::cState, WindowCallKeyDown, T>();
+	handlers.mOnKeyUp			= sSelect<WindowHandlerKeyUp<T>::cState, WindowCallKeyUp, T>();
+	handlers.mOnMouseDown		= sSelect<WindowHandlerMouseDown<T>::cState, WindowCallMouseDown, T>();
+	handlers.mOnMouseUp			= sSelect<WindowHandlerMouseUp<T>::cState, WindowCallMouseUp, T>();
+	handlers.mOnResize			= sSelect<WindowHandlerResize<T>::cState, WindowCallResize, T>();
+	handlers.mOnPointerBatch	= sSelect<WindowHandlerPointerBatch<T>::cState, WindowCallPointerBatch, T>();
+	handlers.mOnUpdate			= sSelect<WindowHandlerUpdate<T>::cState, WindowCallUpdate, T>();
+	handlers.mOnRender			= sSelect<WindowHandlerRender<T>::cState, WindowCallRender, T>();
+
+	// The default OnPaint(const DirtyRegion&) only calls OnPaint()
+	if (WindowHandlerPaintRegion<T>::cState != EWindowHandler::Default)
+		handlers.mOnPaint		= sSelect<WindowHandlerPaintRegion<T>::cState, WindowCallPaintRegion, T>();
+	else
+		handlers.mOnPaint		= sSelect<WindowHandlerPaint<T>::cState, WindowCallPaint, T>();
+	return handlers;
+}
+
+
+
+/**
+@brief Handlers of window type T, built once per type
+**/
+template<class T>
+const WindowHandlers& Window::sGetHandlers()
+{
+	static const WindowHandlers handlers = WindowHandlers::sCreate<T>();
+	return handlers;
+}
+
+
+
+/**
+@brief Create @a inCount windows of type T, @a outWindows receives them in the order of @a inRects
+**/
+template<class T>
+typename std::enable_if<std::is_base_of<Window, T>::value, void>::type Window::sCreateMany(const IRect* inRects, size_t inCount, const String& inName, T** outWindows)
+{
+	uint32_t class_id = sGetClassID<T>();
+	sReserve(inCount);
+	sGetPool(class_id, sizeof(T), alignof(T)).Reserve(inCount);
+
+	for (size_t i = 0; i < inCount; ++i)
+		outWindows[i] = (T*)sCreate(inRects[i], inName, new (sAllocate(class_id, sizeof(T), alignof(T))) T, class_id, sGetHandlers<T>());
+}